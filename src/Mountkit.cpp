@@ -1,4 +1,4 @@
-#include "mountkit.h"
+#include "MountkitInternal.h"
 
 // Conditional includes และ debug control
 #ifdef EMBEDDED_BUILD
@@ -7,25 +7,33 @@
     #include <string.h>
     #include <stdint.h>
     
-    // Simple error handling แทน exit()
-    static volatile int system_error_flag = 0;
-    #define SET_ERROR_FLAG() (system_error_flag = 1)
-    #define CHECK_ERROR_FLAG() (system_error_flag)
-    #define CLEAR_ERROR_FLAG() (system_error_flag = 0)
+    // embedded build ไม่มี thread - error state ชุดเดียว
+    #define MOUNTKIT_THREAD_LOCAL
     
 #else
     // Desktop includes
     #include <cstring>
     #include <cstdlib>
     #include <cassert>
+    #include <cstdarg>
     #include <time.h>
+    #include <thread>
+    #include <atomic>
     
-    // Desktop error handling
-    #define SET_ERROR_FLAG() 
-    #define CHECK_ERROR_FLAG() (0)
-    #define CLEAR_ERROR_FLAG()
+    #define MOUNTKIT_THREAD_LOCAL thread_local
 #endif
 
+// capacity เริ่มต้นของไฟล์ใหม่ และขั้นต่ำของ buffer ที่ write แบบ copy-on-write จองใหม่ (ลดขนาดสำหรับ embedded)
+#ifdef EMBEDDED_BUILD
+    #define FILE_INITIAL_CAPACITY 512
+#else
+    #define FILE_INITIAL_CAPACITY 4096
+#endif
+
+// error ของ operation ที่ fail ล่าสุดต่อ thread (แทน flag ตัวเดียวที่ทุก thread เขียนร่วมกัน)
+// ถูกเขียนเฉพาะตอน fail และอยู่ใน storage ของ thread เอง - operation ที่สำเร็จไม่เสียอะไรเลย
+static MOUNTKIT_THREAD_LOCAL int last_error = MOUNTKIT_OK;
+
 // Debug control macros - ใช้ LIB_DEBUG เท่านั้น
 #ifdef LIB_DEBUG
     #define DEBUG_PRINTF(...) printf(__VA_ARGS__)
@@ -35,12 +43,29 @@
     #define DEBUG_FPRINTF(stream, ...) // Disable debug fprintf
 #endif
 
+// อ่านคู่ (data, size) ที่ตรงกัน - ถ้า writer สลับ buffer ระหว่างอ่าน (seq เปลี่ยน) ให้อ่านใหม่
+static void loadData(MyFile *file, uint8_t **data, size_t *size) {
+    for (;;) {
+        uint32_t seq = loadShared(&file->seq);
+        if (seq & 1) continue;
+        *data = loadShared(&file->data);
+        *size = loadShared(&file->size);
+        #ifndef EMBEDDED_BUILD
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (loadRelaxed(&file->seq) == seq) return;
+        #else
+            return;
+        #endif
+    }
+}
+
 // แก้ไขฟังก์ชัน write ให้ใช้ debug control ที่สอดคล้องกัน
 int mountkit::write(MyFile *file, const char *str) {
     if (!file || !str) {
         #ifdef LIB_DEBUG
             printf("Error: Invalid file or string\n");
         #endif
+        setError(MOUNTKIT_EINVAL);
         return 0;
     }
     
@@ -53,6 +78,13 @@ int mountkit::write(MyFile *file, uint8_t *data, size_t size) {
         #ifdef LIB_DEBUG
             printf("Error: Invalid parameters\n");
         #endif
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    
+    file = fileTarget(file);
+    if (file->kind == MOUNTKIT_DT_LINK) {
+        setError(MOUNTKIT_EINVAL); // target ของ symlink แก้ไม่ได้
         return 0;
     }
     
@@ -60,34 +92,69 @@ int mountkit::write(MyFile *file, uint8_t *data, size_t size) {
         printf("Writing %zu bytes to file '%s'\n", size, (char*)file->name);
     #endif
     
-    // ตรวจสอบว่าขนาดที่จะเขียนเกิน capacity หรือไม่
-    if (size > file->capacity) {
-        #ifdef EMBEDDED_BUILD
-            // สำหรับ embedded: ไม่ขยาย buffer ถ้าเกิน capacity
-            SET_ERROR_FLAG();
+    writeLock(&file->lock);
+    
+    if (lockfree_reads) {
+        // copy-on-write: reader ที่ไม่ถือ lock อาจกำลังอ่าน buffer เดิมอยู่
+        // buffer ใหม่ไม่ต้องสืบขนาดของเดิม - write แทนที่ทั้งไฟล์ จึงจองตาม size (ไฟล์ที่เคยใหญ่หดลงได้)
+        size_t new_capacity = FILE_INITIAL_CAPACITY;
+        while (new_capacity < size) {
+            new_capacity *= 2;
+        }
+        if (new_capacity > file->capacity && !quotaCheck(file->folder, new_capacity - file->capacity, 0)) {
+            writeUnlock(&file->lock);
             return 0;
-        #else
-            // สำหรับ desktop: ขยาย buffer ได้
-            size_t new_capacity = file->capacity;
-            while (new_capacity < size) {
-                new_capacity *= 2;
-            }
-            
-            uint8_t *new_data = (uint8_t*)realloc(file->data, new_capacity);
-            if (!new_data) {
-                SET_ERROR_FLAG();
+        }
+        uint8_t *fresh = (uint8_t*)malloc(new_capacity);
+        if (!fresh) {
+            writeUnlock(&file->lock);
+            setError(MOUNTKIT_ENOMEM);
+            return 0;
+        }
+        // ไม่ล้างส่วนหลัง size: read ไม่อ่านเกิน size และ append/append_shared เขียนทับก่อนเลื่อน size เสมอ
+        memcpy(fresh, data, size);
+        swapData(file, fresh, new_capacity, size);
+    } else {
+        // ตรวจสอบว่าขนาดที่จะเขียนเกิน capacity หรือไม่
+        if (size > file->capacity) {
+            #ifdef EMBEDDED_BUILD
+                // สำหรับ embedded: ไม่ขยาย buffer ถ้าเกิน capacity
+                writeUnlock(&file->lock);
+                setError(MOUNTKIT_ENOSPC);
                 return 0;
-            }
-            
-            file->data = new_data;
-            file->capacity = new_capacity;
-            memset(file->data + file->size, 0, file->capacity - file->size);
-        #endif
+            #else
+                // สำหรับ desktop: ขยาย buffer ได้
+                size_t new_capacity = file->capacity;
+                while (new_capacity < size) {
+                    new_capacity *= 2;
+                }
+                if (!quotaCheck(file->folder, new_capacity - file->capacity, 0)) {
+                    writeUnlock(&file->lock);
+                    return 0;
+                }
+                
+                if (!resizeData(file, new_capacity)) {
+                    writeUnlock(&file->lock);
+                    setError(MOUNTKIT_ENOMEM);
+                    return 0;
+                }
+                
+                memset(file->data + file->size, 0, file->capacity - file->size);
+            #endif
+        }
+        
+        // เขียนข้อมูลลงไฟล์
+        memcpy(file->data, data, size);
+        usageResize(file, file->size, size, file->capacity, file->capacity);
+        file->size = size;
     }
-    
-    // เขียนข้อมูลลงไฟล์
-    memcpy(file->data, data, size);
-    file->size = size;
+    file->reserved = size;
+    if (file->crc_state != MOUNTKIT_CRC_OFF) {
+        file->crc_state = MOUNTKIT_CRC_STALE; // คำนวณใหม่เมื่อมีคนขอ
+    }
+    metaTouch(nodeMeta(file), true);
+    writeUnlock(&file->lock);
+    notify(file, MOUNTKIT_WATCH_MODIFY, NULL);
     
     #ifdef LIB_DEBUG
         printf("Write successful: %zu bytes written\n", size);
@@ -102,6 +169,7 @@ int mountkit::append(MyFile *file, const char *str) {
         #ifdef LIB_DEBUG
             printf("Error: Invalid file or string\n");
         #endif
+        setError(MOUNTKIT_EINVAL);
         return 0;
     }
     
@@ -114,9 +182,17 @@ int mountkit::append(MyFile *file, uint8_t *data, size_t size) {
         #ifdef LIB_DEBUG
             printf("Error: Invalid parameters\n");
         #endif
+        setError(MOUNTKIT_EINVAL);
         return 0;
     }
     
+    file = fileTarget(file);
+    if (file->kind == MOUNTKIT_DT_LINK) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    
+    writeLock(&file->lock);
     size_t new_size = file->size + size;
     
     #ifdef LIB_DEBUG
@@ -139,27 +215,37 @@ int mountkit::append(MyFile *file, uint8_t *data, size_t size) {
         #ifdef LIB_DEBUG
             printf("Expanding capacity from %zu to %zu bytes\n", file->capacity, new_capacity);
         #endif
+        if (!quotaCheck(file->folder, new_capacity - file->capacity, 0)) {
+            writeUnlock(&file->lock);
+            return 0;
+        }
         
         // ขยาย buffer
-        uint8_t *new_data = (uint8_t*)realloc(file->data, new_capacity);
-        if (!new_data) {
+        if (!resizeData(file, new_capacity)) {
             #ifdef LIB_DEBUG
                 printf("Error: Failed to reallocate memory for %zu bytes\n", new_capacity);
             #endif
+            writeUnlock(&file->lock);
+            setError(MOUNTKIT_ENOMEM);
             return 0;
         }
         
-        file->data = new_data;
-        file->capacity = new_capacity;
-        
         #ifdef LIB_DEBUG
             printf("Memory reallocation successful\n");
         #endif
     }
     
-    // เขียนข้อมูลต่อท้าย
+    // เขียนข้อมูลต่อท้าย (reader เห็น bytes ใหม่หลังจาก size ถูก publish เท่านั้น)
     memcpy(file->data + file->size, data, size);
-    file->size = new_size;
+    usageResize(file, file->size, new_size, file->capacity, file->capacity);
+    storeShared(&file->size, new_size);
+    file->reserved = new_size;
+    if (file->crc_state == MOUNTKIT_CRC_VALID) {
+        file->crc32c = mountkit_crc32c(file->crc32c, data, size);
+    }
+    metaTouch(nodeMeta(file), true);
+    writeUnlock(&file->lock);
+    notify(file, MOUNTKIT_WATCH_MODIFY, NULL);
     
     #ifdef LIB_DEBUG
         printf("Append successful: %zu bytes added\n", size);
@@ -176,20 +262,31 @@ int mountkit::read(MyFile *file, uint8_t *buffer, size_t size, size_t offset) {
         #ifdef LIB_DEBUG
             printf("Error: Invalid file or buffer\n");
         #endif
+        setError(MOUNTKIT_EINVAL);
         return 0;
     }
     
-    if (offset >= file->size) {
+    file = fileTarget(file);
+    lookupLock(&file->lock);
+    rcuEnter();
+    uint8_t *file_data;
+    size_t file_size;
+    loadData(file, &file_data, &file_size);
+    if (offset >= file_size) {
         #ifdef LIB_DEBUG
-            printf("Error: Offset (%zu) exceeds file size (%zu)\n", offset, file->size);
+            printf("Error: Offset (%zu) exceeds file size (%zu)\n", offset, file_size);
         #endif
+        rcuLeave();
+        lookupUnlock(&file->lock);
         return 0;
     }
     
-    size_t available = file->size - offset;
+    size_t available = file_size - offset;
     size_t to_read = (size > available) ? available : size;
     
-    memcpy(buffer, file->data + offset, to_read);
+    memcpy(buffer, file_data + offset, to_read);
+    rcuLeave();
+    lookupUnlock(&file->lock);
     
     #ifdef LIB_DEBUG
         printf("Read %zu bytes from file '%s' at offset %zu\n", to_read, (char*)file->name, offset);
@@ -204,6 +301,7 @@ void mountkit::cat(MyFile *file) {
         printf("Error: Invalid file\n");
         return;
     }
+    file = fileTarget(file);
     
     // cat output should always be visible (not debug-controlled)
     printf("Content of file '%s' (%zu bytes):\n", (char*)file->name, file->size);
@@ -270,16 +368,45 @@ void mountkit::createFolder(MyFolder **folder, const char *name) {
     newFolder->files = NULL;
     newFolder->subdir = NULL;
     newFolder->dir = NULL;
+    newFolder->mounted = NULL;
+    newFolder->alloc_flags = 0;
+    newFolder->lock = 0;
+    newFolder->index = NULL;
+    newFolder->parent = NULL;
+    memset(&newFolder->usage, 0, sizeof(newFolder->usage));
+    newFolder->usage.dirs = 1;
+    newFolder->usage.names = strlen(name);
+    metaInit(nodeMeta(newFolder), MOUNTKIT_MODE_DIR);
+    memset(&newFolder->quota, 0, sizeof(newFolder->quota));
     *folder = newFolder;
 }
 
 // free memory ของไฟล์ในโฟลเดอร์
+// ไฟล์ที่ยังมีชื่ออื่น (hard link) อยู่นอก folder ถูกคืนเฉพาะชื่อ
 void mountkit::freeFiles(MyFile *file) {
     while (file) {
         MyFile *next = file->next;
-        free(file->name);
-        free(file->data);
-        free(file);
+        MyFile *inode = fileTarget(file);
+        // folder == NULL: linkEvacuate ถอดไฟล์ออกจากยอดเพราะยังมีชื่ออื่นอยู่ตอน rmdir
+        bool shared = inode != file || !inode->folder;
+        bool last = linkDrop(inode);
+        if (inode != file) {
+            namesAdd(&link_names, true);
+            writeLock(&file->lock);
+            releaseFile(file);
+        }
+        if (last && shared && (lockfree_reads || safe_handles)) {
+            // ชื่ออื่นถูกลบหลัง subtree นี้ - handle ที่ได้ไฟล์มาจากชื่อนั้นยังต้องรอ grace period ของตัวเอง
+            retire(inode, MOUNTKIT_RETIRE_FILE);
+        } else if (last) {
+            writeLock(&inode->lock); // รอ thread ที่ยังอ่าน/เขียนไฟล์นี้อยู่
+            releaseFile(inode);
+        } else if (inode == file) {
+            // ชื่ออื่นได้ไฟล์ไปหลัง linkEvacuate (ln ระหว่าง rmdir) - เลิกนับยอดเข้า folder ที่กำลังถูกคืน
+            writeLock(&inode->lock);
+            inode->folder = NULL;
+            writeUnlock(&inode->lock);
+        }
         file = next;
     }
 }
@@ -287,65 +414,155 @@ void mountkit::freeFiles(MyFile *file) {
 // ลบโฟลเดอร์และลูกทั้งหมด
 void mountkit::removeFolder(MyFolder *folder) {
     if (!folder) return;
-    freeFiles(folder->files);
-    removeFolder(folder->subdir);
-    removeFolder(folder->dir);
-    free(folder->data);
-    free(folder);
+    #ifndef EMBEDDED_BUILD
+        if (pool) {
+            parallelWalk(MOUNTKIT_WALK_REMOVE, folder, NULL);
+            return;
+        }
+    #endif
+    // folder ถูกถอดออกจาก tree แล้ว - รอเฉพาะ thread ที่เดินเข้ามาก่อนหน้า (lock ไม่ต้องปล่อยเพราะ node ถูก free)
+    // free node ใน post-visit: iterator อ่าน link ของลูกและ sibling ไปก่อนแล้ว
+    MyIter it;
+    iter_begin(&it, folder, MOUNTKIT_ITER_PRE | MOUNTKIT_ITER_POST | MOUNTKIT_ITER_SIBLINGS);
+    while (iter_next(&it)) {
+        if (!it.post) {
+            writeLock(&it.folder->lock);
+            freeFiles(it.folder->files);
+        } else {
+            releaseFolderNode(it.folder);
+        }
+    }
+    iter_end(&it);
 }
 
-// ลบโฟลเดอร์และลูกทั้งหมด (เวอร์ชันที่ใช้ recursive)
+// ลบโฟลเดอร์และลูกทั้งหมด (ไม่รวม sibling ของ folder)
 void mountkit::removeFolderRecursive(MyFolder *folder) {
     if (!folder) return;
-    // ลบไฟล์ในโฟลเดอร์
-    freeFiles(folder->files);
-    folder->files = NULL;
-    // ลบโฟลเดอร์ย่อย
-    if (folder->subdir) {
-        removeFolderRecursive(folder->subdir);
-        folder->subdir = NULL;
-    }
-    // ลบโฟลเดอร์ปัจจุบัน
-    free(folder->data);
-    free(folder);
+    linkInvalidate();
+    MyIter it;
+    iter_begin(&it, folder, MOUNTKIT_ITER_PRE | MOUNTKIT_ITER_POST);
+    while (iter_next(&it)) {
+        if (!it.post) {
+            writeLock(&it.folder->lock);
+            freeFiles(it.folder->files);
+            it.folder->files = NULL;
+        } else {
+            releaseFolderNode(it.folder);
+        }
+    }
+    iter_end(&it);
 }
 
 // ลบโฟลเดอร์ตาม path
-void mountkit::rmdir(MyFolder **root, const char *path) {
+// concurrent mode: เดินลงด้วย read lock แบบ hand-over-hand และถือ lock ของระดับ parent ไว้อีกหนึ่งชั้น
+// เพื่อให้เปลี่ยน lock ของ chain สุดท้ายเป็น write lock ได้โดยที่ chain นั้นไม่ถูกลบไปก่อน
+bool mountkit::rmdirPath(MyFolder **root, const char *path) {
+    if (!root || !path) {
+        setError(MOUNTKIT_EINVAL);
+        return false;
+    }
     char buf[256];
     strncpy(buf, path, sizeof(buf)); buf[sizeof(buf)-1] = '\0';
-    char *token = strtok(buf, "/");
-    MyFolder **current = root, **prev = NULL;
+    char *cursor = buf;
+    char *token = nextToken(&cursor);
+    MyFolder **current = root;
+    uint32_t *outer = NULL;       // lock ของ parent ของเจ้าของ chain (read)
+    uint32_t *lock = &root_lock;  // lock ของ chain *current (read, หรือ write ที่ component สุดท้าย)
+    bool exclusive = false;
+    MyFolder *parent = NULL;      // folder ที่ chain *current อยู่ (NULL = root chain)
+    MyFolder *victim = NULL;
+    int error = MOUNTKIT_ENOENT;
+    readLock(lock);
     while (token && *current) {
+        char *next_token = nextToken(&cursor);
+        if (!next_token && concurrent) {
+            readUnlock(lock);
+            writeLock(lock);
+            exclusive = true;
+        }
         MyFolder *iter = *current;
-        prev = current;
+        MyFolder **prev = current;
         while (iter && strcmp(iter->data, token) != 0) {
             prev = &iter->dir;
             iter = iter->dir;
         }
-        if (!iter) return;
-        current = &iter->subdir;
-        token = strtok(NULL, "/");
-        if (!token) {
-            *prev = iter->dir;
-            iter->dir = NULL;
-            removeFolder(iter);
-            return;
+        if (!iter) break;
+        if (!next_token) {
+            // mount point ที่ยังใช้งานอยู่ลบไม่ได้ (ต้อง umount ก่อน)
+            if (!iter->mounted) {
+                storeShared(prev, iter->dir);
+                indexRemove(parent, iter, NULL);
+                usageDetach(iter);
+                if (parent) metaTouch(nodeMeta(parent), true);
+                victim = iter;
+            } else {
+                error = MOUNTKIT_EBUSY;
+            }
+            break;
         }
+        MyFolder *inner = followMount(iter);
+        readLock(&inner->lock);
+        if (outer) readUnlock(outer);
+        outer = lock;
+        lock = &inner->lock;
+        current = &inner->subdir;
+        parent = inner;
+        token = next_token;
     }
+    if (exclusive) writeUnlock(lock); else readUnlock(lock);
+    if (outer) readUnlock(outer);
+    if (victim) {
+        linkInvalidate();
+        linkEvacuate(victim);
+        if (parent) notify(parent, MOUNTKIT_WATCH_DELETE | MOUNTKIT_WATCH_ISDIR, victim->data);
+        notifyGone(victim, NULL);
+        // lock-free read mode / safe handle: reader หรือ handle อาจยังอยู่ใน subtree - คืนหน่วยความจำหลัง grace period
+        if (lockfree_reads || safe_handles) {
+            retire(victim, MOUNTKIT_RETIRE_FOLDER);
+        } else {
+            victim->dir = NULL;
+            removeFolder(victim);
+        }
+    } else {
+        setError(error);
+    }
+    return victim != NULL;
+}
+
+void mountkit::rmdir(MyFolder **root, const char *path) {
+    rmdirPath(root, path);
 }
 
 // mkdir: สร้าง path และ return pointer ไปยัง Folder สุดท้าย
 MyFolder* mountkit::mkdir(MyFolder **root, const char *path) {
     if (!root || !path) {
-        SET_ERROR_FLAG();
+        setError(MOUNTKIT_EINVAL);
         return NULL;
     }
-    
+    return mkdirWalk(root, NULL, path);
+}
+
+// mkdir_at: เหมือน mkdir แต่เริ่มที่ subdir chain ของ parent (folder ใหม่รู้ parent ของตัวเองตั้งแต่ระดับแรก)
+MyFolder* mountkit::mkdir_at(MyFolder *parent, const char *path) {
+    if (!parent || !path) {
+        setError(MOUNTKIT_EINVAL);
+        return NULL;
+    }
+    parent = followMount(parent);
+    return mkdirWalk(&parent->subdir, parent, path);
+}
+
+// concurrent mode: ค้นด้วย read lock และขอ write lock เฉพาะ chain ที่ต้องเพิ่ม folder ใหม่
+MyFolder* mountkit::mkdirWalk(MyFolder **root, MyFolder *parent, const char *path) {
     char buf[256];
     strncpy(buf, path, sizeof(buf)); buf[sizeof(buf)-1] = '\0';
-    char *token = strtok(buf, "/");
-    MyFolder **current = root, *last = NULL;
+    char *cursor = buf;
+    char *token = nextToken(&cursor);
+    MyFolder **current = root, *last = parent;
+    uint32_t *outer = NULL;       // lock ของ parent ของเจ้าของ chain - กัน chain ถูกลบระหว่างเปลี่ยน lock
+    uint32_t *lock = parent ? &parent->lock : &root_lock; // lock ของ chain *current
+    bool exclusive = false, outer_exclusive = false;
+    readLock(lock);
     while (token) {
         MyFolder *iter = *current;
         MyFolder **prev = current;
@@ -353,97 +570,215 @@ MyFolder* mountkit::mkdir(MyFolder **root, const char *path) {
             prev = &iter->dir;
             iter = iter->dir;
         }
+        if (!iter && concurrent && !exclusive) {
+            // ไม่พบ: ขอ write lock แล้วค้นใหม่ (thread อื่นอาจสร้างไปแล้วระหว่างนั้น)
+            readUnlock(lock);
+            writeLock(lock);
+            exclusive = true;
+            continue;
+        }
         if (iter) {
-            last = iter;
-            current = &iter->subdir;
+            last = followMount(iter);
         } else {
+            if (!quotaCheck(last, 0, 1)) {
+                if (exclusive) writeUnlock(lock); else readUnlock(lock);
+                if (outer && outer_exclusive) writeUnlock(outer); else if (outer) readUnlock(outer);
+                return NULL;
+            }
             MyFolder *new_folder = NULL;
             createFolder(&new_folder, token);
             
             // ตรวจสอบว่า createFolder สำเร็จหรือไม่
             if (!new_folder) {
-                SET_ERROR_FLAG();
+                if (exclusive) writeUnlock(lock); else readUnlock(lock);
+                if (outer && outer_exclusive) writeUnlock(outer); else if (outer) readUnlock(outer);
+                setError(MOUNTKIT_ENOMEM);
                 return NULL; // แทน crash
             }
             
-            *prev = new_folder;
+            storeShared(prev, new_folder); // publish หลังสร้าง node เสร็จแล้ว
+            indexInsert(last, new_folder, NULL);
+            usageAttach(last, new_folder);
+            if (last) metaTouch(nodeMeta(last), true);
+            linkInvalidate(); // folder ใหม่บัง symlink ชื่อเดียวกันใน folder นี้
+            if (last) notify(last, MOUNTKIT_WATCH_CREATE | MOUNTKIT_WATCH_ISDIR, token);
             last = new_folder;
-            current = &(new_folder->subdir);
         }
-        token = strtok(NULL, "/");
+        // ล็อก folder ถัดไปก่อน แล้วเลื่อน lock ของ chain นี้ขึ้นไปเป็น outer
+        readLock(&last->lock);
+        if (outer && outer_exclusive) writeUnlock(outer); else if (outer) readUnlock(outer);
+        outer = lock;
+        outer_exclusive = exclusive;
+        exclusive = false;
+        lock = &last->lock;
+        current = &last->subdir;
+        token = nextToken(&cursor);
     }
+    readUnlock(lock);
+    if (outer && outer_exclusive) writeUnlock(outer); else if (outer) readUnlock(outer);
     return last;
 }
 
-// mk: สร้างไฟล์ใหม่ในโฟลเดอร์ (ไม่ซ้ำชื่อ) พร้อมกำหนด capacity
-MyFile* mountkit::mk(MyFolder *folder, const char *filename) {
-    if (!folder || !filename) {
-        SET_ERROR_FLAG();
-        return NULL;
-    }
-    
-    // ตรวจสอบว่ามีไฟล์ชื่อเดียวกันอยู่แล้วหรือไม่
-    for (MyFile *cur = folder->files; cur; cur = cur->next) {
-        if (strcmp((char*)cur->name, filename) == 0) {
-            // ถ้ามีไฟล์อยู่แล้ว ให้ return pointer เดิม
-            return cur;
-        }
-    }
-    
-    // สร้างไฟล์ใหม่
+// ค้นหาไฟล์ตามชื่อใน folder (ผู้เรียกถือ lock ของ folder)
+static MyFile* findFile(MyFolder *folder, const char *filename) {
+    MyFile *cur = loadShared(&folder->files);
+    while (cur && strcmp((char*)cur->name, filename) != 0) cur = loadShared(&cur->next);
+    return cur;
+}
+
+MyFile* mountkit::newFile(const char *filename, bool with_data) {
     MyFile *file = (MyFile*)malloc(sizeof(MyFile));
     if (!file) {
-        SET_ERROR_FLAG();
         return NULL; // แทน exit(1)
     }
     
     file->name = (uint8_t*)strdup(filename);
     if (!file->name) {
         free(file);
-        SET_ERROR_FLAG();
         return NULL; // แทน exit(1)
     }
     
-    // กำหนด capacity เริ่มต้น (ลดขนาดสำหรับ embedded)
-    #ifdef EMBEDDED_BUILD
-        file->capacity = 512; // 512 bytes สำหรับ embedded
-    #else
-        file->capacity = 4096; // 4KB สำหรับ desktop
-    #endif
+    file->capacity = FILE_INITIAL_CAPACITY;
+    if (!with_data) file->capacity = 0; // ชื่อของ hard link - data อยู่ที่ไฟล์จริง
     
-    file->data = (uint8_t*)malloc(file->capacity);
-    if (!file->data) {
+    file->data = file->capacity ? (uint8_t*)malloc(file->capacity) : NULL;
+    if (!file->data && file->capacity) {
         free(file->name);
         free(file);
-        SET_ERROR_FLAG();
         return NULL; // แทน exit(1)
     }
     
     file->size = 0;
-    memset(file->data, 0, file->capacity);
-    file->next = folder->files;
-    folder->files = file;
+    file->reserved = 0;
+    file->crc32c = 0;
+    file->crc_state = MOUNTKIT_CRC_OFF;
+    file->alloc_flags = 0;
+    file->lock = 0;
+    file->seq = 0;
+    file->next = NULL;
+    file->folder = NULL;
+    file->kind = MOUNTKIT_DT_FILE;
+    file->links = 1;
+    file->link = NULL;
+    file->cache = NULL;
+    if (with_data) {
+        metaInit(nodeMeta(file), MOUNTKIT_MODE_FILE);
+    } else {
+        #ifndef EMBEDDED_BUILD
+            memset(&file->meta, 0, sizeof(file->meta)); // ชื่อของ hard link ใช้ metadata ของไฟล์จริง (symlink ตั้งเอง)
+        #endif
+    }
+    if (file->data) memset(file->data, 0, file->capacity);
+    return file;
+}
+
+MyFile* mountkit::linkFile(MyFolder *folder, MyFile *file, bool check_duplicate) {
+    writeLock(&folder->lock);
+    MyFile *existing = check_duplicate ? findFile(folder, (char*)file->name) : NULL;
+    if (!existing) linkFileLocked(folder, file);
+    writeUnlock(&folder->lock);
+    return existing;
+}
+
+void mountkit::linkFileLocked(MyFolder *folder, MyFile *file) {
+    storeShared(&file->next, folder->files);
+    storeShared(&folder->files, file); // publish หลัง next ชี้ถูกแล้ว
+    indexInsert(folder, NULL, file);
+    writeLock(&file->lock); // writer ของไฟล์ที่ถูก mv ส่งส่วนต่างไปยัง folder ใหม่หลังจากนี้
+    usageLink(folder, file);
+    writeUnlock(&file->lock);
+    metaTouch(nodeMeta(folder), true);
+}
+
+// mk: สร้างไฟล์ใหม่ในโฟลเดอร์ (ไม่ซ้ำชื่อ) พร้อมกำหนด capacity
+MyFile* mountkit::mk(MyFolder *folder, const char *filename) {
+    if (!folder || !filename) {
+        setError(MOUNTKIT_EINVAL);
+        return NULL;
+    }
+    
+    // ตรวจสอบว่ามีไฟล์ชื่อเดียวกันอยู่แล้วหรือไม่ - ถ้ามี ให้ return pointer เดิม
+    rcuEnter();
+    lookupLock(&folder->lock);
+    MyFile *existing = findFile(folder, filename);
+    lookupUnlock(&folder->lock);
+    rcuLeave();
+    if (existing) return existing;
     
+    // สร้างไฟล์ใหม่นอก lock แล้วค่อยใส่เข้า folder
+    MyFile *file = newFile(filename);
+    if (!file) {
+        setError(MOUNTKIT_ENOMEM);
+        return NULL;
+    }
+    if (!quotaCheck(folder, file->capacity, 1)) {
+        releaseFile(file);
+        return NULL;
+    }
+    existing = linkFile(folder, file, concurrent);
+    if (existing) {
+        // thread อื่นสร้างชื่อเดียวกันไปก่อน
+        releaseFile(file);
+        return existing;
+    }
+    notify(folder, MOUNTKIT_WATCH_CREATE, filename);
     return file;
 }
 
-// cd: เดิน path และคืน pointer ของตำแหน่งนั้น (รองรับ .. และ .)
+// cd: เดิน path และคืน pointer ของตำแหน่งนั้น (รองรับ .., . และ symlink)
+// เก็บ folder ที่เดินผ่านไว้ใน stack จึงถอย .. ได้ทันทีโดยไม่ต้องค้นหา parent จากทั้ง tree
+// concurrent mode: read lock แบบ hand-over-hand, ถ้า path มี .. จะถือ lock ทุกระดับไว้จนจบ
+// lock-free read mode: ไม่ถือ lock เลย อ่าน link ด้วย acquire load ภายใน read-side section
 MyFolder* mountkit::cd(MyFolder *root, const char *path) {
-    if (!root || !path) return NULL;
-    
+    if (!root || !path) {
+        setError(MOUNTKIT_EINVAL);
+        return NULL;
+    }
+    return cdWalk(root, path, concurrent && !lockfree_reads && strstr(path, "..") != NULL, true, NULL);
+}
+
+// symlink: แทน component ด้วย target แล้วเดินต่อใน buffer เดิม (relative เดินต่อจาก folder ของ symlink, absolute เริ่มที่ root)
+// stack จึงยังเป็น folder จริงที่เดินผ่านมา และ ".." ใน target ถอยตาม folder จริง
+// folder ที่ถึงหลังเดินครบ target ถูกจำไว้ใน symlink - ครั้งถัดไปข้ามไปที่ folder นั้นเลย (ถ้าส่วนที่เหลือไม่มี "..")
+// ต้องเริ่มเดินใหม่ทั้ง path ถ้า target นำ ".." เข้ามาระหว่างที่ stack ไม่ครบ:
+// concurrent mode ที่ไม่ได้ถือ lock ทุกระดับ (hold_all) หรือหลังข้ามผ่านผลที่จำไว้ (stack ขาด folder ระหว่างทาง)
+MyFolder* mountkit::cdWalk(MyFolder *root, const char *path, bool hold_all, bool use_cache, MyFolder **outer) {
     char buf[256];
     strncpy(buf, path, sizeof(buf)); 
     buf[sizeof(buf)-1] = '\0';
+    size_t buf_len = strlen(buf);
     
-    char *token = strtok(buf, "/");
-    MyFolder *current = root;
+    char *cursor = buf;
+    char *token = nextToken(&cursor);
     
     // ถ้า token แรกตรงกับ root name ให้ข้ามไป
-    if (token && strcmp(current->data, token) == 0) {
-        token = strtok(NULL, "/");
+    if (token && strcmp(root->data, token) == 0) {
+        token = nextToken(&cursor);
     }
     
-    while (token && current) {
+    // symlink ที่รอจำ folder ปลายทาง: ครบ target เมื่อ path ที่เหลือไม่เกิน rest bytes
+    // (ส่วนท้ายของ buffer ไม่เปลี่ยนเมื่อ target ซ้อนกัน - ตัวที่ใส่ทีหลังครบก่อนเสมอ)
+    struct { MyFile *link; size_t rest; uint64_t gen; } fills[8];
+    int fill_count = 0;
+    bool cacheable = use_cache && (lockfree_reads || !concurrent);
+    bool shortcut = false; // ข้ามผ่านผลที่จำไว้แล้ว
+    int hops = 0;
+    int error = MOUNTKIT_ENOENT;
+    
+    MyFolder *stack[128];
+    int top = 0;
+    rcuEnter();
+    stack[0] = followMount(root);
+    lookupLock(&stack[0]->lock);
+    
+    for (;;) {
+        size_t remaining = token ? buf_len - (size_t)(token - buf) : 0;
+        while (fill_count > 0 && remaining <= fills[fill_count - 1].rest) {
+            fill_count--;
+            linkRemember(root, fills[fill_count].link, stack[top], fills[fill_count].gen);
+        }
+        if (!token) break;
+        MyFolder *current = stack[top];
         #ifdef LIB_DEBUG
             printf("Processing token: '%s'\n", token);
         #endif
@@ -456,313 +791,936 @@ MyFolder* mountkit::cd(MyFolder *root, const char *path) {
             #endif
         } 
         else if (strcmp(token, "..") == 0) {
-            // Parent directory - ต้องหา parent ของ current
+            // Parent directory - ถ้าอยู่ที่ root แล้วให้อยู่ที่เดิม
+            if (top > 0) {
+                lookupUnlock(&current->lock);
+                top--;
+            }
             #ifdef LIB_DEBUG
-                printf("   [DEBUG] Going to parent directory from: %s\n", current->data);
+                printf("   [DEBUG] Moved to parent directory: %s\n", stack[top]->data);
             #endif
-            
-            MyFolder *parent = findParent(root, current);
-            if (parent) {
-                current = parent;
-                #ifdef LIB_DEBUG
-                    printf("   [DEBUG] Found parent: %s\n", current->data);
-                #endif
-            } else {
-                // ถ้าไม่พบ parent (อยู่ที่ root แล้ว) ให้อยู่ที่เดิม
-                #ifdef LIB_DEBUG
-                    printf("   [DEBUG] Already at root, staying at: %s\n", current->data);
-                #endif
-            }
         } 
         else {
             // Normal directory name
-            MyFolder *iter = current->subdir;
+            MyFolder *iter = loadShared(&current->subdir);
             while (iter && strcmp(iter->data, token) != 0) {
-                iter = iter->dir;
+                iter = loadShared(&iter->dir);
+            }
+            if (top + 1 >= (int)(sizeof(stack) / sizeof(stack[0]))) break;
+            MyFolder *next = iter ? followMount(iter) : NULL;
+            MyFile *link = iter ? NULL : linkFind(current, token);
+            if (link) {
+                bool rest_dots = strstr(cursor, "..") != NULL;
+                if (cacheable && !rest_dots) next = linkCached(root, link);
+                if (next) {
+                    shortcut = true;
+                } else {
+                    if (++hops > MOUNTKIT_SYMLOOP_MAX) {
+                        error = MOUNTKIT_ELOOP;
+                        break;
+                    }
+                    // target + "/" + ส่วนที่เหลือ (data ของ symlink ไม่เปลี่ยนหลังสร้าง และอาจไม่มี '\0' ปิดท้ายหลัง compact)
+                    char spliced[256];
+                    size_t target_len = link->size;
+                    size_t rest_len = strlen(cursor);
+                    if (target_len + 1 + rest_len >= sizeof(spliced)) {
+                        error = MOUNTKIT_EINVAL;
+                        break;
+                    }
+                    memcpy(spliced, link->data, target_len);
+                    spliced[target_len] = '/';
+                    memcpy(spliced + target_len + 1, cursor, rest_len + 1);
+                    if (strstr(spliced, "..") && ((concurrent && !lockfree_reads && !hold_all) || shortcut)) {
+                        if (hold_all) {
+                            for (int i = top; i >= 0; --i) lookupUnlock(&stack[i]->lock);
+                        } else {
+                            lookupUnlock(&stack[top]->lock);
+                            if (outer && top > 0) lookupUnlock(&stack[top - 1]->lock);
+                        }
+                        rcuLeave();
+                        return cdWalk(root, path, concurrent && !lockfree_reads, false, outer);
+                    }
+                    if (cacheable && !rest_dots && fill_count < (int)(sizeof(fills) / sizeof(fills[0]))) {
+                        fills[fill_count].link = link;
+                        fills[fill_count].rest = rest_len;
+                        fills[fill_count].gen = linkGeneration();
+                        fill_count++;
+                    }
+                    bool absolute = target_len > 0 && spliced[0] == '/';
+                    if (absolute && top > 0) {
+                        // เริ่มใหม่ที่ root: ปล่อยทุกระดับที่ถืออยู่ยกเว้น root
+                        if (hold_all) {
+                            for (int i = top; i > 0; --i) lookupUnlock(&stack[i]->lock);
+                        } else {
+                            lookupUnlock(&stack[top]->lock);
+                            if (outer && top > 1) lookupUnlock(&stack[top - 1]->lock);
+                            if (!outer || top > 1) lookupLock(&stack[0]->lock);
+                        }
+                        top = 0;
+                    }
+                    memcpy(buf, spliced, target_len + 1 + rest_len + 1);
+                    buf_len = target_len + 1 + rest_len;
+                    cursor = buf;
+                    token = nextToken(&cursor);
+                    if (absolute && token && strcmp(root->data, token) == 0) {
+                        token = nextToken(&cursor);
+                    }
+                    continue;
+                }
             }
             
-            if (!iter) {
+            if (!next) {
                 #ifdef LIB_DEBUG
                     printf("   [DEBUG] Directory '%s' not found in %s\n", token, current->data);
                 #endif
-                return NULL; // Directory not found
+                break; // Directory not found
             }
             
-            current = iter;
+            lookupLock(&next->lock);
+            if (!hold_all) {
+                // outer: ถือ parent ของ folder ปัจจุบันไว้อีกหนึ่งชั้นแบบ pathWalk
+                if (!outer) lookupUnlock(&current->lock);
+                else if (top > 0) lookupUnlock(&stack[top - 1]->lock);
+            }
+            stack[++top] = next;
             #ifdef LIB_DEBUG
-                printf("   [DEBUG] Moved to directory: %s\n", current->data);
+                printf("   [DEBUG] Moved to directory: %s\n", next->data);
             #endif
         }
         
-        token = strtok(NULL, "/");
+        token = nextToken(&cursor);
     }
-    
-    return current;
+    MyFolder *result = token ? NULL : stack[top];
+    
+    // ปล่อย lock ทั้งหมด ยกเว้น folder และ parent ของมันเมื่อผู้เรียกขอ outer (สำเร็จเท่านั้น)
+    int keep = result && outer ? (top > 0 ? 2 : 1) : 0;
+    if (hold_all) {
+        for (int i = top - keep; i >= 0; --i) lookupUnlock(&stack[i]->lock);
+    } else if (!keep) {
+        lookupUnlock(&stack[top]->lock);
+        if (outer && top > 0) lookupUnlock(&stack[top - 1]->lock);
+    }
+    if (keep) {
+        *outer = top > 0 ? stack[top - 1] : NULL;
+        return result;
+    }
+    rcuLeave();
+    if (!result) setError(error);
+    return result;
+}
+
+// pathWalk: เดิน path ครั้งเดียวแบบ hand-over-hand เหมือน cd แต่หยุดที่ folder ของ component สุดท้าย (leaf)
+// คืน folder นั้นโดยถือ lookup lock ไว้ พร้อม lookup lock ของ parent ของมัน (*outer) ซึ่งกันไม่ให้ folder
+// ถูก rmdir ระหว่างที่ผู้เรียกปล่อย lock ของ folder ชั่วคราว (ใส่ไฟล์ใหม่, rm) - ปล่อยทั้งหมดด้วย pathRelease
+// parents: folder ที่ขาดถูกสร้างด้วย mkdir_at แล้วเดินใหม่อีกรอบ
+// component "." และ ".." ไม่รองรับ (ไม่ถือ lock ย้อนขึ้นไปแบบ cd และ mkdir_at จะสร้างเป็นชื่อ folder)
+// ยกเว้น path ที่มาจาก target ของ symlink (linked) - path นั้นและ path ที่มี symlink ระหว่างทางเดินด้วย cdWalk แทน
+static bool pathHasDots(const char *path) {
+    const char *p = path;
+    while (*p) {
+        while (*p == '/') p++;
+        const char *start = p;
+        while (*p && *p != '/') p++;
+        size_t len = (size_t)(p - start);
+        if (len > 0 && len <= 2 && start[0] == '.' && start[len - 1] == '.') return true;
+    }
+    return false;
+}
+
+MyFolder* mountkit::pathWalk(MyFolder *root, const char *path, char *buf, size_t buf_size, char **leaf, MyFolder **outer, bool parents, bool linked) {
+    bool follow = pathHasDots(path);
+    if (follow && !linked) {
+        setError(MOUNTKIT_EINVAL);
+        return NULL;
+    }
+    while (!follow) {
+        strncpy(buf, path, buf_size);
+        buf[buf_size - 1] = '\0';
+        char *cursor = buf;
+        char *token = nextToken(&cursor);
+        if (token && strcmp(root->data, token) == 0) {
+            token = nextToken(&cursor);
+        }
+        char *next_token = token ? nextToken(&cursor) : NULL;
+
+        rcuEnter();
+        MyFolder *folder = followMount(root);
+        MyFolder *up = NULL;
+        lookupLock(&folder->lock);
+        bool missing = false;
+        while (next_token) {
+            MyFolder *iter = loadShared(&folder->subdir);
+            while (iter && strcmp(iter->data, token) != 0) {
+                iter = loadShared(&iter->dir);
+            }
+            if (!iter) {
+                missing = true;
+                break;
+            }
+            MyFolder *next = followMount(iter);
+            lookupLock(&next->lock);
+            if (up) lookupUnlock(&up->lock);
+            up = folder;
+            folder = next;
+            token = next_token;
+            next_token = nextToken(&cursor);
+        }
+        if (!missing) {
+            *leaf = token;
+            *outer = up;
+            return folder;
+        }
+        if (linkFind(folder, token)) {
+            pathRelease(folder, up);
+            follow = true;
+            continue;
+        }
+        if (!parents) {
+            pathRelease(folder, up);
+            setError(MOUNTKIT_ENOENT);
+            return NULL;
+        }
+
+        // สร้าง component ที่เหลือ (ยกเว้น leaf) ใต้ folder ที่เดินถึง - buf ถูกตัดด้วย '\0' แล้ว จึงตัดจาก path เดิม
+        char *last = next_token;
+        for (char *t = nextToken(&cursor); t; t = nextToken(&cursor)) last = t;
+        size_t from = (size_t)(token - buf);
+        size_t to = (size_t)(last - buf);
+        memcpy(buf, path + from, to - from);
+        buf[to - from] = '\0';
+        lookupUnlock(&folder->lock); // mkdir_at ขอ write lock ของ folder นี้ (up ยังกันไม่ให้ถูก rmdir)
+        MyFolder *made = mkdir_at(folder, buf);
+        pathRelease(NULL, up);
+        if (!made) return NULL;
+    }
+
+    // แยก component สุดท้ายออกแล้วเดินส่วนที่เหลือแบบ cd (ไม่สร้าง folder ผ่าน symlink)
+    strncpy(buf, path, buf_size);
+    buf[buf_size - 1] = '\0';
+    size_t len = strlen(buf);
+    while (len > 0 && buf[len - 1] == '/') buf[--len] = '\0';
+    char *slash = strrchr(buf, '/');
+    char *name = slash ? slash + 1 : buf;
+    bool whole = len == 0 || strcmp(name, ".") == 0 || strcmp(name, "..") == 0; // path ชี้ folder
+    const char *dir = buf;
+    if (!whole) {
+        if (slash) *slash = '\0';
+        else dir = "";
+    }
+    MyFolder *up = NULL;
+    MyFolder *folder = cdWalk(root, dir, concurrent && !lockfree_reads && strstr(dir, "..") != NULL, true, &up);
+    if (!folder) return NULL;
+    *leaf = whole ? NULL : name;
+    *outer = up;
+    return folder;
+}
+
+void mountkit::pathRelease(MyFolder *folder, MyFolder *outer) {
+    if (folder) lookupUnlock(&folder->lock);
+    if (outer) lookupUnlock(&outer->lock);
+    rcuLeave();
+}
+
+// path ที่ได้จากการตาม symlink ที่ component สุดท้าย: target แบบ absolute แทนทั้ง path, relative แทนเฉพาะ component สุดท้าย
+// out เป็น buffer เดียวกับ path ได้ - false ถ้ายาวเกิน size
+static bool linkSplice(const char *path, MyFile *link, char *out, size_t size) {
+    size_t len = strlen(path);
+    while (len > 0 && path[len - 1] == '/') len--;
+    while (len > 0 && path[len - 1] != '/') len--;
+    if (link->size > 0 && link->data[0] == '/') len = 0;
+    if (len + link->size >= size) return false;
+    memmove(out, path, len);
+    memcpy(out + len, link->data, link->size); // data ของ symlink ไม่มี '\0' ปิดท้ายเสมอไป
+    out[len + link->size] = '\0';
+    return true;
+}
+
+// ไฟล์ที่ path ชี้ (สร้างถ้า create) - คืนพร้อม lock ของ pathWalk ที่ผู้เรียกต้องปล่อยด้วย pathRelease(*folder, *outer)
+// symlink ที่ leaf ถูกตามต่อ (create ผ่าน symlink ที่ชี้ไฟล์ที่ยังไม่มีจะสร้างไฟล์ปลายทาง)
+MyFile* mountkit::pathFile(MyFolder *root, const char *path, bool create, bool parents, MyFolder **folder, MyFolder **outer) {
+    if (!root || !path) {
+        setError(MOUNTKIT_EINVAL);
+        return NULL;
+    }
+    char buf[256];
+    char spliced[256];
+    const char *walk = path;
+    bool linked = false;
+    for (int hops = 0;; hops++) {
+        char *leaf;
+        MyFolder *up;
+        MyFolder *current = pathWalk(root, walk, buf, sizeof(buf), &leaf, &up, parents, linked);
+        if (!current) return NULL;
+        if (!leaf) {
+            pathRelease(current, up);
+            setError(MOUNTKIT_EINVAL); // path ชี้ folder
+            return NULL;
+        }
+        MyFile *file = findFile(current, leaf);
+        if (file && file->kind == MOUNTKIT_DT_LINK) {
+            int error = hops >= MOUNTKIT_SYMLOOP_MAX ? MOUNTKIT_ELOOP : MOUNTKIT_OK;
+            if (!error && !linkSplice(walk, file, spliced, sizeof(spliced))) error = MOUNTKIT_EINVAL;
+            pathRelease(current, up);
+            if (error) {
+                setError(error);
+                return NULL;
+            }
+            walk = spliced;
+            linked = true;
+            continue;
+        }
+        while (!file && create) {
+            // ใส่ไฟล์ใหม่ต้องใช้ write lock ของ folder - ปล่อย lookup lock ก่อน (up ยังกันไม่ให้ folder ถูก rmdir)
+            lookupUnlock(&current->lock);
+            MyFile *fresh = newFile(leaf);
+            if (!fresh) {
+                pathRelease(NULL, up);
+                setError(MOUNTKIT_ENOMEM);
+                return NULL;
+            }
+            if (!quotaCheck(current, fresh->capacity, 1)) {
+                releaseFile(fresh);
+                pathRelease(NULL, up);
+                return NULL;
+            }
+            if (linkFile(current, fresh, concurrent)) {
+                releaseFile(fresh); // thread อื่นสร้างชื่อเดียวกันไปก่อน
+            } else {
+                notify(current, MOUNTKIT_WATCH_CREATE, leaf);
+            }
+            lookupLock(&current->lock);
+            file = findFile(current, leaf); // ถ้าถูก rm ไปก่อนได้ lock คืนก็สร้างใหม่
+        }
+        if (!file) {
+            pathRelease(current, up);
+            setError(MOUNTKIT_ENOENT);
+            return NULL;
+        }
+        *folder = current;
+        *outer = up;
+        return file;
+    }
+}
+
+int mountkit::write_path(MyFolder *root, const char *path, const uint8_t *data, size_t size, bool parents) {
+    if (!data || size == 0) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    MyFolder *folder, *outer;
+    MyFile *file = pathFile(root, path, true, parents, &folder, &outer);
+    if (!file) return 0;
+    int ok = write(file, (uint8_t*)data, size);
+    pathRelease(folder, outer);
+    return ok;
+}
+
+int mountkit::write_path(MyFolder *root, const char *path, const char *str, bool parents) {
+    if (!str) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    return write_path(root, path, (const uint8_t*)str, strlen(str), parents);
+}
+
+int mountkit::read_path(MyFolder *root, const char *path, uint8_t *buffer, size_t size, size_t offset) {
+    if (!buffer) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    MyFolder *folder, *outer;
+    MyFile *file = pathFile(root, path, false, false, &folder, &outer);
+    if (!file) return 0;
+    int n = read(file, buffer, size, offset);
+    pathRelease(folder, outer);
+    return n;
+}
+
+int mountkit::rm_path(MyFolder *root, const char *path) {
+    if (!root || !path) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    char buf[256];
+    char *leaf;
+    MyFolder *outer;
+    MyFolder *folder = pathWalk(root, path, buf, sizeof(buf), &leaf, &outer, false);
+    if (!folder) return 0;
+    if (!leaf) {
+        pathRelease(folder, outer);
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    // rm ขอ write lock ของ folder เอง - outer ยังกันไม่ให้ folder ถูก rmdir ระหว่างนั้น
+    lookupUnlock(&folder->lock);
+    int ok = rm(folder, leaf);
+    pathRelease(NULL, outer);
+    return ok;
+}
+
+int mountkit::stat_path(MyFolder *root, const char *path, MyDirEntry *entry, MyStat *st) {
+    if (!root || !path || (!entry && !st)) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    char buf[256];
+    char spliced[256];
+    const char *walk = path;
+    char *leaf;
+    MyFolder *outer;
+    MyFolder *folder;
+    MyFile *file;
+    for (int hops = 0;; hops++) {
+        folder = pathWalk(root, walk, buf, sizeof(buf), &leaf, &outer, false, walk != path);
+        if (!folder) return 0;
+        file = leaf ? findFile(folder, leaf) : NULL;
+        if (!file || file->kind != MOUNTKIT_DT_LINK) break;
+        // ตาม symlink ไปยังปลายทางแบบ pathFile
+        int error = hops >= MOUNTKIT_SYMLOOP_MAX ? MOUNTKIT_ELOOP : MOUNTKIT_OK;
+        if (!error && !linkSplice(walk, file, spliced, sizeof(spliced))) error = MOUNTKIT_EINVAL;
+        pathRelease(folder, outer);
+        if (error) {
+            setError(error);
+            return 0;
+        }
+        walk = spliced;
+    }
+    MyDirEntry scratch;
+    if (!entry) entry = &scratch;
+    memset(entry, 0, sizeof(*entry));
+    int found = 1;
+    if (!leaf) {
+        // path ชี้ root เอง หรือ folder ที่ได้จาก "." / ".." ใน target ของ symlink
+        snprintf(entry->name, sizeof(entry->name), "%s", folder == followMount(root) ? root->data : folder->data);
+        entry->type = MOUNTKIT_DT_DIR;
+        if (st) stat(folder, st);
+    } else if (file) {
+        MyFile *inode = fileTarget(file);
+        snprintf(entry->name, sizeof(entry->name), "%s", leaf);
+        entry->type = MOUNTKIT_DT_FILE;
+        if (st) {
+            stat(inode, st);
+            entry->size = st->size;
+            entry->capacity = st->capacity;
+        } else {
+            readLock(&inode->lock);
+            entry->size = inode->size;
+            entry->capacity = inode->capacity;
+            readUnlock(&inode->lock);
+        }
+    } else {
+        MyFolder *iter = loadShared(&folder->subdir);
+        while (iter && strcmp(iter->data, leaf) != 0) {
+            iter = loadShared(&iter->dir);
+        }
+        if (iter) {
+            snprintf(entry->name, sizeof(entry->name), "%s", leaf);
+            entry->type = MOUNTKIT_DT_DIR;
+            if (st) stat(iter, st); // mount point = root ของ tree ที่ mount ไว้
+        } else {
+            found = 0;
+        }
+    }
+    pathRelease(folder, outer);
+    if (!found) setError(MOUNTKIT_ENOENT);
+    return found;
+}
+
+#ifndef EMBEDDED_BUILD
+int mountkit::append_path(MyFolder *root, const char *path, const uint8_t *data, size_t size, bool parents) {
+    if (!data || size == 0) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    MyFolder *folder, *outer;
+    MyFile *file = pathFile(root, path, true, parents, &folder, &outer);
+    if (!file) return 0;
+    int ok = append(file, (uint8_t*)data, size);
+    pathRelease(folder, outer);
+    return ok;
 }
 
+int mountkit::append_path(MyFolder *root, const char *path, const char *str, bool parents) {
+    if (!str) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    return append_path(root, path, (const uint8_t*)str, strlen(str), parents);
+}
+#endif
+
 // Helper function: หา parent directory ของ target
-MyFolder* mountkit::findParent(MyFolder *root, MyFolder *target) {
+MyFolder* mountkit::findParent(MyFolder *root, MyFolder *target, MyFolder **entry) {
+    root = followMount(root);
     if (!root || !target || root == target) {
         return NULL; // ไม่พบหรือ target คือ root
     }
     
-    // ตรวจสอบว่า target อยู่ใน subdirectory ของ root หรือไม่
-    MyFolder *child = root->subdir;
-    while (child) {
-        if (child == target) {
-            return root; // พบ! root คือ parent ของ target
+    // ค้นทุก folder ใน subtree ว่ามี target เป็นลูกโดยตรงหรือไม่
+    // (root ของ tree ที่ mount ไว้ถือว่าเป็นลูกของ parent ของ mount point)
+    MyFolder *found = NULL;
+    MyIter it;
+    iter_begin(&it, root, MOUNTKIT_ITER_PRE | MOUNTKIT_ITER_MOUNTS);
+    while (!found && iter_next(&it)) {
+        for (MyFolder *child = it.folder->subdir; child; child = child->dir) {
+            if (child == target || followMount(child) == target) {
+                if (entry) *entry = child;
+                found = it.folder; // พบ! folder นี้คือ parent ของ target
+                break;
+            }
         }
-        child = child->dir;
     }
-    
-    // ถ้าไม่พบใน level นี้ ให้ search ใน subdirectories แบบ recursive
-    child = root->subdir;
-    while (child) {
-        MyFolder *found = findParent(child, target);
-        if (found) {
-            return found;
+    iter_end(&it);
+    return found;
+}
+
+// ตรวจสอบว่า node อยู่ใน tree (รวม tree ที่ mount ไว้) หรือไม่ - ใช้กัน mount loop
+static bool treeContains(mountkit &mount, MyFolder *tree, MyFolder *node) {
+    bool found = false;
+    MyIter it;
+    mount.iter_begin(&it, tree, MOUNTKIT_ITER_PRE | MOUNTKIT_ITER_MOUNTS | MOUNTKIT_ITER_SIBLINGS);
+    while (!found && mount.iter_next(&it)) {
+        for (MyFolder *layer = it.entry; layer; layer = layer->mounted) {
+            if (layer == node) found = true;
         }
-        child = child->dir;
     }
+    mount.iter_end(&it);
+    return found;
+}
+
+// หา entry ของ path โดยไม่ข้าม mount ที่ component สุดท้าย
+static MyFolder* findMountEntry(mountkit &mount, MyFolder *root, const char *path) {
+    char buf[256];
+    strncpy(buf, path, sizeof(buf));
+    buf[sizeof(buf)-1] = '\0';
+    
+    size_t len = strlen(buf);
+    while (len > 0 && buf[len-1] == '/') buf[--len] = '\0';
+    
+    char *name = strrchr(buf, '/');
+    MyFolder *parent = root;
+    if (name) {
+        *name++ = '\0';
+        parent = mount.cd(root, buf);
+    } else {
+        name = buf;
+    }
+    if (!parent) return NULL;
+    if (name[0] == '\0' || (parent == root && strcmp(root->data, name) == 0)) return root;
     
-    return NULL; // ไม่พบ parent
+    MyFolder *iter = followMount(parent)->subdir;
+    while (iter && strcmp(iter->data, name) != 0) iter = iter->dir;
+    return iter;
+}
+
+// mount: ต่อ other_root เข้าที่ path (mount ซ้อนกันได้ ตัวล่าสุดอยู่บนสุด)
+int mountkit::mount(MyFolder *root, const char *path, MyFolder *other_root) {
+    if (!root || !path || !other_root) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    
+    MyFolder *target = findMountEntry(*this, root, path);
+    if (!target) {
+        setError(MOUNTKIT_ENOENT);
+        return 0;
+    }
+    
+    // ห้าม mount tree ที่มี mount point อยู่ข้างในตัวเอง
+    if (treeContains(*this, other_root, target)) {
+        #ifdef LIB_DEBUG
+            printf("Error: mounting '%s' at '%s' would create a loop\n", other_root->data, path);
+        #endif
+        setError(MOUNTKIT_ELOOP);
+        return 0;
+    }
+    
+    MyFolder *top = followMount(target);
+    top->mounted = other_root;
+    MyUsage mounted;
+    memset(&mounted, 0, sizeof(mounted));
+    mounted.mounts = 1;
+    usageAdd(top, &mounted, false);
+    linkInvalidate();
+    return 1;
+}
+
+// umount: ถอด tree ที่ mount ไว้บนสุดออกและคืน root ของมัน
+MyFolder* mountkit::umount(MyFolder *root, const char *path) {
+    if (!root || !path) {
+        setError(MOUNTKIT_EINVAL);
+        return NULL;
+    }
+    
+    MyFolder *entry = findMountEntry(*this, root, path);
+    if (!entry || !entry->mounted) {
+        setError(MOUNTKIT_ENOENT);
+        return NULL;
+    }
+    
+    while (entry->mounted->mounted) entry = entry->mounted;
+    MyFolder *detached = entry->mounted;
+    entry->mounted = NULL;
+    MyUsage mounted;
+    memset(&mounted, 0, sizeof(mounted));
+    mounted.mounts = 1;
+    usageAdd(entry, &mounted, true);
+    linkInvalidate();
+    return detached;
 }
 
 // pwd: แสดง path ปัจจุบัน
 void mountkit::pwd(MyFolder *folder, MyFolder *root) {
     if (!folder) return;
-    const MyFolder *stack[128];
+    const char *stack[128];
     int top = 0;
     MyFolder *cur = folder;
-    while (cur && cur != root) {
-        stack[top++] = cur;
-        MyFolder *parent = root, *found = NULL;
-        while (parent) {
-            MyFolder *child = parent->subdir;
-            while (child) {
-                if (child == cur) { found = parent; break; }
-                child = child->dir;
-            }
-            if (found) break;
-            parent = parent->dir;
-        }
-        cur = found;
+    while (cur && cur != root && cur != followMount(root) && top < 127) {
+        // ใช้ชื่อ mount point แทนชื่อ root ของ tree ที่ mount ไว้
+        MyFolder *entry = cur;
+        MyFolder *parent = findParent(root, cur, &entry);
+        stack[top++] = entry->data;
+        cur = parent;
     }
-    if (root) stack[top++] = root;
+    if (root) stack[top++] = root->data;
     for (int i = top - 1; i >= 0; --i)
-        printf("/%s", stack[i]->data);
+        printf("/%s", stack[i]);
     printf("\n");
 }
 
 // PrintAllPath: แสดง path ของทุกโฟลเดอร์
 void mountkit::PrintAllPath(MyFolder *folder, char *prefix) {
     if (!folder) return;
+    #ifndef EMBEDDED_BUILD
+        if (pool && !concurrent) {
+            parallelWalk(MOUNTKIT_WALK_PRINT, folder, prefix);
+            return;
+        }
+    #endif
+    // ถือ read lock ของ folder ตั้งแต่ pre-visit จนถึง post-visit (ช่วงที่ iterator อ่านลูกของมัน)
     char path[256];
-    if (prefix[0] != '\0')
-        snprintf(path, sizeof(path), "%s/%s", prefix, folder->data);
-    else
-        snprintf(path, sizeof(path), "%s", folder->data);
-    printf("%s\n", path);
-    PrintAllPath(folder->subdir, path);
-    PrintAllPath(folder->dir, prefix);
+    MyIter it;
+    iter_begin(&it, folder, MOUNTKIT_ITER_PRE | MOUNTKIT_ITER_POST | MOUNTKIT_ITER_MOUNTS | MOUNTKIT_ITER_SIBLINGS);
+    while (iter_next(&it)) {
+        if (it.post) {
+            readUnlock(&it.folder->lock);
+            continue;
+        }
+        size_t len = prefix[0] != '\0' ? (size_t)snprintf(path, sizeof(path), "%s/", prefix) : 0;
+        if (len < sizeof(path)) iter_path(&it, path + len, sizeof(path) - len);
+        printf("%s\n", path);
+        readLock(&it.folder->lock);
+    }
+    iter_end(&it);
 }
 
 // rm: ลบไฟล์ในโฟลเดอร์ตามชื่อไฟล์
 int mountkit::rm(MyFolder *folder, const char *filename) {
-    if (!folder || !filename) return 0;
+    if (!folder || !filename) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    MyFile *to_delete = NULL;
+    writeLock(&folder->lock);
     MyFile **cur = &folder->files;
     while (*cur) {
         if (strcmp((char*)(*cur)->name, filename) == 0) {
-            MyFile *to_delete = *cur;
-            *cur = to_delete->next;
-            free(to_delete->name);
-            free(to_delete->data);
-            free(to_delete);
-            return 1; // success
+            to_delete = *cur;
+            storeShared(cur, to_delete->next);
+            indexRemove(folder, NULL, to_delete);
+            writeLock(&to_delete->lock);
+            usageUnlink(to_delete);
+            writeUnlock(&to_delete->lock);
+            metaTouch(nodeMeta(folder), true);
+            metaTouch(nodeMeta(fileTarget(to_delete)), false); // จำนวนชื่อลดลง (ชื่อนี้ยังถือไฟล์จริงไว้)
+            break;
         }
         cur = &((*cur)->next);
     }
-    return 0; // not found
+    writeUnlock(&folder->lock);
+    if (!to_delete) {
+        setError(MOUNTKIT_ENOENT);
+        return 0;
+    }
+    notify(folder, MOUNTKIT_WATCH_DELETE, filename);
+    linkInvalidate(); // symlink ที่ถูกลบ หรือชื่อที่ symlink ข้ามไปอาจเปลี่ยน
+    // ไฟล์จริงถูกคืนเมื่อชื่อสุดท้ายถูกลบ (hard link ที่เหลือยังใช้ข้อมูลต่อได้)
+    unlinkName(to_delete, false);
+    return 1; // success
 }
 
 // cp: คัดลอกไฟล์ในโฟลเดอร์ src ไปยังโฟลเดอร์ dst (ชื่อไฟล์เดียวกัน)
+// สร้างสำเนาให้เสร็จก่อนแล้วค่อยใส่เข้า dst - ไม่ถือ lock ของสอง folder พร้อมกัน
 int mountkit::cp(MyFolder *src_folder, const char *filename, MyFolder *dst_folder) {
-    if (!src_folder || !dst_folder || !filename) return 0;
-    // หาไฟล์ต้นทาง
-    MyFile *src = src_folder->files;
-    while (src && strcmp((char*)src->name, filename) != 0)
-        src = src->next;
-    if (!src) return 0; // ไม่พบไฟล์ต้นทาง
+    if (!src_folder || !dst_folder || !filename) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
 
     // ตรวจสอบว่าปลายทางมีไฟล์ชื่อเดียวกันอยู่แล้วหรือไม่
-    MyFile *dst = dst_folder->files;
-    while (dst) {
-        if (strcmp((char*)dst->name, filename) == 0)
-            return 0; // ไม่คัดลอกซ้ำ
-        dst = dst->next;
+    readLock(&dst_folder->lock);
+    MyFile *dst = findFile(dst_folder, filename);
+    readUnlock(&dst_folder->lock);
+    if (dst) {
+        setError(MOUNTKIT_EEXIST); // ไม่คัดลอกซ้ำ
+        return 0;
     }
 
-    // สร้างไฟล์ใหม่ในปลายทาง
-    MyFile *newfile = mk(dst_folder, filename);
-    if (!newfile) return 0;
-
-    // คัดลอกข้อมูล
-    if (src->size > newfile->capacity) {
+    // หาไฟล์ต้นทางแล้วคัดลอกข้อมูลเข้าไฟล์ใหม่ (ยังไม่อยู่ใน folder ใด)
+    MyFile *newfile = NULL;
+    int error = MOUNTKIT_ENOENT;
+    readLock(&src_folder->lock);
+    MyFile *src = findFile(src_folder, filename);
+    if (src) {
+        src = fileTarget(src); // hard link: คัดลอกข้อมูลของไฟล์จริง
+        readLock(&src->lock);
+        error = MOUNTKIT_ENOMEM;
+        newfile = newFile(filename);
         // ขยาย buffer ถ้าจำเป็น
-        uint8_t *newdata = (uint8_t*)realloc(newfile->data, src->size);
-        if (!newdata) {
-            // ถ้า realloc fail ให้ลบไฟล์ที่สร้างใหม่
-            rm(dst_folder, filename);
-            return 0;
+        if (newfile && src->size > newfile->capacity && !resizeData(newfile, src->size)) {
+            releaseFile(newfile);
+            newfile = NULL;
+        }
+        if (newfile) {
+            memcpy(newfile->data, src->data, src->size);
+            newfile->size = src->size;
+            newfile->reserved = src->size;
+            newfile->crc32c = src->crc32c;
+            newfile->crc_state = src->crc_state;
+            newfile->kind = src->kind; // symlink คัดลอกเป็น symlink ที่ชี้ target เดียวกัน
+            #ifndef EMBEDDED_BUILD
+                newfile->meta.mode = src->meta.mode; // ino และเวลาเป็นของสำเนาเอง
+            #endif
         }
-        newfile->data = newdata;
-        newfile->capacity = src->size;
+        readUnlock(&src->lock);
     }
-    memcpy(newfile->data, src->data, src->size);
-    newfile->size = src->size;
+    readUnlock(&src_folder->lock);
+    if (!newfile) {
+        setError(error); // ไม่พบไฟล์ต้นทาง หรือ memory ไม่พอ
+        return 0;
+    }
+    if (!quotaCheck(dst_folder, newfile->capacity, 1)) {
+        releaseFile(newfile);
+        return 0;
+    }
+
+    if (linkFile(dst_folder, newfile, concurrent)) {
+        // thread อื่นสร้างชื่อเดียวกันในปลายทางไปก่อน
+        releaseFile(newfile);
+        setError(MOUNTKIT_EEXIST);
+        return 0;
+    }
+    notify(dst_folder, MOUNTKIT_WATCH_CREATE, filename);
     return 1; // success
 }
 
 // mv: ย้ายไฟล์จากโฟลเดอร์ src ไปยังโฟลเดอร์ dst (ชื่อไฟล์เดียวกัน)
 int mountkit::mv(MyFolder *src_folder, const char *filename, MyFolder *dst_folder) {
-    if (!src_folder || !dst_folder || !filename) return 0;
+    if (!src_folder || !dst_folder || !filename) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    if (src_folder == dst_folder) {
+        readLock(&src_folder->lock);
+        MyFile *same = findFile(src_folder, filename);
+        readUnlock(&src_folder->lock);
+        setError(same ? MOUNTKIT_EEXIST : MOUNTKIT_ENOENT); // ชื่อเดิมใน folder เดิม - ไม่ย้ายซ้ำ
+        return 0;
+    }
 
-    // หาไฟล์ต้นทาง (และ pointer ไปยัง pointer ของมัน)
+    // ถือ write lock ของทั้งสอง folder ตลอดการย้าย - ชื่อจึงไม่ถูกสร้างซ้ำใน src หรือ dst ระหว่างทาง
+    writeLockPair(&src_folder->lock, &dst_folder->lock);
+
+    int error = MOUNTKIT_OK;
     MyFile **cur = &src_folder->files;
     while (*cur && strcmp((char*)(*cur)->name, filename) != 0) {
         cur = &((*cur)->next);
     }
-    if (!*cur) return 0; // ไม่พบไฟล์ต้นทาง
-
-    // ตรวจสอบว่าปลายทางมีไฟล์ชื่อเดียวกันอยู่แล้วหรือไม่
-    for (MyFile *dst = dst_folder->files; dst; dst = dst->next) {
-        if (strcmp((char*)dst->name, filename) == 0)
-            return 0; // ไม่ย้ายซ้ำ
+    MyFile *moving = *cur;
+    if (findFile(dst_folder, filename)) {
+        error = MOUNTKIT_EEXIST; // ไม่ย้ายซ้ำ
+    } else if (!moving) {
+        error = MOUNTKIT_ENOENT; // ไม่พบไฟล์ต้นทาง
+    } else {
+        // ถอดไฟล์ออกจาก src_folder
+        storeShared(cur, moving->next);
+        indexRemove(src_folder, NULL, moving);
+        writeLock(&moving->lock);
+        usageUnlink(moving);
+        size_t moving_capacity = moving->capacity;
+        writeUnlock(&moving->lock);
+        // ยอดของไฟล์ออกจาก ancestor ที่ใช้ร่วมกันแล้ว - quota ที่เกินได้มีแต่ของฝั่ง dst
+        // (hard link ที่ ln สร้างไม่มี capacity ของตัวเอง)
+        if (quotaCheck(dst_folder, moving_capacity, 1)) {
+            metaTouch(nodeMeta(src_folder), true);
+            metaTouch(nodeMeta(fileTarget(moving)), false);
+            linkFileLocked(dst_folder, moving);
+        } else {
+            linkFileLocked(src_folder, moving); // คืนไฟล์กลับที่เดิม (src ยังถูก lock - ชื่อไม่ซ้ำแน่นอน)
+            error = MOUNTKIT_EDQUOT;
+        }
+    }
+    writeUnlock(&dst_folder->lock);
+    writeUnlock(&src_folder->lock);
+    if (error != MOUNTKIT_OK) {
+        if (error != MOUNTKIT_EDQUOT) setError(error); // quotaCheck บันทึก EDQUOT เองแล้ว
+        return 0;
     }
+    linkInvalidate(); // symlink ที่ถูกย้าย resolve target แบบ relative จาก folder ใหม่
+    notify(src_folder, MOUNTKIT_WATCH_MOVED_FROM, filename);
+    notify(dst_folder, MOUNTKIT_WATCH_MOVED_TO, filename);
 
-    // ถอดไฟล์ออกจาก src_folder
-    MyFile *moving = *cur;
-    *cur = moving->next;
+    return 1; // success
+}
 
-    // ใส่ไฟล์เข้า dst_folder
-    moving->next = dst_folder->files;
-    dst_folder->files = moving;
+// ข้อความที่โตได้ของ dir() - หนึ่งชุดต่อ thread และคืนหน่วยความจำเมื่อ thread จบ
+typedef struct DirText {
+    char *data;
+    size_t len;
+    size_t capacity;
+    ~DirText() { free(data); }
+} DirText;
 
-    return 1; // success
+static bool dirAppend(DirText *text, const char *format, ...) {
+    for (;;) {
+        size_t room = text->capacity - text->len;
+        va_list args;
+        va_start(args, format);
+        int n = vsnprintf(text->data ? text->data + text->len : NULL, room, format, args);
+        va_end(args);
+        if (n < 0) return false;
+        if ((size_t)n < room) {
+            text->len += (size_t)n;
+            return true;
+        }
+        size_t capacity = text->capacity ? text->capacity : 1024;
+        while (capacity - text->len <= (size_t)n) capacity *= 2;
+        char *grown = (char*)realloc(text->data, capacity);
+        if (!grown) return false;
+        text->data = grown;
+        text->capacity = capacity;
+    }
 }
 
+#define DIR_PAGE 16 // entry ต่อการเรียก readdir (อยู่บน stack)
+
 // dir: แสดงรายการไฟล์และโฟลเดอร์ในไดเรกทอรีปัจจุบัน
 const char* mountkit::dir(MyFolder *folder, bool show_details) {
-    // Static buffer สำหรับเก็บผลลัพธ์
-    static char result_buffer[8192]; // 8KB buffer
-    result_buffer[0] = '\0'; // Clear buffer
+    // folder กับไฟล์มาปนกันได้ (index เรียงตามชื่อ) - แยกบรรทัดไว้คนละ buffer แล้วค่อยต่อกัน
+    static MOUNTKIT_THREAD_LOCAL DirText result;
+    static MOUNTKIT_THREAD_LOCAL DirText folder_lines;
+    static MOUNTKIT_THREAD_LOCAL DirText file_lines;
+    result.len = folder_lines.len = file_lines.len = 0;
     
     if (!folder) {
-        snprintf(result_buffer, sizeof(result_buffer), "Error: Invalid folder\n");
-        return result_buffer;
+        return dirAppend(&result, "Error: Invalid folder\n") ? result.data : "Error: Invalid folder\n";
     }
     
-    char temp_buffer[512];
     int folder_count = 0;
     int file_count = 0;
     size_t total_size = 0;
-    
-    // Header
-    snprintf(temp_buffer, sizeof(temp_buffer), 
-             "\nDirectory listing for: %s\n"
-             "=====================================\n", 
-             folder->data);
-    strncat(result_buffer, temp_buffer, sizeof(result_buffer) - strlen(result_buffer) - 1);
-    
-    // แสดงรายการโฟลเดอร์ย่อย
-    if (folder->subdir) {
-        strncat(result_buffer, "\nFOLDERS:\n--------\n", 
-                sizeof(result_buffer) - strlen(result_buffer) - 1);
-        
-        MyFolder *current_folder = folder->subdir;
-        while (current_folder) {
-            if (show_details) {
-                snprintf(temp_buffer, sizeof(temp_buffer), 
-                         "  [DIR]  %-20s  <FOLDER>\n", current_folder->data);
+    bool ok = true;
+    
+    MyDirEntry page[DIR_PAGE];
+    MyCursor cursor;
+    cursor_init(&cursor);
+    while (ok && !cursor.done) {
+        int n = readdir(folder, &cursor, page, DIR_PAGE);
+        for (int i = 0; i < n && ok; ++i) {
+            const MyDirEntry *e = &page[i];
+            if (e->type == MOUNTKIT_DT_DIR) {
+                ok = show_details ? dirAppend(&folder_lines, "  [DIR]  %-20s  <FOLDER>\n", e->name)
+                                  : dirAppend(&folder_lines, "  [DIR]  %s\n", e->name);
+                folder_count++;
             } else {
-                snprintf(temp_buffer, sizeof(temp_buffer), 
-                         "  [DIR]  %s\n", current_folder->data);
+                // แสดงรายละเอียด: ชื่อไฟล์, ขนาด, capacity หรือแสดงแบบง่าย
+                ok = show_details ? dirAppend(&file_lines, "  [FILE] %-20s  %6zu bytes  (capacity: %zu)\n",
+                                              e->name, e->size, e->capacity)
+                                  : dirAppend(&file_lines, "  [FILE] %s\n", e->name);
+                file_count++;
+                total_size += e->size;
             }
-            strncat(result_buffer, temp_buffer, 
-                    sizeof(result_buffer) - strlen(result_buffer) - 1);
-            folder_count++;
-            current_folder = current_folder->dir;
         }
     }
     
-    // แสดงรายการไฟล์
-    if (folder->files) {
-        strncat(result_buffer, "\nFILES:\n------\n", 
-                sizeof(result_buffer) - strlen(result_buffer) - 1);
-        
-        MyFile *current_file = folder->files;
-        while (current_file) {
-            if (show_details) {
-                // แสดงรายละเอียด: ชื่อไฟล์, ขนาด, capacity
-                snprintf(temp_buffer, sizeof(temp_buffer), 
-                         "  [FILE] %-20s  %6zu bytes  (capacity: %zu)\n", 
-                         (char*)current_file->name, 
-                         current_file->size,
-                         current_file->capacity);
-            } else {
-                // แสดงแบบง่าย
-                snprintf(temp_buffer, sizeof(temp_buffer), 
-                         "  [FILE] %s\n", (char*)current_file->name);
-            }
-            strncat(result_buffer, temp_buffer, 
-                    sizeof(result_buffer) - strlen(result_buffer) - 1);
-            
-            file_count++;
-            total_size += current_file->size;
-            current_file = current_file->next;
-        }
+    // Header และรายการ
+    ok = ok && dirAppend(&result,
+                         "\nDirectory listing for: %s\n"
+                         "=====================================\n",
+                         folder->data);
+    if (folder_count) {
+        ok = ok && dirAppend(&result, "\nFOLDERS:\n--------\n%s", folder_lines.data);
+    }
+    if (file_count) {
+        ok = ok && dirAppend(&result, "\nFILES:\n------\n%s", file_lines.data);
     }
     
     // แสดงสรุป
-    strncat(result_buffer, "\n=====================================\n", 
-            sizeof(result_buffer) - strlen(result_buffer) - 1);
-    
-    snprintf(temp_buffer, sizeof(temp_buffer), 
-             "Summary:\n"
-             "  Folders: %d\n"
-             "  Files:   %d\n", 
-             folder_count, file_count);
-    strncat(result_buffer, temp_buffer, 
-            sizeof(result_buffer) - strlen(result_buffer) - 1);
-    
+    ok = ok && dirAppend(&result,
+                         "\n=====================================\n"
+                         "Summary:\n"
+                         "  Folders: %d\n"
+                         "  Files:   %d\n",
+                         folder_count, file_count);
     if (show_details) {
-        snprintf(temp_buffer, sizeof(temp_buffer), 
-                 "  Total file size: %zu bytes\n", total_size);
-        strncat(result_buffer, temp_buffer, 
-                sizeof(result_buffer) - strlen(result_buffer) - 1);
-        
+        ok = ok && dirAppend(&result, "  Total file size: %zu bytes\n", total_size);
         // แสดงขนาดในรูปแบบที่อ่านง่าย
         if (total_size >= 1024 * 1024) {
-            snprintf(temp_buffer, sizeof(temp_buffer), 
-                     "  Total file size: %.2f MB\n", total_size / (1024.0 * 1024.0));
-            strncat(result_buffer, temp_buffer, 
-                    sizeof(result_buffer) - strlen(result_buffer) - 1);
+            ok = ok && dirAppend(&result, "  Total file size: %.2f MB\n", total_size / (1024.0 * 1024.0));
         } else if (total_size >= 1024) {
-            snprintf(temp_buffer, sizeof(temp_buffer), 
-                     "  Total file size: %.2f KB\n", total_size / 1024.0);
-            strncat(result_buffer, temp_buffer, 
-                    sizeof(result_buffer) - strlen(result_buffer) - 1);
+            ok = ok && dirAppend(&result, "  Total file size: %.2f KB\n", total_size / 1024.0);
         }
     }
+    ok = ok && dirAppend(&result, "  Total items: %d\n\n", folder_count + file_count);
     
-    snprintf(temp_buffer, sizeof(temp_buffer), 
-             "  Total items: %d\n\n", folder_count + file_count);
-    strncat(result_buffer, temp_buffer, 
-            sizeof(result_buffer) - strlen(result_buffer) - 1);
-    
-    return result_buffer;
+    if (!ok) {
+        setError(MOUNTKIT_ENOMEM);
+        return "Error: Out of memory\n";
+    }
+    return result.data;
+}
+
+
+// clock ของ Test 33 - เพิ่มทีละ 1 ต่อการอ่าน เวลาที่ได้จึงเรียงตามลำดับการแก้เสมอ
+// เริ่มใต้ 2^32 เล็กน้อย - tick ข้ามขอบ 32 bit ระหว่าง test โดยลำดับยังถูกต้อง
+static uint64_t test_ticks = 0xFFFFFFF0ull;
+static uint64_t testClock(void) {
+    return ++test_ticks;
 }
 
+// buffer ในหน่วยความจำสำหรับทดสอบ stream (tar_export/tar_import)
+typedef struct TestStream {
+    uint8_t *data;
+    size_t size;
+    size_t capacity;
+    size_t pos;
+} TestStream;
+
+static int testStreamSink(void *ctx, const uint8_t *data, size_t size) {
+    TestStream *s = (TestStream*)ctx;
+    if (s->size + size > s->capacity) {
+        size_t new_capacity = s->capacity ? s->capacity : 4096;
+        while (new_capacity < s->size + size) new_capacity *= 2;
+        uint8_t *new_data = (uint8_t*)realloc(s->data, new_capacity);
+        if (!new_data) return 0;
+        s->data = new_data;
+        s->capacity = new_capacity;
+    }
+    memcpy(s->data + s->size, data, size);
+    s->size += size;
+    return 1;
+}
+
+static int testStreamSource(void *ctx, uint8_t *buffer, size_t size) {
+    TestStream *s = (TestStream*)ctx;
+    size_t available = s->size - s->pos;
+    // ส่งทีละไม่เกิน 100 bytes เพื่อทดสอบการอ่านที่ไม่ครบ block
+    size_t n = size < available ? size : available;
+    if (n > 100) n = 100;
+    memcpy(buffer, s->data + s->pos, n);
+    s->pos += n;
+    return (int)n;
+}
 
 // ฟังก์ชันสำหรับทดสอบอัตโนมัติ
 void mountkit::run_tests() {
@@ -807,7 +1765,1227 @@ void mountkit::run_tests() {
     MyFile *f3 = mk(toon2, "fileB.txt");
     assert(f3 && strcmp((char*)f3->name, "fileB.txt") == 0);
 
-    // Test 10: removeFolder ทั้งหมด
+    // Test 10: tar_export แล้ว tar_import ต้องได้ tree เดิม
+    write(f3, "tar round trip");
+    MyFolder *deep = mkdir(&root, "root/usr/toon/a_very_long_directory_name_for_pax_header_testing/"
+                                  "another_very_long_directory_name_to_exceed_ustar_limits");
+    MyFile *deep_file = mk(deep, "deep_file_with_a_long_name.bin");
+    uint8_t pattern[1500];
+    for (size_t i = 0; i < sizeof(pattern); ++i) pattern[i] = (uint8_t)(i * 7);
+    write(deep_file, pattern, sizeof(pattern));
+    TestStream stream = { NULL, 0, 0, 0 };
+    int tar_ok = tar_export(usr, testStreamSink, &stream);
+    assert(tar_ok == 1 && stream.size % 512 == 0);
+    MyFolder *restore = mkdir(&root, "root/restore");
+    tar_ok = tar_import(restore, testStreamSource, &stream);
+    assert(tar_ok == 1);
+    MyFolder *restored_toon = cd(root, "restore/toon");
+    assert(restored_toon && restored_toon->files);
+    uint8_t tar_buf[32];
+    assert(read(restored_toon->files, tar_buf, sizeof(tar_buf)) == 14);
+    assert(memcmp(tar_buf, "tar round trip", 14) == 0);
+    MyFolder *restored_deep = cd(restore, "toon/a_very_long_directory_name_for_pax_header_testing");
+    assert(restored_deep && restored_deep->subdir && restored_deep->subdir->files);
+    MyFile *restored_file = restored_deep->subdir->files;
+    assert(restored_file->size == sizeof(pattern));
+    assert(memcmp(restored_file->data, pattern, sizeof(pattern)) == 0);
+    free(stream.data);
+
+    // Test 11: overlay - อ่านตกไป lower, เขียน copy-up, ลบบันทึก whiteout
+    MyOverlay ov;
+    int ov_ok = overlay_init(&ov, root);
+    assert(ov_ok == 1);
+    assert(overlay_lookup(&ov, "usr/toon/fileB.txt") == f3);
+    MyFile *copied = overlay_mk(&ov, "usr/toon/fileB.txt");
+    assert(copied && copied != f3 && copied->size == f3->size);
+    append(copied, " (upper)");
+    assert(f3->size == 14);
+    assert(overlay_read(&ov, "usr/toon/fileB.txt", tar_buf, sizeof(tar_buf)) == 22);
+    ov_ok = overlay_rm(&ov, "usr/toon/fileB.txt");
+    assert(ov_ok == 1);
+    assert(overlay_lookup(&ov, "usr/toon/fileB.txt") == NULL);
+    assert(cd(root, "usr/toon")->files == f3);
+    ov_ok = overlay_rmdir(&ov, "cfg");
+    assert(ov_ok == 1);
+    assert(overlay_cd(&ov, "cfg") == NULL && cd(root, "cfg") == cfg);
+    MyFolder *opaque = overlay_mkdir(&ov, "cfg");
+    assert(opaque && opaque != cfg);
+    assert(overlay_cd(&ov, "usr") == cd(ov.upper, "usr"));
+    assert(overlay_cd(&ov, "restore") == restore);
+    overlay_release(&ov);
+
+    // Test 12: mount/umount - cd, mkdir, .. และ capacity ข้าม mount point ได้
+    MyFolder *other = NULL;
+    MyFolder *other_logs = mkdir(&other, "data/logs");
+    mkdir(&root, "root/mnt/data");
+    size_t cap_before = calculateFolderCapacity(root, true);
+    int mounted = mount(root, "mnt/data", other);
+    assert(mounted == 1);
+    assert(cd(root, "mnt/data/logs") == other_logs);
+    assert(cd(root, "mnt/data/logs/../..") == cd(root, "mnt"));
+    MyFolder *created = mkdir(&root, "root/mnt/data/logs/app");
+    assert(created && cd(other, "logs/app") == created);
+    assert(calculateFolderCapacity(root, true) > cap_before);
+    mounted = mount(other, "logs", root);
+    assert(mounted == 0); // loop
+    rmdir(&root, "root/mnt/data");
+    assert(cd(root, "mnt/data") == other);   // mount point ที่ใช้งานอยู่ลบไม่ได้
+    MyFolder *unmounted = umount(root, "mnt/data");
+    assert(unmounted == other);
+    assert(cd(root, "mnt/data/logs") == NULL);
+    unmounted = umount(root, "mnt/data");
+    assert(unmounted == NULL);
+    removeFolder(other);
+
+    // Test 13: CRC32C - ค่ามาตรฐาน, append แบบ incremental, write แบบ lazy, verify
+    assert(mountkit_crc32c(0, "123456789", 9) == 0xE3069283u);
+    MyFile *sum_file = mk(cfg, "sum.txt");
+    write(sum_file, "1234");
+    assert(sum_file->crc_state == MOUNTKIT_CRC_OFF);
+    checksum(sum_file);
+    append(sum_file, "56789");
+    assert(sum_file->crc_state == MOUNTKIT_CRC_VALID && sum_file->crc32c == 0xE3069283u);
+    write(sum_file, "123456789");
+    assert(sum_file->crc_state == MOUNTKIT_CRC_STALE);
+    uint32_t sum_crc = checksum(sum_file);
+    assert(sum_crc == 0xE3069283u);
+    int corrupt = verify(root);
+    assert(corrupt == 0);
+    sum_file->data[0] ^= 0x01; // จำลอง data เสียหาย
+    corrupt = verify(root);
+    assert(corrupt == 1);
+    sum_file->data[0] ^= 0x01;
+
+    // Test 14: compact - ย้าย tree เข้า arena แล้ว data และการแก้ไขต่อยังถูกต้อง
+    MyCompactReport rep;
+    size_t files_before = 0;
+    for (MyFile *f = cd(root, "usr/toon")->files; f; f = f->next) files_before++;
+    int compacted = compact(&root, &rep);
+    assert(compacted == 1 && rep.slack_after < rep.slack_before);
+    MyFolder *compacted_toon = cd(root, "usr/toon");
+    MyFile *compacted_file = compacted_toon->files;
+    assert(compacted_file && (compacted_file->alloc_flags & MOUNTKIT_ALLOC_NODE));
+    assert(read(compacted_file, tar_buf, sizeof(tar_buf)) == 14 && memcmp(tar_buf, "tar round trip", 14) == 0);
+    append(compacted_file, " and beyond the arena capacity");
+    assert(!(compacted_file->alloc_flags & MOUNTKIT_ALLOC_DATA));
+    assert(compacted_file->size == 44);
+    MyFile *after_compact = mk(compacted_toon, "after_compact.txt");
+    assert(after_compact != NULL);
+    int compact_rm = rm(compacted_toon, "fileB.txt");
+    assert(compact_rm == 1);
+    assert(cd(root, "usr/toon/a_very_long_directory_name_for_pax_header_testing") != NULL);
+    assert(files_before > 0);
+
+    // Test 15: concurrent mode - หลาย thread mkdir/mk/append พร้อมกัน
+    set_concurrent(true);
+    MyFolder *mt = mkdir(&root, "root/mt");
+    MyFile *mt_shared = mk(mt, "shared.log");
+    assert(mt && mt_shared);
+    std::thread mt_workers[4];
+    for (int t = 0; t < 4; ++t) {
+        mt_workers[t] = std::thread([this, &root, t]() {
+            char mt_path[32];
+            snprintf(mt_path, sizeof(mt_path), "root/mt/t%d/a", t);
+            MyFolder *own = mkdir(&root, mt_path);
+            MyFile *own_log = mk(own, "own.log");
+            for (int i = 0; i < 200; ++i) {
+                append(mk(cd(root, "mt"), "shared.log"), "x");
+                append(own_log, "y");
+                mk(own, "tmp");
+                rm(own, "tmp");
+            }
+        });
+    }
+    for (int t = 0; t < 4; ++t) mt_workers[t].join();
+    assert(mt_shared->size == 800);
+    assert(findFile(cd(root, "mt/t3/../t2/a"), "own.log")->size == 200);
+    // node ที่ compact แล้วของหลาย folder อยู่ใน arena chunk เดียวกัน - rmdir พร้อมกันคืน chunk ร่วมกันได้
+    compacted = compact(&root);
+    assert(compacted == 1);
+    for (int t = 0; t < 4; ++t) {
+        mt_workers[t] = std::thread([this, &root, t]() {
+            char mt_path[32];
+            snprintf(mt_path, sizeof(mt_path), "root/mt/t%d", t);
+            rmdir(&root, mt_path);
+        });
+    }
+    for (int t = 0; t < 4; ++t) mt_workers[t].join();
+    assert(cd(root, "mt/t0") == NULL && cd(root, "mt/t3") == NULL && cd(root, "mt") != NULL);
+    // mv ที่ถูก quota ปฏิเสธสวนกับ mk/rm ชื่อเดียวกันใน src: ไฟล์กลับที่เดิมโดยไม่มีชื่อซ้ำ
+    MyFolder *mv_src = mkdir(&root, "root/mt/mv_src");
+    MyFolder *mv_full = mkdir(&root, "root/mt/mv_full");
+    int mv_ok = quota_set(mv_full, 0, 1);
+    assert(mv_ok);
+    std::atomic<int> mv_dups(0);
+    for (int t = 0; t < 2; ++t) {
+        mt_workers[t] = std::thread([this, mv_src, mv_full, &mv_dups, t]() {
+            for (int i = 0; i < 5000; ++i) {
+                if (t) {
+                    mv(mv_src, "f", mv_full);
+                    continue;
+                }
+                if (i & 1) {
+                    rm(mv_src, "f");
+                    continue;
+                }
+                mk(mv_src, "f");
+                int names = 0;
+                readLock(&mv_src->lock);
+                for (MyFile *f = mv_src->files; f; f = f->next) names += strcmp((char*)f->name, "f") == 0;
+                readUnlock(&mv_src->lock);
+                if (names > 1) mv_dups++;
+            }
+        });
+    }
+    for (int t = 0; t < 2; ++t) mt_workers[t].join();
+    assert(mv_dups == 0 && !mv_full->files);
+    mv_ok = quota_set(mv_full, 0, 0);
+    assert(mv_ok);
+    set_concurrent(false);
+
+    // Test 16: lock-free reads - reader ต้องไม่เห็น (data, size) ที่ไม่ตรงกัน ระหว่าง writer สลับ buffer
+    set_lockfree_reads(true);
+    MyFolder *rcu = mkdir(&root, "root/rcu");
+    MyFile *rcu_file = mk(rcu, "uniform.bin");
+    uint8_t rcu_fill[6000];
+    memset(rcu_fill, 'a', sizeof(rcu_fill));
+    write(rcu_file, rcu_fill, 100);
+    std::atomic<bool> rcu_done(false);
+    std::atomic<int> rcu_torn(0);
+    std::thread rcu_readers[2];
+    for (int t = 0; t < 2; ++t) {
+        rcu_readers[t] = std::thread([this, &root, &rcu_done, &rcu_torn]() {
+            uint8_t got[6000];
+            while (!rcu_done.load()) {
+                MyFolder *dir_now = cd(root, "rcu");
+                MyFile *file_now = dir_now ? mk(dir_now, "uniform.bin") : NULL;
+                int n = read(file_now, got, sizeof(got));
+                for (int i = 1; i < n; ++i) {
+                    if (got[i] != got[0]) { rcu_torn++; break; }
+                }
+                cd(root, "rcu/churn/deep");
+            }
+        });
+    }
+    for (int i = 0; i < 300; ++i) {
+        memset(rcu_fill, 'a' + i % 26, sizeof(rcu_fill));
+        write(rcu_file, rcu_fill, 100 + (i * 37) % 5000);
+        mkdir(&root, "root/rcu/churn/deep");
+        MyFile *tmp = mk(cd(root, "rcu/churn"), "tmp.log");
+        append(tmp, "grow");
+        rmdir(&root, "root/rcu/churn");
+    }
+    rcu_done = true;
+    for (int t = 0; t < 2; ++t) rcu_readers[t].join();
+    assert(rcu_torn.load() == 0);
+    assert(cd(root, "rcu/churn") == NULL);
+    // write แทนที่ทั้งไฟล์ - buffer ที่เคยขยายหดกลับตามขนาดใหม่ และ append ต่อจากนั้นได้ตามปกติ
+    int rcu_ok = write(rcu_file, rcu_fill, 6000);
+    assert(rcu_ok && rcu_file->capacity == 8192);
+    rcu_ok = write(rcu_file, rcu_fill, 100) && append(rcu_file, "!");
+    assert(rcu_ok && rcu_file->capacity == 4096 && rcu_file->size == 101 && rcu_file->data[100] == '!');
+    set_lockfree_reads(false);
+
+    // Test 17: append_shared - หลาย producer ต่อท้ายไฟล์เดียว reader เห็นเฉพาะ record ที่ครบแล้ว
+    set_concurrent(true);
+    MyFile *mp_log = mk(mkdir(&root, "root/var/log"), "mp.log");
+    std::atomic<bool> mp_done(false);
+    std::atomic<int> mp_partial(0);
+    std::thread mp_reader([this, mp_log, &mp_done, &mp_partial]() {
+        static uint8_t got[4 * 500 * 16];
+        while (!mp_done.load()) {
+            int n = read(mp_log, got, sizeof(got));
+            if (n % 16 != 0) mp_partial++;
+            for (int i = 0; i < n; ++i) {
+                uint8_t expect = (i % 16 == 15) ? '\n' : got[i - i % 16];
+                if (got[i] != expect) { mp_partial++; break; }
+            }
+        }
+    });
+    std::thread mp_producers[4];
+    for (int t = 0; t < 4; ++t) {
+        mp_producers[t] = std::thread([this, mp_log, t]() {
+            uint8_t record[16];
+            memset(record, 'A' + t, 15);
+            record[15] = '\n';
+            for (int i = 0; i < 500; ++i) append_shared(mp_log, record, sizeof(record));
+        });
+    }
+    for (int t = 0; t < 4; ++t) mp_producers[t].join();
+    mp_done = true;
+    mp_reader.join();
+    assert(mp_partial.load() == 0);
+    assert(mp_log->size == 4 * 500 * 16 && mp_log->reserved == mp_log->size);
+    int mp_count[4] = {0, 0, 0, 0};
+    for (size_t r = 0; r < mp_log->size; r += 16) mp_count[mp_log->data[r] - 'A']++;
+    assert(mp_count[0] == 500 && mp_count[1] == 500 && mp_count[2] == 500 && mp_count[3] == 500);
+    int mp_tail = append(mp_log, "tail");
+    assert(mp_tail == 1 && mp_log->reserved == mp_log->size);
+    set_concurrent(false);
+
+    // Test 18: parallel traversal - capacity เท่ากับแบบ sequential และลบ tree ได้ครบ
+    char par_path[64];
+    MyFolder *par_tree = NULL;
+    for (int i = 0; i < 200; ++i) {
+        snprintf(par_path, sizeof(par_path), "par/a%d/b%d/c%d", i % 7, i % 23, i);
+        MyFile *par_file = mk(mkdir(&par_tree, par_path), "f.txt");
+        assert(par_file != NULL);
+    }
+    size_t par_sequential = calculateFolderCapacity(root, true) + calculateFolderCapacity(par_tree, true);
+    assert(parallelWalk(MOUNTKIT_WALK_CAPACITY, root, NULL) == calculateFolderCapacity(root, true));
+    set_parallel(4, 2);
+    assert(parallelWalk(MOUNTKIT_WALK_CAPACITY, root, NULL) + parallelWalk(MOUNTKIT_WALK_CAPACITY, par_tree, NULL) == par_sequential);
+    removeFolder(par_tree);
+    set_parallel(0);
+
+    // Test 19: async - future, callback ผ่าน async_poll และขีดจำกัด in-flight
+    MyAsync *io = async_open(2, 4);
+    assert(concurrent);
+    MyFolder *async_src = mkdir(&root, "root/async/src");
+    MyFolder *async_dst = mkdir(&root, "root/async/dst");
+    MyFile *async_big = mk(async_src, "big.bin");
+    static uint8_t async_blob[100000];
+    memset(async_blob, 'z', sizeof(async_blob));
+    int async_ok = async_write(io, async_big, async_blob, sizeof(async_blob)).get();
+    assert(async_ok == 1);
+    async_ok = async_cp(io, async_src, "big.bin", async_dst).get();
+    assert(async_ok == 1);
+    assert(findFile(async_dst, "big.bin")->size == sizeof(async_blob));
+    int async_done = 0;
+    mountkit_done_fn async_count = [](void *ctx, int result) { *(int*)ctx += result; };
+    for (int i = 0; i < 4; ++i) {
+        snprintf(par_path, sizeof(par_path), "root/async/tmp%d", i);
+        mkdir(&root, par_path);
+        std::future<int> async_queued = async_rmdir(io, &root, par_path, async_count, &async_done);
+        assert(async_queued.valid());
+    }
+    // callback ยังไม่ถูก poll - in-flight เต็ม งานที่มี callback ต้องไม่ block
+    std::future<int> async_full = async_cp(io, async_src, "big.bin", async_dst, async_count, &async_done);
+    assert(!async_full.valid());
+    while (async_done < 4) async_poll(io);
+    assert(async_in_flight(io) == 0 && cd(root, "async/tmp3") == NULL);
+    // rmdir ที่ fail บน executor คืน 0 และ error code ไปถึง thread ที่ poll
+    int async_missing = async_rmdir(io, &root, "root/async/none").get();
+    assert(async_missing == 0);
+    int async_result = -1;
+    mountkit_done_fn async_store = [](void *ctx, int result) { *(int*)ctx = result; };
+    std::future<int> async_failed = async_rmdir(io, &root, "root/async/none", async_store, &async_result);
+    assert(async_failed.valid());
+    clearError();
+    while (async_result < 0) async_poll(io);
+    assert(async_result == 0 && lastError() == MOUNTKIT_ENOENT);
+    clearError();
+    async_close(io);
+    assert(!concurrent); // async_close คืน mode ก่อน async_open
+    set_concurrent(true);
+    io = async_open(1, 1);
+    async_close(io);
+    assert(concurrent);
+    set_concurrent(false);
+
+    // Test 20: batch - apply ครบทุก operation หรือไม่ apply เลย
+    MyBatch batch;
+    batch_init(&batch);
+    MyFile *batch_log = mk(mkdir(&root, "root/batch/log"), "app.log");
+    append(batch_log, "one\n");
+    int batch_ok = batch_mkdir(&batch, "root/batch/etc/nginx");
+    batch_ok &= batch_write(&batch, "root/batch/etc/nginx/nginx.conf", (const uint8_t*)"worker 4;", 9);
+    batch_ok &= batch_append(&batch, "root/batch/etc/nginx/nginx.conf", (const uint8_t*)"\n", 1);
+    batch_ok &= batch_append(&batch, "root/batch/log/app.log", (const uint8_t*)"two\n", 4);
+    batch_ok &= batch_mk(&batch, "root/batch/log/empty");
+    batch_ok &= batch_rm(&batch, "root/batch/log/empty");
+    assert(batch_ok);
+    batch_ok = batch_mk(&batch, "root");
+    assert(!batch_ok);   // ไฟล์ต้องอยู่ใน folder
+    batch_ok = batch_commit(&batch, &root);
+    assert(batch_ok == 1 && batch.count == 0);
+    MyFolder *batch_nginx = cd(root, "batch/etc/nginx");
+    assert(batch_nginx && findFile(batch_nginx, "nginx.conf")->size == 10);
+    assert(batch_log->size == 8 && memcmp(batch_log->data, "one\ntwo\n", 8) == 0);
+    assert(cd(root, "batch/log")->files == batch_log && batch_log->next == NULL);
+    // rm ไฟล์ที่ไม่มี -> ทั้ง batch ไม่ถูก apply
+    batch_ok = batch_mkdir(&batch, "root/batch/new");
+    batch_ok &= batch_write(&batch, "root/batch/log/app.log", (const uint8_t*)"gone", 4);
+    batch_ok &= batch_rm(&batch, "root/batch/log/missing");
+    assert(batch_ok);
+    batch_ok = batch_commit(&batch, &root);
+    assert(batch_ok == 0);
+    assert(cd(root, "batch/new") == NULL && batch_log->size == 8);
+    batch_release(&batch);
+
+    // Test 21: sharded namespace - subtree อยู่ shard เดียว, capacity รวมทุก shard โดยนับ folder ร่วมครั้งเดียว
+    MyShards *ns = shards_open(4, 2);
+    MyFolder *ns_log = shards_mkdir(ns, "var/log");
+    MyFolder *ns_docs = shards_mkdir(ns, "home/alice/docs");
+    assert(ns_log && ns_docs);
+    MyFile *ns_syslog = shards_mk(ns, "var/log/syslog");
+    int ns_ok = ns_syslog ? shards_instance(ns, "var/log/syslog")->append(ns_syslog, "boot\n") : 0;
+    assert(ns_ok);
+    assert(shards_instance(ns, "var/log/syslog") == shards_instance(ns, "var/log"));
+    MyFile *ns_motd = shards_mk(ns, "var/motd");
+    MyFile *ns_top = shards_mk(ns, "top.txt");
+    assert(ns_motd && ns_top);  // parent ที่ตื้นกว่า depth ถูกสร้างให้
+    assert(shards_cd(ns, "var") && shards_cd(ns, "home/alice/docs") && !shards_cd(ns, "var/tmp"));
+    size_t ns_file = 4096 + sizeof(MyFile);
+    size_t ns_expected = shards_capacity(ns, "var/log") + shards_capacity(ns, "home/alice")
+                       + (strlen("root") + sizeof(MyFolder)) + ns_file + strlen("top.txt") + 1
+                       + (strlen("var") + sizeof(MyFolder)) + ns_file + strlen("motd") + 1
+                       + (strlen("home") + sizeof(MyFolder));
+    assert(shards_capacity(ns, "") == ns_expected);
+    ns_ok = shards_rm(ns, "var/motd");
+    assert(ns_ok);
+    ns_ok = shards_rm(ns, "var/motd");
+    assert(!ns_ok);
+    shards_rmdir(ns, "var");
+    assert(!shards_cd(ns, "var") && !shards_cd(ns, "var/log"));
+    shards_close(ns);
+
+    // Test 22: error code ต่อ thread - operation ที่ fail บันทึกสาเหตุ, ที่สำเร็จไม่ล้าง, thread อื่นไม่เห็น
+    clearError();
+    assert(!hasError());
+    MyFile *err_file = mk(NULL, "x");
+    assert(!err_file && lastError() == MOUNTKIT_EINVAL);
+    err_file = mk(root, "ok.txt");
+    assert(err_file && lastError() == MOUNTKIT_EINVAL);
+    clearError();
+    MyFolder *err_dir = cd(root, "no/such/dir");
+    assert(!err_dir && lastError() == MOUNTKIT_ENOENT);
+    int err_ok = rm(root, "missing.txt");
+    assert(!err_ok && lastError() == MOUNTKIT_ENOENT);
+    rmdir(&root, "root/no_such_dir");
+    assert(lastError() == MOUNTKIT_ENOENT);
+    err_ok = cp(root, "ok.txt", root);
+    assert(!err_ok && lastError() == MOUNTKIT_EEXIST);
+    std::thread([this]() {
+        assert(lastError() == MOUNTKIT_OK);
+        int other_ok = rm(NULL, "x");
+        assert(!other_ok && lastError() == MOUNTKIT_EINVAL);
+    }).join();
+    assert(lastError() == MOUNTKIT_EEXIST && strcmp(errorString(lastError()), "name already exists") == 0);
+    clearError();
+    rm(root, "ok.txt");
+
+    // Test 23: safe handle - handle ที่ถือใน guard ยังใช้ได้หลัง rm/rmdir, หน่วยความจำคืนหลัง guard_leave
+    set_safe_handles(true);
+    MyFolder *held_dir = mkdir(&root, "root/held");
+    MyFile *held_file = mk(held_dir, "live.log");
+    std::thread([this, held_file]() {
+        guard_enter();
+        int held_ok = write(held_file, (uint8_t*)"before", 6);
+        assert(held_ok);
+        guard_leave();
+    }).join();
+    guard_enter();
+    MyFile *gone = mk(held_dir, "gone.tmp");
+    int gone_ok = gone ? rm(held_dir, "gone.tmp") && write(gone, "still here") : 0;
+    assert(gone_ok);
+    std::thread([this, &root]() { rmdir(&root, "root/held"); }).join();
+    assert(!cd(root, "root/held"));
+    gone_ok = append(held_file, "+after");
+    assert(gone_ok && held_file->size == 12);
+    MyFile *late = mk(held_dir, "late.txt");
+    assert(late);  // folder ที่ถูกลบแล้วยังรับ operation ได้ แต่ไม่มีใครเห็น
+    guard_leave();
+    set_safe_handles(false);
+
+    // Test 24: watch - event ของ child และไฟล์, รวม event ที่ซ้ำ, overflow marker, DELETE_SELF
+    MyFolder *watched = mkdir(&root, "root/watched");
+    MyWatch *dir_watch = watch(watched, MOUNTKIT_WATCH_ALL, 4);
+    MyFile *watched_file = mk(watched, "a.log");
+    MyWatch *file_watch = watch(watched_file, MOUNTKIT_WATCH_MODIFY);
+    MyWatchEvent ev[8];
+    int polled = watch_poll(dir_watch, ev, 8);
+    assert(polled == 1 && ev[0].mask == MOUNTKIT_WATCH_CREATE && strcmp(ev[0].name, "a.log") == 0);
+    append(watched_file, "x");
+    append(watched_file, "y");
+    write(watched_file, "z");
+    polled = watch_poll(file_watch, ev, 8);
+    assert(polled == 1 && ev[0].mask == MOUNTKIT_WATCH_MODIFY && ev[0].count == 3);
+    const char *burst[] = {"root/watched/d1", "root/watched/d2", "root/watched/d3", "root/watched/d4", "root/watched/d5"};
+    for (int i = 0; i < 5; ++i) mkdir(&root, burst[i]);
+    polled = watch_poll(dir_watch, ev, 8);
+    assert(polled == 5 && ev[3].mask == (MOUNTKIT_WATCH_CREATE | MOUNTKIT_WATCH_ISDIR));
+    assert(strcmp(ev[3].name, "d4") == 0 && ev[4].mask == MOUNTKIT_WATCH_OVERFLOW);
+    int waited = 0;
+    std::thread waiter([this, dir_watch, &ev, &waited]() { waited = watch_wait(dir_watch, ev, 8, 5000); });
+    mv(watched, "a.log", watched);  // ชื่อซ้ำในปลายทาง - ไม่มี event
+    mk(watched, "b.log");
+    waiter.join();
+    assert(waited == 1 && ev[0].mask == MOUNTKIT_WATCH_CREATE && strcmp(ev[0].name, "b.log") == 0);
+    waited = watch_wait(dir_watch, ev, 8, 1);
+    assert(waited == 0);
+    // compact ย้าย node ทั้ง tree - watch ตามไปยัง copy โดยไม่มี DELETE_SELF
+    compacted = compact(&root);
+    assert(compacted == 1);
+    watched = cd(root, "root/watched");
+    append(findFile(watched, "a.log"), "w");
+    mk(watched, "c.log");
+    polled = watch_poll(file_watch, ev, 8);
+    assert(polled == 1 && ev[0].mask == MOUNTKIT_WATCH_MODIFY);
+    polled = watch_poll(dir_watch, ev, 8);
+    assert(polled == 1 && ev[0].mask == MOUNTKIT_WATCH_CREATE && strcmp(ev[0].name, "c.log") == 0);
+    rmdir(&root, "root/watched");
+    polled = watch_poll(file_watch, ev, 8);
+    assert(polled == 1 && ev[0].mask == MOUNTKIT_WATCH_DELETE_SELF);
+    polled = watch_poll(dir_watch, ev, 8);
+    assert(polled == 1 && ev[0].mask == MOUNTKIT_WATCH_DELETE_SELF);
+    unwatch(file_watch);
+    unwatch(dir_watch);
+    // หลายผู้ส่งพร้อมกัน: ทุก event เข้า queue ครบ ไม่ซ้ำ ไม่หาย (queue ใหญ่พอ - ไม่มี overflow)
+    set_concurrent(true);
+    MyFolder *mp_watched = mkdir(&root, "root/mpwatch");
+    MyWatch *mp_watch = watch(mp_watched, MOUNTKIT_WATCH_CREATE, 1024);
+    std::thread mp_senders[4];
+    for (int t = 0; t < 4; ++t) {
+        mp_senders[t] = std::thread([this, mp_watched, t]() {
+            char mp_name[16];
+            for (int i = 0; i < 200; ++i) {
+                snprintf(mp_name, sizeof(mp_name), "t%d_%d", t, i);
+                mk(mp_watched, mp_name);
+            }
+        });
+    }
+    for (int t = 0; t < 4; ++t) mp_senders[t].join();
+    set_concurrent(false);
+    int mp_seen[4] = {0, 0, 0, 0};
+    int mp_events = 0;
+    MyWatchEvent mp_ev[64];
+    while ((polled = watch_poll(mp_watch, mp_ev, 64)) > 0) {
+        for (int i = 0; i < polled; ++i) {
+            assert(mp_ev[i].mask == MOUNTKIT_WATCH_CREATE && mp_ev[i].count == 1);
+            mp_seen[mp_ev[i].name[1] - '0']++;
+            mp_events++;
+        }
+    }
+    assert(mp_events == 800 && mp_seen[0] == 200 && mp_seen[3] == 200);
+    unwatch(mp_watch);
+    rmdir(&root, "root/mpwatch");
+    // concurrent mode ปิด: thread เดียวแก้ tree ขณะที่อีก thread watch/unwatch ซ้ำ ๆ
+    MyFolder *uw_dir = mkdir(&root, "root/uwatch");
+    std::atomic<bool> uw_stop(false);
+    std::thread uw_writer([this, uw_dir, &uw_stop]() {
+        while (!uw_stop) {
+            mk(uw_dir, "f");
+            rm(uw_dir, "f");
+        }
+    });
+    for (int i = 0; i < 20000; ++i) {
+        MyWatch *uw = watch(uw_dir, MOUNTKIT_WATCH_CREATE, 4);
+        assert(uw);
+        unwatch(uw);
+    }
+    uw_stop = true;
+    uw_writer.join();
+    rmdir(&root, "root/uwatch");
+
+    // Test 25: iterator - ลำดับ pre/post/BFS, prune, path และ tree ที่กว้าง/ลึกมากโดยไม่มี recursion
+    MyFolder *walk = mkdir(&root, "root/walk");
+    mkdir(&root, "root/walk/a/a1");
+    mkdir(&root, "root/walk/b");
+    mk(cd(root, "root/walk/a"), "fa");
+    char order[128], walk_path[64];
+    const int walk_flags[3] = {
+        MOUNTKIT_ITER_PRE | MOUNTKIT_ITER_POST | MOUNTKIT_ITER_FILES,
+        MOUNTKIT_ITER_PRE | MOUNTKIT_ITER_FILES | MOUNTKIT_ITER_BFS,
+        MOUNTKIT_ITER_PRE,
+    };
+    const char *walk_expected[3] = { "+walk+a fa+a1-a1-a+b-b-walk", "+walk+a fa+b+a1", "+walk+a+b" };
+    for (int round = 0; round < 3; ++round) {
+        MyIter it;
+        order[0] = '\0';
+        iter_begin(&it, walk, walk_flags[round]);
+        while (iter_next(&it)) {
+            const char *name = it.file ? (const char*)it.file->name : it.folder->data;
+            snprintf(order + strlen(order), sizeof(order) - strlen(order), "%s%s", it.file ? " " : it.post ? "-" : "+", name);
+            if (round == 2 && !it.file && strcmp(name, "a") == 0) iter_prune(&it);
+            if (round == 0 && it.file) {
+                assert(iter_path(&it, walk_path, sizeof(walk_path)) == 9 && strcmp(walk_path, "walk/a/fa") == 0);
+                assert(iter_path(&it, walk_path, sizeof(walk_path), 1) == 4 && strcmp(walk_path, "a/fa") == 0);
+            }
+        }
+        iter_end(&it);
+        assert(strcmp(order, walk_expected[round]) == 0);
+    }
+    rmdir(&root, "root/walk");
+    
+    // ต่อ link เองนอก tree แล้วคำนวณยอดรวมใหม่ (usageRebuild เดินด้วย iterator เช่นกัน)
+    MyFolder *wide = NULL, *tall = NULL;
+    createFolder(&wide, "wide");
+    createFolder(&tall, "deep");
+    assert(wide && tall);
+    MyFolder **wide_link = &wide->subdir, *deep_tail = tall;
+    for (int i = 0; i < 200000; ++i) {
+        createFolder(wide_link, "w");
+        createFolder(&deep_tail->subdir, "d");
+        assert(*wide_link && deep_tail->subdir);
+        wide_link = &(*wide_link)->dir;
+        deep_tail = deep_tail->subdir;
+    }
+    usageRebuild(wide);
+    usageRebuild(tall);
+    assert(calculateFolderCapacity(wide, true) == 4 + 200001 * sizeof(MyFolder) + 200000);
+    assert(calculateFolderCapacity(tall, true) == 4 + 200001 * sizeof(MyFolder) + 200000);
+    assert(calculateFolderCapacity(wide, false) == 4 + sizeof(MyFolder));
+    removeFolder(wide);
+    removeFolder(tall);
+
+    // Test 26: find - wildcard, class, **, literal prefix, folder match และหยุดกลางทาง
+    mkdir(&root, "root/find/src/lib/deep");
+    mkdir(&root, "root/find/doc");
+    const char *find_files[] = { "src/a.c", "src/b.h", "src/x.txt", "src/lib/c.c", "src/lib/deep/d.c", "doc/readme.txt" };
+    for (size_t i = 0; i < sizeof(find_files) / sizeof(find_files[0]); ++i) {
+        char find_dir[64];
+        snprintf(find_dir, sizeof(find_dir), "root/find/%s", find_files[i]);
+        *strrchr(find_dir, '/') = '\0';
+        MyFile *find_file = mk(cd(root, find_dir), strrchr(find_files[i], '/') + 1);
+        assert(find_file);
+    }
+    mountkit_find_fn find_collect = [](void *ctx, const char *path, MyFolder *folder, MyFile *file) {
+        char *out = (char*)ctx;
+        snprintf(out + strlen(out), 512 - strlen(out), "%s%s ", path, folder && !file ? "/" : "");
+        return 1;
+    };
+    char found[512];
+    found[0] = '\0';
+    int find_count = find(root, "root/find/src/*.c", find_collect, found);
+    assert(find_count == 1 && strcmp(found, "root/find/src/a.c ") == 0);
+    found[0] = '\0';
+    find_count = find(root, "root/find/src/**/*.c", find_collect, found);
+    assert(find_count == 3);
+    assert(strcmp(found, "root/find/src/a.c root/find/src/lib/c.c root/find/src/lib/deep/d.c ") == 0);
+    found[0] = '\0';
+    find_count = find(root, "find/**/[a-c].[!c]", find_collect, found);
+    assert(find_count == 1 && strcmp(found, "root/find/src/b.h ") == 0);
+    found[0] = '\0';
+    find_count = find(root, "root/find/*", find_collect, found);
+    assert(find_count == 2 && strcmp(found, "root/find/src/ root/find/doc/ ") == 0);
+    found[0] = '\0';
+    find_count = find(root, "root/find/s?c/lib", find_collect, found);
+    assert(find_count == 1 && strcmp(found, "root/find/src/lib/ ") == 0);
+    found[0] = '\0';
+    find_count = find(root, "root/find/**/*.txt", find_collect, found);
+    assert(find_count == 2);
+    clearError();
+    find_count = find(root, "root/nothing/**", find_collect, found);
+    assert(find_count == 0 && lastError() == MOUNTKIT_OK);
+    mountkit_find_fn find_first = [](void *ctx, const char *path, MyFolder *folder, MyFile *file) {
+        (void)path; (void)folder; (void)file;
+        (*(int*)ctx)++;
+        return 0;
+    };
+    int find_calls = 0;
+    find_count = find(root, "root/find/**", find_first, &find_calls);
+    assert(find_count == 1 && find_calls == 1);
+    rmdir(&root, "root/find");
+
+    // Test 27: ordered index - เรียงตามชื่อ, prefix/range, แบ่งหน้าข้ามการแก้ไข และตามทัน rm/mv/rmdir/batch
+    MyFolder *idx = mkdir(&root, "root/idx");
+    mk(idx, "log.2024-02");
+    mk(idx, "b.txt");
+    mkdir(&root, "root/idx/log.2024-02");
+    int index_ok = index_enable(idx);
+    index_ok &= index_enable(idx);
+    assert(index_ok);
+    mk(idx, "log.2023-12");
+    mk(idx, "log.2024-01");
+    mk(idx, "a.txt");
+    mkdir(&root, "root/idx/c");
+    mountkit_find_fn index_collect = [](void *ctx, const char *name, MyFolder *folder, MyFile *file) {
+        char *out = (char*)ctx;
+        snprintf(out + strlen(out), 512 - strlen(out), "%s%s ", name, folder && !file ? "/" : "");
+        return 1;
+    };
+    char listed[512];
+    MyCursor index_cursor;
+    listed[0] = '\0';
+    cursor_init(&index_cursor);
+    int scanned = index_scan(idx, &index_cursor, 0, index_collect, listed);
+    assert(scanned == 7 && index_cursor.done);
+    assert(strcmp(listed, "a.txt b.txt c/ log.2023-12 log.2024-01 log.2024-02/ log.2024-02 ") == 0);
+    listed[0] = '\0';
+    cursor_init(&index_cursor, NULL, NULL, "log.2024");
+    scanned = index_scan(idx, &index_cursor, 0, index_collect, listed);
+    assert(scanned == 3);
+    assert(strcmp(listed, "log.2024-01 log.2024-02/ log.2024-02 ") == 0);
+    listed[0] = '\0';
+    cursor_init(&index_cursor, "b", "log.2024");
+    scanned = index_scan(idx, &index_cursor, 0, index_collect, listed);
+    assert(scanned == 3 && strcmp(listed, "b.txt c/ log.2023-12 ") == 0);
+    // หน้าละ 3: ระหว่างหน้าลบชื่อที่ส่งไปแล้วและเพิ่มชื่อที่อยู่ข้างหน้า cursor
+    listed[0] = '\0';
+    cursor_init(&index_cursor);
+    scanned = index_scan(idx, &index_cursor, 3, index_collect, listed);
+    assert(scanned == 3 && !index_cursor.done);
+    index_ok = rm(idx, "a.txt");
+    index_ok &= mk(idx, "d.txt") != NULL;
+    index_ok &= mv(idx, "log.2023-12", cd(root, "root/idx/c"));
+    assert(index_ok);
+    rmdir(&root, "root/idx/log.2024-02");
+    while (!index_cursor.done) index_scan(idx, &index_cursor, 3, index_collect, listed);
+    assert(strcmp(listed, "a.txt b.txt c/ d.txt log.2024-01 log.2024-02 ") == 0);
+    MyBatch index_batch;
+    batch_init(&index_batch);
+    batch_mk(&index_batch, "root/idx/0.txt");
+    batch_mkdir(&index_batch, "root/idx/zz");
+    batch_rm(&index_batch, "root/idx/b.txt");
+    index_ok = batch_commit(&index_batch, &root);
+    assert(index_ok);
+    batch_release(&index_batch);
+    listed[0] = '\0';
+    cursor_init(&index_cursor);
+    index_scan(idx, &index_cursor, 0, index_collect, listed);
+    assert(strcmp(listed, "0.txt c/ d.txt log.2024-01 log.2024-02 zz/ ") == 0);
+    // compact subtree ที่ไม่ใช่ root: entry ใน index ของ parent ต้องชี้ไปยัง copy
+    MyFolder **index_slot = &idx->subdir;
+    while (*index_slot && strcmp((*index_slot)->data, "c") != 0) index_slot = &(*index_slot)->dir;
+    index_ok = compact(index_slot);
+    assert(index_ok && *index_slot == cd(idx, "c"));
+    index_ok = mk(idx, "c.txt") != NULL;
+    index_ok &= mv(cd(idx, "c"), "log.2023-12", idx);
+    assert(index_ok);
+    listed[0] = '\0';
+    cursor_init(&index_cursor);
+    index_scan(idx, &index_cursor, 0, index_collect, listed);
+    assert(strcmp(listed, "0.txt c/ c.txt d.txt log.2023-12 log.2024-01 log.2024-02 zz/ ") == 0);
+    // ลูกจำนวนมาก: ลำดับตรงกับการเรียงชื่อและเริ่มกลางช่วงได้
+    for (int i = 0; i < 3000; ++i) {
+        char index_name[16];
+        snprintf(index_name, sizeof(index_name), "n%05d", (i * 7919) % 3000);
+        MyFile *index_file = mk(idx, index_name);
+        assert(index_file);
+    }
+    int index_count = 0;
+    mountkit_find_fn index_sorted = [](void *ctx, const char *name, MyFolder *folder, MyFile *file) {
+        (void)folder; (void)file;
+        int *n = (int*)ctx;
+        char expect[16];
+        snprintf(expect, sizeof(expect), "n%05d", 1500 + (*n)++);
+        return strcmp(name, expect) == 0 ? 1 : 0;
+    };
+    cursor_init(&index_cursor, "n01500", "n0200");
+    scanned = index_scan(idx, &index_cursor, 0, index_sorted, &index_count);
+    assert(scanned == 500 && index_count == 500);
+    index_disable(idx);
+    clearError();
+    scanned = index_scan(idx, &index_cursor, 0, index_collect, listed);
+    assert(scanned == 0 && lastError() == MOUNTKIT_EINVAL);
+    rmdir(&root, "root/idx");
+
+    // Test 28: readdir - หน้าเล็กข้ามการแก้ไข (ลำดับ chain และลำดับ index) และ dir() ที่ไม่ถูกตัด
+    MyFolder *rd = mkdir(&root, "root/rd");
+    mkdir(&root, "root/rd/sub");
+    for (int i = 0; i < 5; ++i) {
+        char rd_name[8];
+        snprintf(rd_name, sizeof(rd_name), "f%d", i);
+        MyFile *rd_file = mk(rd, rd_name);
+        assert(rd_file);
+        if (i == 2) write(rd_file, "hello");
+    }
+    MyDirEntry rd_page[2];
+    MyCursor rd_cursor;
+    int rd_seen[6] = {0}; // f0..f4, sub
+    cursor_init(&rd_cursor);
+    int rd_count = readdir(rd, &rd_cursor, rd_page, 2);
+    assert(rd_count == 2 && !rd_cursor.done);
+    char rd_removed[MOUNTKIT_NAME_MAX];
+    snprintf(rd_removed, sizeof(rd_removed), "%s", rd_page[0].name);
+    for (int i = 0; i < 2; ++i) rd_seen[rd_page[i].type == MOUNTKIT_DT_DIR ? 5 : rd_page[i].name[1] - '0']++;
+    // ลบ entry ที่ส่งไปแล้วและเพิ่มชื่อใหม่ - entry ที่ไม่ถูกแตะต้องมาครั้งเดียว
+    if (strcmp(rd_removed, "sub") == 0) rmdir(&root, "root/rd/sub");
+    else {
+        int rd_ok = rm(rd, rd_removed);
+        assert(rd_ok);
+    }
+    MyFile *rd_added = mk(rd, "g");
+    assert(rd_added);
+    while (!rd_cursor.done) {
+        int n = readdir(rd, &rd_cursor, rd_page, 2);
+        for (int i = 0; i < n; ++i) {
+            if (strcmp(rd_page[i].name, "g") == 0) continue;
+            rd_seen[rd_page[i].type == MOUNTKIT_DT_DIR ? 5 : rd_page[i].name[1] - '0']++;
+            if (strcmp(rd_page[i].name, "f2") == 0) assert(rd_page[i].size == 5 && rd_page[i].capacity >= 5);
+            if (rd_page[i].type == MOUNTKIT_DT_DIR) assert(rd_page[i].size == 0 && rd_page[i].capacity == 0);
+        }
+    }
+    for (int i = 0; i < 6; ++i) assert(rd_seen[i] == 1);
+    rd_count = readdir(rd, &rd_cursor, rd_page, 2);
+    assert(rd_count == 0);
+    // index: เรียงตาม (ชื่อ, ชนิด) และใช้ prefix ได้
+    int rd_indexed = index_enable(rd);
+    assert(rd_indexed);
+    int rd_total = 0;
+    char rd_prev[MOUNTKIT_NAME_MAX] = "";
+    cursor_init(&rd_cursor);
+    while (!rd_cursor.done) {
+        int n = readdir(rd, &rd_cursor, rd_page, 2);
+        for (int i = 0; i < n; ++i) {
+            assert(strcmp(rd_prev, rd_page[i].name) < 0);
+            memcpy(rd_prev, rd_page[i].name, sizeof(rd_prev) - 1);
+            rd_prev[sizeof(rd_prev) - 1] = '\0';
+            rd_total++;
+        }
+    }
+    assert(rd_total == 6);
+    cursor_init(&rd_cursor, NULL, NULL, "f");
+    rd_count = readdir(rd, &rd_cursor, rd_page, 2);
+    assert(rd_count == 2);
+    rd_count = readdir(rd, &rd_cursor, rd_page, 2);
+    assert(rd_count == 2);
+    rd_count = readdir(rd, &rd_cursor, rd_page, 2);
+    assert(rd_count <= 1 && rd_cursor.done);
+    // dir() เกิน 8KB เดิม: ไม่ตัด และ folder ยังอยู่ก่อนไฟล์แม้ index จะเรียงปนกัน
+    for (int i = 0; i < 400; ++i) {
+        char rd_name[32];
+        snprintf(rd_name, sizeof(rd_name), "long_file_name_%03d", i);
+        MyFile *rd_long = mk(rd, rd_name);
+        assert(rd_long);
+    }
+    mkdir(&root, "root/rd/zz");
+    const char *listing = dir(rd, true);
+    size_t listing_len = strlen(listing);
+    assert(listing_len > 8192);
+    assert(strstr(listing, "long_file_name_399") && strstr(listing, "  Total items: 407\n"));
+    assert(strstr(listing, "[DIR]  zz") < strstr(listing, "\nFILES:\n"));
+    index_disable(rd);
+    assert(strlen(dir(rd, true)) == listing_len);
+    rmdir(&root, "root/rd");
+
+    // Test 29: usage - ยอดรวมตาม write/append/mk/rm/mv/cp/batch/rmdir/mount ตรงกับการเดินนับจริง
+    MyFolder *du = mkdir(&root, "root/du");
+    MyFolder *du_b = mkdir(&root, "root/du/a/b");
+    MyUsage du_u, du_root_before;
+    usage(root, &du_root_before);
+    MyFile *du_f = mk(du_b, "f.txt");
+    int du_ok = write(du_f, "0123456789") && append(du_f, "ab");
+    assert(du_ok);
+    du_ok = usage(du, &du_u);
+    assert(du_ok && du_u.bytes == 12 && du_u.files == 1 && du_u.dirs == 3 && du_u.mounts == 0);
+    assert(du_u.names == strlen("du") + strlen("a") + strlen("b") + strlen("f.txt") + 1);
+    assert(du_u.capacity == du_f->capacity);
+    du_ok = usage(du, &du_u, false);
+    assert(du_ok && du_u.files == 0 && du_u.dirs == 1 && du_u.bytes == 0);
+    du_ok = mv(du_b, "f.txt", du);
+    assert(du_ok);
+    du_ok = usage(du, &du_u);
+    assert(du_ok && du_u.bytes == 12);
+    du_ok = usage(du_b, &du_u);
+    assert(du_ok && du_u.bytes == 0 && du_u.files == 0);
+    du_ok = cp(du, "f.txt", du_b) && usage(du, &du_u);
+    assert(du_ok && du_u.bytes == 24 && du_u.files == 2);
+    du_ok = append_shared(du_f, (const uint8_t*)"xyz", 3) && usage(du, &du_u);
+    assert(du_ok && du_u.bytes == 27);
+    du_ok = rm(du, "f.txt") && usage(du, &du_u);
+    assert(du_ok && du_u.bytes == 12 && du_u.files == 1);
+    MyBatch du_batch;
+    batch_init(&du_batch);
+    batch_mkdir(&du_batch, "root/du/n");
+    batch_write(&du_batch, "root/du/n/x.bin", (const uint8_t*)"12345", 5);
+    batch_append(&du_batch, "root/du/a/b/f.txt", (const uint8_t*)"!", 1);
+    du_ok = batch_commit(&du_batch, &root);
+    assert(du_ok);
+    batch_release(&du_batch);
+    du_ok = usage(du, &du_u);
+    assert(du_ok && du_u.bytes == 18 && du_u.files == 2 && du_u.dirs == 4);
+    // mount: tree ที่ mount ไว้ถูกรวมด้วย และ capacity ตรงกับการไล่ไฟล์จริง
+    MyFolder *du_other = NULL;
+    MyFile *du_other_file = mk(mkdir(&du_other, "other/deep"), "o.txt");
+    du_ok = write(du_other_file, "ooooo");
+    assert(du_ok);
+    mkdir(&root, "root/du/m");
+    du_ok = mount(root, "du/m", du_other);
+    assert(du_ok);
+    du_ok = usage(du, &du_u);
+    assert(du_ok && du_u.bytes == 23 && du_u.files == 3 && du_u.dirs == 6 && du_u.mounts == 1);
+    assert(calculateFolderCapacity(root, true) == parallelWalk(MOUNTKIT_WALK_CAPACITY, root, NULL));
+    MyFolder *du_unmounted = umount(root, "du/m");
+    assert(du_unmounted == du_other);
+    du_ok = usage(du, &du_u);
+    assert(du_ok && du_u.bytes == 18 && du_u.mounts == 0);
+    removeFolder(du_other);
+    rmdir(&root, "root/du");
+    du_ok = usage(root, &du_u);
+    assert(du_ok && du_u.dirs == du_root_before.dirs - 3 && du_u.bytes == du_root_before.bytes);
+    assert(calculateFolderCapacity(root, true) == parallelWalk(MOUNTKIT_WALK_CAPACITY, root, NULL));
+
+    // Test 30: grep - offset/เลขบรรทัดตรงกับการค้นทีละ byte รวมข้อความที่คร่อมรอยต่อของช่วง 1MB
+    struct GrepHits {
+        int count;
+        size_t offset[8];
+        size_t line[8];
+        char path[64];
+    };
+    mountkit_grep_fn gr_collect = [](void *ctx, const char *path, MyFile *file, size_t offset, size_t line) {
+        GrepHits *h = (GrepHits*)ctx;
+        (void)file;
+        if (h->count < 8) {
+            h->offset[h->count] = offset;
+            h->line[h->count] = line;
+        }
+        snprintf(h->path, sizeof(h->path), "%s", path);
+        h->count++;
+        return 1;
+    };
+    MyFolder *gr = mkdir(&root, "root/gr");
+    int gr_ok = write(mk(gr, "a.log"), "alpha\nerror one\nok\nerror two\n");
+    gr_ok &= write(mk(mkdir(&root, "root/gr/sub"), "b.log"), "aaa");
+    assert(gr_ok);
+    GrepHits gr_hits;
+    memset(&gr_hits, 0, sizeof(gr_hits));
+    int gr_found = grep(gr, "error", MOUNTKIT_GREP_LINES, gr_collect, &gr_hits);
+    assert(gr_found == 2);
+    assert(gr_hits.offset[0] == 6 && gr_hits.line[0] == 2 && gr_hits.offset[1] == 19 && gr_hits.line[1] == 4);
+    assert(strcmp(gr_hits.path, "gr/a.log") == 0);
+    memset(&gr_hits, 0, sizeof(gr_hits));
+    gr_found = grep(gr, "aa", 0, gr_collect, &gr_hits);
+    assert(gr_found == 2 && gr_hits.offset[1] == 1 && gr_hits.line[1] == 0);
+    gr_found = grep(gr, "missing", 0, gr_collect, &gr_hits);
+    assert(gr_found == 0);
+    gr_found = grep(gr, "", 0, gr_collect, &gr_hits);
+    assert(gr_found == -1 && lastError() == MOUNTKIT_EINVAL);
+    // หลายช่วง: ข้อความที่เริ่มท้ายช่วงหนึ่งแล้วจบในช่วงถัดไปต้องถูกพบครั้งเดียว
+    size_t gr_size = 3 * (1u << 20) + 100;
+    uint8_t *gr_data = (uint8_t*)malloc(gr_size);
+    assert(gr_data);
+    for (size_t i = 0; i < gr_size; ++i) gr_data[i] = (i % 64 == 63) ? '\n' : 'x';
+    const size_t gr_at[4] = { 5, (1u << 20) - 3, 2 * (1u << 20) + 7, gr_size - 6 };
+    for (int i = 0; i < 4; ++i) memcpy(gr_data + gr_at[i], "NEEDLE", 6);
+    MyFile *gr_big = mk(mkdir(&root, "root/gr/big"), "big.log");
+    gr_ok = write(gr_big, gr_data, gr_size);
+    assert(gr_ok);
+    memset(&gr_hits, 0, sizeof(gr_hits));
+    gr_found = grep(gr, "NEEDLE", MOUNTKIT_GREP_LINES, gr_collect, &gr_hits);
+    assert(gr_found == 4);
+    for (int i = 0; i < 4; ++i) {
+        size_t gr_line = 1;
+        for (size_t k = 0; k < gr_at[i]; ++k) gr_line += gr_data[k] == '\n';
+        assert(gr_hits.offset[i] == gr_at[i] && gr_hits.line[i] == gr_line);
+    }
+    free(gr_data);
+    // FIRST: หนึ่งตำแหน่งต่อไฟล์, callback คืน 0 = หยุดทันที
+    memset(&gr_hits, 0, sizeof(gr_hits));
+    gr_found = grep(gr, "NEEDLE", MOUNTKIT_GREP_FIRST, gr_collect, &gr_hits);
+    assert(gr_found == 1 && gr_hits.offset[0] == 5);
+    mountkit_grep_fn gr_once = [](void *ctx, const char *path, MyFile *file, size_t offset, size_t line) {
+        (void)ctx; (void)path; (void)file; (void)offset; (void)line;
+        return 0;
+    };
+    gr_found = grep(gr, "NEEDLE", 0, gr_once, NULL);
+    assert(gr_found == 1);
+    // tree ที่ mount ไว้ถูกค้นด้วย และ lock ของไฟล์ถูกปล่อยหมด (write ได้ต่อ)
+    MyFolder *gr_other = NULL;
+    gr_ok = write(mk(mkdir(&gr_other, "other"), "o.log"), "an error here");
+    mkdir(&root, "root/gr/m");
+    gr_ok &= mount(root, "gr/m", gr_other);
+    assert(gr_ok);
+    memset(&gr_hits, 0, sizeof(gr_hits));
+    gr_found = grep(gr, "error", MOUNTKIT_GREP_FIRST, gr_collect, &gr_hits);
+    assert(gr_found == 2);
+    MyFolder *gr_unmounted = umount(root, "gr/m");
+    assert(gr_unmounted == gr_other);
+    removeFolder(gr_other);
+    gr_ok = write(gr_big, "done");
+    assert(gr_ok);
+    rmdir(&root, "root/gr");
+
+    // Test 31: path API - write/append/read/stat/rm ด้วย path เดียว, parents, และ error
+    uint8_t pa_buf[64];
+    int pa_ok = write_path(root, "root/pa/x/y.txt", "nope");
+    assert(!pa_ok && lastError() == MOUNTKIT_ENOENT);
+    pa_ok = write_path(root, "root/pa/x/y.txt", "hello", true);
+    pa_ok &= append_path(root, "pa/x/y.txt", " world");
+    pa_ok &= append_path(root, "pa/logs/app.log", "line1\n", true);
+    pa_ok &= append_path(root, "pa/logs/app.log", "line2\n");
+    assert(pa_ok);
+    int pa_n = read_path(root, "root/pa/x/y.txt", pa_buf, sizeof(pa_buf));
+    assert(pa_n == 11 && memcmp(pa_buf, "hello world", 11) == 0);
+    pa_n = read_path(root, "pa/x/y.txt", pa_buf, 5, 6);
+    assert(pa_n == 5 && memcmp(pa_buf, "world", 5) == 0);
+    pa_n = read_path(root, "pa/logs/app.log", pa_buf, sizeof(pa_buf));
+    assert(pa_n == 12);
+    MyFolder *pa_x = cd(root, "pa/x");
+    assert(pa_x && findFile(pa_x, "y.txt") && findFile(pa_x, "y.txt")->folder == pa_x);
+    MyDirEntry pa_st;
+    pa_ok = stat_path(root, "pa/x/y.txt", &pa_st);
+    assert(pa_ok && pa_st.type == MOUNTKIT_DT_FILE && pa_st.size == 11);
+    assert(strcmp(pa_st.name, "y.txt") == 0 && pa_st.capacity >= 11);
+    pa_ok = stat_path(root, "root/pa/x", &pa_st);
+    assert(pa_ok && pa_st.type == MOUNTKIT_DT_DIR && strcmp(pa_st.name, "x") == 0);
+    pa_ok = stat_path(root, "root", &pa_st);
+    assert(pa_ok && pa_st.type == MOUNTKIT_DT_DIR && strcmp(pa_st.name, "root") == 0);
+    pa_ok = stat_path(root, "pa/x/none", &pa_st);
+    assert(!pa_ok && lastError() == MOUNTKIT_ENOENT);
+    pa_n = read_path(root, "pa/none/y.txt", pa_buf, sizeof(pa_buf));
+    assert(!pa_n && lastError() == MOUNTKIT_ENOENT);
+    pa_ok = write_path(root, "pa/x/../y.txt", "z", true);
+    assert(!pa_ok && lastError() == MOUNTKIT_EINVAL);
+    pa_ok = write_path(root, "root", "z");
+    assert(!pa_ok && lastError() == MOUNTKIT_EINVAL);
+    // path ผ่าน mount point
+    MyFolder *pa_other = NULL;
+    mkdir(&pa_other, "other/sub");
+    mkdir(&root, "root/pa/m");
+    pa_ok = mount(root, "pa/m", pa_other);
+    pa_ok &= write_path(root, "pa/m/sub/in.txt", "mounted");
+    assert(pa_ok && cd(pa_other, "sub") && findFile(cd(pa_other, "sub"), "in.txt"));
+    MyFolder *pa_unmounted = umount(root, "pa/m");
+    assert(pa_unmounted == pa_other);
+    removeFolder(pa_other);
+    pa_ok = rm_path(root, "pa/x/y.txt");
+    assert(pa_ok);
+    pa_ok = rm_path(root, "pa/x/y.txt");
+    assert(!pa_ok && lastError() == MOUNTKIT_ENOENT);
+    pa_ok = stat_path(root, "pa/x/y.txt", &pa_st);
+    assert(!pa_ok);
+    MyUsage pa_u;
+    pa_ok = usage(cd(root, "pa"), &pa_u);
+    assert(pa_ok && pa_u.bytes == 12 && pa_u.files == 1);
+    rmdir(&root, "root/pa");
+
+    // Test 32: link - hard link ใช้ data ร่วมกัน, symlink ใน cd/path API (relative, absolute, "..", loop) และผลที่จำไว้
+    MyFolder *ln_a = mkdir(&root, "root/ln/a");
+    MyFolder *ln_b = mkdir(&root, "root/ln/b/c");
+    MyFile *ln_f = mk(ln_a, "f.txt");
+    int ln_ok = write(ln_f, "shared");
+    ln_ok &= ln(ln_a, "f.txt", ln_b, "g.txt");
+    assert(ln_ok);
+    ln_ok = ln(ln_a, "f.txt", ln_b, "g.txt");
+    assert(!ln_ok && lastError() == MOUNTKIT_EEXIST);
+    ln_ok = ln(ln_a, "none", ln_b, "h.txt");
+    assert(!ln_ok && lastError() == MOUNTKIT_ENOENT);
+    ln_ok = append(findFile(ln_b, "g.txt"), "!");
+    assert(ln_ok && ln_f->size == 7 && ln_f->links == 2);
+    MyUsage ln_u;
+    ln_ok = usage(ln_b, &ln_u);
+    assert(ln_ok && ln_u.bytes == 0 && ln_u.files == 1);
+    ln_ok = usage(ln_a, &ln_u);
+    assert(ln_ok && ln_u.bytes == 7);
+    ln_ok = rm(ln_a, "f.txt");
+    int ln_n = read_path(root, "ln/b/c/g.txt", pa_buf, sizeof(pa_buf));
+    assert(ln_ok && ln_n == 7 && memcmp(pa_buf, "shared!", 7) == 0);
+    ln_ok = usage(ln_a, &ln_u);
+    assert(ln_ok && ln_u.bytes == 0 && ln_u.files == 0);
+    ln_ok = rm(ln_b, "g.txt");
+    assert(ln_ok && link_names == 0);
+    // ไฟล์ที่มีชื่ออื่นอยู่นอก subtree ที่ถูก rmdir ยังใช้ได้และไม่ถูกนับใน folder ที่ถูกคืน
+    MyFile *ln_d = mk(mkdir(&root, "root/ln/d"), "d.txt");
+    ln_ok = write(ln_d, "dd") && ln(cd(root, "ln/d"), "d.txt", ln_b, "d2.txt");
+    assert(ln_ok);
+    rmdir(&root, "root/ln/d");
+    ln_ok = write(findFile(ln_b, "d2.txt"), "ddd");
+    assert(ln_d->folder == NULL && ln_ok && ln_d->links == 1);
+    ln_ok = rm(ln_b, "d2.txt");
+    assert(ln_ok);
+    // symlink: relative (จาก folder ของ symlink), absolute (จาก root) และ ".." ตาม folder จริง
+    ln_ok = symlink(ln_a, "to_c", "../b/c") && symlink(root, "abs", "/ln/b") && symlink(ln_b, "up", "..");
+    assert(ln_ok);
+    ln_ok = symlink(ln_a, "to_c", "x");
+    assert(!ln_ok && lastError() == MOUNTKIT_EEXIST);
+    assert(cd(root, "ln/a/to_c") == ln_b && cd(root, "abs/c") == ln_b && cd(root, "ln/b/c/up") == cd(root, "ln/b"));
+    assert(cd(root, "ln/a/to_c/up/..") == cd(root, "ln") && cd(root, "ln/a/to_c/..") == cd(root, "ln/b"));
+    char ln_target[8];
+    ln_n = readlink(ln_a, "to_c", ln_target, sizeof(ln_target));
+    assert(ln_n == 6 && strcmp(ln_target, "../b/c") == 0);
+    ln_n = readlink(ln_a, "to_c", ln_target, 4);
+    assert(ln_n == 6 && strcmp(ln_target, "../") == 0);
+    ln_n = readlink(ln_a, "none", ln_target, sizeof(ln_target));
+    assert(ln_n == -1 && lastError() == MOUNTKIT_ENOENT);
+    ln_ok = symlink(ln_a, "self", "self/x");
+    assert(ln_ok && !cd(root, "ln/a/self") && lastError() == MOUNTKIT_ELOOP);
+    // path API ตาม symlink ทั้งกลางทางและที่ leaf (write ผ่าน symlink ที่ dangling สร้างไฟล์ปลายทาง)
+    ln_ok = write_path(root, "ln/a/to_c/p.txt", "via");
+    assert(ln_ok && findFile(ln_b, "p.txt"));
+    ln_ok = symlink(ln_a, "p", "to_c/p.txt") && symlink(ln_a, "q", "/ln/b/c/q.txt");
+    assert(ln_ok);
+    ln_n = read_path(root, "ln/a/p", pa_buf, sizeof(pa_buf));
+    ln_ok = write_path(root, "ln/a/q", "new");
+    assert(ln_n == 3 && ln_ok && findFile(ln_b, "q.txt"));
+    ln_ok = stat_path(root, "ln/a/p", &pa_st);
+    assert(ln_ok && pa_st.type == MOUNTKIT_DT_FILE && pa_st.size == 3);
+    ln_ok = stat_path(root, "ln/a/to_c", &pa_st);
+    assert(ln_ok && pa_st.type == MOUNTKIT_DT_DIR);
+    ln_ok = write(findFile(ln_a, "p"), "x");
+    assert(!ln_ok && lastError() == MOUNTKIT_EINVAL);
+    ln_ok = write_path(root, "ln/a/self", "x");
+    assert(!ln_ok && lastError() == MOUNTKIT_ELOOP);
+    ln_ok = rm_path(root, "ln/a/p");
+    assert(ln_ok && findFile(ln_b, "p.txt"));
+    // ผลที่จำไว้ถูกใช้ซ้ำ (lock-free read mode - ไม่มี lock ให้ถือระหว่างข้าม) และหมดอายุเมื่อ tree เปลี่ยน
+    set_lockfree_reads(true);
+    assert(cd(root, "ln/a/to_c") == ln_b && findFile(ln_a, "to_c")->cache);
+    assert(cd(root, "ln/a/to_c/up") == cd(root, "ln/b") && cd(root, "ln/a/to_c/..") == cd(root, "ln/b"));
+    rmdir(&root, "root/ln/b/c");
+    assert(!cd(root, "ln/a/to_c") && lastError() == MOUNTKIT_ENOENT && !cd(root, "abs/c"));
+    ln_b = mkdir(&root, "root/ln/b/c");
+    assert(cd(root, "ln/a/to_c") == ln_b);
+    set_lockfree_reads(false);
+    // readdir บอกชนิดของ symlink
+    MyCursor ln_cur;
+    MyDirEntry ln_e[8];
+    cursor_init(&ln_cur);
+    ln_n = readdir(ln_a, &ln_cur, ln_e, 8);
+    int ln_links = 0;
+    for (int i = 0; i < ln_n; ++i) ln_links += ln_e[i].type == MOUNTKIT_DT_LINK;
+    assert(ln_n == 3 && ln_links == 3);
+    // tar: target ที่ยาวเกิน linkname ของ ustar (100 bytes) ไปกับ pax linkpath
+    char ln_long[160], ln_back[192];
+    snprintf(ln_long, sizeof(ln_long), "../b/c/%0140d", 7);
+    ln_ok = symlink(ln_a, "long", ln_long);
+    TestStream ln_stream = { NULL, 0, 0, 0 };
+    ln_ok &= tar_export(ln_a, testStreamSink, &ln_stream);
+    MyFolder *ln_restore = mkdir(&root, "root/ln/restore");
+    ln_ok &= tar_import(ln_restore, testStreamSource, &ln_stream);
+    assert(ln_ok);
+    free(ln_stream.data);
+    ln_n = readlink(ln_restore, "long", ln_back, sizeof(ln_back));
+    assert(ln_n == 147 && strcmp(ln_back, ln_long) == 0);
+    ln_n = readlink(ln_restore, "to_c", ln_back, sizeof(ln_back));
+    assert(ln_n == 6 && strcmp(ln_back, "../b/c") == 0);
+    rm(root, "abs");
+    rmdir(&root, "root/ln");
+
+    // Test 33: metadata - ino ไม่ซ้ำ, mtime/ctime ตาม write/append/mk/mv/rm/ln/chmod และ hard link ใช้ของไฟล์จริง
+    set_clock(testClock);
+    MyFolder *md_a = mkdir(&root, "root/meta/a");
+    MyFolder *md_b = mkdir(&root, "root/meta/b");
+    MyStat md_st, md_dir, md_prev;
+    MyFile *md_f = mk(md_a, "f.txt");
+    int md_ok = stat(md_f, &md_st);
+    assert(md_ok && md_st.type == MOUNTKIT_DT_FILE && md_st.mode == MOUNTKIT_MODE_FILE);
+    assert(md_st.links == 1 && md_st.size == 0 && md_st.ino != 0 && md_st.mtime == md_st.ctime);
+    md_ok = stat(md_a, &md_dir);
+    assert(md_ok && md_dir.type == MOUNTKIT_DT_DIR && md_dir.mode == MOUNTKIT_MODE_DIR);
+    assert(md_dir.ino != md_st.ino && md_dir.mtime > md_st.mtime); // mk แก้รายการลูกของ folder
+    md_prev = md_st;
+    md_ok = write(md_f, "meta") && stat(md_f, &md_st);
+    assert(md_ok && md_st.size == 4 && md_st.ino == md_prev.ino);
+    assert(md_st.mtime > md_prev.mtime && md_st.ctime == md_st.mtime);
+    md_prev = md_st;
+    md_ok = append(md_f, "!") && stat(md_f, &md_st);
+    assert(md_ok && md_st.size == 5 && md_st.mtime > md_prev.mtime);
+    md_prev = md_st;
+    md_ok = chmod(md_f, 0100600) && stat(md_f, &md_st);
+    assert(md_ok && md_st.mode == 0600);
+    assert(md_st.mtime == md_prev.mtime && md_st.ctime > md_prev.ctime);
+    // hard link: ทุกชื่อเห็น ino และเวลาเดียวกัน, ln/rm เปลี่ยนแค่ ctime ของไฟล์
+    md_prev = md_st;
+    md_ok = ln(md_a, "f.txt", md_b, "g.txt") && stat(findFile(md_b, "g.txt"), &md_st);
+    assert(md_ok);
+    assert(md_st.ino == md_prev.ino && md_st.links == 2 && md_st.mtime == md_prev.mtime && md_st.ctime > md_prev.ctime);
+    // mv: ctime ของไฟล์ และ mtime ของทั้งสอง folder
+    stat(md_a, &md_dir);
+    md_prev = md_st;
+    md_ok = mv(md_a, "f.txt", md_b) && stat(md_f, &md_st);
+    assert(md_ok && md_st.ino == md_prev.ino && md_st.mtime == md_prev.mtime);
+    assert(md_st.ctime > md_prev.ctime);
+    md_ok = stat(md_a, &md_prev);
+    assert(md_ok && md_prev.mtime > md_dir.mtime);
+    md_ok = stat(md_b, &md_dir);
+    assert(md_ok && md_dir.mtime > md_st.ctime);
+    md_prev = md_st;
+    md_ok = rm(md_b, "g.txt") && stat(md_f, &md_st);
+    assert(md_ok && md_st.links == 1 && md_st.ctime > md_prev.ctime);
+    md_ok = stat(md_b, &md_dir);
+    assert(md_ok && md_dir.mtime > md_prev.ctime);
+    // stat_path: metadata ตาม path (mount point = tree ที่ mount ไว้), cp คง mode แต่ได้ ino ใหม่
+    MyDirEntry md_e;
+    md_ok = stat_path(root, "meta/b/f.txt", &md_e, &md_prev);
+    assert(md_ok && md_prev.ino == md_st.ino && md_e.size == 5);
+    md_ok = stat_path(root, "meta/b", NULL, &md_dir);
+    assert(md_ok && md_dir.type == MOUNTKIT_DT_DIR);
+    md_ok = cp(md_b, "f.txt", md_a) && stat(findFile(md_a, "f.txt"), &md_st);
+    assert(md_ok);
+    assert(md_st.ino != md_prev.ino && md_st.mode == 0600 && md_st.ctime > md_prev.ctime);
+    md_ok = symlink(md_a, "s", "../b") && stat(findFile(md_a, "s"), &md_st);
+    assert(md_ok && md_st.type == MOUNTKIT_DT_LINK);
+    assert(md_st.mode == MOUNTKIT_MODE_LINK && md_st.size == 4);
+    assert(md_st.ctime > 0xFFFFFFFFull && md_st.ctime > md_prev.ctime); // ข้าม 2^32 แล้วยังเรียงถูก ไม่ wrap
+    set_clock(NULL);
+    rmdir(&root, "root/meta");
+
+    // Test 34: quota - การโตทุกทางถูกตรวจกับยอดของ subtree และ ancestor, fail ทันทีโดยไม่แก้ tree พร้อมรายงาน
+    MyFolder *q_top = mkdir(&root, "root/quota");
+    MyFolder *q_tmp = mkdir(&root, "root/quota/tmp");
+    MyFolder *q_out = mkdir(&root, "root/quota/out");
+    MyQuotaReport q_r;
+    int q_ok = quota_get(q_tmp, &q_r);
+    MyFile *q_x = mk(q_out, "x");
+    assert(!q_ok && q_r.used.dirs == 1 && q_x);
+    q_ok = quota_set(q_tmp, 3 * 4096, 4) && quota_get(q_tmp, &q_r);
+    assert(q_ok && q_r.limit.bytes == 3 * 4096 && q_r.limit.nodes == 4);
+    MyFile *q_f = mk(q_tmp, "a.log");
+    uint8_t q_buf[8192];
+    memset(q_buf, 'q', sizeof(q_buf));
+    q_ok = write(q_f, q_buf, sizeof(q_buf));
+    assert(q_ok && q_f->capacity == 8192);
+    // ต้องขยายเป็น 16384 แต่ quota เหลือ 4096 - ข้อมูลและ buffer เดิมไม่ถูกแตะ
+    q_ok = append(q_f, q_buf, 1);
+    assert(!q_ok && lastError() == MOUNTKIT_EDQUOT && q_f->size == 8192 && q_f->capacity == 8192);
+    q_ok = append_shared(q_f, q_buf, 1);
+    assert(!q_ok && lastError() == MOUNTKIT_EDQUOT && q_f->size == 8192);
+    q_ok = quota_last(&q_r);
+    assert(q_ok && strcmp(q_r.name, "tmp") == 0 && q_r.bytes == 8192 && q_r.used.capacity == 8192);
+    MyFile *q_node = mk(q_tmp, "b");
+    assert(q_node);
+    q_node = mk(q_tmp, "c");
+    assert(!q_node && lastError() == MOUNTKIT_EDQUOT && !findFile(q_tmp, "c"));
+    q_ok = write_path(root, "quota/tmp/c", "x");
+    assert(!q_ok && lastError() == MOUNTKIT_EDQUOT);
+    MyFolder *q_dir = mkdir(&root, "root/quota/tmp/d");
+    assert(q_dir);
+    q_dir = mkdir(&root, "root/quota/tmp/e");
+    assert(!q_dir && lastError() == MOUNTKIT_EDQUOT);
+    q_ok = quota_last(&q_r);
+    assert(q_ok && q_r.nodes == 1 && q_r.used.files + q_r.used.dirs == 4);
+    q_ok = ln(q_out, "x", q_tmp, "l");
+    assert(!q_ok && lastError() == MOUNTKIT_EDQUOT);
+    q_ok = cp(q_out, "x", q_tmp);
+    assert(!q_ok && lastError() == MOUNTKIT_EDQUOT);
+    q_ok = mv(q_out, "x", q_tmp);
+    assert(!q_ok && lastError() == MOUNTKIT_EDQUOT && findFile(q_out, "x"));
+    // quota ของ ancestor: mv ภายใต้ quota เดียวกันไม่ถูกนับซ้ำ, batch ถูกตรวจทั้งชุดก่อน apply
+    q_ok = quota_set(q_top, 0, 7);
+    q_node = mk(q_out, "y");
+    assert(q_ok && !q_node);
+    q_ok = quota_last(&q_r);
+    assert(q_ok && strcmp(q_r.name, "quota") == 0);
+    q_ok = mv(q_tmp, "b", q_out);
+    assert(q_ok && findFile(q_out, "b"));
+    MyBatch q_batch;
+    batch_init(&q_batch);
+    q_ok = batch_mk(&q_batch, "root/quota/out/z") && batch_append(&q_batch, "root/quota/out/x", q_buf, 1);
+    assert(q_ok);
+    q_ok = batch_commit(&q_batch, &root);
+    assert(!q_ok && lastError() == MOUNTKIT_EDQUOT && !findFile(q_out, "z"));
+    q_ok = quota_set(q_top, 0, 0);
+    assert(q_ok);
+    q_ok = quota_get(q_top, &q_r);
+    assert(!q_ok);
+    q_ok = batch_mk(&q_batch, "root/quota/out/z") && batch_commit(&q_batch, &root);
+    assert(q_ok && findFile(q_out, "z"));
+    batch_release(&q_batch);
+    q_ok = quota_set(q_tmp, 0, 0) && append(q_f, q_buf, 1);
+    assert(q_ok && q_f->capacity == 16384);
+    // append_shared หลาย producer: quota พอให้ขยายได้ครั้งเดียว - ทุกช่วงที่จองได้ผ่านการตรวจ จึงไม่มีการขยายเกิน quota
+    MyFile *q_mp = mk(q_out, "mp.log");
+    MyUsage q_u;
+    q_ok = q_mp && write(q_mp, q_buf, 4096) && usage(q_out, &q_u) && quota_set(q_out, q_u.capacity + 4096, 0);
+    assert(q_ok && q_mp->capacity == 4096);
+    set_concurrent(true);
+    std::atomic<int> q_appended(0);
+    std::thread q_producers[4];
+    for (int t = 0; t < 4; ++t) {
+        q_producers[t] = std::thread([this, q_mp, &q_buf, &q_appended]() {
+            for (int i = 0; i < 100; ++i) {
+                if (append_shared(q_mp, q_buf, 64)) q_appended++;
+            }
+        });
+    }
+    for (int t = 0; t < 4; ++t) q_producers[t].join();
+    set_concurrent(false);
+    assert(q_appended == 64 && q_mp->capacity == 8192 && q_mp->size == 8192 && q_mp->reserved == 8192);
+    rmdir(&root, "root/quota");
+
+    // Test 35: removeFolder ทั้งหมด
     removeFolder(root);
 
     printf("All tests passed!\n");
@@ -834,6 +3012,7 @@ void mountkit::auto_test_and_report() {
     int critical_failures = 0;
     
     MyFolder *test_root = NULL;
+    clearError(); // Test 1.1 หยุดเมื่อ thread นี้มี operation ที่ fail
     
     // =================================================================
     // TEST CATEGORY 1: FOLDER OPERATIONS STRESS TEST
@@ -863,7 +3042,7 @@ void mountkit::auto_test_and_report() {
         }
         
         // ตรวจสอบ error flag
-        if (CHECK_ERROR_FLAG()) {
+        if (hasError()) {
             printf("[ERROR] Error flag detected - stopping test\n");
             break;
         }
@@ -1217,7 +3396,7 @@ void mountkit::auto_test_and_report() {
 // เพิ่มฟังก์ชัน embedded test ด้วย ASCII characters
 #ifdef EMBEDDED_BUILD
 void mountkit::embedded_test() {
-    CLEAR_ERROR_FLAG();
+    clearError();
     
     printf("=== EMBEDDED SYSTEM TEST START ===\n");
     
@@ -1295,59 +3474,43 @@ void mountkit::embedded_test() {
     printf("=== EMBEDDED TEST COMPLETE ===\n");
 }
 
+#endif
+
+void mountkit::setError(int code) {
+    last_error = code;
+}
+
+int mountkit::lastError() {
+    return last_error;
+}
+
+const char* mountkit::errorString(int code) {
+    switch (code) {
+        case MOUNTKIT_OK:     return "no error";
+        case MOUNTKIT_EINVAL: return "invalid parameter";
+        case MOUNTKIT_ENOMEM: return "out of memory";
+        case MOUNTKIT_ENOENT: return "no such file or folder";
+        case MOUNTKIT_EEXIST: return "name already exists";
+        case MOUNTKIT_ENOSPC: return "capacity exceeded";
+        case MOUNTKIT_EBUSY:  return "mount point in use";
+        case MOUNTKIT_ELOOP:  return "mount would create a loop";
+        case MOUNTKIT_EIO:    return "stream or archive error";
+        case MOUNTKIT_EDQUOT: return "subtree quota exceeded";
+        default:              return "unknown error";
+    }
+}
+
 bool mountkit::hasError() {
-    return CHECK_ERROR_FLAG();
+    return last_error != MOUNTKIT_OK;
 }
 
 void mountkit::clearError() {
-    CLEAR_ERROR_FLAG();
+    last_error = MOUNTKIT_OK;
 }
-#endif
 
-// เพิ่มฟังก์ชัน calculateFolderCapacity ที่ขาดหาย
+// calculateFolderCapacity: ชื่อ + MyFolder ต่อ folder, capacity + MyFile + ชื่อ ต่อไฟล์ - จากยอดรวมที่เก็บไว้
 size_t mountkit::calculateFolderCapacity(MyFolder *folder, bool include_subdirs) {
-    if (!folder) return 0;
-    
-    size_t total_size = 0;
-    
-    // 1. Base size = ความยาวของชื่อ folder
-    size_t base_size = 0;
-    if (folder->data) {
-        base_size = strlen(folder->data);
-    }
-    
-    // 2. Path overhead = sizeof(MyFolder) structure ต่อ folder
-    size_t path_overhead = sizeof(MyFolder);
-    
-    // 3. File metadata = รวม File.capacity ของไฟล์ทั้งหมด
-    size_t file_capacity_total = 0;
-    size_t file_metadata_total = 0;
-    
-    MyFile *current_file = folder->files;
-    while (current_file) {
-        // ใช้ capacity ของไฟล์ตามที่กำหนดในโจทย์
-        file_capacity_total += current_file->capacity;
-        
-        // metadata ของ file structure เอง
-        file_metadata_total += sizeof(MyFile);
-        if (current_file->name) {
-            file_metadata_total += strlen((char*)current_file->name) + 1;
-        }
-        
-        current_file = current_file->next;
-    }
-    
-    // รวมขนาดของ folder ปัจจุบัน
-    total_size = base_size + path_overhead + file_capacity_total + file_metadata_total;
-    
-    // 4. ถ้ารวม subdirectories
-    if (include_subdirs) {
-        MyFolder *current_subdir = folder->subdir;
-        while (current_subdir) {
-            total_size += calculateFolderCapacity(current_subdir, true);
-            current_subdir = current_subdir->dir;
-        }
-    }
-    
-    return total_size;
+    MyUsage u;
+    if (!folder || !usage(folder, &u, include_subdirs)) return 0;
+    return u.dirs * sizeof(MyFolder) + u.files * sizeof(MyFile) + u.capacity + u.names;
 }
\ No newline at end of file
@@ -9,11 +9,40 @@
 #include <stdint.h>
 #include <string.h>
 
+#ifndef EMBEDDED_BUILD
+    #include <future>
+#endif
+
 #define mountkit_DEBUG 
 
 // Forward declarations
 typedef struct MyFile MyFile;
 typedef struct MyFolder MyFolder;
+typedef struct MyRetired MyRetired; // node/buffer ที่รอ grace period (ภายใน MountkitRcu.cpp)
+typedef struct MyPool MyPool;       // work-stealing pool ของ traversal แบบขนาน (ภายใน MountkitParallel.cpp)
+typedef struct MyWalkTask MyWalkTask;
+typedef struct MyAsync MyAsync;     // executor และ completion queue ของ async_* (ภายใน MountkitAsync.cpp)
+typedef struct MyBatchOp MyBatchOp; // operation ที่รอ batch_commit (ภายใน MountkitBatch.cpp)
+typedef struct MyBatchCommit MyBatchCommit; // state ระหว่าง batch_commit (ภายใน MountkitBatch.cpp)
+typedef struct MyShards MyShards;   // namespace ที่แบ่งไปหลาย mountkit instance (ภายใน MountkitShard.cpp)
+typedef struct MyWatch MyWatch;     // subscription และ event queue ของ watch (ภายใน MountkitWatch.cpp)
+typedef struct MyIndex MyIndex;     // ordered index ของชื่อลูกใน folder (ภายใน MountkitIndex.cpp)
+typedef struct MyLinkCache MyLinkCache; // ผล resolve ของ symlink ที่จำไว้ (ภายใน MountkitLink.cpp)
+
+/**
+ * @brief metadata ของ node (inode) - 32 bytes อยู่ใน MyFile/MyFolder เอง อ่านได้โดยไม่แตะ data
+ * 
+ * เวลาเป็น tick แบบ monotonic 64 bit (ms จาก clock แบบ coarse หรือจาก set_clock) - ไม่วนกลับ
+ * ใช้ตรวจว่าเปลี่ยนหรือไม่และเรียงลำดับการแก้ ไม่ใช่เวลาจริง
+ * hard link: ใช้ metadata ของไฟล์จริง (node ของชื่อที่ ln สร้างมี ino เป็น 0)
+ * มีเฉพาะ desktop build - embedded ไม่เก็บ metadata เพื่อให้ node เล็ก
+ */
+typedef struct MyMeta {
+    uint64_t ino;       // หมายเลข node ไม่ซ้ำตลอดอายุของ mountkit instance (เริ่มที่ 1)
+    uint64_t mtime;     // tick ที่ data (ไฟล์) หรือรายการลูก (folder) เปลี่ยนล่าสุด
+    uint64_t ctime;     // tick ที่ node เปลี่ยนล่าสุด (data, ชื่อ, ที่อยู่, จำนวนชื่อ หรือ mode)
+    uint16_t mode;      // permission bits แบบ POSIX (07777) - เก็บและ export ไว้เฉย ๆ ไม่ได้ใช้ตรวจสิทธิ์
+} MyMeta;
 
 /**
  * @brief โครงสร้างไฟล์ในระบบ - จัดเก็บข้อมูลไฟล์และ metadata
@@ -24,8 +53,119 @@ typedef struct MyFile {
     uint8_t *name;      // ชื่อไฟล์ (null-terminated string)
     uint8_t *data;      // ข้อมูลของไฟล์ (binary data)
     struct MyFile *next; // pointer ไปยังไฟล์ถัดไปใน directory เดียวกัน
+    uint32_t crc32c;    // CRC32C ของ data (ใช้ได้เมื่อ crc_state == MOUNTKIT_CRC_VALID)
+    uint8_t crc_state;  // สถานะ checksum: MOUNTKIT_CRC_OFF / VALID / STALE
+    uint8_t alloc_flags; // ส่วนไหนอยู่ใน compaction arena (MOUNTKIT_ALLOC_*)
+    uint32_t lock;      // reader-writer lock ของ data (ใช้เมื่อเปิด concurrent mode)
+    uint32_t seq;       // เลขรุ่นของคู่ (data, size) สำหรับ reader แบบ lock-free (เลขคี่ = กำลังเปลี่ยน)
+    size_t reserved;    // bytes ที่ append_shared จองไปแล้ว (>= size, เท่ากับ size เมื่อไม่มี producer ค้าง)
+    struct MyFolder *folder; // folder ที่ไฟล์ link อยู่ (NULL = ยังไม่ link หรือถูกลบแล้ว) - แก้ภายใต้ lock ของไฟล์
+    uint8_t kind;       // MOUNTKIT_DT_FILE หรือ MOUNTKIT_DT_LINK (symlink: data คือ path ปลายทาง ซึ่งแก้ไม่ได้)
+    uint32_t links;     // จำนวนชื่อที่ชี้ไฟล์นี้ (ln เพิ่ม, rm ลด) - คืนหน่วยความจำเมื่อชื่อสุดท้ายถูกลบ
+    struct MyFile *link; // hard link: ไฟล์จริงที่ชื่อนี้ชี้ (NULL = node นี้คือไฟล์จริง) - ไม่เปลี่ยนหลังสร้าง
+    MyLinkCache *cache; // symlink: folder ปลายทางที่ resolve ไว้ล่าสุด
+#ifndef EMBEDDED_BUILD
+    MyMeta meta;        // ino, เวลา และ mode
+#endif
 } MyFile;
 
+// สถานะ checksum ของไฟล์
+#define MOUNTKIT_CRC_OFF   0 // ไม่ได้ติดตาม checksum (ค่าเริ่มต้นของ mk)
+#define MOUNTKIT_CRC_VALID 1 // crc32c ตรงกับ data ปัจจุบัน
+#define MOUNTKIT_CRC_STALE 2 // data ถูก write แล้ว ต้องคำนวณใหม่ตอนใช้งาน
+
+// ที่มาของหน่วยความจำของ node (ตั้งโดย compact, ค่า 0 = malloc ปกติ)
+#define MOUNTKIT_ALLOC_NODE 0x01 // struct อยู่ใน arena
+#define MOUNTKIT_ALLOC_NAME 0x02 // ชื่ออยู่ใน arena
+#define MOUNTKIT_ALLOC_DATA 0x04 // data อยู่ใน arena (ขยายเมื่อไรจะถูกย้ายออกไป heap)
+
+// ชนิดของหน่วยความจำที่รอ grace period ใน lock-free read mode
+#define MOUNTKIT_RETIRE_FILE       0 // MyFile ที่ถูก rm
+#define MOUNTKIT_RETIRE_FOLDER     1 // MyFolder ที่ถูก rmdir (ทั้ง subtree)
+#define MOUNTKIT_RETIRE_DATA       2 // data buffer เดิม (malloc)
+#define MOUNTKIT_RETIRE_DATA_ARENA 3 // data buffer เดิม (compaction arena)
+
+// traversal ที่แบ่งงานให้ work-stealing pool ได้
+#define MOUNTKIT_WALK_REMOVE   0 // removeFolder
+#define MOUNTKIT_WALK_CAPACITY 1 // calculateFolderCapacity (include_subdirs)
+#define MOUNTKIT_WALK_PRINT    2 // PrintAllPath
+
+// ลำดับการเดินของ iter_begin (รวมกันด้วย |)
+#define MOUNTKIT_ITER_PRE      0x01 // visit folder ก่อนลูก
+#define MOUNTKIT_ITER_POST     0x02 // visit folder อีกครั้งหลังลูกครบ (depth-first เท่านั้น)
+#define MOUNTKIT_ITER_FILES    0x04 // visit ไฟล์ของแต่ละ folder (หลัง pre-visit ของ folder ก่อน subfolder)
+#define MOUNTKIT_ITER_BFS      0x08 // breadth-first (ค่าเริ่มต้นคือ depth-first)
+#define MOUNTKIT_ITER_MOUNTS   0x10 // เข้าไปใน tree ที่ mount ไว้แทน folder ของ mount point
+#define MOUNTKIT_ITER_SIBLINGS 0x20 // sibling ของ node เริ่มต้น (ตาม dir) เป็นจุดเริ่มด้วย
+
+#define MOUNTKIT_ITER_INLINE 16 // ระดับที่เก็บใน MyIter เอง (ลึกกว่านี้จึงจอง heap)
+
+#define MOUNTKIT_NAME_MAX 256 // ชื่อที่ MyCursor และ MyDirEntry เก็บได้เต็ม (เท่ากับ buffer ของ path)
+
+// ชนิดของ MyDirEntry (ตรงกับ MyCursor::last_kind)
+#define MOUNTKIT_DT_DIR  1
+#define MOUNTKIT_DT_FILE 2
+#define MOUNTKIT_DT_LINK 3 // symlink (MyDirEntry เท่านั้น - cursor ยังนับเป็นไฟล์)
+
+// mode เริ่มต้นของ node ใหม่
+#define MOUNTKIT_MODE_FILE 0644
+#define MOUNTKIT_MODE_DIR  0755
+#define MOUNTKIT_MODE_LINK 0777
+
+#define MOUNTKIT_SYMLOOP_MAX 40 // symlink ที่ตามได้ต่อการเดิน path หนึ่งครั้ง (เกินนี้ถือว่า loop)
+
+// ตัวเลือกของ grep (รวมกันด้วย |)
+#define MOUNTKIT_GREP_LINES 0x01 // คำนวณเลขบรรทัดของแต่ละตำแหน่ง
+#define MOUNTKIT_GREP_FIRST 0x02 // เฉพาะตำแหน่งแรกของแต่ละไฟล์ (หาว่าไฟล์ไหนมีข้อความนี้)
+
+// error code ของ operation ที่ fail ล่าสุดใน thread ที่เรียก (lastError)
+#define MOUNTKIT_OK     0
+#define MOUNTKIT_EINVAL 1 // parameter ไม่ถูกต้อง
+#define MOUNTKIT_ENOMEM 2 // memory ไม่พอ
+#define MOUNTKIT_ENOENT 3 // ไม่พบไฟล์หรือ folder
+#define MOUNTKIT_EEXIST 4 // มีชื่อนี้อยู่แล้ว
+#define MOUNTKIT_ENOSPC 5 // เกิน capacity ที่ขยายไม่ได้ (embedded)
+#define MOUNTKIT_EBUSY  6 // mount point ที่ยังใช้งานอยู่
+#define MOUNTKIT_ELOOP  7 // mount ที่จะทำให้เกิด loop หรือ symlink ที่ตามเกิน MOUNTKIT_SYMLOOP_MAX
+#define MOUNTKIT_EIO    8 // stream หรือ format ของ tar ผิดพลาด
+#define MOUNTKIT_EDQUOT 9 // เกิน quota ของ subtree (รายละเอียดจาก quota_last)
+
+// ชนิดของ event ของ watch (ใช้เป็น mask ตอน watch และเป็น MyWatchEvent.mask)
+#define MOUNTKIT_WATCH_CREATE      0x0001 // mkdir, mk, cp, batch สร้าง child ใน folder
+#define MOUNTKIT_WATCH_MODIFY      0x0002 // write, append ของไฟล์
+#define MOUNTKIT_WATCH_DELETE      0x0004 // rm, rmdir ลบ child ใน folder
+#define MOUNTKIT_WATCH_MOVED_FROM  0x0008 // mv ย้ายไฟล์ออกจาก folder
+#define MOUNTKIT_WATCH_MOVED_TO    0x0010 // mv ย้ายไฟล์เข้า folder
+#define MOUNTKIT_WATCH_DELETE_SELF 0x0020 // node ที่ watch ถูกลบ - event สุดท้ายของ watch (ส่งเสมอ ไม่ขึ้นกับ mask)
+#define MOUNTKIT_WATCH_ALL         0x003f
+#define MOUNTKIT_WATCH_ISDIR       0x4000 // child เป็น folder
+#define MOUNTKIT_WATCH_OVERFLOW    0x8000 // queue เต็ม มี event หายไปก่อนหน้านี้ (ส่งเสมอ ไม่ขึ้นกับ mask)
+
+/**
+ * @brief ยอดรวมการใช้พื้นที่ของ subtree (รวม folder เอง) - ถูกแก้ตามทุก operation จึงอ่านได้โดยไม่ต้องเดิน tree
+ * 
+ * ไม่รวม tree ที่ mount ไว้ข้างใน (mounts บอกว่ามีหรือไม่) - usage() รวมให้เองโดยเดินเฉพาะ folder ที่มี mount อยู่ข้างใต้
+ */
+typedef struct MyUsage {
+    size_t bytes;       // รวม size ของไฟล์
+    size_t capacity;    // รวม capacity ของไฟล์
+    size_t files;       // จำนวนไฟล์
+    size_t dirs;        // จำนวน folder (รวมตัวเอง)
+    size_t names;       // bytes ของชื่อ (folder: strlen, ไฟล์: strlen + 1)
+    size_t mounts;      // จำนวน mount point (รวมตัวเอง)
+} MyUsage;
+
+/**
+ * @brief ขีดจำกัดของ subtree (quota_set) - ตรวจกับยอดใน MyUsage ก่อนทุก operation ที่ทำให้ subtree โต
+ * 
+ * bytes เทียบกับ MyUsage::capacity (buffer ที่จองไว้จริง ไม่ใช่ size) และ nodes เทียบกับ files + dirs
+ * ไม่รวม tree ที่ mount ไว้ข้างในเหมือนยอดของ MyUsage
+ */
+typedef struct MyQuota {
+    size_t bytes;       // capacity รวมสูงสุด (0 = ไม่จำกัด)
+    size_t nodes;       // จำนวนไฟล์ + folder สูงสุด รวม folder เอง (0 = ไม่จำกัด)
+} MyQuota;
+
 /**
  * @brief โครงสร้างโฟลเดอร์ในระบบ - จัดเก็บ directories และไฟล์
  */
@@ -34,8 +174,202 @@ typedef struct MyFolder {
     MyFile *files;          // linked list ของไฟล์ทั้งหมดใน directory นี้
     struct MyFolder *subdir; // pointer ไปยัง subdirectory แรก
     struct MyFolder *dir;    // pointer ไปยัง sibling directory ถัดไป
+    struct MyFolder *mounted; // root ของ tree ที่ mount ทับ folder นี้ (NULL ถ้าไม่ใช่ mount point)
+    uint8_t alloc_flags;     // ส่วนไหนอยู่ใน compaction arena (MOUNTKIT_ALLOC_*)
+    uint32_t lock;           // reader-writer lock ของ files และ subdir chain (ใช้เมื่อเปิด concurrent mode)
+    MyIndex *index;          // ลูกทั้งหมดเรียงตามชื่อ (NULL ถ้าไม่ได้ index_enable) - ใช้ lock เดียวกับ chain
+    struct MyFolder *parent; // folder ที่ subdir chain มี folder นี้อยู่ (NULL = root chain หรือถูกลบแล้ว)
+    MyUsage usage;           // ยอดรวมของ subtree - ส่วนต่างถูกส่งขึ้นไปตาม parent ทุกครั้งที่ขนาดหรือโครงสร้างเปลี่ยน
+#ifndef EMBEDDED_BUILD
+    MyMeta meta;             // ino, เวลา และ mode (mtime เปลี่ยนเมื่อมีลูกเข้า/ออก)
+#endif
+    MyQuota quota;           // ขีดจำกัดของ subtree (ทั้งคู่เป็น 0 = ไม่มี quota)
 } MyFolder;
 
+/**
+ * @brief overlay (union) mount - upper tree ส่วนตัวซ้อนบน lower tree ที่แชร์กัน
+ * 
+ * การค้นหาจะดู upper ก่อนแล้วค่อยตกไปที่ lower, การเขียนจะ copy-up เฉพาะไฟล์ที่ถูกแตะ
+ * และการลบจะบันทึก whiteout (ไฟล์ว่างชื่อ ".wh.<name>") ไว้ใน upper
+ * lower tree จะไม่ถูกแก้ไขเลย จึงแชร์ให้หลาย worker ใช้พร้อมกันได้
+ */
+typedef struct MyOverlay {
+    MyFolder *upper;    // tree ส่วนตัวที่เขียนได้
+    MyFolder *lower;    // tree ที่แชร์กัน (read-only)
+} MyOverlay;
+
+/**
+ * @brief ชุดของ mkdir/mk/write/append/rm ที่จะถูก apply พร้อมกันด้วย batch_commit
+ */
+typedef struct MyBatch {
+    MyBatchOp *ops;     // operation ตามลำดับที่ใส่เข้ามา
+    size_t count;
+    size_t capacity;
+} MyBatch;
+
+/**
+ * @brief หนึ่งระดับใน stack (depth-first) หรือ queue (breadth-first) ของ MyIter
+ */
+typedef struct MyIterFrame {
+    MyFolder *node;         // entry ใน sibling chain (NULL = ระดับเหนือ node เริ่มต้น)
+    MyFolder *next_child;   // ลูกถัดไปที่ยังไม่ได้เข้า
+    MyFile *next_file;      // ไฟล์ถัดไปที่ยังไม่ได้ visit
+    void *data;             // ค่าของผู้เรียกต่อ folder (iter_data)
+    int depth;
+    int state;
+} MyIterFrame;
+
+/**
+ * @brief ตัวเดิน tree แบบ explicit stack - ใช้ stack ของ thread คงที่ไม่ว่า tree จะกว้างหรือลึกแค่ไหน
+ * 
+ * หลัง iter_next คืน 1 field ด้านล่างบอก node ปัจจุบัน (ห้าม copy MyIter ระหว่างเดิน)
+ * iterator ไม่ถือ lock เอง: link ของลูกถูกอ่านหลัง pre-visit ของ folder และก่อน post-visit
+ * ผู้เรียกที่ต้องกัน writer จึงล็อก folder ใน pre-visit แล้วปล่อยใน post-visit ได้
+ */
+typedef struct MyIter {
+    MyFolder *folder;       // folder ปัจจุบัน หรือ folder ที่ไฟล์ปัจจุบันอยู่ (ข้าม mount แล้วถ้า MOUNTKIT_ITER_MOUNTS)
+    MyFolder *entry;        // entry ของ folder ใน sibling chain ของ parent (mount point ถ้ามี)
+    MyFile *file;           // ไฟล์ปัจจุบัน (NULL = กำลัง visit folder)
+    int depth;              // 0 = node เริ่มต้น, ไฟล์ลึกกว่า folder ของมันหนึ่งระดับ
+    bool post;              // visit หลังลูกครบแล้ว
+    bool failed;            // memory ไม่พอสำหรับ stack - walk จบก่อนครบ
+    int flags;
+    MyIterFrame *frames;
+    size_t count;           // depth-first: ความลึกของ stack, breadth-first: ท้าย queue
+    size_t head;            // breadth-first: หัว queue
+    size_t capacity;
+    MyIterFrame inline_frames[MOUNTKIT_ITER_INLINE];
+} MyIter;
+
+/**
+ * @brief ตำแหน่งของ index_scan และ readdir - อยู่กับผู้เรียก จึงเลื่อนต่อได้แม้ folder ถูกแก้ระหว่างหน้า
+ * 
+ * จำเฉพาะชื่อของ entry สุดท้ายที่ส่งไปแล้ว หน้าถัดไปเริ่มที่ชื่อถัดจากนั้นใน index ปัจจุบัน
+ */
+typedef struct MyCursor {
+    const char *to;                  // หยุดก่อนชื่อที่ >= to (NULL = ไม่จำกัด)
+    const char *prefix;              // เฉพาะชื่อที่ขึ้นต้นด้วย prefix (NULL = ทุกชื่อ)
+    char last[MOUNTKIT_NAME_MAX];    // key ของ entry สุดท้ายที่ส่งแล้ว (หรือจุดเริ่ม)
+    int last_kind;                   // 0 = last ยังไม่ถูกส่ง (เริ่มที่ชื่อ >= last), หรือ MOUNTKIT_DT_*
+    size_t pos;                      // จำนวน entry ที่ readdir ส่งแล้ว (folder ที่ไม่มี index)
+    bool done;                       // ครบช่วงแล้ว
+} MyCursor;
+
+/**
+ * @brief ลูกหนึ่งรายการจาก readdir - copy มาทั้งหมด ใช้ต่อได้แม้ node ถูกลบไปแล้ว
+ */
+typedef struct MyDirEntry {
+    char name[MOUNTKIT_NAME_MAX];    // ชื่อ (ตัดถ้ายาวเกิน)
+    int type;                        // MOUNTKIT_DT_DIR, MOUNTKIT_DT_FILE หรือ MOUNTKIT_DT_LINK
+    size_t size;                     // bytes ของข้อมูล (0 สำหรับ folder, ความยาว path ปลายทางสำหรับ symlink)
+    size_t capacity;                 // buffer ที่จองไว้ (0 สำหรับ folder)
+} MyDirEntry;
+
+/**
+ * @brief ผลของ stat - copy มาจาก metadata ของ node โดยไม่แตะ data
+ */
+typedef struct MyStat {
+    uint64_t ino;       // MyMeta::ino (ของไฟล์จริงสำหรับ hard link)
+    int type;           // MOUNTKIT_DT_DIR, MOUNTKIT_DT_FILE หรือ MOUNTKIT_DT_LINK
+    uint32_t mode;      // permission bits
+    uint32_t links;     // จำนวนชื่อของไฟล์ (folder = 1)
+    size_t size;        // bytes ของข้อมูล (0 สำหรับ folder, ความยาว path ปลายทางสำหรับ symlink)
+    size_t capacity;    // buffer ที่จองไว้ (0 สำหรับ folder)
+    uint64_t mtime;     // tick ของ MyMeta (0 บน embedded)
+    uint64_t ctime;
+} MyStat;
+
+/**
+ * @brief รายงานของ quota - ขีดจำกัด ยอดที่ใช้ และสิ่งที่ operation ขอเพิ่ม (copy มาทั้งหมด)
+ */
+typedef struct MyQuotaReport {
+    char name[MOUNTKIT_NAME_MAX];    // ชื่อของ folder ที่มี quota (ตัดถ้ายาวเกิน)
+    MyQuota limit;
+    MyUsage used;                    // ยอดของ subtree ตอนตรวจ
+    size_t bytes;                    // capacity ที่ operation ขอเพิ่ม (0 สำหรับ quota_get)
+    size_t nodes;                    // node ที่ operation ขอเพิ่ม
+} MyQuotaReport;
+
+/**
+ * @brief event หนึ่งรายการจาก watch - ขนาดคงที่ 64 bytes (หนึ่ง cache line)
+ */
+typedef struct MyWatchEvent {
+    uint32_t mask;      // MOUNTKIT_WATCH_* ของ event
+    uint32_t count;     // จำนวน event ที่เหมือนกันติดกันที่ถูกรวมเป็นรายการนี้ (>= 1)
+    char name[56];      // ชื่อ child (ตัดถ้ายาวเกิน), "" สำหรับ event ของ node ที่ watch เอง
+} MyWatchEvent;
+
+/**
+ * @brief ผลลัพธ์ของ compact - layout ของ subtree ก่อนและหลัง
+ */
+typedef struct MyCompactReport {
+    size_t nodes;            // จำนวน folder + file node ใน subtree
+    size_t slack_before;     // capacity ที่ไม่ได้ใช้ (capacity - size) รวมก่อน compact
+    size_t slack_after;      // capacity ที่ไม่ได้ใช้รวมหลัง compact
+    double far_hops_before;  // สัดส่วนการเดินไป node ถัดไปที่ข้ามไกลเกิน 1 page (0..1)
+    double far_hops_after;
+    double walk_ms_before;   // เวลาเดิน subtree หนึ่งรอบ (ms)
+    double walk_ms_after;
+} MyCompactReport;
+
+/**
+ * @brief callback ที่ถูกเรียกกับไฟล์แต่ละไฟล์ (เช่น ไฟล์ที่ verify ไม่ผ่าน)
+ */
+typedef void (*mountkit_file_fn)(void *ctx, MyFile *file);
+
+/**
+ * @brief callback ของ find และ index_scan ที่ถูกเรียกกับแต่ละ node ที่พบ
+ * @param path path ของ node (เริ่มด้วยชื่อ root ใช้กับ cd ได้) - index_scan ส่งเฉพาะชื่อ
+ * @param folder folder ที่ตรง (NULL ถ้าเป็นไฟล์)
+ * @param file ไฟล์ที่ตรง (NULL ถ้าเป็น folder)
+ * @return 1 เพื่อค้นต่อ, 0 เพื่อหยุด
+ */
+typedef int (*mountkit_find_fn)(void *ctx, const char *path, MyFolder *folder, MyFile *file);
+
+/**
+ * @brief callback ของ grep ที่ถูกเรียกกับแต่ละตำแหน่งที่พบ
+ * @param path path ของไฟล์ (เริ่มด้วยชื่อ root ใช้กับ cd ได้)
+ * @param offset ตำแหน่ง byte แรกของข้อความที่พบใน data ของไฟล์
+ * @param line เลขบรรทัด (เริ่มที่ 1) ถ้าขอ MOUNTKIT_GREP_LINES ไม่งั้น 0
+ * @return 1 เพื่อค้นต่อ, 0 เพื่อหยุด
+ */
+typedef int (*mountkit_grep_fn)(void *ctx, const char *path, MyFile *file, size_t offset, size_t line);
+
+/**
+ * @brief callback เมื่อ operation แบบ async เสร็จ (ถูกเรียกจาก async_poll บน thread ที่ poll)
+ * @param result ค่าที่ operation คืน (1 = สำเร็จ, 0 = ไม่สำเร็จ)
+ */
+typedef void (*mountkit_done_fn)(void *ctx, int result);
+
+/**
+ * @brief callback ที่คืน tick ปัจจุบัน (64 bit) - ต้องไม่ลดลง
+ */
+typedef uint64_t (*mountkit_clock_fn)(void);
+
+/**
+ * @brief คำนวณ CRC32C ต่อจากค่าเดิม (ใช้ hardware CRC ถ้า CPU รองรับ)
+ * @param crc ค่า CRC ก่อนหน้า (เริ่มต้นที่ 0)
+ * @param data ข้อมูลที่ต้องการคำนวณ
+ * @param size ขนาดข้อมูลเป็น bytes
+ * @return ค่า CRC32C ใหม่
+ * 
+ * ตัวอย่างการใช้งาน:
+ * uint32_t crc = mountkit_crc32c(0, "123456789", 9); // 0xE3069283
+ */
+uint32_t mountkit_crc32c(uint32_t crc, const void *data, size_t size);
+
+/**
+ * @brief callback สำหรับรับข้อมูลแบบ stream (เช่น output ของ tar_export)
+ * @return 1 ถ้าสำเร็จ, 0 ถ้าไม่สำเร็จ (หยุด stream)
+ */
+typedef int (*mountkit_sink_fn)(void *ctx, const uint8_t *data, size_t size);
+
+/**
+ * @brief callback สำหรับอ่านข้อมูลแบบ stream (เช่น input ของ tar_import)
+ * @return จำนวน bytes ที่อ่านได้, 0 เมื่อหมดข้อมูล, < 0 ถ้า error
+ */
+typedef int (*mountkit_source_fn)(void *ctx, uint8_t *buffer, size_t size);
+
 /**
  * @brief คลาส mountkit - ระบบจัดการไฟล์และโฟลเดอร์ในหน่วยความจำ
  * 
@@ -64,6 +398,17 @@ public:
      */
     MyFolder* mkdir(MyFolder **root, const char *path);
     
+    /**
+     * @brief สร้าง directory ตาม path ที่ต่อจาก folder ที่มีอยู่แล้ว (mkdir -p แบบ relative)
+     * @param parent folder เริ่มต้น (mount point = tree ที่ mount ไว้)
+     * @param path path ใต้ parent (เช่น "logs/2024")
+     * @return pointer ไปยัง directory สุดท้าย หรือ NULL ถ้าไม่สำเร็จ
+     * 
+     * ตัวอย่างการใช้งาน:
+     * MyFolder *logs = mount.mkdir_at(var, "log/nginx");
+     */
+    MyFolder* mkdir_at(MyFolder *parent, const char *path);
+    
     /**
      * @brief สร้างไฟล์ใหม่ใน directory ที่กำหนด
      * @param folder pointer ไปยัง directory ที่จะสร้างไฟล์
@@ -89,6 +434,35 @@ public:
      */
     MyFolder* cd(MyFolder *root, const char *path);
     
+    /**
+     * @brief ต่อ tree อื่นเข้าที่ path ใน tree นี้ (คล้าย mount ใน Linux)
+     * @param root pointer ไปยัง root directory
+     * @param path path ของ directory ที่จะเป็น mount point (ต้องมีอยู่แล้ว)
+     * @param other_root root ของ tree ที่ต้องการ mount (ไม่ถูก copy และยังเป็นของผู้เรียก)
+     * @return 1 ถ้าสำเร็จ, 0 ถ้าไม่พบ path หรือจะทำให้เกิด loop
+     * 
+     * หลัง mount แล้ว cd, mkdir, pwd และฟังก์ชันแสดงรายการจะข้ามเข้าไปใน other_root
+     * ส่วนเนื้อหาเดิมของ mount point จะถูกซ่อนไว้จนกว่าจะ umount
+     * 
+     * ตัวอย่างการใช้งาน:
+     * mount.mkdir(&root, "mnt/data");
+     * mount.mount(root, "mnt/data", data_root);
+     * MyFolder *logs = mount.cd(root, "mnt/data/logs");
+     */
+    int mount(MyFolder *root, const char *path, MyFolder *other_root);
+    
+    /**
+     * @brief ถอด tree ที่ mount ไว้บนสุดที่ path ออก (คล้าย umount ใน Linux)
+     * @param root pointer ไปยัง root directory
+     * @param path path ของ mount point
+     * @return root ของ tree ที่ถูกถอดออก หรือ NULL ถ้า path ไม่ใช่ mount point
+     * 
+     * ตัวอย่างการใช้งาน:
+     * MyFolder *old = mount.umount(root, "mnt/data");
+     * mount.mount(root, "mnt/data", new_data_root); // สลับ subsystem ทั้งชุด
+     */
+    MyFolder* umount(MyFolder *root, const char *path);
+    
     // =================================================================
     // FILE I/O FUNCTIONS - ฟังก์ชันสำหรับอ่านเขียนไฟล์
     // =================================================================
@@ -132,7 +506,71 @@ public:
      * int partial_read = mount.read(large_file, buffer, 100, 1000); // อ่าน 100 bytes เริ่มจากตำแหน่ง 1000
      */
     int read(MyFile *file, uint8_t *buffer, size_t size, size_t offset = 0);
-    
+
+    // =================================================================
+    // PATH API - หา folder และไฟล์ปลายทางด้วยการเดิน path ครั้งเดียวต่อ operation
+    // =================================================================
+    // path แบบเดียวกับ cd ("root/var/log/syslog" หรือ "var/log/syslog") แต่ไม่รองรับ "." และ ".."
+    // symlink ระหว่างทางถูกตามเหมือน cd ("." และ ".." ใน target ของ symlink ใช้ได้)
+    // folder ของไฟล์ถูก lock ไว้ตลอด operation จึงไม่ถูก rmdir หรือ rm ไปกลางทาง
+
+    /**
+     * @brief เขียนข้อมูลลงไฟล์ตาม path (สร้างไฟล์ถ้ายังไม่มี)
+     * @param root root directory
+     * @param path path ของไฟล์
+     * @param data ข้อมูลที่ต้องการเขียน (แทนที่ข้อมูลเดิมทั้งหมด)
+     * @param size ขนาดของข้อมูลเป็น bytes
+     * @param parents สร้าง folder ที่ยังไม่มีตลอด path ด้วย (เหมือน mkdir -p)
+     * @return 1 ถ้าสำเร็จ, 0 ถ้าไม่สำเร็จ (MOUNTKIT_ENOENT ถ้า folder ไม่มีและไม่ได้ขอ parents)
+     *
+     * ตัวอย่างการใช้งาน:
+     * mount.write_path(root, "etc/app/config.txt", "port=8080\n", true);
+     */
+    int write_path(MyFolder *root, const char *path, const uint8_t *data, size_t size, bool parents = false);
+    int write_path(MyFolder *root, const char *path, const char *str, bool parents = false);
+
+    /**
+     * @brief อ่านข้อมูลจากไฟล์ตาม path
+     * @param root root directory
+     * @param path path ของไฟล์
+     * @param buffer buffer สำหรับเก็บข้อมูลที่อ่านได้
+     * @param size จำนวน bytes ที่ต้องการอ่าน
+     * @param offset ตำแหน่งเริ่มต้นในไฟล์ (default: 0)
+     * @return จำนวน bytes ที่อ่านได้จริง (0 และ MOUNTKIT_ENOENT ถ้าไม่พบ)
+     *
+     * ตัวอย่างการใช้งาน:
+     * uint8_t buffer[256];
+     * int n = mount.read_path(root, "etc/app/config.txt", buffer, sizeof(buffer));
+     */
+    int read_path(MyFolder *root, const char *path, uint8_t *buffer, size_t size, size_t offset = 0);
+
+    /**
+     * @brief ลบไฟล์ตาม path
+     * @param root root directory
+     * @param path path ของไฟล์
+     * @return 1 ถ้าสำเร็จ, 0 ถ้าไม่พบไฟล์หรือไม่สำเร็จ
+     *
+     * ตัวอย่างการใช้งาน:
+     * mount.rm_path(root, "tmp/upload.part");
+     */
+    int rm_path(MyFolder *root, const char *path);
+
+    /**
+     * @brief ข้อมูลของไฟล์หรือ folder ตาม path (ชื่อ ชนิด ขนาด และ metadata)
+     * @param root root directory
+     * @param path path ของไฟล์หรือ folder
+     * @param entry ผลลัพธ์ (รูปแบบเดียวกับ readdir, folder มี size และ capacity เป็น 0) - NULL ได้
+     * @param st metadata แบบ stat() (NULL = ไม่ต้องการ)
+     * @return 1 ถ้าพบ, 0 ถ้าไม่พบ (MOUNTKIT_ENOENT)
+     *
+     * ตัวอย่างการใช้งาน:
+     * MyDirEntry entry;
+     * if (mount.stat_path(root, "var/log/syslog", &entry)) printf("%zu bytes\n", entry.size);
+     * MyStat st;
+     * mount.stat_path(root, "var/log/syslog", NULL, &st);
+     */
+    int stat_path(MyFolder *root, const char *path, MyDirEntry *entry, MyStat *st = NULL);
+
     // =================================================================
     // UTILITY FUNCTIONS - ฟังก์ชันเสริมสำหรับจัดการระบบไฟล์
     // =================================================================
@@ -160,6 +598,338 @@ public:
      */
     int rm(MyFolder *folder, const char *filename);
     
+    /**
+     * @brief เริ่มต้น batch ว่าง
+     * @param batch batch ที่ต้องการเริ่มต้น
+     * 
+     * ตัวอย่างการใช้งาน:
+     * MyBatch batch;
+     * mount.batch_init(&batch);
+     */
+    void batch_init(MyBatch *batch);
+    
+    /**
+     * @brief ใส่ operation ลง batch (path แบบเดียวกับ mkdir: เริ่มจาก chain ที่ root ชี้อยู่)
+     * @param batch batch จาก batch_init
+     * @param path path ของ directory (batch_mkdir) หรือของไฟล์ (ที่เหลือ)
+     * @param data, size ข้อมูลที่จะเขียน/ต่อท้าย (ถูก copy เก็บไว้ทันที)
+     * @return 1 ถ้าสำเร็จ, 0 ถ้า parameter ไม่ถูกต้องหรือ memory ไม่พอ
+     * 
+     * batch_mkdir สร้าง directory ระหว่างทางให้ด้วย, batch_write/batch_append สร้างไฟล์ถ้ายังไม่มี
+     * และ batch_rm ต้องลบไฟล์ที่มีอยู่ (ไม่งั้นทั้ง batch ไม่ถูก apply)
+     * 
+     * ตัวอย่างการใช้งาน:
+     * mount.batch_mkdir(&batch, "root/etc/nginx");
+     * mount.batch_write(&batch, "root/etc/nginx/nginx.conf", conf, conf_len);
+     * mount.batch_rm(&batch, "root/etc/nginx/default.old");
+     */
+    int batch_mkdir(MyBatch *batch, const char *path);
+    int batch_mk(MyBatch *batch, const char *path);
+    int batch_write(MyBatch *batch, const char *path, const uint8_t *data, size_t size);
+    int batch_append(MyBatch *batch, const char *path, const uint8_t *data, size_t size);
+    int batch_rm(MyBatch *batch, const char *path);
+    
+    /**
+     * @brief apply ทุก operation ใน batch แบบ all-or-nothing แล้วล้าง batch
+     * @param batch batch ที่ใส่ operation ไว้แล้ว
+     * @param root pointer ไปยัง root chain (ตัวเดียวกับที่ใช้กับ mkdir)
+     * @return 1 ถ้า apply ครบ, 0 ถ้ามี operation ที่ทำไม่ได้หรือ memory ไม่พอ (tree ไม่ถูกแก้ไข)
+     * 
+     * operation ถูกจัดกลุ่มตาม directory ปลายทางและเรียงตาม path: directory ถูกสร้างก่อนของข้างใน
+     * และ operation ใน directory เดียวกันคงลำดับเดิม การเดิน path ใช้ prefix ร่วมกัน
+     * และ lock แต่ละ folder/ไฟล์ที่ถูกแก้เพียงครั้งเดียวตลอด commit
+     * reader ที่ไม่ถือ lock (lock-free read mode) อาจเห็นผลของ folder ที่มีอยู่แล้วทีละ folder
+     * 
+     * ตัวอย่างการใช้งาน:
+     * if (!mount.batch_commit(&batch, &root)) printf("nothing applied\n");
+     */
+    int batch_commit(MyBatch *batch, MyFolder **root);
+    
+    /**
+     * @brief ทิ้ง operation ที่ยังไม่ commit และคืนหน่วยความจำของ batch
+     * @param batch batch ที่ต้องการคืน
+     */
+    void batch_release(MyBatch *batch);
+    
+    /**
+     * @brief เริ่มเดิน subtree ของ folder ด้วย explicit stack/queue (ไม่มี recursion)
+     * @param it iterator ของผู้เรียก (ต้องเรียก iter_end เมื่อเลิกใช้)
+     * @param folder node เริ่มต้น (NULL = ไม่มีอะไรให้เดิน)
+     * @param flags MOUNTKIT_ITER_*
+     * 
+     * stack โตตามความลึกเท่านั้น (ลูกจำนวนมากไม่กินที่เพราะเก็บแค่ cursor ของ sibling ถัดไป)
+     * link ไปยัง sibling ถัดไปถูกอ่านก่อน visit node จึง free node ระหว่าง post-visit ได้
+     * 
+     * ตัวอย่างการใช้งาน:
+     * MyIter it;
+     * mount.iter_begin(&it, docs, MOUNTKIT_ITER_PRE | MOUNTKIT_ITER_FILES);
+     * while (mount.iter_next(&it)) {
+     *     if (!it.file && strcmp(it.folder->data, ".cache") == 0) mount.iter_prune(&it);
+     *     else if (it.file) printf("%s\n", (char*)it.file->name);
+     * }
+     * mount.iter_end(&it);
+     */
+    void iter_begin(MyIter *it, MyFolder *folder, int flags);
+    
+    /**
+     * @brief เลื่อนไป node ถัดไป
+     * @return 1 ถ้ามี node ให้ visit, 0 ถ้าครบแล้ว (หรือ it->failed)
+     */
+    int iter_next(MyIter *it);
+    
+    /**
+     * @brief ไม่เข้าไปในลูก (ไฟล์และ folder) ที่เหลือของ folder ที่เพิ่ง pre-visit หรือของ folder ที่ไฟล์ปัจจุบันอยู่
+     * post-visit ของ folder นั้นยังเกิดขึ้นตามปกติ
+     */
+    void iter_prune(MyIter *it);
+    
+    /**
+     * @brief ช่องเก็บค่าของผู้เรียกต่อ folder (เช่น node ที่สร้างคู่กันระหว่าง copy tree)
+     * @param up 0 = folder ปัจจุบัน (หรือ folder ของไฟล์ปัจจุบัน), 1 = parent ของมัน (ระดับบนสุดมีช่องร่วมหนึ่งช่อง)
+     * @return pointer ไปยังช่อง (ใช้ได้ถึง iter_next ครั้งถัดไป) หรือ NULL ถ้าไม่มีระดับนั้น
+     * 
+     * breadth-first มีเฉพาะ up = 0
+     */
+    void** iter_data(MyIter *it, int up);
+    
+    /**
+     * @brief path ของ node ปัจจุบันจาก node เริ่มต้น (เช่น "root/var/log/syslog") - depth-first เท่านั้น
+     * @param from_depth ข้าม component ที่ตื้นกว่านี้ (1 = ไม่รวมชื่อ node เริ่มต้น)
+     * @return ความยาวของ path ทั้งหมดแบบ snprintf (>= size แปลว่าถูกตัด)
+     */
+    size_t iter_path(MyIter *it, char *buf, size_t size, int from_depth = 0);
+    
+    /**
+     * @brief คืน stack ที่จองบน heap (ถ้ามี)
+     */
+    void iter_end(MyIter *it);
+    
+    /**
+     * @brief ค้นหาไฟล์และ folder ที่ path ตรงกับ glob pattern
+     * @param root folder ที่ pattern เริ่มต้น (component แรกที่ตรงกับชื่อ root ถูกข้ามเหมือน cd)
+     * @param pattern component คั่นด้วย '/': '*' และ '?' ภายในชื่อ, [a-z] / [!...] class,
+     *                '\\' escape และ "**" แทน folder กี่ชั้นก็ได้ (รวม 0 ชั้น)
+     * @param fn callback ต่อ node ที่ตรง (folder ถูกรายงานก่อนของข้างใน)
+     * @param ctx pointer ที่ส่งต่อให้ callback
+     * @return จำนวน node ที่ส่งให้ callback (0 พร้อม MOUNTKIT_EINVAL ถ้า pattern ยาวเกินหรือ parameter ผิด)
+     * 
+     * component ที่เป็น literal ต้นทางถูกค้นหาตรง ๆ ทีละชั้นแบบ cd และ subtree ที่ไม่มีทางตรง
+     * ส่วนที่เหลือของ pattern ไม่ถูกเดินเข้าไปเลย
+     * callback ถูกเรียกขณะถือ read lock ของ folder ระหว่างทาง จึงห้ามแก้ tree
+     * (ยกเว้นลบไฟล์ที่เพิ่งได้รับเมื่อไม่ได้เปิด concurrent mode)
+     * 
+     * ตัวอย่างการใช้งาน:
+     * mountkit_find_fn print = [](void *ctx, const char *path, MyFolder *folder, MyFile *file) {
+     *     printf("%s\n", path);
+     *     return 1;
+     * };
+     * mount.find(root, "root/etc/nginx*.conf", print, NULL);
+     */
+    int find(MyFolder *root, const char *pattern, mountkit_find_fn fn, void *ctx);
+    
+    /**
+     * @brief สร้าง ordered index ของลูกทั้งหมดใน folder (skip list ตามชื่อ, folder มาก่อนไฟล์ที่ชื่อซ้ำกัน)
+     * @param folder folder ที่ต้องการ (ไม่ข้าม mount)
+     * @return 1 ถ้าสำเร็จหรือมี index อยู่แล้ว, 0 ถ้า memory ไม่พอ
+     * 
+     * หลังจากนี้ทุก operation ที่เพิ่ม/ลบลูกของ folder จะแก้ index ไปพร้อมกันในราคา O(log n)
+     * ถ้าจอง node ของ index ไม่ได้ระหว่างนั้น index จะถูกทิ้ง (operation เองยังสำเร็จ)
+     * index ของ folder ที่ถูก compact ถูกสร้างใหม่บน copy และ entry ใน index ของ parent ถูกสลับไปยัง copy
+     * 
+     * ตัวอย่างการใช้งาน:
+     * mount.index_enable(logs);
+     */
+    int index_enable(MyFolder *folder);
+    
+    /**
+     * @brief ทิ้ง ordered index ของ folder
+     */
+    void index_disable(MyFolder *folder);
+    
+    /**
+     * @brief เริ่ม cursor สำหรับ index_scan
+     * @param from เริ่มที่ชื่อ >= from (NULL = ต้นสุด)
+     * @param to หยุดก่อนชื่อที่ >= to (NULL = ไม่จำกัด) - ต้องอยู่ได้ตลอดอายุ cursor
+     * @param prefix เฉพาะชื่อที่ขึ้นต้นด้วย prefix (NULL = ทุกชื่อ) - ต้องอยู่ได้ตลอดอายุ cursor
+     */
+    void cursor_init(MyCursor *cursor, const char *from = NULL, const char *to = NULL, const char *prefix = NULL);
+    
+    /**
+     * @brief ส่งลูกของ folder ตามลำดับชื่อจากตำแหน่งของ cursor ไม่เกิน max รายการแล้วเลื่อน cursor
+     * @param max จำนวนสูงสุดในหน้านี้ (<= 0 = ไม่จำกัด)
+     * @param fn callback ต่อ entry (path คือชื่อ) - คืน 0 เพื่อหยุด หน้าถัดไปเริ่มหลัง entry นั้น
+     * @return จำนวน entry ที่ส่งให้ callback (0 พร้อม MOUNTKIT_EINVAL ถ้า folder ไม่มี index)
+     * 
+     * ค้นหาจุดเริ่มในราคา O(log n) จึงใช้ได้ทั้งช่วงของชื่อ ([from, to)), prefix และแบ่งหน้า
+     * callback ถูกเรียกขณะถือ read lock ของ folder จึงห้ามแก้ folder นั้น
+     * ชื่อที่ยาวกว่า MOUNTKIT_NAME_MAX - 1 เลื่อน cursor ข้ามทุกชื่อที่ขึ้นต้นเหมือนกันถึงตรงนั้น
+     * 
+     * ตัวอย่างการใช้งาน:
+     * MyCursor cursor;
+     * mount.cursor_init(&cursor, NULL, NULL, "log.2024");
+     * while (!cursor.done) mount.index_scan(logs, &cursor, 100, print_page, &page);
+     */
+    int index_scan(MyFolder *folder, MyCursor *cursor, int max, mountkit_find_fn fn, void *ctx);
+    
+    /**
+     * @brief อ่านลูกของ folder ทีละหน้าลง buffer ของผู้เรียก (ไม่จองหน่วยความจำ)
+     * @param folder folder ที่ต้องการ (mount point = tree ที่ mount ไว้)
+     * @param cursor ตำแหน่งจาก cursor_init - เรียกซ้ำจนกว่า cursor->done
+     * @param entries buffer ของผู้เรียก
+     * @param max ขนาดของ buffer
+     * @return จำนวน entry ที่เขียนลง buffer
+     * 
+     * folder ที่มี index: เรียงตามชื่อ, ใช้ช่วง from/to/prefix ของ cursor และเลื่อนต่อในราคา O(log n)
+     * folder ที่ไม่มี index: ตามลำดับ chain (folder ก่อนแล้วไฟล์) และไม่ใช้ช่วงของ cursor
+     * หน้าถัดไปเริ่มหลัง entry สุดท้ายที่ส่ง (หาตามชื่อ) ถ้า entry นั้นยังอยู่ ไม่งั้นเริ่มที่ลำดับเดิม
+     * entry ที่ไม่ถูกแก้ระหว่างหน้าถูกส่งครั้งเดียวเสมอ ยกเว้นตอนที่ entry สุดท้ายของหน้าก่อนถูกลบ
+     * 
+     * ตัวอย่างการใช้งาน:
+     * MyDirEntry page[64];
+     * MyCursor cursor;
+     * mount.cursor_init(&cursor);
+     * while (!cursor.done) {
+     *     int n = mount.readdir(folder, &cursor, page, 64);
+     *     for (int i = 0; i < n; ++i) printf("%s %zu\n", page[i].name, page[i].size);
+     * }
+     */
+    int readdir(MyFolder *folder, MyCursor *cursor, MyDirEntry *entries, int max);
+    
+    /**
+     * @brief ยอดรวมการใช้พื้นที่ของ folder (คล้าย du) จากยอดที่เก็บไว้ - ไม่ต้องเดิน tree
+     * @param folder folder ที่ต้องการ (mount point = tree ที่ mount ไว้)
+     * @param out ผลลัพธ์ (mounts = จำนวน mount point ที่ถูกรวมเข้ามา)
+     * @param include_subdirs รวม subdirectories หรือไม่
+     * @return 1 ถ้าสำเร็จ, 0 ถ้า parameter ไม่ถูกต้อง
+     * 
+     * O(1) ถ้า subtree ไม่มี mount point, ไม่งั้นเดินเฉพาะ folder ที่มี mount point อยู่ข้างใต้
+     * include_subdirs = false ใช้เวลาตามจำนวน subdirectory ของ folder
+     * ยอดถูกแก้ทีละ operation จึงไม่ใช่ snapshot ของหลาย operation ที่ทำพร้อมกัน
+     * 
+     * ตัวอย่างการใช้งาน:
+     * MyUsage u;
+     * mount.usage(home, &u);
+     * printf("%zu files, %zu bytes\n", u.files, u.bytes);
+     */
+    int usage(MyFolder *folder, MyUsage *out, bool include_subdirs = true);
+    
+    /**
+     * @brief metadata ของไฟล์หรือ folder (ino, ชนิด, mode, จำนวนชื่อ, ขนาด, mtime/ctime) - ไม่แตะ data
+     * @param file ไฟล์ (hard link = ไฟล์จริง, symlink = ตัว symlink เอง)
+     * @param folder folder (mount point = tree ที่ mount ไว้)
+     * @param st ผลลัพธ์
+     * @return 1 ถ้าสำเร็จ, 0 ถ้า parameter ไม่ถูกต้อง
+     * 
+     * embedded ไม่เก็บ metadata: ino, mtime และ ctime เป็น 0 และ mode เป็นค่าเริ่มต้นตามชนิด
+     * 
+     * ตัวอย่างการใช้งาน:
+     * MyStat before, after;
+     * mount.stat(config, &before);
+     * ...
+     * mount.stat(config, &after);
+     * if (after.mtime != before.mtime) reload(config);
+     */
+    int stat(MyFile *file, MyStat *st);
+    int stat(MyFolder *folder, MyStat *st);
+    
+    /**
+     * @brief เปลี่ยน mode ของไฟล์หรือ folder (เก็บไว้ใน metadata และ tar_export เท่านั้น)
+     * @param mode permission bits (เฉพาะ 07777)
+     * @return 1 ถ้าสำเร็จ, 0 ถ้า parameter ไม่ถูกต้อง
+     * 
+     * embedded ไม่เก็บ metadata - ตรวจ parameter แล้วไม่มีผลอื่น
+     * 
+     * ตัวอย่างการใช้งาน:
+     * mount.chmod(script, 0755);
+     */
+    int chmod(MyFile *file, uint32_t mode);
+    int chmod(MyFolder *folder, uint32_t mode);
+    
+    /**
+     * @brief กำหนดที่มาของ tick สำหรับ mtime/ctime
+     * @param fn callback ที่คืน tick ปัจจุบัน (NULL = ค่าเริ่มต้น: ms จาก monotonic clock แบบ coarse)
+     * 
+     * ตั้งก่อนสร้าง node - ไม่ปลอดภัยถ้าเปลี่ยนขณะ thread อื่นกำลังแก้ tree
+     * embedded ไม่เก็บ metadata จึงไม่มีผล
+     * 
+     * ตัวอย่างการใช้งาน:
+     * static uint64_t frame_ticks(void) { return frame_counter; }
+     * mount.set_clock(frame_ticks);
+     */
+    void set_clock(mountkit_clock_fn fn);
+    
+    /**
+     * @brief ตั้งขีดจำกัดของ subtree (คล้าย quota ของ directory)
+     * @param folder folder ที่ต้องการ (mount point = tree ที่ mount ไว้)
+     * @param max_bytes capacity รวมสูงสุดของไฟล์ใน subtree (0 = ไม่จำกัด)
+     * @param max_nodes จำนวนไฟล์ + folder สูงสุด รวม folder เอง (0 = ไม่จำกัด)
+     * @return 1 ถ้าสำเร็จ, 0 ถ้า parameter ไม่ถูกต้อง
+     * 
+     * write, append, append_shared, mk, cp, mv, ln, symlink, mkdir, path API, batch_commit และ tar_import
+     * ตรวจก่อนจองหน่วยความจำกับยอดที่เก็บไว้ของทุก folder ตาม parent chain ที่มี quota (O(ความลึก), ไม่เดิน tree)
+     * operation ที่จะทำให้เกิน fail ทันทีด้วย MOUNTKIT_EDQUOT โดยไม่แก้ tree และรายงานไว้ให้ quota_last
+     * ตั้งต่ำกว่ายอดปัจจุบันได้ - ของเดิมไม่ถูกลบ แต่ subtree จะโตต่อไม่ได้จนกว่าจะลดลง
+     * การตรวจไม่ได้ถือ lock ร่วมกับ writer อื่น: writer หลาย thread ใน subtree เดียวกันอาจเกินได้ไม่เกินคนละหนึ่ง operation
+     * 
+     * ตัวอย่างการใช้งาน:
+     * mount.quota_set(tmp, 64 * 1024 * 1024, 10000);
+     * if (!mount.append(log, data, size) && mount.lastError() == MOUNTKIT_EDQUOT) {
+     *     MyQuotaReport r;
+     *     mount.quota_last(&r);
+     *     printf("%s: %zu/%zu bytes\n", r.name, r.used.capacity, r.limit.bytes);
+     * }
+     */
+    int quota_set(MyFolder *folder, size_t max_bytes, size_t max_nodes);
+    
+    /**
+     * @brief ขีดจำกัดและยอดปัจจุบันของ folder
+     * @return 1 ถ้า folder มี quota, 0 ถ้าไม่มี (report ยังมียอดปัจจุบัน) หรือ parameter ไม่ถูกต้อง
+     */
+    int quota_get(MyFolder *folder, MyQuotaReport *report);
+    
+    /**
+     * @brief รายงานของ operation ล่าสุดใน thread นี้ที่ fail ด้วย MOUNTKIT_EDQUOT
+     * @return 1 ถ้ามี, 0 ถ้ายังไม่เคยเกิน quota ใน thread นี้
+     */
+    int quota_last(MyQuotaReport *report);
+    
+    /**
+     * @brief error code ของ operation ที่ fail ล่าสุดใน thread นี้ (แบบ errno)
+     * @return MOUNTKIT_OK ถ้ายังไม่มี operation ที่ fail ตั้งแต่ clearError ครั้งก่อน, หรือ MOUNTKIT_E*
+     * 
+     * error ถูกเก็บแยกต่อ thread (embedded build ที่ไม่มี thread มีชุดเดียว) และถูกเขียนเฉพาะตอน fail
+     * operation ที่สำเร็จไม่แตะ error state จึงตรวจหลังทำหลาย operation ต่อกันได้
+     * 
+     * ตัวอย่างการใช้งาน:
+     * if (!mount.mk(folder, "a.txt")) printf("%s\n", mount.errorString(mount.lastError()));
+     */
+    int lastError();
+    
+    /**
+     * @brief ข้อความของ error code
+     */
+    const char* errorString(int code);
+    
+    /**
+     * @brief ตรวจสอบว่ามี operation ที่ fail ใน thread นี้หรือไม่
+     * @return true ถ้ามี error, false ถ้าปกติ
+     * 
+     * ตัวอย่างการใช้งาน:
+     * if (mount.hasError()) {
+     *     // จัดการ error
+     *     mount.clearError();
+     * }
+     */
+    bool hasError();
+    
+    /**
+     * @brief เคลียร์ error state ของ thread นี้
+     * 
+     * ตัวอย่างการใช้งาน:
+     * mount.clearError(); // รีเซ็ต error state
+     */
+    void clearError();
+    
     // =================================================================
     // BUILD-SPECIFIC FUNCTIONS - ฟังก์ชันที่แตกต่างกันตาม build type
     // =================================================================
@@ -168,26 +938,6 @@ public:
         // ===== EMBEDDED-SPECIFIC FUNCTIONS =====
         // ฟังก์ชันเฉพาะสำหรับ embedded systems (ใช้ทรัพยากรน้อย)
         
-        /**
-         * @brief ตรวจสอบว่ามี error เกิดขึ้นในระบบหรือไม่
-         * @return true ถ้ามี error, false ถ้าปกติ
-         * 
-         * ตัวอย่างการใช้งาน:
-         * if (mount.hasError()) {
-         *     // จัดการ error
-         *     mount.clearError();
-         * }
-         */
-        bool hasError();
-        
-        /**
-         * @brief เคลียร์ error flag ของระบบ
-         * 
-         * ตัวอย่างการใช้งาน:
-         * mount.clearError(); // รีเซ็ต error state
-         */
-        void clearError();
-        
         /**
          * @brief รัน test พื้นฐานสำหรับ embedded system (ใช้ทรัพยากรน้อย)
          * 
@@ -256,10 +1006,63 @@ public:
          */
         int mv(MyFolder *src_folder, const char *filename, MyFolder *dst_folder);
         
+        /**
+         * @brief สร้าง hard link - ชื่อใหม่ที่ชี้ไฟล์เดียวกัน (คล้าย ln ใน Linux)
+         * @param src_folder directory ของไฟล์ต้นทาง
+         * @param filename ชื่อไฟล์ต้นทาง (ชื่อเดิมหรือ hard link ก็ได้, symlink ไม่ได้)
+         * @param dst_folder directory ของชื่อใหม่
+         * @param linkname ชื่อใหม่
+         * @return 1 ถ้าสำเร็จ, 0 ถ้าไม่สำเร็จ (MOUNTKIT_EEXIST ถ้ามีชื่อนี้แล้ว)
+         * 
+         * ทุกชื่อใช้ data, lock และ watch ชุดเดียวกัน - ฟังก์ชันที่รับ MyFile* ของชื่อใดก็ได้ทำงานกับไฟล์จริง
+         * rm ลบเฉพาะชื่อ ไฟล์ถูกคืนเมื่อชื่อสุดท้ายหายไป
+         * usage: bytes ของไฟล์นับที่ folder ของชื่อเดิมเท่านั้น (ชื่อที่ ln เพิ่มนับแค่ files และ names)
+         * ถ้าชื่อเดิมถูกลบก่อน bytes จะไม่ถูกนับใน folder ใดอีก
+         * 
+         * ตัวอย่างการใช้งาน:
+         * mount.ln(logs_dir, "app.log", current_dir, "latest.log");
+         */
+        int ln(MyFolder *src_folder, const char *filename, MyFolder *dst_folder, const char *linkname);
+        
+        /**
+         * @brief สร้าง symbolic link (คล้าย ln -s ใน Linux)
+         * @param folder directory ที่จะสร้าง symlink
+         * @param name ชื่อของ symlink
+         * @param target path ปลายทาง - ขึ้นต้นด้วย '/' = เริ่มจาก root ที่ส่งให้ cd/path API, ไม่งั้นเริ่มจาก folder ของ symlink
+         * @return 1 ถ้าสำเร็จ, 0 ถ้าไม่สำเร็จ (MOUNTKIT_EEXIST ถ้ามีชื่อนี้แล้ว, MOUNTKIT_EINVAL ถ้า target ว่างหรือยาวเกิน 255)
+         * 
+         * cd และ path API ตาม symlink ทุก component (ยกเว้น rm_path ที่ลบตัว symlink เอง)
+         * ".." ใน target ถอยตาม folder จริง ไม่ใช่ตามตัวอักษรของ path
+         * ปลายทางไม่จำเป็นต้องมีอยู่ (dangling) - write_path ผ่าน symlink ที่ชี้ไฟล์ที่ยังไม่มีจะสร้างไฟล์นั้น
+         * folder ปลายทางถูกจำไว้ใน symlink และใช้ซ้ำจนกว่า tree จะเปลี่ยน (lock-free read mode หรือไม่ได้เปิด concurrent)
+         * 
+         * ตัวอย่างการใช้งาน:
+         * mount.symlink(root, "current", "releases/v2");
+         * MyFolder *bin = mount.cd(root, "current/bin");
+         */
+        int symlink(MyFolder *folder, const char *name, const char *target);
+        
+        /**
+         * @brief อ่าน path ปลายทางของ symlink
+         * @param folder directory ของ symlink
+         * @param name ชื่อของ symlink
+         * @param buffer ผลลัพธ์ (null-terminated, ตัดถ้ายาวเกิน)
+         * @param size ขนาดของ buffer
+         * @return ความยาวของ target ทั้งหมด, -1 ถ้าไม่พบ (MOUNTKIT_ENOENT) หรือไม่ใช่ symlink (MOUNTKIT_EINVAL)
+         * 
+         * ตัวอย่างการใช้งาน:
+         * char target[256];
+         * mount.readlink(root, "current", target, sizeof(target)); // "releases/v2"
+         */
+        int readlink(MyFolder *folder, const char *name, char *buffer, size_t size);
+        
         /**
          * @brief แสดงรายการไฟล์ใน directory (คล้าย ls ใน Linux)
          * @param folder directory ที่ต้องการแสดง
          * @param show_details แสดงรายละเอียด (size, capacity) หรือไม่
+         * @return ข้อความของ listing ทั้งหมด (ไม่ตัด) ใน buffer ของ thread ที่เรียก - ใช้ได้ถึง dir() ครั้งถัดไปใน thread เดียวกัน
+         * 
+         * จัดรูปแบบจาก readdir ทีละหน้า: ไม่ถือ lock ของ folder ตลอด listing
          * 
          * ตัวอย่างการใช้งาน:
          * mount.dir(current_dir);           // แสดงแค่ชื่อไฟล์
@@ -291,7 +1094,22 @@ public:
          * mount.append(binary_file, extra_data, sizeof(extra_data));
          */
         int append(MyFile *file, uint8_t *data, size_t size);
-        
+
+        /**
+         * @brief เพิ่มข้อมูลต่อท้ายไฟล์ตาม path (สร้างไฟล์ถ้ายังไม่มี) - เดิน path ครั้งเดียวเหมือน write_path
+         * @param root root directory
+         * @param path path ของไฟล์
+         * @param data ข้อมูลที่ต้องการเพิ่ม
+         * @param size ขนาดข้อมูล
+         * @param parents สร้าง folder ที่ยังไม่มีตลอด path ด้วย
+         * @return 1 ถ้าสำเร็จ, 0 ถ้าไม่สำเร็จ
+         *
+         * ตัวอย่างการใช้งาน:
+         * mount.append_path(root, "var/log/syslog", "[INFO] started\n", true);
+         */
+        int append_path(MyFolder *root, const char *path, const uint8_t *data, size_t size, bool parents = false);
+        int append_path(MyFolder *root, const char *path, const char *str, bool parents = false);
+
         /**
          * @brief แสดงเนื้อหาของไฟล์ (คล้าย cat ใน Linux)
          * @param file pointer ไปยังไฟล์ที่ต้องการแสดง
@@ -316,6 +1134,8 @@ public:
          * @param include_subdirs รวม subdirectories หรือไม่
          * @return ขนาด memory รวมเป็น bytes
          * 
+         * คำนวณจาก usage() - ไม่เดิน tree และไม่ strlen ชื่อทุกตัวอีกต่อไป
+         * 
          * ตัวอย่างการใช้งาน:
          * size_t total = mount.calculateFolderCapacity(root, true);
          * size_t this_dir = mount.calculateFolderCapacity(current_dir, false);
@@ -323,6 +1143,600 @@ public:
          */
         size_t calculateFolderCapacity(MyFolder *folder, bool include_subdirs = true);
         
+        /**
+         * @brief export subtree เป็น tar archive (ustar + pax) แบบ streaming
+         * @param folder directory ที่ต้องการ export (path ใน archive จะ relative กับ folder นี้)
+         * @param sink callback รับข้อมูล - ได้รับ header และ MyFile::data โดยตรง ไม่มี staging buffer
+         * @param ctx pointer ที่ส่งต่อให้ sink
+         * @return 1 ถ้าสำเร็จ, 0 ถ้าไม่สำเร็จ
+         * 
+         * ตัวอย่างการใช้งาน:
+         * mount.tar_export(etc_dir, my_sink, &my_buffer);
+         */
+        int tar_export(MyFolder *folder, mountkit_sink_fn sink, void *ctx);
+        
+        /**
+         * @brief export subtree เป็น tar archive ลง file descriptor
+         * @param folder directory ที่ต้องการ export
+         * @param fd file descriptor ปลายทาง (เช่น socket หรือไฟล์ที่เปิดไว้)
+         * @return 1 ถ้าสำเร็จ, 0 ถ้าไม่สำเร็จ
+         * 
+         * ตัวอย่างการใช้งาน:
+         * mount.tar_export_fd(root, fileno(stdout));
+         */
+        int tar_export_fd(MyFolder *folder, int fd);
+        
+        /**
+         * @brief อ่าน tar archive แบบ streaming แล้วสร้าง tree ลงใน folder
+         * @param folder directory ปลายทาง (ไฟล์ชื่อซ้ำจะถูกเขียนทับ)
+         * @param source callback สำหรับอ่านข้อมูล archive
+         * @param ctx pointer ที่ส่งต่อให้ source
+         * @return 1 ถ้าสำเร็จ, 0 ถ้า archive เสียหายหรือ memory ไม่พอ
+         * 
+         * ตัวอย่างการใช้งาน:
+         * MyFolder *restore = mount.mkdir(&root, "root/restore");
+         * mount.tar_import(restore, my_source, &my_stream);
+         */
+        int tar_import(MyFolder *folder, mountkit_source_fn source, void *ctx);
+        
+        /**
+         * @brief อ่าน tar archive จาก file descriptor แล้วสร้าง tree ลงใน folder
+         * @param folder directory ปลายทาง
+         * @param fd file descriptor ต้นทาง
+         * @return 1 ถ้าสำเร็จ, 0 ถ้าไม่สำเร็จ
+         * 
+         * ตัวอย่างการใช้งาน:
+         * mount.tar_import_fd(restore, fd);
+         */
+        int tar_import_fd(MyFolder *folder, int fd);
+        
+        /**
+         * @brief คืนค่า CRC32C ของไฟล์ และเริ่มติดตาม checksum ของไฟล์นี้
+         * @param file pointer ไปยังไฟล์
+         * @return ค่า CRC32C ของ data ปัจจุบัน
+         * 
+         * หลังเรียกครั้งแรก append จะอัปเดต checksum ต่อเนื่อง ส่วน write
+         * จะทำให้ checksum ถูกคำนวณใหม่เมื่อใช้งานครั้งถัดไป
+         * 
+         * ตัวอย่างการใช้งาน:
+         * uint32_t crc = mount.checksum(config_file);
+         */
+        uint32_t checksum(MyFile *file);
+        
+        /**
+         * @brief ตรวจ checksum ของไฟล์ทั้งหมดใน subtree แบบขนาน
+         * @param folder directory ที่ต้องการตรวจ (รวม subdirectories)
+         * @param on_corrupt callback สำหรับไฟล์ที่ data ไม่ตรงกับ checksum (optional)
+         * @param ctx pointer ที่ส่งต่อให้ callback
+         * @return จำนวนไฟล์ที่เสียหาย หรือ -1 ถ้า memory ไม่พอ
+         * 
+         * ไฟล์ที่ไม่ได้ติดตาม checksum จะถูกข้าม
+         * 
+         * ตัวอย่างการใช้งาน:
+         * int bad = mount.verify(root);
+         * if (bad > 0) printf("%d corrupted files\n", bad);
+         */
+        int verify(MyFolder *folder, mountkit_file_fn on_corrupt = NULL, void *ctx = NULL);
+
+        /**
+         * @brief ค้นหาข้อความใน data ของไฟล์ทั้งหมดใน subtree แบบขนาน (SSE2/AVX2 บน x86)
+         * @param root directory ที่ต้องการค้น (รวม subdirectories และ tree ที่ mount ไว้)
+         * @param needle ข้อความที่ค้นหา (ไม่ว่าง)
+         * @param flags MOUNTKIT_GREP_* (0 = ทุกตำแหน่ง ไม่คำนวณเลขบรรทัด)
+         * @param fn callback ของแต่ละตำแหน่ง ถูกเรียกตามลำดับ path และ offset ใน thread ที่เรียก
+         * @param ctx pointer ที่ส่งต่อให้ callback
+         * @return จำนวนตำแหน่งที่ส่งให้ callback หรือ -1 ถ้า parameter ผิดหรือ memory ไม่พอ
+         *
+         * scan buffer ของไฟล์ตรง ๆ โดยแบ่งเป็นช่วงละ 1MB ให้หลาย thread (ไฟล์ใหญ่ไฟล์เดียวก็กระจายได้)
+         * นับตำแหน่งที่ซ้อนกันด้วย ("aa" ใน "aaa" = 2 ตำแหน่ง)
+         * ไฟล์ถูก read lock ตั้งแต่เริ่มค้นจนส่งผลของไฟล์นั้นครบ - callback ห้าม write หรือ rm ไฟล์ที่ได้รับ
+         *
+         * ตัวอย่างการใช้งาน:
+         * mountkit_grep_fn print = [](void *ctx, const char *path, MyFile *file, size_t offset, size_t line) {
+         *     printf("%s:%zu (offset %zu)\n", path, line, offset);
+         *     return 1;
+         * };
+         * mount.grep(cd(root, "root/var/log"), "timeout", MOUNTKIT_GREP_LINES, print, NULL);
+         */
+        int grep(MyFolder *root, const char *needle, int flags, mountkit_grep_fn fn, void *ctx = NULL);
+        
+        /**
+         * @brief จัดเรียง subtree ใหม่ให้อยู่ในหน่วยความจำต่อเนื่องตามลำดับการเดิน tree
+         * @param root pointer ไปยัง pointer ของ folder ที่ต้องการ compact (จะถูกเปลี่ยนเป็นตำแหน่งใหม่)
+         * @param report ถ้าไม่ใช่ NULL จะได้สถิติ fragmentation และเวลาเดิน tree ก่อน/หลัง
+         * @return 1 ถ้าสำเร็จ, 0 ถ้า memory ไม่พอ (tree เดิมไม่ถูกแก้ไข)
+         * 
+         * node, ชื่อ และ data ขนาดเล็กถูกย้ายเข้า arena, data ขนาดใหญ่ถูกตัด slack ออก
+         * pointer ของ MyFolder/MyFile ใน subtree ที่ถือไว้ก่อนหน้าจะใช้ไม่ได้อีก
+         * (tree ที่ mount ไว้ข้างในจะไม่ถูกย้าย)
+         * 
+         * ตัวอย่างการใช้งาน:
+         * MyCompactReport rep;
+         * mount.compact(&root, &rep);
+         * printf("walk: %.3f -> %.3f ms\n", rep.walk_ms_before, rep.walk_ms_after);
+         */
+        int compact(MyFolder **root, MyCompactReport *report = NULL);
+        
+        /**
+         * @brief เริ่มต้น overlay บน lower tree ที่แชร์กัน (สร้าง upper root ว่าง)
+         * @param ov overlay ที่ต้องการเริ่มต้น
+         * @param lower root ของ tree ที่ใช้เป็นฐาน (จะไม่ถูกแก้ไข)
+         * @return 1 ถ้าสำเร็จ, 0 ถ้าไม่สำเร็จ
+         * 
+         * ตัวอย่างการใช้งาน:
+         * MyOverlay worker;
+         * mount.overlay_init(&worker, base_root);
+         */
+        int overlay_init(MyOverlay *ov, MyFolder *lower);
+        
+        /**
+         * @brief คืนหน่วยความจำของ upper tree (lower ไม่ถูกลบ)
+         * @param ov overlay ที่ต้องการคืนหน่วยความจำ
+         * 
+         * ตัวอย่างการใช้งาน:
+         * mount.overlay_release(&worker);
+         */
+        void overlay_release(MyOverlay *ov);
+        
+        /**
+         * @brief หา directory ผ่าน overlay (upper ก่อน แล้วตกไป lower)
+         * @param ov overlay
+         * @param path path ของ directory
+         * @return folder ของ layer บนสุดที่มี path นี้ หรือ NULL ถ้าไม่พบ/ถูก whiteout
+         *         (folder ที่ได้จาก lower เป็น read-only ห้ามแก้ไขโดยตรง)
+         * 
+         * ตัวอย่างการใช้งาน:
+         * MyFolder *etc = mount.overlay_cd(&worker, "etc");
+         */
+        MyFolder* overlay_cd(MyOverlay *ov, const char *path);
+        
+        /**
+         * @brief สร้าง directory ใน upper (ถ้าสร้างทับ whiteout จะเป็น opaque ไม่เห็น lower)
+         * @param ov overlay
+         * @param path path ของ directory
+         * @return folder ใน upper หรือ NULL ถ้าไม่สำเร็จ
+         * 
+         * ตัวอย่างการใช้งาน:
+         * MyFolder *cache = mount.overlay_mkdir(&worker, "var/cache/app");
+         */
+        MyFolder* overlay_mkdir(MyOverlay *ov, const char *path);
+        
+        /**
+         * @brief หาไฟล์ผ่าน overlay โดยไม่ copy-up (สำหรับอ่านเท่านั้น)
+         * @param ov overlay
+         * @param path path ของไฟล์ (เช่น "etc/passwd")
+         * @return pointer ไปยังไฟล์ใน layer บนสุด หรือ NULL ถ้าไม่พบ/ถูก whiteout
+         * 
+         * ตัวอย่างการใช้งาน:
+         * MyFile *passwd = mount.overlay_lookup(&worker, "etc/passwd");
+         */
+        MyFile* overlay_lookup(MyOverlay *ov, const char *path);
+        
+        /**
+         * @brief อ่านไฟล์ผ่าน overlay
+         * @param ov overlay
+         * @param path path ของไฟล์
+         * @param buffer buffer สำหรับเก็บข้อมูล
+         * @param size จำนวน bytes ที่ต้องการอ่าน
+         * @param offset ตำแหน่งเริ่มต้นในไฟล์ (default: 0)
+         * @return จำนวน bytes ที่อ่านได้จริง
+         * 
+         * ตัวอย่างการใช้งาน:
+         * int n = mount.overlay_read(&worker, "etc/hosts", buffer, sizeof(buffer));
+         */
+        int overlay_read(MyOverlay *ov, const char *path, uint8_t *buffer, size_t size, size_t offset = 0);
+        
+        /**
+         * @brief เปิดไฟล์สำหรับเขียนผ่าน overlay (copy-up จาก lower ถ้าจำเป็น)
+         * @param ov overlay
+         * @param path path ของไฟล์
+         * @return pointer ไปยังไฟล์ใน upper (ใช้กับ write/append ได้) หรือ NULL ถ้าไม่สำเร็จ
+         * 
+         * ตัวอย่างการใช้งาน:
+         * MyFile *hosts = mount.overlay_mk(&worker, "etc/hosts");
+         * mount.append(hosts, "10.0.0.5\tworker5\n");
+         */
+        MyFile* overlay_mk(MyOverlay *ov, const char *path);
+        
+        /**
+         * @brief ลบไฟล์ผ่าน overlay (บันทึก whiteout ถ้าไฟล์มีอยู่ใน lower)
+         * @param ov overlay
+         * @param path path ของไฟล์
+         * @return 1 ถ้าสำเร็จ, 0 ถ้าไม่พบไฟล์
+         * 
+         * ตัวอย่างการใช้งาน:
+         * mount.overlay_rm(&worker, "etc/motd");
+         */
+        int overlay_rm(MyOverlay *ov, const char *path);
+        
+        /**
+         * @brief ลบ directory ผ่าน overlay (บันทึก whiteout ถ้า directory มีอยู่ใน lower)
+         * @param ov overlay
+         * @param path path ของ directory
+         * @return 1 ถ้าสำเร็จ, 0 ถ้าไม่พบ directory
+         * 
+         * ตัวอย่างการใช้งาน:
+         * mount.overlay_rmdir(&worker, "usr/share/doc");
+         */
+        int overlay_rmdir(MyOverlay *ov, const char *path);
+        
+        /**
+         * @brief เปิด/ปิด concurrent mode - ใช้ reader-writer lock ต่อ folder และต่อไฟล์
+         * @param enable true = thread-safe, false = ไม่มี lock (ค่าเริ่มต้น)
+         * 
+         * การเดิน path ใช้ lock แบบ hand-over-hand (ล็อกลูกก่อนปล่อย parent) ทำให้
+         * operation บน subtree ที่ไม่ทับกันทำงานขนานกันได้ ทุก thread ต้องใช้ mountkit
+         * instance เดียวกันและส่ง root variable ตัวเดียวกันให้ mkdir/rmdir
+         * ต้องเรียกก่อนเริ่มใช้งานจากหลาย thread
+         * 
+         * ยังไม่ thread-safe: pwd, mount/umount, tar_*, overlay_*, compact, verify
+         * และ pointer ที่ได้จาก cd/mk จะใช้ไม่ได้ถ้า thread อื่น rm/rmdir ไปแล้ว
+         * 
+         * ตัวอย่างการใช้งาน:
+         * mount.set_concurrent(true);
+         * // แต่ละ thread: mount.append(mount.mk(mount.cd(root, "var/log"), "app.log"), "ok\n");
+         */
+        void set_concurrent(bool enable);
+        
+        /**
+         * @brief benchmark หลาย thread ผสม cd/mk/read/append เทียบ global mutex กับ lock ต่อ folder
+         * @param max_threads จำนวน thread สูงสุด (วัดที่ 1, 2, 4, ... จนถึงค่านี้)
+         * @param ops_per_thread จำนวน operation ต่อ thread ในแต่ละรอบ
+         * @return 1 ถ้าสำเร็จ, 0 ถ้า memory ไม่พอ
+         * 
+         * ตัวอย่างการใช้งาน:
+         * mount.concurrent_benchmark(32, 200000);
+         */
+        int concurrent_benchmark(int max_threads, int ops_per_thread);
+        
+        /**
+         * @brief เปิด/ปิด lock-free read mode (RCU) - cd, การค้นชื่อใน mk และ read ไม่ถือ lock
+         * @param enable true = reader ไม่ทำ atomic read-modify-write เลย (เปิด concurrent mode ให้ด้วย - async_close คืน mode เดิม)
+         * 
+         * writer ยังใช้ lock ต่อ folder/ไฟล์ระหว่างกันเอง แต่ publish link และ data buffer ใหม่
+         * ด้วย release store แทนการแก้ในที่เดิม node และ buffer ที่ rm, rmdir, write และ append
+         * ปลดออกจะรอจนผ่าน grace period (reader ทุกตัวที่อาจเห็นออกไปแล้ว) ก่อนถูก free
+         * การปิดจะเรียก synchronize() ให้ - ต้องเรียกตอนไม่มี thread อื่นใช้งานอยู่
+         * 
+         * ตัวอย่างการใช้งาน:
+         * mount.set_lockfree_reads(true);
+         * // ... หลาย thread cd/read พร้อมกับ writer ...
+         * mount.set_lockfree_reads(false);
+         */
+        void set_lockfree_reads(bool enable);
+        
+        /**
+         * @brief รอ grace period แล้วคืนหน่วยความจำที่ถูก retire ทั้งหมด
+         * 
+         * ห้ามเรียกจาก thread ที่กำลังอยู่ใน read-side section (จะรอตัวเองไม่จบ)
+         * 
+         * ตัวอย่างการใช้งาน:
+         * mount.rmdir(&root, "root/tmp/cache");
+         * mount.synchronize(); // หน่วยความจำของ tmp/cache ถูกคืนแล้ว
+         */
+        void synchronize();
+        
+        /**
+         * @brief เปิด/ปิด safe handle mode - MyFile* และ MyFolder* ที่ถืออยู่ใน guard ไม่ถูก free ระหว่างใช้งาน
+         * @param enable true = rm และ rmdir ส่ง node ไปรอ grace period แทนการ free ทันที (เปิด concurrent mode ให้ด้วย)
+         * 
+         * การปิดจะเรียก synchronize() ให้ - ต้องเรียกตอนไม่มี thread อื่นใช้งานอยู่
+         * lock-free read mode มีพฤติกรรมนี้อยู่แล้ว (compact ยังแทนที่ node ทั้ง subtree - handle เดิมใช้ไม่ได้)
+         * 
+         * ตัวอย่างการใช้งาน:
+         * mount.set_safe_handles(true);
+         */
+        void set_safe_handles(bool enable);
+        
+        /**
+         * @brief เข้า/ออก guard ของ thread ที่เรียก - handle ที่ได้มาหลัง guard_enter ใช้ได้จนถึง guard_leave
+         * 
+         * ภายใน guard thread อื่น rm/rmdir node ได้ตามปกติ (node หายจาก tree ทันที) แต่หน่วยความจำ
+         * ถูกคืนหลังทุก thread ที่เข้า guard ก่อนหน้านั้นออกไปแล้วเท่านั้น - operation บน handle ที่ถูกลบ
+         * ไปแล้วยังทำงานได้ (เหมือนไฟล์ที่ถูก unlink) แทนที่จะเป็น use-after-free
+         * การเข้า/ออกเป็น store ลง slot ของ thread เอง ไม่มี lock ร่วม ซ้อนกันได้
+         * ต้องเปิด set_safe_handles หรือ set_lockfree_reads และห้ามเรียก synchronize ภายใน guard
+         * 
+         * ตัวอย่างการใช้งาน:
+         * mount.guard_enter();
+         * MyFile *log = mount.mk(mount.cd(root, "var/log"), "app.log");
+         * mount.append(log, "started\n");   // thread อื่น rmdir var/log ได้พร้อมกัน
+         * mount.guard_leave();
+         */
+        void guard_enter();
+        void guard_leave();
+        
+        /**
+         * @brief append แบบหลาย producer โดยไม่ถือ lock - สำหรับ log ที่หลาย thread เขียนต่อท้ายพร้อมกัน
+         * @param file ไฟล์ปลายทาง
+         * @param data ข้อมูลที่จะเขียนต่อท้าย
+         * @param size ขนาดข้อมูล (bytes)
+         * @return 1 ถ้าสำเร็จ, 0 ถ้า parameter ไม่ถูกต้อง (EINVAL) หรือการขยาย buffer ที่ช่วงนี้ต้องใช้เกิน quota (EDQUOT)
+         * - ทั้งสองกรณีไม่มีการจองใด ๆ
+         * 
+         * producer จองช่วง byte ด้วย CAS บน reserved แล้ว copy ขนานกัน
+         * (quota ถูกตรวจกับช่วงที่จองได้จริง - ถ้า CAS แพ้ producer อื่นจะตรวจใหม่ก่อนจองอีกครั้ง)
+         * bytes ถูก commit (reader มองเห็น) ตามลำดับการจอง reader จึงเห็นเฉพาะข้อมูลที่เขียนครบแล้ว
+         * เมื่อ buffer เต็ม producer ที่ถึงคิวก่อนจะขยายให้ครอบทุกช่วงที่จองไว้แล้ว
+         * การ commit ต้องรอ producer ก่อนหน้า copy เสร็จ ถ้า thread มากกว่าจำนวน core
+         * producer ที่ถูก preempt จะทำให้ตัวที่จองต่อจากมันรอไปด้วย
+         * ต้องเปิด concurrent mode ถ้ามีหลาย thread และระหว่างที่มี producer อยู่
+         * ห้าม write/append/rm ไฟล์เดียวกันจาก thread อื่น
+         * 
+         * ตัวอย่างการใช้งาน:
+         * MyFile *log = mount.mk(mount.cd(root, "var/log"), "syslog");
+         * // แต่ละ thread: mount.append_shared(log, (const uint8_t*)"boot ok\n", 8);
+         */
+        int append_shared(MyFile *file, const uint8_t *data, size_t size);
+        
+        /**
+         * @brief benchmark throughput ของ append ไฟล์เดียวจากหลาย thread เทียบ append (lock) กับ append_shared
+         * @param max_threads จำนวน thread สูงสุด (วัดที่ 1, 2, 4, ... จนถึงค่านี้)
+         * @param appends_per_thread จำนวน record ที่แต่ละ thread append ในแต่ละรอบ
+         * @return 1 ถ้าสำเร็จ, 0 ถ้า memory ไม่พอหรือขนาดไฟล์ผิด
+         * 
+         * ตัวอย่างการใช้งาน:
+         * mount.append_benchmark(16, 100000);
+         */
+        int append_benchmark(int max_threads, int appends_per_thread);
+        
+        /**
+         * @brief เปิด/ปิด traversal แบบขนานของ removeFolder และ PrintAllPath
+         * @param threads จำนวน thread ทั้งหมดรวม thread ที่เรียก (<= 1 = ทำทีละ thread แบบเดิม)
+         * @param threshold จำนวน folder ที่ task ต้องเดินครบก่อนจะแบ่ง subdirectory ที่เหลือให้ worker อื่น
+         * 
+         * งานถูกแบ่งที่ขอบ subdirectory เมื่อมี worker ว่างเท่านั้น tree ที่เล็กกว่า threshold
+         * จึงทำจบใน thread ที่เรียก PrintAllPath ยังพิมพ์ตามลำดับเดิม (เก็บ output ไว้พิมพ์ตอนจบ)
+         * เมื่อเปิด concurrent mode จะทำ PrintAllPath ทีละ thread เหมือนเดิม
+         * ต้องเรียกตอนไม่มี traversal ทำงานอยู่
+         * 
+         * ตัวอย่างการใช้งาน:
+         * mount.set_parallel(8);
+         * mount.removeFolder(huge_tree); // ลบด้วย 8 thread
+         * mount.set_parallel(0);
+         */
+        void set_parallel(int threads, size_t threshold = 4096);
+        
+        /**
+         * @brief benchmark การเดินรวม capacity ทุก folder และ removeFolder บน tree ขนาดใหญ่ที่ 1, 2, 4, ... thread
+         * @param max_threads จำนวน thread สูงสุด
+         * @param folders จำนวน folder ใน tree ทดสอบ (แต่ละ folder มี 2 ไฟล์)
+         * @return 1 ถ้าสำเร็จ, 0 ถ้า memory ไม่พอหรือผลไม่ตรงกับแบบ sequential / calculateFolderCapacity
+         * 
+         * ตัวอย่างการใช้งาน:
+         * mount.parallel_benchmark(16, 1000000);
+         */
+        int parallel_benchmark(int max_threads, int folders);
+        
+        /**
+         * @brief benchmark find (prefix และ pruning) เทียบกับการเดินทุก node แล้วจับคู่ path เต็ม
+         * @param nodes จำนวน node ใน tree ทดสอบ (folder ละ 2 ไฟล์, 8 subdirectory)
+         * @return 1 ถ้าสำเร็จ, 0 ถ้า memory ไม่พอหรือจำนวน match ไม่ตรงกัน
+         * 
+         * ตัวอย่างการใช้งาน:
+         * mount.find_benchmark(10000000);
+         */
+        int find_benchmark(size_t nodes);
+        
+        /**
+         * @brief สร้าง executor สำหรับ operation แบบ async (เปิด concurrent mode ให้ด้วย)
+         * @param threads จำนวน worker thread
+         * @param max_in_flight จำนวน operation สูงสุดที่ยังไม่จบ (รวม callback ที่ยังไม่ถูก poll)
+         * @return handle สำหรับ async_*, NULL ถ้า memory ไม่พอ
+         * 
+         * ทุก async_* คืน std::future<int> และรับ callback (optional) ที่จะถูกเรียกใน async_poll
+         * - ไม่มี callback: รอ (block) ถ้า in-flight เต็ม แล้วใช้ผลจาก future
+         * - มี callback: ไม่ block เลย ถ้า in-flight เต็มจะคืน future ที่ valid() == false
+         *   และ callback จะไม่ถูกเรียก (event loop ควรลองใหม่หลัง poll)
+         * thread ที่ poll ไม่ควรส่งงานแบบไม่มี callback เพราะอาจรอ callback ของตัวเองไม่จบ
+         * 
+         * ตัวอย่างการใช้งาน:
+         * MyAsync *io = mount.async_open(4, 128);
+         * std::future<int> done = mount.async_cp(io, big_dir, "disk.img", backup_dir);
+         * // ... ทำงานอื่น ...
+         * if (done.get()) printf("copied\n");
+         * mount.async_close(io);
+         */
+        MyAsync* async_open(int threads = 2, int max_in_flight = 64);
+        
+        /**
+         * @brief รอ operation ที่ค้างทั้งหมด เรียก callback ที่ยังไม่ถูก poll แล้วหยุด executor
+         * และคืน concurrent mode เป็นค่าก่อน async_open
+         * @param as handle จาก async_open
+         */
+        void async_close(MyAsync *as);
+        
+        /**
+         * @brief cp แบบ async
+         * @param as handle จาก async_open
+         * @param src_folder, filename, dst_folder เหมือน cp()
+         * @param done callback เมื่อเสร็จ (NULL = ใช้ future อย่างเดียว)
+         * @param ctx pointer ที่ส่งต่อให้ callback
+         * @return future ของผล cp(), valid() == false ถ้า in-flight เต็ม (กรณีมี callback)
+         * 
+         * ตัวอย่างการใช้งาน:
+         * mount.async_cp(io, src, "video.bin", dst, on_copied, &request);
+         */
+        std::future<int> async_cp(MyAsync *as, MyFolder *src_folder, const char *filename, MyFolder *dst_folder,
+                                  mountkit_done_fn done = NULL, void *ctx = NULL);
+        
+        /**
+         * @brief write แบบ async (data ต้องคงอยู่จนกว่า operation จะเสร็จ)
+         * 
+         * ตัวอย่างการใช้งาน:
+         * std::future<int> f = mount.async_write(io, file, blob, blob_size);
+         */
+        std::future<int> async_write(MyAsync *as, MyFile *file, const uint8_t *data, size_t size,
+                                     mountkit_done_fn done = NULL, void *ctx = NULL);
+        
+        /**
+         * @brief rmdir แบบ async (ลบทั้ง subtree บน executor)
+         * @return future ของผล: 1 = ลบแล้ว, 0 = rmdir fail (ENOENT, EBUSY, ...)
+         * 
+         * สาเหตุที่ fail ถูกเก็บไว้กับ completion - callback อ่านได้จาก lastError()
+         * 
+         * ตัวอย่างการใช้งาน:
+         * mount.async_rmdir(io, &root, "root/tmp/cache", on_removed, NULL);
+         */
+        std::future<int> async_rmdir(MyAsync *as, MyFolder **root, const char *path,
+                                     mountkit_done_fn done = NULL, void *ctx = NULL);
+        
+        /**
+         * @brief snapshot subtree เป็น tar ลง file descriptor แบบ async (tar_export_fd)
+         * 
+         * ตัวอย่างการใช้งาน:
+         * mount.async_tar_export_fd(io, etc_dir, snapshot_fd, on_snapshot, NULL);
+         */
+        std::future<int> async_tar_export_fd(MyAsync *as, MyFolder *folder, int fd,
+                                             mountkit_done_fn done = NULL, void *ctx = NULL);
+        
+        /**
+         * @brief โหลด tar จาก file descriptor แบบ async (tar_import_fd)
+         * 
+         * ตัวอย่างการใช้งาน:
+         * mount.async_tar_import_fd(io, restore_dir, archive_fd, on_restored, NULL);
+         */
+        std::future<int> async_tar_import_fd(MyAsync *as, MyFolder *folder, int fd,
+                                             mountkit_done_fn done = NULL, void *ctx = NULL);
+        
+        /**
+         * @brief เรียก callback ของ operation ที่เสร็จแล้วบน thread ที่เรียก (ไม่ block)
+         * @param as handle จาก async_open
+         * @param max_completions จำนวน callback สูงสุดที่จะเรียกในครั้งนี้ (0 = ทั้งหมด)
+         * @return จำนวน callback ที่ถูกเรียก
+         * 
+         * ก่อนเรียก callback ของ operation ที่ fail, lastError() ของ thread ที่ poll
+         * จะเป็น error code ที่ operation นั้นได้บน executor
+         * 
+         * ตัวอย่างการใช้งาน:
+         * while (running) { wait_for_events(); mount.async_poll(io); }
+         */
+        int async_poll(MyAsync *as, int max_completions = 0);
+        
+        /**
+         * @brief file descriptor ที่อ่านได้ (readable) เมื่อมี completion รอ async_poll
+         * @param as handle จาก async_open
+         * @return fd สำหรับ poll/epoll/select, -1 ถ้า platform ไม่รองรับ
+         * 
+         * ตัวอย่างการใช้งาน:
+         * struct pollfd pfd = { mount.async_fd(io), POLLIN, 0 };
+         * if (poll(&pfd, 1, 100) > 0) mount.async_poll(io);
+         */
+        int async_fd(MyAsync *as);
+        
+        /**
+         * @brief จำนวน operation ที่ยังไม่จบ (รวม callback ที่รอ poll)
+         */
+        int async_in_flight(MyAsync *as);
+        
+        /**
+         * @brief สร้าง namespace ที่แบ่งไปยัง mountkit instance อิสระ count ตัวตาม hash ของ path
+         * @param count จำนวน shard
+         * @param depth จำนวน component แรกของ path ที่ใช้เป็น key (ค่าเริ่มต้น 1 = แบ่งตาม top-level dir)
+         * @return handle สำหรับ shards_* หรือ NULL ถ้า memory ไม่พอ
+         * 
+         * path ของ shards_* เริ่มจาก root ของ namespace (เช่น "var/log/syslog")
+         * entry ที่ path ยาวอย่างน้อย depth component อยู่ใน shard เดียวพร้อมทั้ง subtree
+         * ส่วน folder ที่ตื้นกว่า depth (รวม root) มีได้ในหลาย shard และถูกรวมกันตอน enumerate
+         * แต่ละ shard มี lock, retired list และ pool ของตัวเอง - thread ที่ทำงานคนละ shard ไม่แย่ง lock กันเลย
+         * shard รับ concurrent/lock-free read mode ของ instance ที่เปิดไว้ตอนเรียก
+         * 
+         * ตัวอย่างการใช้งาน:
+         * MyShards *ns = mount.shards_open(8);
+         * MyFile *log = mount.shards_mk(ns, "var/log/syslog");
+         * mount.shards_instance(ns, "var/log/syslog")->append(log, "boot\n");
+         * printf("%zu\n", mount.shards_capacity(ns, ""));
+         * mount.shards_close(ns);
+         */
+        MyShards* shards_open(int count, int depth = 1);
+        
+        /**
+         * @brief คืนทุก shard และ tree ของมัน
+         */
+        void shards_close(MyShards *shards);
+        
+        /**
+         * @brief instance ที่เป็นเจ้าของ entry ที่ path - ใช้เรียก operation บน MyFile/MyFolder ที่ได้จาก shards_*
+         */
+        mountkit* shards_instance(MyShards *shards, const char *path);
+        
+        /**
+         * @brief mkdir / cd / mk / rm / rmdir บน shard ที่เป็นเจ้าของ path
+         * @return เหมือน operation เดิม (shards_cd ของ folder ที่ตื้นกว่า depth คืน copy ใน shard ใดก็ได้)
+         * 
+         * shards_mk สร้าง folder ที่ตื้นกว่า depth ที่ขาดอยู่ใน shard เจ้าของให้เอง
+         * shards_rmdir ของ folder ที่ตื้นกว่า depth ลบออกจากทุก shard
+         */
+        MyFolder* shards_mkdir(MyShards *shards, const char *path);
+        MyFolder* shards_cd(MyShards *shards, const char *path);
+        MyFile* shards_mk(MyShards *shards, const char *path);
+        int shards_rm(MyShards *shards, const char *path);
+        void shards_rmdir(MyShards *shards, const char *path);
+        
+        /**
+         * @brief PrintAllPath ของทั้ง namespace - folder ที่อยู่หลาย shard แสดงครั้งเดียว (เรียงตามชื่อ)
+         */
+        void shards_print(MyShards *shards);
+        
+        /**
+         * @brief calculateFolderCapacity ของ path โดยรวมทุก shard (node ของ folder ที่อยู่หลาย shard นับครั้งเดียว)
+         */
+        size_t shards_capacity(MyShards *shards, const char *path, bool include_subdirs = true);
+        
+        /**
+         * @brief subscribe การเปลี่ยนแปลงของ folder หรือไฟล์ (คล้าย inotify)
+         * @param folder / file node ที่ต้องการติดตาม
+         * @param mask MOUNTKIT_WATCH_* ที่สนใจ
+         * @param capacity จำนวน event ที่ค้างใน queue ได้ (ปัดขึ้นเป็นกำลังของ 2)
+         * @return handle สำหรับ watch_poll / watch_wait / unwatch หรือ NULL ถ้า parameter ผิด/memory ไม่พอ
+         * 
+         * watch ของ folder ได้ CREATE / DELETE / MOVED_FROM / MOVED_TO ของ child โดยตรง
+         * watch ของไฟล์ได้ MODIFY ทุกครั้งที่ write/append (batch_commit ด้วย)
+         * ทั้งสองแบบได้ DELETE_SELF เมื่อ node ถูกลบ (รวมถูกลบพร้อม folder บรรพบุรุษ) แล้ว watch จะเงียบไป
+         * (ยังต้อง unwatch เพื่อคืน queue)
+         * compact ไม่นับเป็นการลบ - watch ย้ายไปอยู่กับ node ตัวใหม่โดยไม่มี event
+         * event ที่เหมือนกันและยังไม่ถูกอ่านจะถูกรวมเป็นรายการเดียว (count)
+         * เมื่อ queue เต็ม event ใหม่จะถูกทิ้งและผู้อ่านได้ MOUNTKIT_WATCH_OVERFLOW หนึ่งรายการแทน
+         * ผู้อ่านไม่แตะ lock ของ tree เลย - ไม่มี watch เลยก็ไม่มีต้นทุนกับ operation
+         * 
+         * ตัวอย่างการใช้งาน:
+         * MyWatch *w = mount.watch(mount.cd(root, "var/log"), MOUNTKIT_WATCH_CREATE | MOUNTKIT_WATCH_DELETE);
+         * MyWatchEvent ev[16];
+         * int n = mount.watch_wait(w, ev, 16, 1000);
+         * for (int i = 0; i < n; ++i) printf("%04x %s x%u\n", ev[i].mask, ev[i].name, ev[i].count);
+         * mount.unwatch(w);
+         */
+        MyWatch* watch(MyFolder *folder, uint32_t mask, size_t capacity = 256);
+        MyWatch* watch(MyFile *file, uint32_t mask, size_t capacity = 256);
+        
+        /**
+         * @brief ยกเลิก watch และคืน queue (ต้องไม่มี thread ใดกำลัง poll/wait อยู่)
+         * เรียกจาก thread ใดก็ได้ แม้ thread อื่นกำลังแก้ tree และไม่ได้เปิด concurrent mode
+         */
+        void unwatch(MyWatch *watch);
+        
+        /**
+         * @brief อ่าน event ที่ค้างอยู่โดยไม่รอ
+         * @param events buffer ของผู้เรียก
+         * @param max_events ขนาดของ buffer
+         * @return จำนวน event ที่อ่านได้ (0 = ไม่มี)
+         * 
+         * ผู้อ่านของ watch หนึ่งตัวต้องมีทีละ thread เดียว
+         */
+        int watch_poll(MyWatch *watch, MyWatchEvent *events, int max_events);
+        
+        /**
+         * @brief เหมือน watch_poll แต่ block จนมี event หรือหมดเวลา
+         * @param timeout_ms เวลารอสูงสุด (ms), -1 = รอจนกว่าจะมี event
+         * @return จำนวน event ที่อ่านได้ (0 = หมดเวลา)
+         */
+        int watch_wait(MyWatch *watch, MyWatchEvent *events, int max_events, int timeout_ms = -1);
+        
+        /**
+         * @brief หยุด worker ของ set_parallel (ถ้ามี) และคืน watch ที่ยังค้างอยู่
+         */
+        ~mountkit();
+        
     #endif
     
     // =================================================================
@@ -370,14 +1784,312 @@ private:
      */
     void removeFolder(MyFolder *folder);
     
+    /**
+     * @brief rmdir ที่บอกผล (rmdir และ async_rmdir ใช้ร่วมกัน)
+     * @return true ถ้าถอด folder ออกแล้ว, false ถ้า fail (สาเหตุอยู่ใน lastError())
+     */
+    bool rmdirPath(MyFolder **root, const char *path);
+    
     // Private members สำหรับ internal implementation
         /**
-     * @brief หา parent directory ของ folder ที่กำหนด
+     * @brief หา parent directory ของ folder ที่กำหนด (ข้าม mount point ได้)
      * @param root root directory สำหรับ search
      * @param target folder ที่ต้องการหา parent
+     * @param entry ถ้าไม่ใช่ NULL จะได้ entry ใน parent ที่ชี้ไปยัง target
+     *              (คือ mount point ถ้า target เป็น root ของ tree ที่ mount ไว้)
      * @return pointer ไปยัง parent folder หรือ NULL ถ้าไม่พบ
      */
-    MyFolder* findParent(MyFolder *root, MyFolder *target);
+    MyFolder* findParent(MyFolder *root, MyFolder *target, MyFolder **entry = NULL);
+    
+    /**
+     * @brief คืนหน่วยความจำของไฟล์หนึ่งไฟล์ (ทั้ง malloc ปกติและ compaction arena)
+     * @param file ไฟล์ที่ถูกถอดออกจาก directory แล้ว
+     */
+    void releaseFile(MyFile *file);
+    
+    /**
+     * @brief คืนหน่วยความจำของ node และชื่อของโฟลเดอร์ (ไม่รวมลูก)
+     * @param folder โฟลเดอร์ที่ถูกถอดออกจาก tree แล้ว
+     */
+    void releaseFolderNode(MyFolder *folder);
+    
+    /**
+     * @brief เปลี่ยน capacity ของ data ไฟล์ (ย้ายออกจาก arena ถ้าจำเป็น)
+     * @param file ไฟล์ที่ต้องการเปลี่ยนขนาด buffer
+     * @param new_capacity capacity ใหม่เป็น bytes
+     * @return 1 ถ้าสำเร็จ, 0 ถ้า memory ไม่พอ (ไฟล์ไม่ถูกแก้ไข)
+     */
+    int resizeData(MyFile *file, size_t new_capacity);
+    
+    /**
+     * @brief คืนหน่วยความจำของ tree เดิมหลัง compact (data ขนาดใหญ่ถูกโอนให้ copy แล้ว)
+     * @param folder tree เดิม
+     * @param copy tree ใหม่ที่มีโครงสร้างเดียวกัน
+     */
+    void compactRelease(MyFolder *folder, MyFolder *copy);
+    
+    /**
+     * @brief สร้าง MyFile ใหม่ที่ยังไม่อยู่ใน folder ใด (capacity เริ่มต้นตาม build)
+     * @param filename ชื่อไฟล์
+     * @param with_data false = ไม่จอง data (ชื่อของ hard link)
+     * @return ไฟล์ใหม่ หรือ NULL ถ้า memory ไม่พอ
+     */
+    MyFile* newFile(const char *filename, bool with_data = true);
+    
+    /**
+     * @brief ใส่ไฟล์เข้า folder (ถือ write lock ของ folder)
+     * @param folder folder ปลายทาง
+     * @param file ไฟล์ที่ยังไม่อยู่ใน folder ใด
+     * @param check_duplicate ค้นหาชื่อซ้ำก่อนใส่
+     * @return NULL ถ้าใส่สำเร็จ, หรือไฟล์ชื่อเดียวกันที่มีอยู่แล้ว (file ไม่ถูกใส่)
+     */
+    MyFile* linkFile(MyFolder *folder, MyFile *file, bool check_duplicate);
+    
+    /**
+     * @brief ใส่ไฟล์เข้า folder โดยผู้เรียกถือ write lock ของ folder อยู่แล้ว (ไม่ตรวจชื่อซ้ำ)
+     */
+    void linkFileLocked(MyFolder *folder, MyFile *file);
+    
+    /**
+     * @brief บันทึก error ของ thread ที่เรียก (เรียกเฉพาะตอน fail)
+     * @param code MOUNTKIT_E*
+     */
+    void setError(int code);
+    
+    /**
+     * @brief reader-writer lock บน lock word ของ node (ไม่ทำอะไรถ้าไม่ได้เปิด concurrent mode)
+     * @param word &folder->lock, &file->lock หรือ &root_lock
+     */
+    void readLock(uint32_t *word);
+    void readUnlock(uint32_t *word);
+    void writeLock(uint32_t *word);
+    void writeUnlock(uint32_t *word);
+    
+    /**
+     * @brief write lock ของสอง node พร้อมกัน (mv) - ปลดด้วย writeUnlock ทีละตัว
+     */
+    void writeLockPair(uint32_t *first, uint32_t *second);
+    
+    /**
+     * @brief read lock ของ path lookup (cd, mk, read) - ข้ามไปเมื่อเปิด lock-free read mode
+     */
+    void lookupLock(uint32_t *word);
+    void lookupUnlock(uint32_t *word);
+    
+    /**
+     * @brief เข้า/ออก read-side section ของ lock-free read mode (ซ้อนกันได้, no-op ถ้าไม่ได้เปิด)
+     */
+    void rcuEnter();
+    void rcuLeave();
+    
+    /**
+     * @brief เปลี่ยน data buffer ของไฟล์ (ถือ write lock ของไฟล์) แล้ว retire buffer เดิม
+     * @param file ไฟล์
+     * @param data buffer ใหม่ (malloc) ที่เตรียมข้อมูลไว้แล้ว
+     * @param capacity ขนาดของ buffer ใหม่
+     * @param size ขนาดข้อมูลใหม่
+     */
+    void swapData(MyFile *file, uint8_t *data, size_t capacity, size_t size);
+    
+    /**
+     * @brief ส่งหน่วยความจำที่ถูกถอดออกจาก tree แล้วไปรอ grace period
+     * @param ptr MyFile*, MyFolder* (ทั้ง subtree) หรือ data buffer
+     * @param kind ชนิดของ ptr (MOUNTKIT_RETIRE_*)
+     */
+    void retire(void *ptr, int kind);
+    
+    /**
+     * @brief คืนหน่วยความจำที่ผ่าน grace period แล้ว
+     * @param wait true = รอจนคืนได้ครบทุกรายการ
+     */
+    void reclaim(bool wait);
+    
+    /**
+     * @brief คืนหน่วยความจำหนึ่งรายการที่ผ่าน grace period แล้ว
+     * @param ptr ตัวที่ถูก retire
+     * @param kind ชนิดของ ptr (MOUNTKIT_RETIRE_*)
+     */
+    void releaseRetired(void *ptr, int kind);
+    
+    /**
+     * @brief คืน data buffer ตามที่มาของหน่วยความจำ (malloc ปกติหรือ compaction arena)
+     */
+    void releaseData(uint8_t *data, bool in_arena);
+    
+    /**
+     * @brief เดิน tree บน work-stealing pool (ผู้เรียกทำ task แรกเองแล้วช่วยขโมยงานจนจบ, ไม่มี pool = เดินใน thread ที่เรียก)
+     * @param kind MOUNTKIT_WALK_*
+     * @param folder folder เริ่มต้น
+     * @param prefix path ของ parent (MOUNTKIT_WALK_PRINT)
+     * @return capacity รวม (MOUNTKIT_WALK_CAPACITY), 0 สำหรับแบบอื่น
+     */
+    size_t parallelWalk(int kind, MyFolder *folder, const char *prefix);
+    
+    /**
+     * @brief capacity ของ folder เดียวโดยไล่ไฟล์จริง (ไม่ใช้ยอดที่เก็บไว้) - ใช้ตรวจยอดรวมเทียบกับ tree
+     */
+    size_t scanCapacity(MyFolder *folder);
+    
+    /**
+     * @brief ทำ task หนึ่งตัว: DFS บน stack ของตัวเองและแบ่ง entry ล่างสุดออกเมื่อมี worker ว่าง
+     */
+    void walkRun(MyWalkTask *task);
+    
+    /**
+     * @brief loop ของ worker thread / หยิบ task จาก queue ของตัวเองหรือขโมยจาก queue อื่น / ใส่ task ลง queue
+     * @param index index ของ queue (worker 0..n-1, n = thread ภายนอก)
+     */
+    void poolWorker(int index);
+    MyWalkTask* poolTake(int index);
+    void poolPush(int index, MyWalkTask *task);
+    
+    /**
+     * @brief ขั้นตอนของ batch_commit
+     * batchPrepare: เดิน path ของแต่ละกลุ่ม, ถือ lock และเตรียม folder/ไฟล์/buffer ใหม่นอก tree
+     * batchStage: เตรียม operation ของกลุ่มที่ parent เดียวกัน
+     * batchQuota: ตรวจ quota กับยอดรวมที่ทั้ง batch จะเพิ่ม (ก่อนจอง buffer ของไฟล์ที่มีอยู่แล้ว)
+     * batchApply: link ของที่เตรียมไว้เข้า tree (fail ไม่ได้)
+     * batchRelease: ปล่อย lock ทั้งหมด และคืนของที่เตรียมไว้ถ้า discard
+     */
+    int batchPrepare(MyBatchCommit *commit);
+    int batchStage(MyBatchCommit *commit, int target, size_t first, size_t count);
+    int batchQuota(MyBatchCommit *commit);
+    void batchApply(MyBatchCommit *commit);
+    void batchRelease(MyBatchCommit *commit, bool discard);
+    
+    /**
+     * @brief ส่ง event ไปยัง watch ของ node (ไม่ทำอะไรถ้าไม่มี watch เลย, no-op บน embedded)
+     * @param node folder หรือไฟล์ที่เกิด event
+     * @param mask MOUNTKIT_WATCH_*
+     * @param name ชื่อ child ที่เกี่ยวข้อง (NULL = event ของ node เอง)
+     */
+    void notify(const void *node, uint32_t mask, const char *name);
+    
+    /**
+     * @brief สร้าง watch ของ folder หรือไฟล์แล้วใส่เข้า watch list
+     */
+    MyWatch* watchNode(const void *node, uint32_t mask, size_t capacity);
+    
+    /**
+     * @brief ส่ง DELETE_SELF ให้ watch ของไฟล์ หรือของ folder และทุก node ใน subtree ที่ถูกถอดออกแล้ว
+     */
+    void notifyGone(MyFolder *folder, MyFile *file);
+    
+    /**
+     * @brief ย้าย watch ของ node เดิมไปยัง copy (compact แทนที่ node โดยที่ tree ไม่ได้เปลี่ยน)
+     */
+    void watchRetarget(const void *from, const void *to);
+    
+    /**
+     * @brief แก้ ordered index ของ folder (ถ้ามี) เมื่อ child หรือ file ถูก link/unlink - ผู้เรียกถือ write lock ของ folder
+     */
+    void indexInsert(MyFolder *folder, MyFolder *child, MyFile *file);
+    void indexRemove(MyFolder *folder, MyFolder *child, MyFile *file);
+    
+    /**
+     * @brief คืนหน่วยความจำของ index (folder ถูกถอดออกจาก tree แล้ว หรือผู้เรียกถือ write lock)
+     */
+    void indexRelease(MyFolder *folder);
+    
+    /**
+     * @brief mkdir จาก chain *root ของ parent (NULL = root chain ของ tree)
+     */
+    MyFolder* mkdirWalk(MyFolder **root, MyFolder *parent, const char *path);
+
+    /**
+     * @brief เดิน path ถึง folder ของ component สุดท้าย (*leaf ชี้ใน buf, NULL ถ้า path ชี้ folder)
+     * @param linked path มาจาก target ของ symlink (ยอมให้มี "." และ "..")
+     * @return folder ที่ถือ lookup lock ไว้ พร้อม lookup lock ของ parent (*outer) - ปล่อยด้วย pathRelease
+     */
+    MyFolder* pathWalk(MyFolder *root, const char *path, char *buf, size_t buf_size, char **leaf, MyFolder **outer, bool parents, bool linked = false);
+    void pathRelease(MyFolder *folder, MyFolder *outer);
+
+    /**
+     * @brief ไฟล์ที่ path ชี้ (สร้างถ้า create) พร้อม lock ของ pathWalk ใน *folder และ *outer
+     */
+    MyFile* pathFile(MyFolder *root, const char *path, bool create, bool parents, MyFolder **folder, MyFolder **outer);
+
+    /**
+     * @brief เดิน path แบบ cd (ตาม symlink, ".." ถอยตาม stack ของ folder จริง)
+     * @param hold_all ถือ lock ทุกระดับจนจบ (concurrent mode ที่ path มี "..")
+     * @param use_cache ใช้ folder ปลายทางที่จำไว้ใน symlink (false เมื่อเดินใหม่เพราะต้องการ stack ครบ)
+     * @param outer NULL = ปล่อย lock ทั้งหมด, ไม่งั้นคืนแบบ pathWalk (lookup lock ของ folder และ parent ค้างไว้)
+     */
+    MyFolder* cdWalk(MyFolder *root, const char *path, bool hold_all, bool use_cache, MyFolder **outer);
+
+    /**
+     * @brief hard link และ symlink (MountkitLink.cpp)
+     * linkFind: symlink ชื่อ name ใน folder (ผู้เรียกถือ lookup lock ของ folder)
+     * linkCached/linkRemember: folder ปลายทางที่จำไว้ใน symlink - ใช้ได้เมื่อไม่มี lock ให้ถือ (lock-free read หรือ thread เดียว)
+     * linkInvalidate: tree เปลี่ยนโครงสร้าง - ผลที่จำไว้ทั้งหมดหมดอายุ
+     * unlinkName: ชื่อถูกถอดออกจาก folder แล้ว (usageUnlink แล้ว) - คืน node ของชื่อ และไฟล์จริงเมื่อเป็นชื่อสุดท้าย
+     * linkEvacuate: subtree ถูกถอดออก - ไฟล์ที่ยังมีชื่ออยู่นอก subtree เลิกนับยอดเข้า folder ที่จะถูกคืน
+     */
+    MyFile* linkFind(MyFolder *folder, const char *name);
+    MyFolder* linkCached(MyFolder *root, MyFile *link);
+    void linkRemember(MyFolder *root, MyFile *link, MyFolder *folder, uint64_t gen);
+    uint64_t linkGeneration();
+    void linkInvalidate();
+    void unlinkName(MyFile *entry, bool locked);
+    void linkEvacuate(MyFolder *folder);
+
+    /**
+     * @brief แก้ยอดรวม (MyFolder::usage) ตาม parent chain
+     * usageAdd: บวก/ลบ delta ที่ folder และทุก ancestor
+     * usageResize: size/capacity ของไฟล์เปลี่ยน - ผู้เรียกถือ lock ของไฟล์ (หรือไฟล์ยังไม่ link)
+     * usageLink/usageUnlink: ไฟล์เข้า/ออกจาก folder - ผู้เรียกถือ write lock ของทั้ง folder และไฟล์
+     * usageAttach/usageDetach: subtree เข้า/ออกจาก subdir chain ของ parent - ผู้เรียกถือ write lock ของ parent
+     * usageRebuild: คำนวณใหม่ทั้ง subtree จาก tree จริง (tree ที่ต่อ link เอง เช่น compaction) - ยังไม่มีใครเห็น subtree
+     */
+    void usageAdd(MyFolder *folder, const MyUsage *delta, bool subtract);
+    void usageResize(MyFile *file, size_t old_size, size_t new_size, size_t old_capacity, size_t new_capacity);
+    void usageLink(MyFolder *folder, MyFile *file);
+    void usageUnlink(MyFile *file);
+    void usageAttach(MyFolder *parent, MyFolder *child);
+    void usageDetach(MyFolder *child);
+    void usageRebuild(MyFolder *folder);
+    
+    /**
+     * @brief ตรวจ quota ของ folder และทุก ancestor ก่อนเพิ่ม bytes (capacity) และ nodes เข้า subtree
+     * @param folder folder ที่ยอดจะถูกบวกเข้า (NULL = ไม่มีอะไรให้ตรวจ)
+     * @return 1 ถ้าไม่เกิน, 0 ถ้าเกิน (MOUNTKIT_EDQUOT พร้อมรายงาน)
+     */
+    int quotaCheck(MyFolder *folder, size_t bytes, size_t nodes);
+    
+    /**
+     * @brief quotaCheck ของหลายส่วนพร้อมกัน - ส่วนที่อยู่ใต้ quota เดียวกันถูกรวมกันก่อนตรวจ
+     * @param folders folder ที่แต่ละส่วนถูกบวกเข้า (NULL = ข้าม)
+     * @param adds capacity และ node ที่แต่ละส่วนขอเพิ่ม
+     */
+    int quotaCheckAll(MyFolder *const *folders, const MyQuota *adds, size_t count);
+
+    /**
+     * @brief metadata ของ node (MountkitMeta.cpp)
+     * metaInit: node ใหม่ - ino ถัดไป, เวลาปัจจุบัน และ mode เริ่มต้น
+     * metaTouch: node ถูกแก้ (modified = data หรือรายการลูกเปลี่ยน: mtime และ ctime, ไม่งั้นเฉพาะ ctime)
+     * ผู้เรียกถือ lock ของ node ที่กันการแก้แบบเดียวกันไว้แล้ว (field ถูกเขียนแบบ atomic ให้ stat อ่านได้ไม่ต้องรอ)
+     */
+    void metaInit(MyMeta *meta, uint16_t mode);
+    void metaTouch(MyMeta *meta, bool modified);
+    
+
+    bool concurrent = false;      // เปิดใช้ lock หรือไม่ (set_concurrent)
+    bool lockfree_reads = false;  // reader ไม่ถือ lock (set_lockfree_reads)
+    bool safe_handles = false;    // rm/rmdir คืนหน่วยความจำหลัง grace period (set_safe_handles)
+    uint32_t root_lock = 0;       // lock ของ sibling chain ที่ root variable ของ mkdir/rmdir ชี้อยู่
+    uint32_t retire_lock = 0;     // lock ของ retired list
+    MyRetired *retired = NULL;    // รายการที่รอ grace period
+    size_t retired_count = 0;
+    MyPool *pool = NULL;          // worker ของ set_parallel (NULL = traversal ทีละ thread)
+    uint32_t watch_lock = 0;      // lock ของ watch list (ถือเป็นลำดับสุดท้ายเสมอ หลัง lock ของ tree)
+    MyWatch *watches = NULL;      // watch ที่ยังใช้งานอยู่
+    uint64_t link_gen = 0;        // รุ่นของโครงสร้าง tree สำหรับผล resolve ของ symlink ที่จำไว้
+    size_t link_names = 0;        // จำนวนชื่อที่ ln สร้างและยังอยู่ (0 = ไม่ต้องดูแล hard link ตอน rmdir)
+#ifndef EMBEDDED_BUILD
+    uint64_t next_ino = 1;        // ino ของ node ถัดไป
+    mountkit_clock_fn clock_fn = NULL; // ที่มาของ tick จาก set_clock
+#endif
+    bool quotas = false;          // เคยมี quota_set (false = ข้ามการตรวจ quota ทั้งหมด)
 };
 
 #endif // __mountkit_H__
\ No newline at end of file
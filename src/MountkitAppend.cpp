@@ -0,0 +1,189 @@
+#include "MountkitInternal.h"
+
+// append หลาย producer แบบไม่ถือ lock: producer จองช่วง [offset, offset + size) ด้วย CAS
+// บน MyFile::reserved แล้ว copy ขนานกัน จากนั้น commit ตามลำดับการจองโดยเลื่อน MyFile::size
+// reader (read) อ่านถึง size เท่านั้น จึงไม่เห็นช่วงที่ยัง copy ไม่เสร็จ
+
+#ifndef EMBEDDED_BUILD
+
+#include <atomic>
+#include <thread>
+#include <chrono>
+
+#define APPEND_SPIN   64  // จำนวนรอบที่ spin ก่อนเริ่ม yield ระหว่างรอคิว
+#define APPEND_RECORD 64  // ขนาด record ของ append_benchmark (bytes)
+
+static inline void appendBackoff(int spin) {
+    if (spin >= APPEND_SPIN) std::this_thread::yield();
+}
+
+int mountkit::append_shared(MyFile *file, const uint8_t *data, size_t size) {
+    if (!file || !data || size == 0) {
+        #ifdef LIB_DEBUG
+            printf("Error: Invalid parameters\n");
+        #endif
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    if (file->link) file = file->link; // hard link: append ลงไฟล์จริง
+    if (file->kind == MOUNTKIT_DT_LINK) {
+        setError(MOUNTKIT_EINVAL); // data ของ symlink คือ target
+        return 0;
+    }
+
+    std::atomic<size_t> *reserved = sharedField(&file->reserved);
+    std::atomic<size_t> *committed = sharedField(&file->size);
+    std::atomic<size_t> *capacity = sharedField(&file->capacity);
+
+    // quota ตรวจก่อนจอง เพราะช่วงที่จองแล้วยกเลิกไม่ได้ - จองด้วย CAS เพื่อให้ end ที่ตรวจคือ end ที่ได้จริง
+    // การขยายที่ตรวจคือการขยายที่ producer ผู้ถึงคิวจะทำให้ end นี้ (capacity ปัจจุบันคูณสองจนครอบ)
+    size_t offset = reserved->load(std::memory_order_relaxed);
+    size_t end;
+    for (;;) {
+        end = offset + size;
+        size_t current = capacity->load(std::memory_order_acquire);
+        if (end > current) {
+            size_t grown = current;
+            while (grown < end) {
+                grown *= 2;
+            }
+            readLock(&file->lock); // folder ของไฟล์เปลี่ยนภายใต้ lock ของไฟล์ (mv/rm)
+            int allowed = quotaCheck(file->folder, grown - current, 0);
+            readUnlock(&file->lock);
+            if (!allowed) return 0;
+        }
+        if (reserved->compare_exchange_weak(offset, end, std::memory_order_relaxed)) break;
+    }
+
+    // ช่วงที่จองอยู่ใน buffer ปัจจุบัน: copy ได้ทันที
+    // ช่วงที่เกิน: รอจนทุกช่วงก่อนหน้า commit (ไม่มีใครเขียน buffer เดิมอยู่แล้ว)
+    // แล้วขยายครั้งเดียวให้ครอบทุกช่วงที่จองไว้ producer ถัดไปที่รอ capacity อยู่ก็ไปต่อได้เลย
+    for (int spin = 0; end > capacity->load(std::memory_order_acquire); ++spin) {
+        if (committed->load(std::memory_order_acquire) != offset) {
+            appendBackoff(spin);
+            continue;
+        }
+        // ครอบถึง end ล่าสุดที่จองไว้ - producer ที่จอง end นั้นตรวจ quota ของการขยายขนาดนี้ไว้แล้ว
+        size_t target = reserved->load(std::memory_order_relaxed);
+        size_t new_capacity = file->capacity;
+        while (new_capacity < target) {
+            new_capacity *= 2;
+        }
+        writeLock(&file->lock); // กัน reader ที่ถือ lock ระหว่างย้าย buffer
+        int grown = resizeData(file, new_capacity);
+        writeUnlock(&file->lock);
+        if (!grown) {
+            // ช่วงที่จองแล้วยกเลิกไม่ได้ (producer ถัดไปรอคิวนี้อยู่) - รอ memory แล้วลองใหม่
+            #ifdef LIB_DEBUG
+                printf("Error: Failed to reallocate memory for %zu bytes, retrying\n", new_capacity);
+            #endif
+            std::this_thread::yield();
+        }
+    }
+
+    memcpy(sharedField(&file->data)->load(std::memory_order_acquire) + offset, data, size);
+
+    // commit ตามลำดับการจอง - size เลื่อนผ่านช่วงที่ copy ครบแล้วเท่านั้น
+    for (int spin = 0; committed->load(std::memory_order_acquire) != offset; ++spin) {
+        appendBackoff(spin);
+    }
+    if (file->crc_state == MOUNTKIT_CRC_VALID) {
+        file->crc32c = mountkit_crc32c(file->crc32c, data, size);
+    }
+    // read lock: producer หลายตัว commit ต่อกันได้ แต่ไม่สลับกับ mv/rm ที่เปลี่ยน folder ของไฟล์
+    readLock(&file->lock);
+    usageResize(file, offset, end, 0, 0);
+    metaTouch(nodeMeta(file), true); // commit เรียงตามการจอง - tick ของ producer หลังสุดเป็นค่าสุดท้าย
+    committed->store(end, std::memory_order_release);
+    readUnlock(&file->lock);
+    return 1;
+}
+
+// =================================================================
+// append_benchmark
+// =================================================================
+
+typedef struct AppendWorker {
+    mountkit *mount;
+    MyFile *file;
+    bool shared;   // true = append_shared, false = append (lock ต่อไฟล์)
+    int id;
+    int appends;
+} AppendWorker;
+
+static void appendWorker(AppendWorker *w) {
+    uint8_t record[APPEND_RECORD];
+    memset(record, 'a' + w->id % 26, sizeof(record));
+    record[sizeof(record) - 1] = '\n';
+    for (int i = 0; i < w->appends; ++i) {
+        if (w->shared) {
+            w->mount->append_shared(w->file, record, sizeof(record));
+        } else {
+            w->mount->append(w->file, record, sizeof(record));
+        }
+    }
+}
+
+// รัน producer n ตัวบนไฟล์เดียวแล้วคืนจำนวน record ต่อวินาที
+static double appendRun(mountkit *mount, MyFile *file, bool shared, int threads, int appends) {
+    AppendWorker *workers = new AppendWorker[threads];
+    std::thread *pool = new std::thread[threads];
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t) {
+        workers[t].mount = mount;
+        workers[t].file = file;
+        workers[t].shared = shared;
+        workers[t].id = t;
+        workers[t].appends = appends;
+        pool[t] = std::thread(appendWorker, &workers[t]);
+    }
+    for (int t = 0; t < threads; ++t) pool[t].join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    delete[] pool;
+    delete[] workers;
+    return seconds > 0 ? (double)threads * appends / seconds : 0.0;
+}
+
+int mountkit::append_benchmark(int max_threads, int appends_per_thread) {
+    if (max_threads < 1 || appends_per_thread < 1) return 0;
+
+    MyFolder *root = NULL;
+    MyFolder *log = mkdir(&root, "root/var/log");
+    if (!log) {
+        removeFolder(root);
+        return 0;
+    }
+
+    bool was_concurrent = concurrent;
+    concurrent = true;
+    int ok = 1;
+    printf("\n=== APPEND BENCHMARK (%d x %d-byte records/thread, one shared file) ===\n",
+           appends_per_thread, APPEND_RECORD);
+    printf("%8s  %18s  %18s  %8s  %10s\n", "threads", "append (lock)", "append_shared", "speedup", "MB/s");
+    for (int threads = 1; ok; threads *= 2) {
+        if (threads > max_threads) threads = max_threads;
+        size_t expected = (size_t)threads * appends_per_thread * APPEND_RECORD;
+        double rates[2];
+        for (int shared = 0; shared < 2 && ok; ++shared) {
+            MyFile *file = mk(log, "bench.log");
+            if (!file) {
+                ok = 0;
+                break;
+            }
+            rates[shared] = appendRun(this, file, shared != 0, threads, appends_per_thread);
+            if (file->size != expected) ok = 0;
+            rm(log, "bench.log");
+        }
+        if (!ok) break;
+        printf("%8d  %13.0f rec/s  %13.0f rec/s  %7.2fx  %10.1f\n",
+               threads, rates[0], rates[1], rates[0] > 0 ? rates[1] / rates[0] : 0.0,
+               rates[1] * APPEND_RECORD / (1024.0 * 1024.0));
+        if (threads == max_threads) break;
+    }
+    concurrent = was_concurrent;
+
+    removeFolder(root);
+    return ok;
+}
+
+#endif // EMBEDDED_BUILD
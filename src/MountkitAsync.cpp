@@ -0,0 +1,235 @@
+#include "MountkitInternal.h"
+
+// async facade: operation ถูกใส่คิวให้ executor thread ทำ ผลส่งกลับผ่าน std::future
+// และ/หรือ callback ที่ถูกเรียกใน async_poll บน thread ของผู้เรียก (เช่น event loop)
+
+#ifndef EMBEDDED_BUILD
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+#include <string>
+#include <new>
+
+#ifndef _WIN32
+    #include <unistd.h>
+    #include <fcntl.h>
+#endif
+
+typedef struct MyAsyncOp {
+    std::function<int()> work;
+    std::promise<int> promise;
+    mountkit_done_fn done;      // NULL = ใช้ future อย่างเดียว
+    void *ctx;
+    int result;
+    int error;                  // lastError() ของ worker หลัง operation (MOUNTKIT_OK = ไม่มี error)
+} MyAsyncOp;
+
+typedef struct MyAsync {
+    mountkit *owner;                     // error code ของ worker อ่าน/ล้างผ่าน instance นี้
+    int threads;
+    int max_in_flight;
+    std::thread *workers;
+    std::mutex lock;
+    std::condition_variable work_ready;  // executor รองาน
+    std::condition_variable slot_free;   // ผู้ส่งงานแบบไม่มี callback รอ in-flight ลดลง
+    std::deque<MyAsyncOp*> queue;        // รอ executor
+    std::deque<MyAsyncOp*> completed;    // เสร็จแล้ว รอ async_poll เรียก callback
+    int in_flight;
+    bool closing;
+    bool was_concurrent;                 // mode ก่อน async_open - async_close คืนค่านี้
+    int notify[2];                       // pipe: 1 byte ต่อ completion ที่รอ poll (-1 = ไม่มี)
+} MyAsync;
+
+static void asyncWorker(MyAsync *as) {
+    std::unique_lock<std::mutex> guard(as->lock);
+    for (;;) {
+        while (as->queue.empty() && !as->closing) as->work_ready.wait(guard);
+        if (as->queue.empty()) return;  // กำลังปิดและงานหมดแล้ว
+        MyAsyncOp *op = as->queue.front();
+        as->queue.pop_front();
+        guard.unlock();
+
+        // error code เป็นของ thread - ล้างก่อนแล้วเก็บไว้กับ completion เพื่อส่งให้ thread ที่ poll
+        as->owner->clearError();
+        op->result = op->work();
+        op->error = as->owner->lastError();
+        if (op->done) {
+            op->promise.set_value(op->result);
+            guard.lock();
+            as->completed.push_back(op);
+            #ifndef _WIN32
+                if (as->notify[1] >= 0) {
+                    // pipe เต็มก็ไม่เป็นไร - fd ยัง readable และ async_poll ดู completed เอง
+                    char byte = 1;
+                    ssize_t n = ::write(as->notify[1], &byte, 1);
+                    (void)n;
+                }
+            #endif
+        } else {
+            // คืนที่ใน in-flight ก่อน - ผู้ที่ได้ผลจาก future แล้วส่งงานต่อได้ทันที
+            guard.lock();
+            as->in_flight--;
+            as->slot_free.notify_one();
+            guard.unlock();
+            op->promise.set_value(op->result);
+            delete op;
+            guard.lock();
+        }
+    }
+}
+
+// ใส่งานลงคิว - มี callback: ไม่ block (คืน future ว่างถ้าเต็ม), ไม่มี: รอจนมีที่ว่าง
+static std::future<int> asyncSubmit(MyAsync *as, std::function<int()> work, mountkit_done_fn done, void *ctx) {
+    if (!as) return std::future<int>();
+    std::unique_lock<std::mutex> guard(as->lock);
+    if (done) {
+        if (as->closing || as->in_flight >= as->max_in_flight) return std::future<int>();
+    } else {
+        while (!as->closing && as->in_flight >= as->max_in_flight) as->slot_free.wait(guard);
+        if (as->closing) return std::future<int>();
+    }
+    MyAsyncOp *op = new (std::nothrow) MyAsyncOp;
+    if (!op) return std::future<int>();
+    op->work = work;
+    op->done = done;
+    op->ctx = ctx;
+    op->result = 0;
+    op->error = MOUNTKIT_OK;
+    std::future<int> result = op->promise.get_future();
+    as->in_flight++;
+    as->queue.push_back(op);
+    as->work_ready.notify_one();
+    return result;
+}
+
+MyAsync* mountkit::async_open(int threads, int max_in_flight) {
+    if (threads < 1) threads = 1;
+    if (max_in_flight < 1) max_in_flight = 1;
+    MyAsync *as = new (std::nothrow) MyAsync();
+    if (!as) return NULL;
+    as->owner = this;
+    as->threads = threads;
+    as->max_in_flight = max_in_flight;
+    as->in_flight = 0;
+    as->closing = false;
+    as->notify[0] = as->notify[1] = -1;
+    #ifndef _WIN32
+        if (pipe(as->notify) == 0) {
+            fcntl(as->notify[0], F_SETFL, fcntl(as->notify[0], F_GETFL) | O_NONBLOCK);
+            fcntl(as->notify[1], F_SETFL, fcntl(as->notify[1], F_GETFL) | O_NONBLOCK);
+        } else {
+            as->notify[0] = as->notify[1] = -1;
+        }
+    #endif
+
+    // operation ทำงานบน executor พร้อมกับ thread ของผู้เรียก
+    as->was_concurrent = concurrent;
+    set_concurrent(true);
+    as->workers = new std::thread[threads];
+    for (int i = 0; i < threads; ++i) as->workers[i] = std::thread(asyncWorker, as);
+    return as;
+}
+
+void mountkit::async_close(MyAsync *as) {
+    if (!as) return;
+    {
+        std::lock_guard<std::mutex> guard(as->lock);
+        as->closing = true;
+    }
+    as->work_ready.notify_all();
+    as->slot_free.notify_all();
+    for (int i = 0; i < as->threads; ++i) as->workers[i].join();
+    async_poll(as, 0);
+    set_concurrent(as->was_concurrent);
+    #ifndef _WIN32
+        if (as->notify[0] >= 0) {
+            close(as->notify[0]);
+            close(as->notify[1]);
+        }
+    #endif
+    delete[] as->workers;
+    delete as;
+}
+
+std::future<int> mountkit::async_cp(MyAsync *as, MyFolder *src_folder, const char *filename, MyFolder *dst_folder,
+                                    mountkit_done_fn done, void *ctx) {
+    if (!filename) return std::future<int>();
+    std::string name(filename);
+    return asyncSubmit(as, [this, src_folder, name, dst_folder]() {
+        return cp(src_folder, name.c_str(), dst_folder);
+    }, done, ctx);
+}
+
+std::future<int> mountkit::async_write(MyAsync *as, MyFile *file, const uint8_t *data, size_t size,
+                                       mountkit_done_fn done, void *ctx) {
+    return asyncSubmit(as, [this, file, data, size]() {
+        return write(file, (uint8_t*)data, size);
+    }, done, ctx);
+}
+
+std::future<int> mountkit::async_rmdir(MyAsync *as, MyFolder **root, const char *path,
+                                       mountkit_done_fn done, void *ctx) {
+    if (!root || !path) return std::future<int>();
+    std::string target(path);
+    return asyncSubmit(as, [this, root, target]() {
+        return rmdirPath(root, target.c_str()) ? 1 : 0;
+    }, done, ctx);
+}
+
+std::future<int> mountkit::async_tar_export_fd(MyAsync *as, MyFolder *folder, int fd,
+                                               mountkit_done_fn done, void *ctx) {
+    return asyncSubmit(as, [this, folder, fd]() {
+        return tar_export_fd(folder, fd);
+    }, done, ctx);
+}
+
+std::future<int> mountkit::async_tar_import_fd(MyAsync *as, MyFolder *folder, int fd,
+                                               mountkit_done_fn done, void *ctx) {
+    return asyncSubmit(as, [this, folder, fd]() {
+        return tar_import_fd(folder, fd);
+    }, done, ctx);
+}
+
+int mountkit::async_poll(MyAsync *as, int max_completions) {
+    if (!as) return 0;
+    int ran = 0;
+    while (max_completions <= 0 || ran < max_completions) {
+        MyAsyncOp *op;
+        {
+            std::lock_guard<std::mutex> guard(as->lock);
+            if (as->completed.empty()) break;
+            op = as->completed.front();
+            as->completed.pop_front();
+            as->in_flight--;
+            #ifndef _WIN32
+                if (as->notify[0] >= 0) {
+                    char byte;
+                    ssize_t n = ::read(as->notify[0], &byte, 1);
+                    (void)n;
+                }
+            #endif
+        }
+        as->slot_free.notify_one();
+        // callback อาจส่งงานใหม่ได้ - เรียกนอก lock
+        if (op->error != MOUNTKIT_OK) setError(op->error);
+        op->done(op->ctx, op->result);
+        delete op;
+        ran++;
+    }
+    return ran;
+}
+
+int mountkit::async_fd(MyAsync *as) {
+    return as ? as->notify[0] : -1;
+}
+
+int mountkit::async_in_flight(MyAsync *as) {
+    if (!as) return 0;
+    std::lock_guard<std::mutex> guard(as->lock);
+    return as->in_flight;
+}
+
+#endif // EMBEDDED_BUILD
@@ -0,0 +1,752 @@
+#include "MountkitInternal.h"
+
+// batch: เก็บ mkdir/mk/write/append/rm ไว้ก่อนแล้ว apply ทีเดียวใน batch_commit
+// commit มี 3 ขั้น: เรียง operation ตาม path ของ folder ปลายทาง, เตรียมทุกอย่างนอก tree
+// (ถือ write lock ของ folder ที่จะถูกแก้ไว้ตลอด) แล้ว link เข้า tree ด้วยขั้นตอนที่ fail ไม่ได้
+// ถ้าขั้นเตรียมล้มเหลว ของที่เตรียมไว้ถูกทิ้งทั้งหมดและ tree ไม่ถูกแก้เลย
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef EMBEDDED_BUILD
+    #include <atomic>
+#endif
+
+#define BATCH_MKDIR  0
+#define BATCH_MK     1
+#define BATCH_WRITE  2
+#define BATCH_APPEND 3
+#define BATCH_RM     4
+
+#define BATCH_PATH_MAX  256  // เท่ากับ buffer ของ mkdir/rmdir
+#define BATCH_DEPTH_MAX 128  // เท่ากับ stack ของ cd
+#define BATCH_MIN_OPS   16
+#define BATCH_MIN_TAIL  64
+
+struct MyBatchOp {
+    int kind;        // BATCH_*
+    char *path;      // component คั่นด้วย '\0' เช่น "root\0var\0log\0"
+    int parts;       // จำนวน component
+    uint8_t *data;   // copy ของข้อมูล (write/append)
+    size_t size;
+};
+
+// หนึ่ง entry ต่อชื่อที่ถูกแก้ - mkdir "a/b/c" แตกเป็น a, a/b และ a/b/c
+typedef struct BatchItem {
+    MyBatchOp *op;
+    int level;       // index ของ component ที่เป็นชื่อ (parent = component 0..level-1)
+    size_t order;    // ลำดับที่ใส่เข้ามา
+} BatchItem;
+
+// folder ที่ถูกแก้ (parent ของกลุ่ม) และของใหม่ที่รอ link
+typedef struct BatchTarget {
+    MyFolder *folder;     // NULL = root chain
+    uint32_t *lock;       // write lock ที่ถือไว้ (NULL = folder ที่ batch สร้างเอง)
+    bool pending;         // folder ที่ batch สร้างเอง (ยังไม่อยู่ใน tree)
+    MyFolder *new_dirs;   // folder ใหม่ (ต่อกันด้วย dir)
+    MyFile *new_files;    // ไฟล์ใหม่ (ต่อกันด้วย next)
+    MyFolder *charge;     // folder ใน tree ที่ยอดของของใหม่ถูกนับเข้า (ตรวจ quota) - NULL = root chain
+} BatchTarget;
+
+// การแก้ไฟล์ที่มีอยู่แล้วใน tree
+typedef struct BatchEdit {
+    MyFile *file;
+    MyFolder *folder;
+    bool removed;
+    bool replace;         // tail แทนที่ข้อมูลเดิม (write) แทนการต่อท้าย
+    bool locked;          // ถือ write lock ของไฟล์อยู่
+    uint8_t *tail;        // ข้อมูลที่จะเขียน/ต่อท้าย
+    size_t tail_size;
+    size_t tail_capacity;
+    uint8_t *fresh;       // buffer ใหม่ของ replace
+    size_t fresh_capacity; // capacity ที่ต้องใช้หลัง apply (replace: ของ fresh)
+} BatchEdit;
+
+// หนึ่งระดับของ path ที่กำลังเดินอยู่ (ใช้ร่วมกันระหว่างกลุ่มที่ prefix ตรงกัน)
+typedef struct BatchLevel {
+    const char *name;
+    MyFolder *folder;     // NULL = root chain (level 0)
+    int target;           // index ใน targets, -1 = เดินผ่านเท่านั้น
+    bool pending;
+    bool read_held;
+} BatchLevel;
+
+struct MyBatchCommit {
+    MyFolder **root;
+    BatchItem *items;
+    size_t item_count;
+    BatchTarget *targets;       // เรียงตาม path (parent มาก่อนลูก)
+    size_t target_count;
+    BatchEdit *edits;
+    size_t edit_count;
+    MyFolder **held_keys;       // hash: folder -> target (folder เดียวกันผ่าน mount หลาย path)
+    int *held_values;
+    size_t held_mask;
+    BatchLevel stack[BATCH_DEPTH_MAX + 1];
+    int depth;
+};
+
+static const char* batchComponent(const char *path, int index) {
+    while (index-- > 0) path += strlen(path) + 1;
+    return path;
+}
+
+static inline bool batchIsDir(const BatchItem *item) {
+    return item->op->kind == BATCH_MKDIR;
+}
+
+// parent path ทีละ component (prefix สั้นกว่ามาก่อน) -> directory ก่อนไฟล์ -> ชื่อ -> ลำดับที่ใส่
+// ทุกกลุ่มใน subtree เดียวกันจึงติดกันและ parent มาก่อนลูกเสมอ
+static int batchCompare(const void *a, const void *b) {
+    const BatchItem *x = (const BatchItem*)a, *y = (const BatchItem*)b;
+    const char *p = x->op->path, *q = y->op->path;
+    int shared = x->level < y->level ? x->level : y->level;
+    for (int i = 0; i < shared; ++i) {
+        int c = strcmp(p, q);
+        if (c) return c;
+        p += strlen(p) + 1;
+        q += strlen(q) + 1;
+    }
+    if (x->level != y->level) return x->level < y->level ? -1 : 1;
+    if (batchIsDir(x) != batchIsDir(y)) return batchIsDir(x) ? -1 : 1;
+    int c = strcmp(p, q);
+    if (c) return c;
+    return x->order < y->order ? -1 : (x->order > y->order ? 1 : 0);
+}
+
+static bool batchSameParent(const BatchItem *x, const BatchItem *y) {
+    if (x->level != y->level) return false;
+    const char *p = x->op->path, *q = y->op->path;
+    for (int i = 0; i < x->level; ++i) {
+        if (strcmp(p, q) != 0) return false;
+        p += strlen(p) + 1;
+        q += strlen(q) + 1;
+    }
+    return true;
+}
+
+static size_t batchHash(MyFolder *folder, size_t mask) {
+    return (size_t)(((uintptr_t)folder >> 4) * 2654435761u) & mask;
+}
+
+static int batchFindTarget(MyBatchCommit *c, MyFolder *folder) {
+    for (size_t i = batchHash(folder, c->held_mask); c->held_keys[i]; i = (i + 1) & c->held_mask) {
+        if (c->held_keys[i] == folder) return c->held_values[i];
+    }
+    return -1;
+}
+
+static int batchAddTarget(MyBatchCommit *c, MyFolder *folder, bool pending) {
+    int t = (int)c->target_count++;
+    BatchTarget *target = &c->targets[t];
+    target->folder = folder;
+    target->lock = NULL;
+    target->pending = pending;
+    target->new_dirs = NULL;
+    target->new_files = NULL;
+    // folder ที่ batch สร้างเองยังไม่มียอด - ของข้างในนับเข้า folder ที่มีอยู่แล้วที่ใกล้ที่สุดใน stack
+    target->charge = NULL;
+    for (int d = c->depth; d > 0 && !target->charge; --d) {
+        if (!c->stack[d].pending) target->charge = c->stack[d].folder;
+    }
+    size_t i = batchHash(folder, c->held_mask);
+    while (c->held_keys[i]) i = (i + 1) & c->held_mask;
+    c->held_keys[i] = folder;
+    c->held_values[i] = t;
+    return t;
+}
+
+// folder นี้ถูกถือ read lock อยู่แล้วใน stack หรือไม่ (เข้าถึงซ้ำผ่าน mount)
+static bool batchReadHeld(MyBatchCommit *c, MyFolder *folder) {
+    for (int i = 1; i <= c->depth; ++i) {
+        if (c->stack[i].read_held && c->stack[i].folder == folder) return true;
+    }
+    return false;
+}
+
+static MyFolder* batchFindDir(MyFolder *chain, const char *name) {
+    while (chain && strcmp(chain->data, name) != 0) chain = chain->dir;
+    return chain;
+}
+
+static int batchAppendTail(BatchEdit *edit, const uint8_t *data, size_t size) {
+    if (edit->tail_size + size > edit->tail_capacity) {
+        size_t capacity = edit->tail_capacity ? edit->tail_capacity : BATCH_MIN_TAIL;
+        while (capacity < edit->tail_size + size) {
+            capacity *= 2;
+        }
+        uint8_t *grown = (uint8_t*)realloc(edit->tail, capacity);
+        if (!grown) return 0;
+        edit->tail = grown;
+        edit->tail_capacity = capacity;
+    }
+    memcpy(edit->tail + edit->tail_size, data, size);
+    edit->tail_size += size;
+    return 1;
+}
+
+// คืน MOUNTKIT_OK หรือ error code
+static int batchAdd(MyBatch *batch, int kind, const char *path, const uint8_t *data, size_t size) {
+    bool has_data = kind == BATCH_WRITE || kind == BATCH_APPEND;
+    if (!batch || !path || (has_data && (!data || size == 0))) {
+        #ifdef LIB_DEBUG
+            printf("Error: Invalid parameters\n");
+        #endif
+        return MOUNTKIT_EINVAL;
+    }
+
+    char buf[BATCH_PATH_MAX];
+    strncpy(buf, path, sizeof(buf)); buf[sizeof(buf)-1] = '\0';
+    char *normalized = (char*)malloc(strlen(buf) + 1);
+    if (!normalized) return MOUNTKIT_ENOMEM;
+    int parts = 0;
+    char *out = normalized;
+    for (char *p = buf; *p;) {
+        while (*p == '/') p++;
+        if (!*p) break;
+        while (*p && *p != '/') *out++ = *p++;
+        *out++ = '\0';
+        parts++;
+    }
+    // ไฟล์ต้องอยู่ใน folder (root chain มีแต่ folder)
+    if (parts < (kind == BATCH_MKDIR ? 1 : 2) || parts > BATCH_DEPTH_MAX) {
+        #ifdef LIB_DEBUG
+            printf("Error: Invalid batch path '%s'\n", path);
+        #endif
+        free(normalized);
+        return MOUNTKIT_EINVAL;
+    }
+
+    if (batch->count == batch->capacity) {
+        size_t capacity = batch->capacity ? batch->capacity * 2 : BATCH_MIN_OPS;
+        MyBatchOp *grown = (MyBatchOp*)realloc(batch->ops, capacity * sizeof(MyBatchOp));
+        if (!grown) {
+            free(normalized);
+            return MOUNTKIT_ENOMEM;
+        }
+        batch->ops = grown;
+        batch->capacity = capacity;
+    }
+    MyBatchOp *op = &batch->ops[batch->count];
+    op->kind = kind;
+    op->path = normalized;
+    op->parts = parts;
+    op->data = NULL;
+    op->size = 0;
+    if (has_data) {
+        op->data = (uint8_t*)malloc(size);
+        if (!op->data) {
+            free(normalized);
+            return MOUNTKIT_ENOMEM;
+        }
+        memcpy(op->data, data, size);
+        op->size = size;
+    }
+    batch->count++;
+    return MOUNTKIT_OK;
+}
+
+static void batchClear(MyBatch *batch) {
+    for (size_t i = 0; i < batch->count; ++i) {
+        free(batch->ops[i].path);
+        free(batch->ops[i].data);
+    }
+    batch->count = 0;
+}
+
+void mountkit::batch_init(MyBatch *batch) {
+    if (!batch) return;
+    batch->ops = NULL;
+    batch->count = 0;
+    batch->capacity = 0;
+}
+
+int mountkit::batch_mkdir(MyBatch *batch, const char *path) {
+    int error = batchAdd(batch, BATCH_MKDIR, path, NULL, 0);
+    if (error) setError(error);
+    return error == MOUNTKIT_OK;
+}
+
+int mountkit::batch_mk(MyBatch *batch, const char *path) {
+    int error = batchAdd(batch, BATCH_MK, path, NULL, 0);
+    if (error) setError(error);
+    return error == MOUNTKIT_OK;
+}
+
+int mountkit::batch_write(MyBatch *batch, const char *path, const uint8_t *data, size_t size) {
+    int error = batchAdd(batch, BATCH_WRITE, path, data, size);
+    if (error) setError(error);
+    return error == MOUNTKIT_OK;
+}
+
+int mountkit::batch_append(MyBatch *batch, const char *path, const uint8_t *data, size_t size) {
+    int error = batchAdd(batch, BATCH_APPEND, path, data, size);
+    if (error) setError(error);
+    return error == MOUNTKIT_OK;
+}
+
+int mountkit::batch_rm(MyBatch *batch, const char *path) {
+    int error = batchAdd(batch, BATCH_RM, path, NULL, 0);
+    if (error) setError(error);
+    return error == MOUNTKIT_OK;
+}
+
+void mountkit::batch_release(MyBatch *batch) {
+    if (!batch) return;
+    batchClear(batch);
+    free(batch->ops);
+    batch_init(batch);
+}
+
+int mountkit::batch_commit(MyBatch *batch, MyFolder **root) {
+    if (!batch || !root) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    if (batch->count == 0) return 1;
+
+    size_t item_count = 0;
+    for (size_t i = 0; i < batch->count; ++i) {
+        item_count += batch->ops[i].kind == BATCH_MKDIR ? (size_t)batch->ops[i].parts : 1;
+    }
+    size_t table = 16;
+    while (table < item_count * 2) {
+        table *= 2;
+    }
+
+    // กลุ่มละไม่เกินหนึ่ง target และชื่อละไม่เกินหนึ่ง edit - จองครั้งเดียวตามจำนวน item
+    MyBatchCommit *c = (MyBatchCommit*)calloc(1, sizeof(MyBatchCommit));
+    if (c) {
+        c->root = root;
+        c->items = (BatchItem*)malloc(item_count * sizeof(BatchItem));
+        c->targets = (BatchTarget*)malloc(item_count * sizeof(BatchTarget));
+        c->edits = (BatchEdit*)calloc(item_count, sizeof(BatchEdit));
+        c->held_keys = (MyFolder**)calloc(table, sizeof(MyFolder*));
+        c->held_values = (int*)malloc(table * sizeof(int));
+        c->held_mask = table - 1;
+    }
+    int ok = 0;
+    if (c && c->items && c->targets && c->edits && c->held_keys && c->held_values) {
+        for (size_t i = 0; i < batch->count; ++i) {
+            MyBatchOp *op = &batch->ops[i];
+            int first = op->kind == BATCH_MKDIR ? 0 : op->parts - 1;
+            for (int level = first; level < op->parts; ++level) {
+                BatchItem *item = &c->items[c->item_count++];
+                item->op = op;
+                item->level = level;
+                item->order = i;
+            }
+        }
+        qsort(c->items, c->item_count, sizeof(BatchItem), batchCompare);
+
+        ok = batchPrepare(c);
+        if (ok) batchApply(c);
+        batchRelease(c, !ok);
+    } else {
+        setError(MOUNTKIT_ENOMEM);
+    }
+    if (c) {
+        free(c->items);
+        free(c->targets);
+        free(c->edits);
+        free(c->held_keys);
+        free(c->held_values);
+        free(c);
+    }
+    batchClear(batch);
+    return ok;
+}
+
+// เดิน path ของแต่ละกลุ่มโดยใช้ระดับที่ตรงกับกลุ่มก่อนหน้าต่อ (กลุ่มเรียงตาม path แล้ว)
+// folder ที่ถูกแก้ถือ write lock ไว้จนจบ commit, folder ที่เดินผ่านถือ read lock จนกว่าจะออกจาก subtree
+// lock ถูกขอจากบนลงล่างตามลำดับ path เหมือน mkdir/rmdir และไฟล์ถูก lock หลัง folder ทั้งหมด
+int mountkit::batchPrepare(MyBatchCommit *c) {
+    BatchLevel *stack = c->stack;
+    stack[0].name = NULL;
+    stack[0].folder = NULL;
+    stack[0].target = -1;
+    stack[0].pending = false;
+    stack[0].read_held = false;
+    c->depth = 0;
+    if (c->items[0].level == 0) {
+        // มี mkdir ที่ระดับบนสุด - กลุ่มแรกเสมอ
+        writeLock(&root_lock);
+        stack[0].target = batchAddTarget(c, NULL, false);
+        c->targets[stack[0].target].lock = &root_lock;
+    } else {
+        readLock(&root_lock);
+        stack[0].read_held = true;
+    }
+
+    size_t first = 0;
+    while (first < c->item_count) {
+        size_t end = first + 1;
+        while (end < c->item_count && batchSameParent(&c->items[first], &c->items[end])) end++;
+        int level_count = c->items[first].level;
+
+        // ระดับที่ใช้ร่วมกับกลุ่มก่อนหน้า
+        const char *name = c->items[first].op->path;
+        int common = 0;
+        while (common < c->depth && common < level_count && strcmp(stack[common + 1].name, name) == 0) {
+            common++;
+            name += strlen(name) + 1;
+        }
+        while (c->depth > common) {
+            if (stack[c->depth].read_held) readUnlock(&stack[c->depth].folder->lock);
+            c->depth--;
+        }
+
+        // เดินลงส่วนที่เหลือ - ค้นใน tree ก่อนแล้วค่อยค้นใน folder ที่ batch สร้างไว้
+        while (c->depth < level_count) {
+            BatchLevel *top = &stack[c->depth];
+            MyFolder *iter = batchFindDir(top->folder ? top->folder->subdir : *c->root, name);
+            bool pending = top->pending;
+            if (!iter && top->target >= 0) {
+                iter = batchFindDir(c->targets[top->target].new_dirs, name);
+                pending = true;
+            }
+            if (!iter) {
+                #ifdef LIB_DEBUG
+                    printf("Error: batch parent '%s' not found\n", name);
+                #endif
+                setError(MOUNTKIT_ENOENT);
+                return 0;
+            }
+            MyFolder *next = followMount(iter);
+            BatchLevel *level = &stack[++c->depth];
+            level->name = name;
+            level->folder = next;
+            level->pending = pending;
+            level->read_held = false;
+            level->target = batchFindTarget(c, next);
+            if (c->depth == level_count) {
+                if (level->target < 0) {
+                    if (!pending && batchReadHeld(c, next)) {
+                        // folder เดียวกันถูกเดินผ่านด้วย read lock ทาง mount อื่น - upgrade ไม่ได้
+                        #ifdef LIB_DEBUG
+                            printf("Error: batch folder '%s' reached through two mount paths\n", next->data);
+                        #endif
+                        setError(MOUNTKIT_EBUSY);
+                        return 0;
+                    }
+                    level->target = batchAddTarget(c, next, pending);
+                    if (!pending) {
+                        writeLock(&next->lock);
+                        c->targets[level->target].lock = &next->lock;
+                    }
+                }
+            } else if (!pending && level->target < 0 && !batchReadHeld(c, next)) {
+                readLock(&next->lock);
+                level->read_held = true;
+            }
+            name += strlen(name) + 1;
+        }
+
+        if (!batchStage(c, stack[c->depth].target, first, end - first)) return 0;
+        first = end;
+    }
+
+    // ไฟล์ที่มีอยู่แล้ว: lock แล้วคำนวณ capacity ที่ต้องใช้ (quota ถูกตรวจก่อนจองอะไรเพิ่ม)
+    for (size_t i = 0; i < c->edit_count; ++i) {
+        BatchEdit *edit = &c->edits[i];
+        MyFile *file = edit->file;
+        writeLock(&file->lock);
+        edit->locked = true;
+        if (edit->removed) continue;
+        size_t need = edit->replace ? edit->tail_size : file->size + edit->tail_size;
+        size_t capacity = file->capacity;
+        while (capacity < need) {
+            capacity *= 2;
+        }
+        #ifdef EMBEDDED_BUILD
+            // เหมือน write: embedded ไม่ขยาย buffer
+            if (edit->replace && capacity > file->capacity) {
+                setError(MOUNTKIT_ENOSPC);
+                return 0;
+            }
+        #endif
+        edit->fresh_capacity = capacity;
+    }
+    if (!batchQuota(c)) return 0;
+
+    // เตรียม buffer ให้ apply ได้โดยไม่ต้องจองหน่วยความจำ
+    for (size_t i = 0; i < c->edit_count; ++i) {
+        BatchEdit *edit = &c->edits[i];
+        MyFile *file = edit->file;
+        if (edit->removed) continue;
+        if (edit->replace) {
+            size_t capacity = edit->fresh_capacity;
+            edit->fresh = (uint8_t*)malloc(capacity);
+            if (!edit->fresh) {
+                setError(MOUNTKIT_ENOMEM);
+                return 0;
+            }
+            memcpy(edit->fresh, edit->tail, edit->tail_size);
+            memset(edit->fresh + edit->tail_size, 0, capacity - edit->tail_size);
+        } else if (edit->fresh_capacity > file->capacity) {
+            // ขยายก่อน - เนื้อหาไม่เปลี่ยน จึงไม่ต้องย้อนถ้า commit ล้มเหลว
+            if (!resizeData(file, edit->fresh_capacity)) {
+                setError(MOUNTKIT_ENOMEM);
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+// ยอดที่แต่ละ target (ไฟล์และ folder ใหม่) และแต่ละ edit (capacity ที่โตขึ้น) จะเพิ่ม
+// ไฟล์ที่ถูกลบใน batch เดียวกันไม่ถูกหักออก - batch ที่เกิน quota ระหว่างทางจึงไม่ผ่านแม้ยอดสุดท้ายจะไม่เกิน
+int mountkit::batchQuota(MyBatchCommit *c) {
+    size_t count = c->target_count + c->edit_count;
+    MyFolder **folders = (MyFolder**)malloc(count * sizeof(MyFolder*));
+    MyQuota *adds = (MyQuota*)malloc(count * sizeof(MyQuota));
+    if (!folders || !adds) {
+        free(folders);
+        free(adds);
+        setError(MOUNTKIT_ENOMEM);
+        return 0;
+    }
+    size_t n = 0;
+    for (size_t t = 0; t < c->target_count; ++t) {
+        BatchTarget *target = &c->targets[t];
+        folders[n] = target->charge;
+        adds[n].bytes = 0;
+        adds[n].nodes = 0;
+        for (MyFolder *d = target->new_dirs; d; d = d->dir) adds[n].nodes++;
+        for (MyFile *f = target->new_files; f; f = f->next) {
+            adds[n].bytes += f->capacity;
+            adds[n].nodes++;
+        }
+        n++;
+    }
+    for (size_t i = 0; i < c->edit_count; ++i) {
+        BatchEdit *edit = &c->edits[i];
+        if (edit->removed || edit->fresh_capacity <= edit->file->capacity) continue;
+        folders[n] = edit->folder;
+        adds[n].bytes = edit->fresh_capacity - edit->file->capacity;
+        adds[n].nodes = 0;
+        n++;
+    }
+    int ok = quotaCheckAll(folders, adds, n);
+    free(folders);
+    free(adds);
+    return ok;
+}
+
+// เตรียม item [first, first + count) ที่ parent เดียวกัน (target)
+// item ชื่อเดียวกันติดกันตามลำดับที่ใส่ จึงไล่สถานะของแต่ละชื่อได้ในรอบเดียว
+int mountkit::batchStage(MyBatchCommit *c, int t, size_t first, size_t count) {
+    BatchTarget *target = &c->targets[t];
+    BatchItem *items = c->items + first;
+    size_t i = 0;
+    while (i < count) {
+        const char *name = batchComponent(items[i].op->path, items[i].level);
+        bool is_dir = batchIsDir(&items[i]);
+        size_t end = i + 1;
+        while (end < count && batchIsDir(&items[end]) == is_dir &&
+               strcmp(batchComponent(items[end].op->path, items[end].level), name) == 0) {
+            end++;
+        }
+
+        if (is_dir) {
+            MyFolder *chain = target->folder ? target->folder->subdir : *c->root;
+            if (!batchFindDir(chain, name) && !batchFindDir(target->new_dirs, name)) {
+                MyFolder *folder = NULL;
+                createFolder(&folder, name);
+                if (!folder) {
+                    setError(MOUNTKIT_ENOMEM);
+                    return 0;
+                }
+                folder->dir = target->new_dirs;
+                target->new_dirs = folder;
+            }
+            i = end;
+            continue;
+        }
+
+        MyFile *existing = NULL;
+        if (!target->pending) {
+            existing = target->folder->files;
+            while (existing && strcmp((char*)existing->name, name) != 0) existing = existing->next;
+        }
+        BatchEdit *edit = NULL;
+        MyFile *fresh = NULL;   // ไฟล์ใหม่ของชื่อนี้ (link ตอนจบชื่อ)
+        for (size_t k = i; k < end; ++k) {
+            MyBatchOp *op = items[k].op;
+            bool live = existing && !(edit && edit->removed);
+            if (live) {
+                if (op->kind == BATCH_MK) continue;
+                if (!edit) {
+                    edit = &c->edits[c->edit_count++];
+                    edit->file = existing;
+                    edit->folder = target->folder;
+                }
+                if (op->kind == BATCH_RM) {
+                    edit->removed = true;
+                    edit->replace = false;
+                    edit->tail_size = 0;
+                    continue;
+                }
+                if (existing->link || existing->kind == MOUNTKIT_DT_LINK) {
+                    // hard link / symlink: batch แก้ data ผ่าน node ของชื่อนี้ไม่ได้
+                    if (fresh) releaseFile(fresh);
+                    setError(MOUNTKIT_EINVAL);
+                    return 0;
+                }
+                if (op->kind == BATCH_WRITE) {
+                    edit->replace = true;
+                    edit->tail_size = 0;
+                }
+                if (!batchAppendTail(edit, op->data, op->size)) {
+                    if (fresh) releaseFile(fresh);
+                    setError(MOUNTKIT_ENOMEM);
+                    return 0;
+                }
+                continue;
+            }
+            if (op->kind == BATCH_RM) {
+                if (!fresh) {
+                    #ifdef LIB_DEBUG
+                        printf("Error: batch rm of missing file '%s'\n", name);
+                    #endif
+                    setError(MOUNTKIT_ENOENT);
+                    return 0;
+                }
+                releaseFile(fresh);
+                fresh = NULL;
+                continue;
+            }
+            if (!fresh) {
+                fresh = newFile(name);
+                if (!fresh) {
+                    setError(MOUNTKIT_ENOMEM);
+                    return 0;
+                }
+            }
+            if (op->kind == BATCH_MK) continue;
+            // ไฟล์ใหม่ยังไม่มีใครเห็น - เขียนตรงโดยไม่ต้อง lock
+            size_t offset = op->kind == BATCH_WRITE ? 0 : fresh->size;
+            if (offset + op->size > fresh->capacity) {
+                size_t capacity = fresh->capacity;
+                while (capacity < offset + op->size) {
+                    capacity *= 2;
+                }
+                if (!resizeData(fresh, capacity)) {
+                    releaseFile(fresh);
+                    setError(MOUNTKIT_ENOMEM);
+                    return 0;
+                }
+            }
+            memcpy(fresh->data + offset, op->data, op->size);
+            fresh->size = offset + op->size;
+            fresh->reserved = fresh->size;
+        }
+        if (fresh) {
+            fresh->next = target->new_files;
+            target->new_files = fresh;
+        }
+        i = end;
+    }
+    return 1;
+}
+
+// link ของที่เตรียมไว้ - ไม่มีการจองหน่วยความจำ (ยกเว้น node ของ ordered index ซึ่งถูกทิ้งแทนถ้าจองไม่ได้)
+// target ถูก apply จากลูกขึ้นไปหา parent: folder ใหม่มีของข้างในครบก่อนถูก publish
+void mountkit::batchApply(MyBatchCommit *c) {
+    for (size_t i = 0; i < c->edit_count; ++i) {
+        BatchEdit *edit = &c->edits[i];
+        MyFile *file = edit->file;
+        if (edit->removed) {
+            MyFile **cur = &edit->folder->files;
+            while (*cur != file) cur = &(*cur)->next;
+            storeShared(cur, file->next);
+            indexRemove(edit->folder, NULL, file);
+            usageUnlink(file);
+            metaTouch(nodeMeta(edit->folder), true);
+            metaTouch(nodeMeta(fileTarget(file)), false);
+            notify(edit->folder, MOUNTKIT_WATCH_DELETE, (char*)file->name);
+            unlinkName(file, true); // ปล่อย lock ของไฟล์ให้ด้วย
+            edit->locked = false;
+            continue;
+        }
+        if (edit->replace) {
+            swapData(file, edit->fresh, edit->fresh_capacity, edit->tail_size);
+            edit->fresh = NULL;
+            if (file->crc_state != MOUNTKIT_CRC_OFF) {
+                file->crc_state = MOUNTKIT_CRC_STALE;
+            }
+        } else if (edit->tail_size) {
+            memcpy(file->data + file->size, edit->tail, edit->tail_size);
+            if (file->crc_state == MOUNTKIT_CRC_VALID) {
+                file->crc32c = mountkit_crc32c(file->crc32c, edit->tail, edit->tail_size);
+            }
+            usageResize(file, file->size, file->size + edit->tail_size, file->capacity, file->capacity);
+            storeShared(&file->size, file->size + edit->tail_size);
+        }
+        file->reserved = file->size;
+        metaTouch(nodeMeta(file), true);
+        notify(file, MOUNTKIT_WATCH_MODIFY, NULL);
+    }
+
+    for (size_t t = c->target_count; t-- > 0;) {
+        BatchTarget *target = &c->targets[t];
+        MyFolder **dirs = target->folder ? &target->folder->subdir : c->root;
+        if (target->folder && (target->new_dirs || target->new_files)) metaTouch(nodeMeta(target->folder), true);
+        // folder ที่ batch สร้างเองยังไม่มีใคร watch ได้
+        if (target->folder && !target->pending) {
+            for (MyFolder *d = target->new_dirs; d; d = d->dir) {
+                notify(target->folder, MOUNTKIT_WATCH_CREATE | MOUNTKIT_WATCH_ISDIR, d->data);
+            }
+            for (MyFile *f = target->new_files; f; f = f->next) {
+                notify(target->folder, MOUNTKIT_WATCH_CREATE, (char*)f->name);
+            }
+        }
+        if (target->new_dirs) {
+            MyFolder *last = target->new_dirs;
+            // folder ใหม่มีของข้างในครบแล้ว (target ของมันถูก apply ก่อน) - ยอดของทั้ง subtree เข้า parent ทีเดียว
+            for (MyFolder *d = target->new_dirs; d; d = d->dir) {
+                indexInsert(target->folder, d, NULL);
+                usageAttach(target->folder, d);
+            }
+            while (last->dir) last = last->dir;
+            last->dir = *dirs;
+            storeShared(dirs, target->new_dirs);
+            target->new_dirs = NULL;
+        }
+        if (target->new_files) {
+            MyFile *last = target->new_files;
+            for (MyFile *f = target->new_files; f; f = f->next) {
+                indexInsert(target->folder, NULL, f);
+                usageLink(target->folder, f);
+            }
+            while (last->next) last = last->next;
+            last->next = target->folder->files;
+            storeShared(&target->folder->files, target->new_files);
+            target->new_files = NULL;
+        }
+    }
+    linkInvalidate(); // ชื่อที่ถูกลบหรือ folder ใหม่เปลี่ยนผล resolve ของ symlink
+}
+
+void mountkit::batchRelease(MyBatchCommit *c, bool discard) {
+    if (discard) {
+        // folder ใหม่แต่ละตัวอยู่ใน new_dirs ของ target เดียว และยังไม่มีลูกที่ link แล้ว
+        for (size_t t = 0; t < c->target_count; ++t) {
+            removeFolder(c->targets[t].new_dirs);
+            freeFiles(c->targets[t].new_files);
+        }
+    }
+    for (size_t i = 0; i < c->edit_count; ++i) {
+        BatchEdit *edit = &c->edits[i];
+        free(edit->tail);
+        free(edit->fresh);
+        if (edit->locked) writeUnlock(&edit->file->lock);
+    }
+    for (size_t t = 0; t < c->target_count; ++t) {
+        if (c->targets[t].lock) writeUnlock(c->targets[t].lock);
+    }
+    for (; c->depth > 0; c->depth--) {
+        if (c->stack[c->depth].read_held) readUnlock(&c->stack[c->depth].folder->lock);
+    }
+    if (c->stack[0].read_held) readUnlock(&root_lock);
+}
@@ -0,0 +1,240 @@
+#include "MountkitInternal.h"
+
+// CRC32C (Castagnoli) ต่อไฟล์ - ใช้คำสั่ง hardware ถ้ามี ไม่งั้นใช้ตาราง slicing-by-8
+
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #include <nmmintrin.h>
+    #define MOUNTKIT_CRC_X86 1
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <nmmintrin.h>
+    #include <intrin.h>
+    #define MOUNTKIT_CRC_X86 1
+#elif defined(__ARM_FEATURE_CRC32)
+    #include <arm_acle.h>
+    #define MOUNTKIT_CRC_ARM 1
+#endif
+
+#ifndef EMBEDDED_BUILD
+    #include <thread>
+    #include <atomic>
+#endif
+
+#define CRC32C_POLY 0x82F63B78u // reflected polynomial
+
+// ตาราง slicing-by-8 สำหรับ fallback (สร้างครั้งแรกที่ใช้)
+typedef struct Crc32cTable {
+    uint32_t t[8][256];
+} Crc32cTable;
+
+static Crc32cTable crc32cMakeTable() {
+    Crc32cTable table;
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+        for (int k = 0; k < 8; ++k) {
+            crc = (crc >> 1) ^ (CRC32C_POLY & (0u - (crc & 1)));
+        }
+        table.t[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; ++i) {
+        for (int s = 1; s < 8; ++s) {
+            uint32_t prev = table.t[s - 1][i];
+            table.t[s][i] = (prev >> 8) ^ table.t[0][prev & 0xFF];
+        }
+    }
+    return table;
+}
+
+static uint32_t crc32cSoftware(uint32_t crc, const uint8_t *p, size_t n) {
+    static const Crc32cTable table = crc32cMakeTable();
+    const uint32_t (*t)[256] = table.t;
+
+    while (n >= 8) {
+        uint32_t lo = ((uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+                       ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24)) ^ crc;
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^
+              t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+              t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+        p += 8;
+        n -= 8;
+    }
+    while (n--) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+    }
+    return crc;
+}
+
+#if defined(MOUNTKIT_CRC_X86)
+#if defined(__GNUC__)
+__attribute__((target("sse4.2")))
+#endif
+static uint32_t crc32cHardware(uint32_t crc, const uint8_t *p, size_t n) {
+    while (n > 0 && ((uintptr_t)p & 7) != 0) {
+        crc = _mm_crc32_u8(crc, *p++);
+        n--;
+    }
+    #if defined(__x86_64__) || defined(_M_X64)
+        uint64_t crc64 = crc;
+        while (n >= 8) {
+            uint64_t v;
+            memcpy(&v, p, 8);
+            crc64 = _mm_crc32_u64(crc64, v);
+            p += 8;
+            n -= 8;
+        }
+        crc = (uint32_t)crc64;
+    #endif
+    while (n >= 4) {
+        uint32_t v;
+        memcpy(&v, p, 4);
+        crc = _mm_crc32_u32(crc, v);
+        p += 4;
+        n -= 4;
+    }
+    while (n--) {
+        crc = _mm_crc32_u8(crc, *p++);
+    }
+    return crc;
+}
+
+static bool crc32cHardwareAvailable() {
+    #if defined(__GNUC__)
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sse4.2") != 0;
+    #else
+        int info[4];
+        __cpuid(info, 1);
+        return (info[2] & (1 << 20)) != 0;
+    #endif
+}
+#elif defined(MOUNTKIT_CRC_ARM)
+static uint32_t crc32cHardware(uint32_t crc, const uint8_t *p, size_t n) {
+    while (n >= 8) {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        crc = __crc32cd(crc, v);
+        p += 8;
+        n -= 8;
+    }
+    while (n--) {
+        crc = __crc32cb(crc, *p++);
+    }
+    return crc;
+}
+
+static bool crc32cHardwareAvailable() {
+    return true; // __ARM_FEATURE_CRC32 รับประกันตอน compile แล้ว
+}
+#endif
+
+typedef uint32_t (*Crc32cKernel)(uint32_t crc, const uint8_t *p, size_t n);
+
+static Crc32cKernel crc32cSelectKernel() {
+    #if defined(MOUNTKIT_CRC_X86) || defined(MOUNTKIT_CRC_ARM)
+        if (crc32cHardwareAvailable()) return crc32cHardware;
+    #endif
+    return crc32cSoftware;
+}
+
+uint32_t mountkit_crc32c(uint32_t crc, const void *data, size_t size) {
+    static const Crc32cKernel kernel = crc32cSelectKernel();
+    if (!data || size == 0) return crc;
+    return ~kernel(~crc, (const uint8_t*)data, size);
+}
+
+#ifndef EMBEDDED_BUILD
+
+uint32_t mountkit::checksum(MyFile *file) {
+    if (!file) return 0;
+    if (file->link) file = file->link; // hard link: checksum ของไฟล์จริง
+    if (file->crc_state != MOUNTKIT_CRC_VALID) {
+        file->crc32c = mountkit_crc32c(0, file->data, file->size);
+        file->crc_state = MOUNTKIT_CRC_VALID;
+    }
+    return file->crc32c;
+}
+
+// เก็บ pointer ของไฟล์ทั้งหมดใน subtree เป็น array (ข้าม mount point ด้วย)
+static int collectFiles(mountkit &mount, MyFolder *folder, MyFile ***list, size_t *count, size_t *capacity) {
+    int ok = 1;
+    MyIter it;
+    mount.iter_begin(&it, folder, MOUNTKIT_ITER_FILES | MOUNTKIT_ITER_MOUNTS);
+    while (ok && mount.iter_next(&it)) {
+        if (*count == *capacity) {
+            size_t new_capacity = *capacity ? *capacity * 2 : 64;
+            MyFile **grown = (MyFile**)realloc(*list, new_capacity * sizeof(MyFile*));
+            if (!grown) {
+                ok = 0;
+                break;
+            }
+            *list = grown;
+            *capacity = new_capacity;
+        }
+        (*list)[(*count)++] = it.file;
+    }
+    if (it.failed) ok = 0;
+    mount.iter_end(&it);
+    return ok;
+}
+
+int mountkit::verify(MyFolder *folder, mountkit_file_fn on_corrupt, void *ctx) {
+    if (!folder) return -1;
+
+    MyFile **files = NULL;
+    size_t count = 0, capacity = 0;
+    if (!collectFiles(*this, folder, &files, &count, &capacity)) {
+        free(files);
+        return -1;
+    }
+
+    size_t total_bytes = 0;
+    for (size_t i = 0; i < count; ++i) total_bytes += files[i]->size;
+
+    // 0 = ปกติ, 1 = เสียหาย
+    uint8_t *corrupt = (uint8_t*)calloc(count ? count : 1, 1);
+    if (!corrupt) {
+        free(files);
+        return -1;
+    }
+
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+            MyFile *f = files[i];
+            if (f->crc_state == MOUNTKIT_CRC_VALID) {
+                corrupt[i] = mountkit_crc32c(0, f->data, f->size) != f->crc32c;
+            } else if (f->crc_state == MOUNTKIT_CRC_STALE) {
+                // ถูก write หลังคำนวณครั้งล่าสุด - ไม่มีค่าอ้างอิง ให้คำนวณใหม่
+                f->crc32c = mountkit_crc32c(0, f->data, f->size);
+                f->crc_state = MOUNTKIT_CRC_VALID;
+            }
+        }
+    };
+
+    // ไฟล์รวมน้อยกว่า 1MB ไม่คุ้มที่จะแตก thread
+    unsigned int threads = std::thread::hardware_concurrency();
+    if (threads > count) threads = (unsigned int)count;
+    if (total_bytes < (1u << 20) || threads < 2) {
+        worker();
+    } else {
+        std::thread *pool = new std::thread[threads - 1];
+        for (unsigned int t = 0; t + 1 < threads; ++t) pool[t] = std::thread(worker);
+        worker();
+        for (unsigned int t = 0; t + 1 < threads; ++t) pool[t].join();
+        delete[] pool;
+    }
+
+    int bad = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (!corrupt[i]) continue;
+        bad++;
+        if (on_corrupt) on_corrupt(ctx, files[i]);
+    }
+
+    free(corrupt);
+    free(files);
+    return bad;
+}
+
+#endif // EMBEDDED_BUILD
@@ -0,0 +1,371 @@
+#include "MountkitInternal.h"
+
+// online compaction: ย้าย node, ชื่อ และ data ขนาดเล็กของ subtree ไปไว้ใน arena
+// ที่เรียงตามลำดับการเดิน tree เพื่อลด cache miss และคืน capacity ที่ไม่ได้ใช้
+
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifdef _WIN32
+    #include <malloc.h>
+#endif
+#ifndef EMBEDDED_BUILD
+    #include <atomic>
+#endif
+
+// arena แบ่งเป็น chunk ขนาดคงที่ที่ align ตามขนาดตัวเอง
+// จึงหา header ของ chunk จาก pointer ใดๆ ข้างในได้ด้วยการ mask address
+#define ARENA_CHUNK_SIZE    ((size_t)64 * 1024)
+#define ARENA_ALIGN         16
+#define COMPACT_SMALL_DATA  1024  // data ที่เล็กกว่านี้จะถูกย้ายเข้า arena
+#define COMPACT_MIN_DATA    16    // capacity ขั้นต่ำ กัน loop ขยายจาก 0
+#define COMPACT_FAR_HOP     4096  // ระยะห่างระหว่าง node ที่ถือว่ากระโดดข้าม page
+
+typedef struct ArenaChunk {
+    size_t live;    // จำนวน allocation ที่ยังไม่ถูกคืน (นับลงผ่าน sharedField)
+    size_t used;    // bytes ที่ bump ไปแล้ว (รวม header)
+    struct ArenaChunk *next; // chunk ถัดไปของ compaction เดียวกัน (ใช้ตอน rollback)
+} ArenaChunk;
+
+static ArenaChunk* arenaChunkAlloc() {
+    void *mem = NULL;
+    #ifdef _WIN32
+        mem = _aligned_malloc(ARENA_CHUNK_SIZE, ARENA_CHUNK_SIZE);
+    #else
+        if (posix_memalign(&mem, ARENA_CHUNK_SIZE, ARENA_CHUNK_SIZE) != 0) mem = NULL;
+    #endif
+    if (!mem) return NULL;
+    ArenaChunk *chunk = (ArenaChunk*)mem;
+    chunk->live = 0;
+    chunk->used = (sizeof(ArenaChunk) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    chunk->next = NULL;
+    return chunk;
+}
+
+static void arenaChunkFree(ArenaChunk *chunk) {
+    #ifdef _WIN32
+        _aligned_free(chunk);
+    #else
+        free(chunk);
+    #endif
+}
+
+// คืน allocation หนึ่งชิ้น - chunk จะถูก free เมื่อไม่มีใครใช้แล้ว
+// concurrent mode: node ใน chunk เดียวกันถูกคืนจากหลาย thread ได้ (rm คนละ folder) - นับลงแบบ atomic
+static void arenaRelease(void *ptr) {
+    if (!ptr) return;
+    ArenaChunk *chunk = (ArenaChunk*)((uintptr_t)ptr & ~(uintptr_t)(ARENA_CHUNK_SIZE - 1));
+    #ifndef EMBEDDED_BUILD
+        if (sharedField(&chunk->live)->fetch_sub(1, std::memory_order_acq_rel) == 1) arenaChunkFree(chunk);
+    #else
+        if (--chunk->live == 0) arenaChunkFree(chunk);
+    #endif
+}
+
+void mountkit::releaseData(uint8_t *data, bool in_arena) {
+    if (in_arena) arenaRelease(data); else free(data);
+}
+
+void mountkit::releaseFile(MyFile *file) {
+    uint8_t flags = file->alloc_flags;
+    free(file->cache);
+    if (flags & MOUNTKIT_ALLOC_NAME) arenaRelease(file->name); else free(file->name);
+    releaseData(file->data, (flags & MOUNTKIT_ALLOC_DATA) != 0);
+    if (flags & MOUNTKIT_ALLOC_NODE) arenaRelease(file); else free(file);
+}
+
+void mountkit::releaseFolderNode(MyFolder *folder) {
+    uint8_t flags = folder->alloc_flags;
+    indexRelease(folder);
+    if (flags & MOUNTKIT_ALLOC_NAME) arenaRelease(folder->data); else free(folder->data);
+    if (flags & MOUNTKIT_ALLOC_NODE) arenaRelease(folder); else free(folder);
+}
+
+int mountkit::resizeData(MyFile *file, size_t new_capacity) {
+    if (new_capacity < COMPACT_MIN_DATA) new_capacity = COMPACT_MIN_DATA;
+    if (lockfree_reads || (file->alloc_flags & MOUNTKIT_ALLOC_DATA)) {
+        // data ใน arena realloc ไม่ได้ และใน lock-free read mode reader อาจยังอ่าน buffer เดิมอยู่
+        // - ย้ายไป heap block ใหม่ (buffer เดิมถูกคืนหรือ retire ใน swapData)
+        uint8_t *new_data = (uint8_t*)malloc(new_capacity);
+        if (!new_data) return 0;
+        size_t keep = file->size < new_capacity ? file->size : new_capacity;
+        memcpy(new_data, file->data, keep);
+        swapData(file, new_data, new_capacity, keep);
+        return 1;
+    } else {
+        uint8_t *new_data = (uint8_t*)realloc(file->data, new_capacity);
+        if (!new_data) return 0;
+        file->data = new_data;
+    }
+    usageResize(file, file->size, file->size, file->capacity, new_capacity);
+    // append_shared รอ capacity โดยไม่ถือ lock - publish หลัง data
+    storeShared(&file->capacity, new_capacity);
+    return 1;
+}
+
+#ifndef EMBEDDED_BUILD
+
+// bump allocator ที่ใช้ระหว่าง compaction
+typedef struct CompactArena {
+    ArenaChunk *head;
+    ArenaChunk *current;
+    bool failed;
+} CompactArena;
+
+static void* arenaAlloc(CompactArena *arena, size_t size) {
+    size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if (!arena->current || arena->current->used + size > ARENA_CHUNK_SIZE) {
+        ArenaChunk *chunk = arenaChunkAlloc();
+        if (!chunk) {
+            arena->failed = true;
+            return NULL;
+        }
+        if (arena->current) arena->current->next = chunk; else arena->head = chunk;
+        arena->current = chunk;
+    }
+    void *ptr = (uint8_t*)arena->current + arena->current->used;
+    arena->current->used += size;
+    arena->current->live++;
+    return ptr;
+}
+
+static char* arenaStrdup(CompactArena *arena, const char *str) {
+    size_t len = strlen(str) + 1;
+    char *copy = (char*)arenaAlloc(arena, len);
+    if (copy) memcpy(copy, str, len);
+    return copy;
+}
+
+// สถิติ layout ของ tree (ใช้ทั้งก่อนและหลัง compact)
+typedef struct CompactStats {
+    size_t nodes;
+    size_t hops;
+    size_t far_hops;
+    size_t slack;
+    uintptr_t last;
+} CompactStats;
+
+static void statsTouch(CompactStats *st, const void *ptr) {
+    uintptr_t addr = (uintptr_t)ptr;
+    if (st->last) {
+        uintptr_t dist = addr > st->last ? addr - st->last : st->last - addr;
+        st->hops++;
+        if (dist > COMPACT_FAR_HOP) st->far_hops++;
+    }
+    st->last = addr;
+}
+
+// เดิน subtree ตามลำดับเดียวกับที่ compact จัดวาง (ไม่ข้าม mount point)
+static void statsWalk(mountkit &mount, CompactStats *st, MyFolder *folder) {
+    MyIter it;
+    mount.iter_begin(&it, folder, MOUNTKIT_ITER_PRE | MOUNTKIT_ITER_FILES);
+    while (mount.iter_next(&it)) {
+        if (it.file) {
+            statsTouch(st, it.file);
+            statsTouch(st, it.file->name);
+            st->nodes++;
+            st->slack += it.file->capacity - it.file->size;
+        } else {
+            statsTouch(st, it.folder);
+            statsTouch(st, it.folder->data);
+            st->nodes++;
+        }
+    }
+    mount.iter_end(&it);
+}
+
+// เวลาเดิน tree หนึ่งรอบ (ms) - เดินซ้ำหลายรอบเพื่อให้ clock() วัดได้
+static double timeWalk(mountkit &mount, MyFolder *folder) {
+    const int rounds = 16;
+    volatile size_t sink = 0;
+    clock_t start = clock();
+    for (int r = 0; r < rounds; ++r) {
+        CompactStats st;
+        memset(&st, 0, sizeof(st));
+        statsWalk(mount, &st, folder);
+        sink += st.nodes;
+    }
+    (void)sink;
+    return ((double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC) / rounds;
+}
+
+// copy subtree ลง arena ตามลำดับ pre-order: folder, ชื่อ, ไฟล์ แล้วจึง subdirectories
+// ช่อง iter_data ของแต่ละระดับเก็บ link ที่ copy ตัวถัดไปของระดับนั้นต้องต่อเข้า
+static MyFolder* compactCopy(mountkit &mount, CompactArena *arena, MyFolder *folder) {
+    MyFolder *result = NULL;
+    bool ok = true;
+    MyIter it;
+    mount.iter_begin(&it, folder, MOUNTKIT_ITER_PRE);
+    *mount.iter_data(&it, 0) = &result;
+    while (ok && mount.iter_next(&it)) {
+        MyFolder *src = it.folder;
+        MyFolder *copy = (MyFolder*)arenaAlloc(arena, sizeof(MyFolder));
+        char *name = arenaStrdup(arena, src->data);
+        if (!copy || !name) {
+            ok = false;
+            break;
+        }
+        *copy = *src;
+        copy->data = name;
+        copy->alloc_flags = MOUNTKIT_ALLOC_NODE | MOUNTKIT_ALLOC_NAME;
+        copy->subdir = NULL;
+        copy->dir = NULL;
+        copy->lock = 0;
+        copy->index = NULL; // entry ชี้ไปยัง node เดิม - สร้างใหม่ใน compactRelease
+
+        MyFile **file_link = &copy->files;
+        for (MyFile *f = src->files; f && ok; f = f->next) {
+            MyFile *fc = (MyFile*)arenaAlloc(arena, sizeof(MyFile));
+            uint8_t *fname = (uint8_t*)arenaStrdup(arena, (char*)f->name);
+            if (!fc || !fname) {
+                ok = false;
+                break;
+            }
+            *fc = *f;
+            fc->name = fname;
+            fc->next = NULL;
+            fc->alloc_flags = MOUNTKIT_ALLOC_NODE | MOUNTKIT_ALLOC_NAME;
+            fc->lock = 0;
+            fc->seq = 0;
+            fc->cache = NULL; // ผลที่จำไว้หมดอายุอยู่แล้ว (compact เพิ่มรุ่นของ tree) - ก้อนเดิมคืนพร้อมไฟล์เดิม
+            bool kept = !f->link && f->links > 1; // ชื่ออื่นชี้ node นี้อยู่ - compactRelease ใส่ node เดิมแทน copy
+            if (!kept && !f->link && (f->size < COMPACT_SMALL_DATA || (f->alloc_flags & MOUNTKIT_ALLOC_DATA))) {
+                size_t capacity = f->size < COMPACT_MIN_DATA ? COMPACT_MIN_DATA : f->size;
+                fc->data = (uint8_t*)arenaAlloc(arena, capacity);
+                if (!fc->data) {
+                    ok = false;
+                    break;
+                }
+                memcpy(fc->data, f->data, f->size);
+                fc->capacity = capacity;
+                fc->alloc_flags |= MOUNTKIT_ALLOC_DATA;
+            }
+            // data ขนาดใหญ่: ใช้ buffer เดิม (ตัด slack ตอน commit)
+            *file_link = fc;
+            file_link = &fc->next;
+        }
+
+        void **sibling_link = mount.iter_data(&it, 1);
+        *(MyFolder**)*sibling_link = copy;
+        *sibling_link = &copy->dir;
+        *mount.iter_data(&it, 0) = &copy->subdir;
+    }
+    if (it.failed) ok = false;
+    mount.iter_end(&it);
+    return ok ? result : NULL;
+}
+
+// คืนหน่วยความจำของ tree เดิมหลัง commit (data ขนาดใหญ่ถูกโอนไปแล้วจึงไม่ free)
+// เดิน tree เดิม - ช่อง iter_data ของแต่ละระดับเก็บ copy ตัวถัดไปที่คู่กับ folder ของระดับนั้น
+// ไฟล์ที่มี hard link ชี้อยู่ไม่ถูกย้าย: node เดิมแทนที่ copy ของมันใน chain ใหม่
+// watch ของ node ที่ถูกคืนย้ายไปอยู่กับ copy ก่อน - address เดิมอาจถูกใช้ใหม่
+void mountkit::compactRelease(MyFolder *folder, MyFolder *copy) {
+    MyIter it;
+    iter_begin(&it, folder, MOUNTKIT_ITER_PRE | MOUNTKIT_ITER_POST);
+    *iter_data(&it, 0) = copy;
+    while (iter_next(&it)) {
+        if (it.post) {
+            releaseFolderNode(it.folder);
+            continue;
+        }
+        void **pair_slot = iter_data(&it, 1);
+        MyFolder *pair = (MyFolder*)*pair_slot;
+        *pair_slot = pair->dir;
+        *iter_data(&it, 0) = pair->subdir;
+        watchRetarget(it.folder, pair);
+
+        MyFile *f = it.folder->files;
+        MyFile **fc_link = &pair->files;
+        while (f) {
+            MyFile *next = f->next;
+            MyFile *fc = *fc_link;
+            if (!f->link && f->links > 1) {
+                // copy ใช้ data buffer เดียวกับ f - คืนเฉพาะ node และชื่อใน arena
+                f->next = fc->next;
+                f->folder = fc->folder;
+                *fc_link = f;
+                arenaRelease(fc->name);
+                arenaRelease(fc);
+                fc = f;
+            } else if (fc->alloc_flags & MOUNTKIT_ALLOC_DATA) {
+                watchRetarget(f, fc);
+                releaseFile(f);
+            } else {
+                watchRetarget(f, fc);
+                // ตัด slack ของ buffer ที่โอนมา
+                if (fc->capacity > fc->size && fc->size >= COMPACT_MIN_DATA) {
+                    uint8_t *shrunk = (uint8_t*)realloc(fc->data, fc->size);
+                    if (shrunk) {
+                        usageResize(fc, fc->size, fc->size, fc->capacity, fc->size);
+                        fc->data = shrunk;
+                        fc->capacity = fc->size;
+                    }
+                }
+                f->data = NULL;
+                f->alloc_flags &= (uint8_t)~MOUNTKIT_ALLOC_DATA;
+                releaseFile(f);
+            }
+            f = next;
+            fc_link = &fc->next;
+        }
+        // copy มีลูกครบแล้ว (ถ้าจองไม่ได้ copy ก็แค่ไม่มี index)
+        if (it.folder->index) index_enable(pair);
+    }
+    iter_end(&it);
+}
+
+int mountkit::compact(MyFolder **root, MyCompactReport *report) {
+    if (!root || !*root) return 0;
+    MyFolder *old_root = *root;
+
+    CompactStats before;
+    memset(&before, 0, sizeof(before));
+    statsWalk(*this, &before, old_root);
+    double walk_before = report ? timeWalk(*this, old_root) : 0.0;
+
+    CompactArena arena = { NULL, NULL, false };
+    MyFolder *new_root = compactCopy(*this, &arena, old_root);
+    if (!new_root || arena.failed) {
+        // rollback: tree เดิมยังไม่ถูกแตะ
+        ArenaChunk *chunk = arena.head;
+        while (chunk) {
+            ArenaChunk *next = chunk->next;
+            arenaChunkFree(chunk);
+            chunk = next;
+        }
+        return 0;
+    }
+
+    // ยอดของ copy (capacity ถูกตัดแล้ว, file->folder ชี้ไปยัง copy) - ส่วนต่างจากยอดเดิมส่งขึ้นไปยัง parent
+    usageRebuild(new_root);
+    if (new_root->parent) {
+        usageAdd(new_root->parent, &old_root->usage, true);
+        usageAdd(new_root->parent, &new_root->usage, false);
+    }
+    new_root->dir = old_root->dir;
+    *root = new_root;
+    // index ของ parent ยังชี้ไปยัง root เดิม - สลับเป็น copy ก่อน root เดิมถูกคืน
+    if (new_root->parent && new_root->parent->index) {
+        indexRemove(new_root->parent, old_root, NULL);
+        indexInsert(new_root->parent, new_root, NULL);
+    }
+    compactRelease(old_root, new_root);
+    linkInvalidate(); // folder ที่ symlink จำไว้ถูกย้าย
+
+    if (report) {
+        CompactStats after;
+        memset(&after, 0, sizeof(after));
+        statsWalk(*this, &after, new_root);
+        report->nodes = after.nodes;
+        report->slack_before = before.slack;
+        report->slack_after = after.slack;
+        report->far_hops_before = before.hops ? (double)before.far_hops / before.hops : 0.0;
+        report->far_hops_after = after.hops ? (double)after.far_hops / after.hops : 0.0;
+        report->walk_ms_before = walk_before;
+        report->walk_ms_after = timeWalk(*this, new_root);
+    }
+    return 1;
+}
+
+#endif // EMBEDDED_BUILD
@@ -0,0 +1,265 @@
+#include "MountkitInternal.h"
+
+// concurrent mode: reader-writer lock ขนาด 32 bit ฝังอยู่ใน MyFolder/MyFile
+// bit 31 = มี writer ถืออยู่, bit 30 = มี writer รออยู่ (reader ใหม่ต้องรอ), bit 0-29 = จำนวน reader
+
+#ifndef EMBEDDED_BUILD
+    #include <atomic>
+    #include <thread>
+    #include <mutex>
+    #include <chrono>
+#endif
+
+#define LOCK_WRITER  0x80000000u
+#define LOCK_PENDING 0x40000000u
+#define LOCK_SPIN    64  // จำนวนรอบที่ spin ก่อนเริ่ม yield
+
+#ifndef EMBEDDED_BUILD
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "lock word must be a plain 32-bit atomic");
+
+static inline std::atomic<uint32_t>* lockWord(uint32_t *word) {
+    return sharedField(word);
+}
+
+static inline void lockBackoff(int spin) {
+    if (spin >= LOCK_SPIN) std::this_thread::yield();
+}
+
+void rwReadLock(uint32_t *word) {
+    std::atomic<uint32_t> *w = lockWord(word);
+    uint32_t v = w->load(std::memory_order_relaxed);
+    for (int spin = 0;; ++spin) {
+        if (!(v & (LOCK_WRITER | LOCK_PENDING))) {
+            if (w->compare_exchange_weak(v, v + 1, std::memory_order_acquire, std::memory_order_relaxed)) return;
+        } else {
+            lockBackoff(spin);
+            v = w->load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void rwReadUnlock(uint32_t *word) {
+    lockWord(word)->fetch_sub(1, std::memory_order_release);
+}
+
+void rwWriteLock(uint32_t *word) {
+    std::atomic<uint32_t> *w = lockWord(word);
+    uint32_t v = w->load(std::memory_order_relaxed);
+    for (int spin = 0;; ++spin) {
+        if ((v & ~LOCK_PENDING) == 0) {
+            // ว่าง (อาจมี pending ของตัวเองหรือ writer อื่นค้างอยู่ - writer ตัวถัดไปจะตั้งใหม่เอง)
+            if (w->compare_exchange_weak(v, LOCK_WRITER, std::memory_order_acquire, std::memory_order_relaxed)) return;
+        } else {
+            if (!(v & LOCK_PENDING)) w->fetch_or(LOCK_PENDING, std::memory_order_relaxed);
+            lockBackoff(spin);
+            v = w->load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void rwWriteUnlock(uint32_t *word) {
+    lockWord(word)->fetch_and(~LOCK_WRITER, std::memory_order_release);
+}
+
+void mountkit::readLock(uint32_t *word) {
+    if (concurrent) rwReadLock(word);
+}
+
+void mountkit::readUnlock(uint32_t *word) {
+    if (concurrent) rwReadUnlock(word);
+}
+
+void mountkit::writeLock(uint32_t *word) {
+    if (concurrent) rwWriteLock(word);
+}
+
+void mountkit::writeUnlock(uint32_t *word) {
+    if (concurrent) rwWriteUnlock(word);
+}
+
+// second ขอแบบไม่รอ: ถ้าไม่ว่างให้ปล่อย first แล้วเริ่มใหม่ - ไม่เคยรอ lock ขณะถือ lock อื่น จึงไม่ deadlock
+// กับผู้ที่ lock จากบนลงล่าง (ไม่ตั้ง pending บน second: reader ที่ถือ second อยู่อาจกำลังรอ first)
+void mountkit::writeLockPair(uint32_t *first, uint32_t *second) {
+    if (!concurrent) return;
+    std::atomic<uint32_t> *w = lockWord(second);
+    for (int spin = 0;; ++spin) {
+        writeLock(first);
+        uint32_t v = w->load(std::memory_order_relaxed);
+        if ((v & ~LOCK_PENDING) == 0 &&
+            w->compare_exchange_strong(v, LOCK_WRITER, std::memory_order_acquire, std::memory_order_relaxed)) return;
+        writeUnlock(first);
+        lockBackoff(spin);
+    }
+}
+
+void mountkit::set_concurrent(bool enable) {
+    concurrent = enable;
+}
+
+// =================================================================
+// concurrent_benchmark
+// =================================================================
+
+#define BENCH_DIRS      8            // subdirectory ต่อ worker
+#define BENCH_FILES     4            // ไฟล์ต่อ subdirectory
+#define BENCH_NAMES     16           // ชื่อไฟล์ที่ mk วนใช้ (จำกัดจำนวนไฟล์ไม่ให้โตไม่สิ้นสุด)
+#define BENCH_LOG_LIMIT (64 * 1024)  // append จนถึงขนาดนี้แล้วเริ่มใหม่
+
+typedef struct BenchWorker {
+    mountkit *mount;
+    MyFolder *root;
+    std::mutex *global;   // ไม่ใช่ NULL = ครอบทุก call ด้วย mutex ตัวเดียว (แบบเดิม)
+    int id;
+    int ops;
+} BenchWorker;
+
+// ถือ global mutex ระหว่าง call หนึ่งครั้ง (ไม่ทำอะไรถ้าใช้ lock ต่อ folder)
+struct BenchGuard {
+    std::mutex *m;
+    explicit BenchGuard(std::mutex *mutex) : m(mutex) { if (m) m->lock(); }
+    ~BenchGuard() { if (m) m->unlock(); }
+};
+
+static void benchWorker(BenchWorker *w) {
+    mountkit *mount = w->mount;
+    uint32_t seed = 2463534242u ^ (uint32_t)(w->id * 2654435761u);
+    uint8_t buffer[256];
+    char path[64], name[16];
+    memset(buffer, 'x', sizeof(buffer));
+
+    for (int i = 0; i < w->ops; ++i) {
+        seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+        uint32_t op = seed % 100;
+        bool shared = (seed >> 8) % 8 == 0;  // 1 ใน 8 ไปที่ var/log ที่ทุก thread ใช้ร่วมกัน
+        if (shared) {
+            snprintf(path, sizeof(path), "var/log");
+        } else {
+            snprintf(path, sizeof(path), "home/w%d/d%u", w->id, (seed >> 12) % BENCH_DIRS);
+        }
+
+        MyFolder *folder;
+        {
+            BenchGuard g(w->global);
+            folder = mount->cd(w->root, path);
+        }
+        if (!folder || op < 40) continue;  // 40% cd อย่างเดียว
+
+        if (op < 90) {
+            // 35% read, 15% append - หาไฟล์ด้วย mk (คืนไฟล์เดิมถ้ามีอยู่แล้ว)
+            if (shared) {
+                snprintf(name, sizeof(name), "syslog");
+            } else {
+                snprintf(name, sizeof(name), "f%u", (seed >> 16) % BENCH_FILES);
+            }
+            MyFile *file;
+            {
+                BenchGuard g(w->global);
+                file = mount->mk(folder, name);
+            }
+            if (!file) continue;
+            BenchGuard g(w->global);
+            if (op < 75) {
+                mount->read(file, buffer, sizeof(buffer), 0);
+            } else if (mount->read(file, buffer, 1, BENCH_LOG_LIMIT) > 0) {
+                // ยาวเกิน limit แล้ว - เริ่มใหม่
+                mount->write(file, buffer, 64);
+            } else {
+                mount->append(file, buffer, 64);
+            }
+        } else {
+            // 10% mk ชื่อที่วนอยู่ในชุดจำกัด
+            snprintf(name, sizeof(name), "n%u", (seed >> 16) % BENCH_NAMES);
+            BenchGuard g(w->global);
+            mount->mk(folder, name);
+        }
+    }
+}
+
+// รัน worker n ตัวพร้อมกันแล้วคืน operations ต่อวินาที
+static double benchRun(mountkit *mount, MyFolder *root, std::mutex *global, int threads, int ops) {
+    BenchWorker *workers = new BenchWorker[threads];
+    std::thread *pool = new std::thread[threads];
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t) {
+        workers[t].mount = mount;
+        workers[t].root = root;
+        workers[t].global = global;
+        workers[t].id = t;
+        workers[t].ops = ops;
+        pool[t] = std::thread(benchWorker, &workers[t]);
+    }
+    for (int t = 0; t < threads; ++t) pool[t].join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    delete[] pool;
+    delete[] workers;
+    return seconds > 0 ? (double)threads * ops / seconds : 0.0;
+}
+
+int mountkit::concurrent_benchmark(int max_threads, int ops_per_thread) {
+    if (max_threads < 1 || ops_per_thread < 1) return 0;
+
+    // home/w<i>/d<k>/f<j> ต่อ worker และ var/log/syslog ที่แชร์กัน
+    MyFolder *root = NULL;
+    char path[64], name[16];
+    uint8_t block[4096];
+    memset(block, 'L', sizeof(block));
+    MyFolder *log = mkdir(&root, "root/var/log");
+    MyFile *syslog = log ? mk(log, "syslog") : NULL;
+    if (!syslog || !write(syslog, block, sizeof(block))) {
+        removeFolder(root);
+        return 0;
+    }
+    for (int t = 0; t < max_threads; ++t) {
+        for (int d = 0; d < BENCH_DIRS; ++d) {
+            snprintf(path, sizeof(path), "root/home/w%d/d%d", t, d);
+            MyFolder *folder = mkdir(&root, path);
+            for (int f = 0; folder && f < BENCH_FILES; ++f) {
+                snprintf(name, sizeof(name), "f%d", f);
+                MyFile *file = mk(folder, name);
+                if (file) write(file, block, 256);
+            }
+            if (!folder) {
+                removeFolder(root);
+                return 0;
+            }
+        }
+    }
+
+    bool was_concurrent = concurrent;
+    bool was_lockfree = lockfree_reads;
+    std::mutex global;
+    printf("\n=== CONCURRENT BENCHMARK (%d ops/thread: 40%% cd, 35%% read, 15%% append, 10%% mk) ===\n",
+           ops_per_thread);
+    printf("%8s  %18s  %18s  %18s  %8s\n", "threads", "global mutex", "per-folder locks", "lock-free reads", "speedup");
+    for (int threads = 1;; threads *= 2) {
+        if (threads > max_threads) threads = max_threads;
+        set_lockfree_reads(false);
+        concurrent = false;
+        double baseline = benchRun(this, root, &global, threads, ops_per_thread);
+        concurrent = true;
+        double locked = benchRun(this, root, NULL, threads, ops_per_thread);
+        set_lockfree_reads(true);
+        double lockfree = benchRun(this, root, NULL, threads, ops_per_thread);
+        double best = locked > lockfree ? locked : lockfree;
+        printf("%8d  %13.0f op/s  %13.0f op/s  %13.0f op/s  %7.2fx\n",
+               threads, baseline, locked, lockfree, baseline > 0 ? best / baseline : 0.0);
+        if (threads == max_threads) break;
+    }
+    set_lockfree_reads(was_lockfree);
+    concurrent = was_concurrent;
+
+    removeFolder(root);
+    return 1;
+}
+
+#else
+
+// embedded build ไม่มี thread - lock เป็น no-op
+void mountkit::readLock(uint32_t *word) { (void)word; }
+void mountkit::readUnlock(uint32_t *word) { (void)word; }
+void mountkit::writeLock(uint32_t *word) { (void)word; }
+void mountkit::writeUnlock(uint32_t *word) { (void)word; }
+void mountkit::writeLockPair(uint32_t *first, uint32_t *second) { (void)first; (void)second; }
+
+#endif // EMBEDDED_BUILD
@@ -0,0 +1,351 @@
+#include "MountkitInternal.h"
+
+// find: จับคู่ tree กับ glob pattern ทีละ component ("root/src/**/*.[ch]")
+// component ที่เป็น literal ต้นทางถูก resolve ด้วยการค้นหาชื่อใน folder ตรง ๆ แบบเดียวกับ cd (ไม่เดิน subtree)
+// ส่วนที่เหลือเดินด้วย iterator โดยเก็บชุดของตำแหน่งใน pattern ที่ยังไปต่อได้ของแต่ละ folder เป็น bitmask
+// folder ที่ไม่มีตำแหน่งไหนไปต่อได้ถูก prune ทันที (ไม่อ่านลูกของมันเลย)
+
+#define FIND_PATH_MAX  256 // เท่ากับ buffer ของ cd/mkdir
+#define FIND_PARTS_MAX 31  // bit ที่ 0..count ต้องพอใน uint32_t
+
+// ชนิดของ component
+#define FIND_LITERAL 0 // ไม่มี wildcard - เทียบด้วย strcmp
+#define FIND_GLOB    1 // มี *, ?, [...] หรือ escape
+#define FIND_ANY     2 // "**" = folder กี่ชั้นก็ได้ (รวม 0 ชั้น)
+
+typedef struct FindPattern {
+    char buf[FIND_PATH_MAX];
+    const char *parts[FIND_PARTS_MAX];
+    uint8_t kind[FIND_PARTS_MAX];
+    int count;
+    uint32_t files;   // ตำแหน่งที่ชื่อไฟล์ชื่อเดียวทำให้ครบ pattern ได้ (ข้ามไฟล์ของ folder ที่ไม่มีตำแหน่งเหล่านี้)
+} FindPattern;
+
+// ตัวอักษรหนึ่งตัวของ pattern (?, [...], \x หรือตัวอักษรปกติ) - เลื่อน *pp ไปตัวถัดไปถ้าตรง
+static bool globOne(const char **pp, char c) {
+    const char *p = *pp;
+    if (*p == '?') {
+        *pp = p + 1;
+        return true;
+    }
+    if (*p == '[') {
+        const char *q = p + 1;
+        bool negate = (*q == '!' || *q == '^');
+        if (negate) q++;
+        bool hit = false;
+        // ']' ตัวแรกเป็นสมาชิกของ class
+        for (bool first = true; *q && (*q != ']' || first); ++q, first = false) {
+            uint8_t lo = (uint8_t)*q;
+            if (lo == '\\' && q[1]) lo = (uint8_t)*++q;
+            uint8_t hi = lo;
+            if (q[1] == '-' && q[2] && q[2] != ']') {
+                q += 2;
+                if (*q == '\\' && q[1]) q++;
+                hi = (uint8_t)*q;
+            }
+            if ((uint8_t)c >= lo && (uint8_t)c <= hi) hit = true;
+        }
+        if (*q == ']') {
+            *pp = q + 1;
+            return hit != negate;
+        }
+        // ไม่มี ']' ปิด - ถือว่า '[' เป็นตัวอักษรธรรมดา
+    }
+    if (*p == '\\' && p[1]) p++;
+    if (*p != c) return false;
+    *pp = p + 1;
+    return true;
+}
+
+// glob ของชื่อหนึ่งชื่อ: '*' ย้อนกลับไปยัง '*' ล่าสุดเท่านั้น (ไม่มี recursion)
+static bool globMatch(const char *p, const char *s) {
+    const char *star_p = NULL, *star_s = NULL;
+    while (*s) {
+        if (*p == '*') {
+            star_p = ++p;
+            star_s = s;
+            continue;
+        }
+        if (*p && globOne(&p, *s)) {
+            s++;
+            continue;
+        }
+        if (!star_p) return false;
+        p = star_p;
+        s = ++star_s;
+    }
+    while (*p == '*') p++;
+    return *p == '\0';
+}
+
+static bool findHasMeta(const char *part) {
+    return strpbrk(part, "*?[\\") != NULL;
+}
+
+// ตำแหน่ง "**" ที่ active ทำให้ตำแหน่งถัดไป active ด้วย (จับคู่ 0 folder)
+static uint32_t findClosure(const FindPattern *p, uint32_t mask) {
+    for (int i = 0; i < p->count; ++i) {
+        if (((mask >> i) & 1) && p->kind[i] == FIND_ANY) mask |= 1u << (i + 1);
+    }
+    return mask;
+}
+
+// ตำแหน่งที่ active หลังผ่านชื่อ name หนึ่งชั้น
+static uint32_t findStep(const FindPattern *p, uint32_t mask, const char *name) {
+    uint32_t next = 0;
+    for (int i = 0; i < p->count; ++i) {
+        if (!((mask >> i) & 1)) continue;
+        if (p->kind[i] == FIND_ANY) {
+            next |= 1u << i;
+        } else if (p->kind[i] == FIND_LITERAL ? strcmp(p->parts[i], name) == 0 : globMatch(p->parts[i], name)) {
+            next |= 1u << (i + 1);
+        }
+    }
+    return findClosure(p, next);
+}
+
+// แยก pattern เป็น component - component แรกที่ตรงกับชื่อ root ถูกข้ามแบบเดียวกับ cd
+static bool findCompile(const char *pattern, const char *root_name, FindPattern *out) {
+    if (strlen(pattern) >= sizeof(out->buf)) return false;
+    strcpy(out->buf, pattern);
+    out->count = 0;
+    out->files = 0;
+    for (char *p = out->buf; *p;) {
+        if (*p == '/') {
+            *p++ = '\0';
+            continue;
+        }
+        if (out->count == FIND_PARTS_MAX) return false;
+        out->parts[out->count++] = p;
+        while (*p && *p != '/') p++;
+    }
+    int skip = (out->count > 0 && root_name && strcmp(out->parts[0], root_name) == 0) ? 1 : 0;
+    for (int i = skip; i < out->count; ++i) {
+        const char *part = out->parts[i];
+        out->parts[i - skip] = part;
+        out->kind[i - skip] = strcmp(part, "**") == 0 ? FIND_ANY : findHasMeta(part) ? FIND_GLOB : FIND_LITERAL;
+    }
+    out->count -= skip;
+    uint32_t done = 1u << out->count;
+    for (int i = 0; i < out->count; ++i) {
+        if (out->kind[i] == FIND_ANY || (findClosure(out, 1u << (i + 1)) & done)) out->files |= 1u << i;
+    }
+    return true;
+}
+
+// path ของ node ปัจจุบัน = path ของ folder เริ่มต้น (path[0..prefix)) + path ใต้ folder นั้น
+static void findPath(mountkit &mount, MyIter *it, char *path, size_t prefix) {
+    path[prefix] = '\0';
+    if (it->depth == 0 || prefix + 1 >= FIND_PATH_MAX) return;
+    path[prefix] = '/';
+    mount.iter_path(it, path + prefix + 1, FIND_PATH_MAX - prefix - 1, 1);
+}
+
+int mountkit::find(MyFolder *root, const char *pattern, mountkit_find_fn fn, void *ctx) {
+    FindPattern p;
+    if (!root || !pattern || !fn || !findCompile(pattern, root->data, &p)) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    const uint32_t live = (1u << p.count) - 1;
+    const uint32_t done = 1u << p.count;
+
+    // 1. literal prefix: ค้นหาชื่อทีละชั้นด้วย lock แบบ hand-over-hand เหมือน cd
+    //    component สุดท้ายไม่ถูก resolve ที่นี่เพราะอาจเป็นได้ทั้งไฟล์และ folder
+    char path[FIND_PATH_MAX];
+    size_t prefix = (size_t)snprintf(path, sizeof(path), "%s", root->data);
+    int start = 0;
+    rcuEnter();
+    MyFolder *folder = followMount(root);
+    lookupLock(&folder->lock);
+    while (start < p.count - 1 && p.kind[start] == FIND_LITERAL) {
+        MyFolder *iter = loadShared(&folder->subdir);
+        while (iter && strcmp(iter->data, p.parts[start]) != 0) {
+            iter = loadShared(&iter->dir);
+        }
+        MyFolder *next = followMount(iter);
+        if (next) lookupLock(&next->lock);
+        lookupUnlock(&folder->lock);
+        folder = next;
+        if (!folder) break;
+        if (prefix < sizeof(path)) prefix += (size_t)snprintf(path + prefix, sizeof(path) - prefix, "/%s", p.parts[start]);
+        start++;
+    }
+    if (folder) lookupUnlock(&folder->lock);
+    rcuLeave();
+    if (!folder) return 0; // ไม่มี match ไม่ใช่ error
+    if (prefix >= sizeof(path)) prefix = sizeof(path) - 1;
+
+    // 2. เดิน subtree ที่เหลือ: ช่อง iter_data ของแต่ละ folder เก็บ mask ของตำแหน่งที่ active ใต้ folder นั้น
+    //    folder ที่มีตำแหน่งไปต่อได้ถูก read lock ตั้งแต่ pre-visit จนถึง post-visit
+    int matches = 0;
+    bool stop = false;
+    MyIter it;
+    iter_begin(&it, folder, MOUNTKIT_ITER_PRE | MOUNTKIT_ITER_POST | MOUNTKIT_ITER_FILES | MOUNTKIT_ITER_MOUNTS);
+    while (iter_next(&it)) {
+        if (it.file) {
+            uint32_t mask = (uint32_t)(uintptr_t)*iter_data(&it, 0);
+            if (stop || !(mask & p.files)) continue;
+            if (!(findStep(&p, mask, (const char*)it.file->name) & done)) continue;
+            findPath(*this, &it, path, prefix);
+            matches++;
+            if (!fn(ctx, path, NULL, it.file)) {
+                stop = true;
+                iter_prune(&it);
+            }
+            continue;
+        }
+        void **slot = iter_data(&it, 0);
+        if (it.post) {
+            if ((uintptr_t)*slot & live) readUnlock(&it.folder->lock);
+            continue;
+        }
+        uint32_t mask = 0;
+        if (!stop) {
+            mask = it.depth == 0 ? findClosure(&p, 1u << start)
+                                 : findStep(&p, (uint32_t)(uintptr_t)*iter_data(&it, 1), it.entry->data);
+        }
+        if (mask & done) {
+            findPath(*this, &it, path, prefix);
+            matches++;
+            if (!fn(ctx, path, it.folder, NULL)) {
+                stop = true;
+                mask = 0;
+            }
+        }
+        *slot = (void*)(uintptr_t)mask;
+        if (mask & live) readLock(&it.folder->lock);
+        else iter_prune(&it);
+    }
+    if (it.failed) {
+        // stack โตไม่ได้ - ปล่อย lock ของ folder ที่ยังค้างอยู่บน stack (frame 0 คือระดับเหนือ folder เริ่มต้น)
+        for (size_t i = 1; i < it.count; ++i) {
+            if ((uintptr_t)it.frames[i].data & live) readUnlock(&followMount(it.frames[i].node)->lock);
+        }
+        setError(MOUNTKIT_ENOMEM);
+    }
+    iter_end(&it);
+    return matches;
+}
+
+#ifndef EMBEDDED_BUILD
+
+#include <chrono>
+#include <vector>
+
+// =================================================================
+// find_benchmark
+// =================================================================
+
+#define FIND_FANOUT    8  // subdirectory ต่อ folder ใน tree ของ find_benchmark
+#define FIND_FILE_DATA 16 // capacity ของไฟล์ใน tree ของ find_benchmark
+
+// แบบเดิม: เดินทุก node สร้าง path เต็ม แล้วจับคู่ทั้ง path กับ pattern
+static int findScanAll(mountkit &mount, MyFolder *root, const FindPattern *p) {
+    const uint32_t done = 1u << p->count;
+    char path[FIND_PATH_MAX];
+    int matches = 0;
+    MyIter it;
+    mount.iter_begin(&it, root, MOUNTKIT_ITER_PRE | MOUNTKIT_ITER_FILES | MOUNTKIT_ITER_MOUNTS);
+    while (mount.iter_next(&it)) {
+        mount.iter_path(&it, path, sizeof(path));
+        // component แรกคือชื่อ root (ถูกตัดออกจาก pattern แล้ว)
+        uint32_t mask = findClosure(p, 1);
+        char *cursor = strchr(path, '/');
+        while (cursor && mask) {
+            char *name = cursor + 1;
+            cursor = strchr(name, '/');
+            if (cursor) *cursor = '\0';
+            mask = findStep(p, mask, name);
+        }
+        if (mask & done) matches++;
+    }
+    mount.iter_end(&it);
+    return matches;
+}
+
+static double findSeconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int mountkit::find_benchmark(size_t nodes) {
+    // folder ละ 2 ไฟล์ - node 3 ตัวต่อ folder
+    size_t folders = nodes / 3;
+    if (folders < 1) return 0;
+
+    // tree ทดสอบ: folder ละ FIND_FANOUT subdirectory (สร้างแบบ BFS) และไฟล์ว่าง a.txt, b.txt
+    MyFolder *root = NULL;
+    createFolder(&root, "root");
+    std::vector<MyFolder*> all;
+    if (root) all.push_back(root);
+    char name[16];
+    int ok = root != NULL;
+    for (size_t parent = 0; ok && parent < all.size() && all.size() < folders; ++parent) {
+        for (int k = FIND_FANOUT - 1; k >= 0 && all.size() < folders; --k) {
+            MyFolder *child = NULL;
+            snprintf(name, sizeof(name), "d%d", k);
+            createFolder(&child, name);
+            if (!child) {
+                ok = 0;
+                break;
+            }
+            child->dir = all[parent]->subdir;
+            all[parent]->subdir = child;
+            all.push_back(child);
+        }
+    }
+    for (size_t i = 0; ok && i < all.size(); ++i) {
+        // สลับไปใช้ buffer เล็กแทนการ realloc ลดขนาด - block 4KB ที่คืนถูกใช้ซ้ำโดยไฟล์ถัดไปทั้งก้อน
+        // (realloc ลดขนาดทิ้งเศษที่ใช้ซ้ำไม่ได้ไว้ทุกไฟล์ และ tree 10M node จะไม่พอ memory)
+        for (int k = 0; ok && k < 2; ++k) {
+            MyFile *file = mk(all[i], k ? "b.txt" : "a.txt");
+            uint8_t *small = file ? (uint8_t*)malloc(FIND_FILE_DATA) : NULL;
+            if (!small) ok = 0;
+            else swapData(file, small, FIND_FILE_DATA, 0);
+        }
+    }
+    std::vector<MyFolder*>().swap(all);
+    if (ok) usageRebuild(root); // folder ถูกต่อ link เอง
+    if (!ok) {
+        removeFolder(root);
+        return 0;
+    }
+
+    static const char *patterns[] = {
+        "root/d1/d2/d3/*.txt",   // literal prefix ลึก 3 ชั้น
+        "root/*/d0/*/a.txt",     // glob ที่จำกัดความลึก
+        "root/d[0-1]/**/b.txt",  // ** ใต้ subtree ที่เลือกด้วย class
+        "root/**/d7/a.txt",      // ** ทั้ง tree
+        "root/**/x*",            // ไม่มี match - ต้องเดินทั้ง tree ทั้งสองแบบ
+    };
+    mountkit_find_fn count = [](void *ctx, const char *path, MyFolder *folder, MyFile *file) {
+        (void)path; (void)folder; (void)file;
+        (*(int*)ctx)++;
+        return 1;
+    };
+
+    printf("\n=== FIND BENCHMARK (%zu folders, %zu nodes) ===\n", folders, folders * 3);
+    printf("%-24s  %9s  %14s  %14s  %9s\n", "pattern", "matches", "find", "scan all", "speedup");
+    for (size_t i = 0; ok && i < sizeof(patterns) / sizeof(patterns[0]); ++i) {
+        FindPattern p;
+        findCompile(patterns[i], root->data, &p);
+
+        int found = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        int matches = find(root, patterns[i], count, &found);
+        double find_s = findSeconds(start);
+
+        start = std::chrono::steady_clock::now();
+        int scanned = findScanAll(*this, root, &p);
+        double scan_s = findSeconds(start);
+
+        if (matches != found || matches != scanned) ok = 0;
+        printf("%-24s  %9d  %11.2f ms  %11.2f ms  %8.1fx\n", patterns[i], matches,
+               find_s * 1000.0, scan_s * 1000.0, find_s > 0 ? scan_s / find_s : 0.0);
+    }
+
+    removeFolder(root);
+    return ok;
+}
+
+#endif // EMBEDDED_BUILD
@@ -0,0 +1,281 @@
+#include "MountkitInternal.h"
+
+// grep: ค้นหาข้อความใน data ของทุกไฟล์ใน subtree โดย scan buffer ของไฟล์ตรง ๆ (ไม่ copy)
+// 1. เดิน tree ด้วย iterator เก็บไฟล์ทั้งหมดพร้อม path และ read lock ของแต่ละไฟล์ไว้
+// 2. แบ่งไฟล์เป็นช่วงละ GREP_SEGMENT ให้ thread หยิบทีละช่วง (ไฟล์ใหญ่ไฟล์เดียวก็กระจายได้)
+//    แต่ละช่วงรายงานเฉพาะตำแหน่งเริ่มที่อยู่ในช่วงของตัวเอง แต่อ่านเลยท้ายช่วงได้ len - 1 bytes
+// 3. ส่งผลให้ callback ตามลำดับ path และ offset ใน thread ที่เรียก แล้วปล่อย lock ของไฟล์นั้น
+// hard link: ไฟล์จริงถูกค้นครั้งเดียวภายใต้ชื่อแรกที่เจอ (read lock ซ้ำอาจค้างถ้ามี writer รออยู่), symlink ถูกข้าม
+// kernel: เทียบ byte แรกและ byte สุดท้ายของ needle กับ 16/32 ตำแหน่งพร้อมกัน (SSE2/AVX2)
+// แล้ว memcmp เฉพาะตำแหน่งที่ทั้งสอง byte ตรง - ไม่มี SIMD ใช้ memchr หา byte แรก
+
+#ifndef EMBEDDED_BUILD
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <string>
+#include <unordered_set>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__SSE2__))
+    #include <immintrin.h>
+    #define MOUNTKIT_GREP_X86 1
+#endif
+
+#define GREP_PATH_MAX 256        // เท่ากับ buffer ของ find
+#define GREP_SEGMENT  (1u << 20) // bytes ต่อช่วงที่ thread หยิบไป (และขนาดรวมขั้นต่ำที่คุ้มจะแตก thread)
+
+// คืนตำแหน่งแรกใน hay[0..n) ที่ needle ทั้งก้อนอยู่ใน n bytes นี้ หรือ NULL
+typedef const uint8_t* (*GrepKernel)(const uint8_t *hay, size_t n, const uint8_t *needle, size_t len);
+
+static const uint8_t* grepScalar(const uint8_t *hay, size_t n, const uint8_t *needle, size_t len) {
+    if (n < len) return NULL;
+    const uint8_t *end = hay + (n - len) + 1; // ตำแหน่งเริ่มที่เป็นไปได้ทั้งหมด
+    while (hay < end) {
+        const uint8_t *hit = (const uint8_t*)memchr(hay, needle[0], (size_t)(end - hay));
+        if (!hit) return NULL;
+        if (memcmp(hit + 1, needle + 1, len - 1) == 0) return hit;
+        hay = hit + 1;
+    }
+    return NULL;
+}
+
+#if defined(MOUNTKIT_GREP_X86)
+static const uint8_t* grepSse2(const uint8_t *hay, size_t n, const uint8_t *needle, size_t len) {
+    if (len < 2 || n < len + 16) return grepScalar(hay, n, needle, len);
+    const __m128i first = _mm_set1_epi8((char)needle[0]);
+    const __m128i last = _mm_set1_epi8((char)needle[len - 1]);
+    size_t i = 0;
+    // block ที่ i ต้องอ่าน hay[i + len - 1 .. i + len + 14] ได้
+    for (; i + len + 15 <= n; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(hay + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(hay + i + len - 1));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last)));
+        while (mask) {
+            size_t at = i + (size_t)__builtin_ctz(mask);
+            if (memcmp(hay + at + 1, needle + 1, len - 2) == 0) return hay + at;
+            mask &= mask - 1;
+        }
+    }
+    return grepScalar(hay + i, n - i, needle, len);
+}
+
+__attribute__((target("avx2")))
+static const uint8_t* grepAvx2(const uint8_t *hay, size_t n, const uint8_t *needle, size_t len) {
+    if (len < 2 || n < len + 32) return grepSse2(hay, n, needle, len);
+    const __m256i first = _mm256_set1_epi8((char)needle[0]);
+    const __m256i last = _mm256_set1_epi8((char)needle[len - 1]);
+    size_t i = 0;
+    for (; i + len + 31 <= n; i += 32) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(hay + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(hay + i + len - 1));
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last)));
+        while (mask) {
+            size_t at = i + (size_t)__builtin_ctz(mask);
+            if (memcmp(hay + at + 1, needle + 1, len - 2) == 0) return hay + at;
+            mask &= mask - 1;
+        }
+    }
+    return grepSse2(hay + i, n - i, needle, len);
+}
+#endif
+
+static GrepKernel grepSelectKernel() {
+    #if defined(MOUNTKIT_GREP_X86)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return grepAvx2;
+        return grepSse2;
+    #else
+        return grepScalar;
+    #endif
+}
+
+static size_t grepNewlines(const uint8_t *p, size_t n) {
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i) count += p[i] == '\n';
+    return count;
+}
+
+typedef struct GrepHit {
+    size_t offset;
+    size_t line;       // จำนวน '\n' ก่อน offset นับจากต้นช่วง
+} GrepHit;
+
+typedef struct GrepFile {
+    MyFile *file;
+    const uint8_t *data; // ค่าที่เห็นตอน lock (append_shared อาจเลื่อน size ต่อแต่ buffer ไม่ถูกสลับ)
+    size_t size;
+    size_t path;         // offset ของ path ใน GrepJob::paths
+    size_t segments;     // ช่วงแรกของไฟล์นี้ใน GrepJob::segments
+} GrepFile;
+
+typedef struct GrepSegment {
+    size_t file;
+    size_t start;
+    size_t end;
+    size_t newlines;     // '\n' ทั้งช่วง (MOUNTKIT_GREP_LINES)
+    std::vector<GrepHit> hits;
+} GrepSegment;
+
+typedef struct GrepJob {
+    const uint8_t *needle;
+    size_t len;
+    int flags;
+    GrepKernel kernel;
+    std::vector<GrepFile> files;
+    std::vector<GrepSegment> segments;
+    std::string paths;
+    std::atomic<size_t> *first; // offset ของตำแหน่งแรกที่พบต่อไฟล์ (MOUNTKIT_GREP_FIRST) - ช่วงที่อยู่หลังจากนั้นไม่ต้อง scan
+    std::atomic<size_t> next;
+} GrepJob;
+
+static void grepSegment(GrepJob *job, GrepSegment *seg) {
+    const GrepFile *f = &job->files[seg->file];
+    const bool lines = (job->flags & MOUNTKIT_GREP_LINES) != 0;
+    const bool first = (job->flags & MOUNTKIT_GREP_FIRST) != 0;
+    size_t limit = seg->end + job->len - 1;
+    if (limit > f->size) limit = f->size;
+
+    size_t pos = seg->start;
+    size_t counted = seg->start;
+    size_t newlines = 0;
+    while (pos < seg->end) {
+        if (first && job->first[seg->file].load(std::memory_order_relaxed) < seg->start) break;
+        const uint8_t *hit = job->kernel(f->data + pos, limit - pos, job->needle, job->len);
+        if (!hit) break;
+        size_t at = (size_t)(hit - f->data);
+        if (at >= seg->end) break;
+        if (lines) {
+            newlines += grepNewlines(f->data + counted, at - counted);
+            counted = at;
+        }
+        GrepHit h = { at, newlines };
+        seg->hits.push_back(h);
+        if (first) {
+            size_t seen = job->first[seg->file].load(std::memory_order_relaxed);
+            while (at < seen && !job->first[seg->file].compare_exchange_weak(seen, at, std::memory_order_relaxed)) {}
+            break;
+        }
+        pos = at + 1; // นับตำแหน่งที่ซ้อนกันด้วย ช่วงจึงไม่ขึ้นกับผลของช่วงก่อนหน้า
+    }
+    if (lines) seg->newlines = newlines + grepNewlines(f->data + counted, seg->end - counted);
+}
+
+int mountkit::grep(MyFolder *root, const char *needle, int flags, mountkit_grep_fn fn, void *ctx) {
+    if (!root || !needle || !needle[0] || !fn) {
+        setError(MOUNTKIT_EINVAL);
+        return -1;
+    }
+
+    static const GrepKernel kernel = grepSelectKernel();
+    GrepJob job;
+    job.needle = (const uint8_t*)needle;
+    job.len = strlen(needle);
+    job.flags = flags;
+    job.kernel = kernel;
+    job.first = NULL;
+    job.next.store(0);
+
+    // 1. เก็บไฟล์: folder ถูก read lock ตั้งแต่ pre-visit จนถึง post-visit (ช่วงที่ iterator อ่านลูกของมัน)
+    //    ไฟล์ที่ยาวพอจะมี needle ถูก read lock ค้างไว้จนส่งผลครบ
+    char path[GREP_PATH_MAX];
+    size_t total = 0;
+    std::unordered_set<MyFile*> linked; // ไฟล์จริงที่มีหลายชื่อและถูกเก็บไปแล้ว
+    MyIter it;
+    iter_begin(&it, root, MOUNTKIT_ITER_PRE | MOUNTKIT_ITER_POST | MOUNTKIT_ITER_FILES | MOUNTKIT_ITER_MOUNTS);
+    while (iter_next(&it)) {
+        if (it.file) {
+            MyFile *inode = fileTarget(it.file);
+            if (inode->kind == MOUNTKIT_DT_LINK) continue;
+            if (loadShared(&inode->links) > 1 && !linked.insert(inode).second) continue;
+            readLock(&inode->lock);
+            GrepFile f;
+            f.file = inode;
+            f.data = loadShared(&inode->data);
+            f.size = loadShared(&inode->size);
+            if (f.size < job.len) {
+                readUnlock(&inode->lock);
+                continue;
+            }
+            size_t len = (size_t)iter_path(&it, path, sizeof(path));
+            if (len >= sizeof(path)) len = sizeof(path) - 1;
+            f.path = job.paths.size();
+            f.segments = 0;
+            job.paths.append(path, len);
+            job.paths.push_back('\0');
+            job.files.push_back(f);
+            total += f.size;
+            continue;
+        }
+        if (it.post) readUnlock(&it.folder->lock);
+        else readLock(&it.folder->lock);
+    }
+    if (it.failed) {
+        // stack โตไม่ได้ - ปล่อย lock ของ folder ที่ยังค้างอยู่บน stack (frame 0 คือระดับเหนือ folder เริ่มต้น)
+        for (size_t i = 1; i < it.count; ++i) readUnlock(&followMount(it.frames[i].node)->lock);
+        for (size_t i = 0; i < job.files.size(); ++i) readUnlock(&job.files[i].file->lock);
+        iter_end(&it);
+        setError(MOUNTKIT_ENOMEM);
+        return -1;
+    }
+    iter_end(&it);
+
+    // 2. แบ่งช่วงแล้ว scan
+    for (size_t i = 0; i < job.files.size(); ++i) {
+        job.files[i].segments = job.segments.size();
+        for (size_t start = 0; start < job.files[i].size; start += GREP_SEGMENT) {
+            GrepSegment seg;
+            seg.file = i;
+            seg.start = start;
+            seg.end = job.files[i].size - start > GREP_SEGMENT ? start + GREP_SEGMENT : job.files[i].size;
+            seg.newlines = 0;
+            job.segments.push_back(seg);
+        }
+    }
+    if (flags & MOUNTKIT_GREP_FIRST) {
+        job.first = new std::atomic<size_t>[job.files.size() ? job.files.size() : 1];
+        for (size_t i = 0; i < job.files.size(); ++i) job.first[i].store((size_t)-1);
+    }
+
+    auto worker = [&job]() {
+        for (size_t i = job.next.fetch_add(1); i < job.segments.size(); i = job.next.fetch_add(1)) {
+            grepSegment(&job, &job.segments[i]);
+        }
+    };
+    // เหมือน verify: ข้อมูลรวมน้อยกว่าหนึ่งช่วงไม่คุ้มที่จะแตก thread
+    unsigned int threads = std::thread::hardware_concurrency();
+    if (threads > job.segments.size()) threads = (unsigned int)job.segments.size();
+    if (total < GREP_SEGMENT || threads < 2) {
+        worker();
+    } else {
+        std::thread *pool = new std::thread[threads - 1];
+        for (unsigned int t = 0; t + 1 < threads; ++t) pool[t] = std::thread(worker);
+        worker();
+        for (unsigned int t = 0; t + 1 < threads; ++t) pool[t].join();
+        delete[] pool;
+    }
+
+    // 3. ส่งผลตามลำดับ - ไฟล์ถูกปล่อยทันทีที่ส่งผลของมันครบ (หรือเมื่อ callback สั่งหยุด)
+    int matches = 0;
+    bool stop = false;
+    for (size_t i = 0; i < job.files.size(); ++i) {
+        const GrepFile *f = &job.files[i];
+        size_t line = 1;
+        bool done = stop;
+        for (size_t s = f->segments; !done && s < job.segments.size() && job.segments[s].file == i; ++s) {
+            const GrepSegment *seg = &job.segments[s];
+            for (size_t h = 0; !done && h < seg->hits.size(); ++h) {
+                size_t at_line = (flags & MOUNTKIT_GREP_LINES) ? line + seg->hits[h].line : 0;
+                matches++;
+                if (!fn(ctx, job.paths.c_str() + f->path, f->file, seg->hits[h].offset, at_line)) stop = true;
+                done = stop || (flags & MOUNTKIT_GREP_FIRST);
+            }
+            line += seg->newlines;
+        }
+        readUnlock(&f->file->lock);
+    }
+    delete[] job.first;
+    return matches;
+}
+
+#endif // EMBEDDED_BUILD
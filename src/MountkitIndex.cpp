@@ -0,0 +1,350 @@
+#include "MountkitInternal.h"
+
+// ordered index ของลูกใน folder: skip list ของ (ชื่อ, ชนิด) ที่ชี้ไปยัง folder หรือไฟล์
+// chain เดิมยังเป็นข้อมูลหลักของ tree - index เป็นลำดับเสริมที่ถูกแก้พร้อม chain ภายใต้ write lock
+// ของ folder เดียวกัน และถูกอ่านภายใต้ read lock จึงทิ้งแล้วสร้างใหม่จาก chain ได้เสมอ
+
+#define INDEX_LEVELS 16 // p = 1/4 - พอสำหรับลูกหลายพันล้านตัวต่อ folder
+
+// ชนิดใน key: folder มาก่อนไฟล์ที่ชื่อซ้ำกัน, 0 = ก่อนทุก entry ของชื่อนั้น (ใช้ค้นจุดเริ่ม)
+#define INDEX_START  0
+#define INDEX_FOLDER 1
+#define INDEX_FILE   2
+
+typedef struct IndexNode {
+    const char *name;           // ชื่อของ folder/ไฟล์ (ไม่ copy - อยู่ใน index เท่าที่ node ยังอยู่ใน chain)
+    MyFolder *folder;
+    MyFile *file;
+    struct IndexNode *next[1];  // จริง ๆ มีตามความสูงที่สุ่มได้
+} IndexNode;
+
+typedef struct MyIndex {
+    IndexNode *head[INDEX_LEVELS];
+    int levels;                 // ระดับสูงสุดที่มี node
+    uint32_t rng;               // xorshift ของความสูง
+    size_t count;
+} MyIndex;
+
+static int indexKind(const IndexNode *node) {
+    return node->file ? INDEX_FILE : INDEX_FOLDER;
+}
+
+// เทียบ key (name, kind) กับ node: < 0, 0, > 0
+static int indexCompare(const char *name, int kind, const IndexNode *node) {
+    int c = strcmp(name, node->name);
+    return c ? c : kind - indexKind(node);
+}
+
+static int indexHeight(MyIndex *ix) {
+    uint32_t x = ix->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    ix->rng = x;
+    int height = 1;
+    while (height < INDEX_LEVELS && (x & 3) == 0) {
+        height++;
+        x >>= 2;
+    }
+    return height;
+}
+
+// link ที่ชี้ไปยัง node แรกที่ key >= (name, kind) ในแต่ละระดับ
+static void indexPath(MyIndex *ix, const char *name, int kind, IndexNode ***path) {
+    IndexNode **links = ix->head;
+    for (int level = INDEX_LEVELS - 1; level >= 0; --level) {
+        while (links[level] && indexCompare(name, kind, links[level]) > 0) {
+            links = links[level]->next;
+        }
+        path[level] = &links[level];
+    }
+}
+
+static bool indexAdd(MyIndex *ix, const char *name, MyFolder *folder, MyFile *file) {
+    int height = indexHeight(ix);
+    IndexNode *node = (IndexNode*)malloc(sizeof(IndexNode) + (height - 1) * sizeof(IndexNode*));
+    if (!node) return false;
+    node->name = name;
+    node->folder = folder;
+    node->file = file;
+    IndexNode **path[INDEX_LEVELS];
+    indexPath(ix, name, file ? INDEX_FILE : INDEX_FOLDER, path);
+    for (int level = 0; level < height; ++level) {
+        node->next[level] = *path[level];
+        *path[level] = node;
+    }
+    if (height > ix->levels) ix->levels = height;
+    ix->count++;
+    return true;
+}
+
+static void indexDel(MyIndex *ix, const char *name, MyFolder *folder, MyFile *file) {
+    IndexNode **path[INDEX_LEVELS];
+    indexPath(ix, name, file ? INDEX_FILE : INDEX_FOLDER, path);
+    // key ซ้ำกันได้ก็ต่อเมื่อ chain มีชื่อซ้ำ - หา node ของ pointer นี้จริง ๆ ที่ระดับล่างสุด
+    IndexNode **link = path[0];
+    while (*link && ((*link)->folder != folder || (*link)->file != file) &&
+           indexCompare(name, file ? INDEX_FILE : INDEX_FOLDER, *link) == 0) {
+        link = &(*link)->next[0];
+    }
+    IndexNode *node = *link;
+    if (!node || node->folder != folder || node->file != file) return;
+    for (int level = 0; level < INDEX_LEVELS; ++level) {
+        IndexNode **cur = path[level];
+        while (*cur && *cur != node && indexCompare(name, file ? INDEX_FILE : INDEX_FOLDER, *cur) == 0) {
+            cur = &(*cur)->next[level];
+        }
+        if (*cur != node) break; // node สูงไม่ถึงระดับนี้
+        *cur = node->next[level];
+    }
+    free(node);
+    ix->count--;
+}
+
+static void indexFree(MyIndex *ix) {
+    IndexNode *node = ix->head[0];
+    while (node) {
+        IndexNode *next = node->next[0];
+        free(node);
+        node = next;
+    }
+    free(ix);
+}
+
+void mountkit::indexInsert(MyFolder *folder, MyFolder *child, MyFile *file) {
+    if (!folder || !folder->index) return;
+    const char *name = file ? (const char*)file->name : child->data;
+    if (!indexAdd(folder->index, name, child, file)) {
+        // index ที่ขาด entry ใช้ไม่ได้ - ทิ้งทั้งหมดแทนการเก็บลำดับที่ผิด
+        indexRelease(folder);
+    }
+}
+
+void mountkit::indexRemove(MyFolder *folder, MyFolder *child, MyFile *file) {
+    if (!folder || !folder->index) return;
+    indexDel(folder->index, file ? (const char*)file->name : child->data, child, file);
+}
+
+void mountkit::indexRelease(MyFolder *folder) {
+    if (!folder->index) return;
+    indexFree(folder->index);
+    folder->index = NULL;
+}
+
+int mountkit::index_enable(MyFolder *folder) {
+    if (!folder) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    MyIndex *ix = (MyIndex*)calloc(1, sizeof(MyIndex));
+    if (!ix) {
+        setError(MOUNTKIT_ENOMEM);
+        return 0;
+    }
+    ix->levels = 1;
+    ix->rng = 0x9e3779b9u ^ (uint32_t)(uintptr_t)folder;
+    if (!ix->rng) ix->rng = 1;
+
+    writeLock(&folder->lock);
+    if (folder->index) {
+        writeUnlock(&folder->lock);
+        free(ix);
+        return 1;
+    }
+    bool ok = true;
+    for (MyFolder *sub = folder->subdir; sub && ok; sub = sub->dir) ok = indexAdd(ix, sub->data, sub, NULL);
+    for (MyFile *f = folder->files; f && ok; f = f->next) ok = indexAdd(ix, (const char*)f->name, NULL, f);
+    if (ok) folder->index = ix;
+    writeUnlock(&folder->lock);
+    if (!ok) {
+        indexFree(ix);
+        setError(MOUNTKIT_ENOMEM);
+        return 0;
+    }
+    return 1;
+}
+
+void mountkit::index_disable(MyFolder *folder) {
+    if (!folder) return;
+    writeLock(&folder->lock);
+    indexRelease(folder);
+    writeUnlock(&folder->lock);
+}
+
+// เก็บ key ลง cursor - ชื่อที่ยาวเกินถูกแทนด้วย key ที่มากกว่าทุกชื่อที่ขึ้นต้นเหมือนกัน (ไม่วนส่งซ้ำ)
+static void cursorStore(MyCursor *cursor, const char *name, int kind) {
+    size_t len = strlen(name);
+    if (len < sizeof(cursor->last)) {
+        memcpy(cursor->last, name, len + 1);
+        cursor->last_kind = kind;
+        return;
+    }
+    len = sizeof(cursor->last) - 1;
+    memcpy(cursor->last, name, len);
+    while (len > 0 && (uint8_t)cursor->last[len - 1] == 0xff) len--;
+    if (len > 0) cursor->last[len - 1]++;
+    cursor->last[len] = '\0';
+    cursor->last_kind = INDEX_START;
+    if (len == 0) cursor->done = true;
+}
+
+void mountkit::cursor_init(MyCursor *cursor, const char *from, const char *to, const char *prefix) {
+    if (!cursor) return;
+    cursor->to = to;
+    cursor->prefix = prefix;
+    cursor->pos = 0;
+    cursor->done = false;
+    cursorStore(cursor, from ? from : "", INDEX_START);
+}
+
+// node แรกที่ยังไม่ถูกส่ง: หลัง key ใน cursor และไม่ก่อน prefix
+static IndexNode* indexSeek(const MyIndex *ix, const MyCursor *cursor) {
+    const char *start = cursor->last;
+    int kind = cursor->last_kind;
+    if (cursor->prefix && cursor->prefix[0] && strcmp(cursor->prefix, start) > 0) {
+        start = cursor->prefix;
+        kind = INDEX_START;
+    }
+    // node แรกที่ key > (start, kind): ถ้า kind เป็น START จะได้ชื่อ >= start
+    IndexNode *const *links = ix->head;
+    for (int level = ix->levels - 1; level >= 0; --level) {
+        while (links[level] && (kind == INDEX_START ? indexCompare(start, kind, links[level]) > 0
+                                                    : indexCompare(start, kind, links[level]) >= 0)) {
+            links = links[level]->next;
+        }
+    }
+    return links[0];
+}
+
+// node อยู่ในช่วง prefix/to ของ cursor หรือไม่
+static bool indexInRange(const MyCursor *cursor, const IndexNode *node, size_t prefix_len) {
+    if (!node) return false;
+    if (prefix_len && strncmp(node->name, cursor->prefix, prefix_len) != 0) return false;
+    return !cursor->to || strcmp(node->name, cursor->to) < 0;
+}
+
+int mountkit::index_scan(MyFolder *folder, MyCursor *cursor, int max, mountkit_find_fn fn, void *ctx) {
+    if (!folder || !cursor || !fn) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    readLock(&folder->lock);
+    MyIndex *ix = folder->index;
+    if (!ix) {
+        readUnlock(&folder->lock);
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    if (cursor->done) {
+        readUnlock(&folder->lock);
+        return 0;
+    }
+
+    size_t prefix_len = cursor->prefix ? strlen(cursor->prefix) : 0;
+    IndexNode *node = indexSeek(ix, cursor);
+    int count = 0;
+    bool stopped = false;
+    while (indexInRange(cursor, node, prefix_len) && (max <= 0 || count < max)) {
+        cursorStore(cursor, node->name, indexKind(node));
+        count++;
+        if (!fn(ctx, node->name, node->folder, node->file)) {
+            stopped = true;
+            break;
+        }
+        node = node->next[0];
+    }
+    // หน้าที่เต็มพอดีหรือถูกหยุดยังไม่รู้ว่าครบหรือยัง - เรียกครั้งถัดไปจะได้ 0 และ done
+    if (!stopped && (max <= 0 || count < max)) cursor->done = true;
+    readUnlock(&folder->lock);
+    return count;
+}
+
+// ตำแหน่งใน chain ของ folder ที่ไม่มี index: subfolder ทั้งหมดก่อน แล้วจึงไฟล์
+typedef struct ChainPos {
+    MyFolder *sub;
+    MyFile *file;
+} ChainPos;
+
+static bool chainEnd(const ChainPos *p) {
+    return !p->sub && !p->file;
+}
+
+static void chainStep(ChainPos *p) {
+    if (p->sub) p->sub = p->sub->dir;
+    else if (p->file) p->file = p->file->next;
+}
+
+static const char* chainName(const ChainPos *p) {
+    return p->sub ? p->sub->data : (const char*)p->file->name;
+}
+
+static int chainKind(const ChainPos *p) {
+    return p->sub ? INDEX_FOLDER : INDEX_FILE;
+}
+
+int mountkit::readdir(MyFolder *folder, MyCursor *cursor, MyDirEntry *entries, int max) {
+    if (!folder || !cursor || !entries || max <= 0) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    if (cursor->done) return 0;
+    folder = followMount(folder);
+    readLock(&folder->lock);
+
+    int count = 0;
+    if (folder->index) {
+        size_t prefix_len = cursor->prefix ? strlen(cursor->prefix) : 0;
+        IndexNode *node = indexSeek(folder->index, cursor);
+        for (; count < max && indexInRange(cursor, node, prefix_len); node = node->next[0]) {
+            MyDirEntry *e = &entries[count++];
+            snprintf(e->name, sizeof(e->name), "%s", node->name);
+            e->type = indexKind(node);
+            e->size = e->capacity = 0;
+            MyFile *inode = node->file ? fileTarget(node->file) : NULL;
+            if (inode) {
+                readLock(&inode->lock);
+                e->size = inode->size;
+                e->capacity = inode->capacity;
+                readUnlock(&inode->lock);
+            }
+            cursorStore(cursor, node->name, e->type);
+            if (inode && inode->kind == MOUNTKIT_DT_LINK) e->type = MOUNTKIT_DT_LINK; // cursor นับเป็นไฟล์
+        }
+        if (!indexInRange(cursor, node, prefix_len)) cursor->done = true;
+    } else {
+        // หา entry สุดท้ายที่ส่งไปแล้วตามชื่อ - ถ้าถูกลบหรือย้ายไปแล้ว ข้ามไปตามจำนวนที่ส่งแทน
+        ChainPos p = { folder->subdir, folder->files };
+        size_t pos = 0;
+        bool found = false;
+        if (cursor->last_kind != INDEX_START) {
+            for (; !chainEnd(&p) && !found; chainStep(&p), pos++) {
+                found = chainKind(&p) == cursor->last_kind && strcmp(chainName(&p), cursor->last) == 0;
+            }
+        }
+        if (!found) {
+            p.sub = folder->subdir;
+            p.file = folder->files;
+            for (pos = 0; pos < cursor->pos && !chainEnd(&p); ++pos) chainStep(&p);
+        }
+        for (; count < max && !chainEnd(&p); chainStep(&p)) {
+            MyDirEntry *e = &entries[count++];
+            snprintf(e->name, sizeof(e->name), "%s", chainName(&p));
+            e->type = chainKind(&p);
+            e->size = e->capacity = 0;
+            MyFile *inode = p.file && !p.sub ? fileTarget(p.file) : NULL;
+            if (inode) {
+                readLock(&inode->lock);
+                e->size = inode->size;
+                e->capacity = inode->capacity;
+                readUnlock(&inode->lock);
+            }
+            cursorStore(cursor, chainName(&p), e->type);
+            if (inode && inode->kind == MOUNTKIT_DT_LINK) e->type = MOUNTKIT_DT_LINK; // cursor นับเป็นไฟล์
+        }
+        cursor->pos = pos;
+        if (chainEnd(&p)) cursor->done = true;
+    }
+    cursor->pos += count;
+    readUnlock(&folder->lock);
+    return count;
+}
@@ -0,0 +1,100 @@
+#ifndef __mountkit_internal_H__
+#define __mountkit_internal_H__
+
+// helper ภายในที่ทุก Mountkit*.cpp ใช้ร่วมกัน (ไม่ใช่ public API - ไม่ติดตั้งไปกับ Mountkit.h)
+
+#include "Mountkit.h"
+
+#ifndef EMBEDDED_BUILD
+    #include <atomic>
+#endif
+
+// ข้าม mount point ไปยัง root ของ tree ที่ mount ไว้บนสุด
+static inline MyFolder* followMount(MyFolder *folder) {
+    while (folder && folder->mounted) folder = folder->mounted;
+    return folder;
+}
+
+// hard link: ชื่อที่ ln สร้างชี้ไฟล์จริง - ทุก operation ที่รับ MyFile* ทำงานกับไฟล์จริง
+static inline MyFile* fileTarget(MyFile *file) {
+    return file->link ? file->link : file;
+}
+
+// แยก path ทีละ component (แทน strtok ที่เก็บ state ร่วมกันทุก thread)
+static inline char* nextToken(char **cursor) {
+    char *p = *cursor;
+    while (*p == '/') p++;
+    if (*p == '\0') {
+        *cursor = p;
+        return NULL;
+    }
+    char *token = p;
+    while (*p && *p != '/') p++;
+    if (*p) *p++ = '\0';
+    *cursor = p;
+    return token;
+}
+
+// field ของ node ที่ถูกอ่านโดยไม่ถือ lock พร้อมกับ writer ต้องเข้าถึงแบบ atomic - ทุกไฟล์ใช้ชุดนี้ชุดเดียว
+// loadShared/storeShared (acquire/release): pointer และ field ที่ publish ข้อมูลอื่นตามมา (link, data, size, parent)
+// loadRelaxed/storeRelaxed: ค่าที่อ่านทีละ field โดยไม่ต้องเห็นข้อมูลอื่นตาม (ตัวนับ, metadata, flag)
+// sharedField: read-modify-write (fetch_add, exchange, CAS) บน field เดิม - desktop เท่านั้น
+#ifndef EMBEDDED_BUILD
+template <typename T> static inline std::atomic<T>* sharedField(T *field) {
+    return reinterpret_cast<std::atomic<T>*>(field);
+}
+template <typename T> static inline T loadShared(T *field) {
+    return sharedField(field)->load(std::memory_order_acquire);
+}
+template <typename T> static inline void storeShared(T *field, T value) {
+    sharedField(field)->store(value, std::memory_order_release);
+}
+template <typename T> static inline T loadRelaxed(const T *field) {
+    return reinterpret_cast<const std::atomic<T>*>(field)->load(std::memory_order_relaxed);
+}
+template <typename T> static inline void storeRelaxed(T *field, T value) {
+    sharedField(field)->store(value, std::memory_order_relaxed);
+}
+
+// reader-writer lock บน lock word ที่ทำงานเสมอไม่ว่า concurrent mode จะเปิดหรือไม่ (MountkitConcurrent.cpp)
+// node ของ tree ใช้ผ่าน readLock/writeLock ของ mountkit - ชุดนี้สำหรับ lock ที่ต้องมีผลในทุก mode (watch list)
+void rwReadLock(uint32_t *word);
+void rwReadUnlock(uint32_t *word);
+void rwWriteLock(uint32_t *word);
+void rwWriteUnlock(uint32_t *word);
+
+// จำนวนชื่อของไฟล์จริง (hard link) - true ถ้าเป็นชื่อสุดท้าย (ผู้เรียกคืนไฟล์)
+static inline bool linkDrop(MyFile *file) {
+    return sharedField(&file->links)->fetch_sub(1, std::memory_order_acq_rel) == 1;
+}
+static inline void linkHold(MyFile *file) {
+    sharedField(&file->links)->fetch_add(1, std::memory_order_relaxed);
+}
+static inline void namesAdd(size_t *counter, bool subtract) {
+    if (subtract) sharedField(counter)->fetch_sub(1, std::memory_order_relaxed);
+    else sharedField(counter)->fetch_add(1, std::memory_order_relaxed);
+}
+#else
+template <typename T> static inline T loadShared(T *field) { return *field; }
+template <typename T> static inline void storeShared(T *field, T value) { *field = value; }
+template <typename T> static inline T loadRelaxed(const T *field) { return *field; }
+template <typename T> static inline void storeRelaxed(T *field, T value) { *field = value; }
+
+static inline bool linkDrop(MyFile *file) { return --file->links == 0; }
+static inline void linkHold(MyFile *file) { ++file->links; }
+static inline void namesAdd(size_t *counter, bool subtract) { if (subtract) --*counter; else ++*counter; }
+#endif
+
+// metadata (MyMeta) มีเฉพาะ desktop - embedded ส่ง NULL ให้ metaInit/metaTouch ซึ่งไม่ทำอะไร
+#ifndef EMBEDDED_BUILD
+template <typename T> static inline MyMeta* nodeMeta(T *node) { return &node->meta; }
+#else
+template <typename T> static inline MyMeta* nodeMeta(T *node) { (void)node; return NULL; }
+#endif
+
+// mode ของ node (fallback = MOUNTKIT_MODE_* ตามชนิด เมื่อไม่มี metadata)
+static inline uint16_t metaMode(MyMeta *meta, uint16_t fallback) {
+    return meta ? loadRelaxed(&meta->mode) : fallback;
+}
+
+#endif // __mountkit_internal_H__
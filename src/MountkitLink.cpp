@@ -0,0 +1,261 @@
+#include "MountkitInternal.h"
+
+// hard link: ชื่อที่ ln สร้างเป็น node เบา (ไม่มี data) ที่ชี้ไฟล์จริงผ่าน MyFile::link
+// ไฟล์จริงนับชื่อของตัวเองใน MyFile::links และถูกคืนเมื่อชื่อสุดท้ายถูกลบ (unlinkName)
+// symlink: ไฟล์ชนิด MOUNTKIT_DT_LINK ที่ data คือ path ปลายทาง - cd และ path API แทน component ด้วย target
+// folder ปลายทางที่ resolve ได้ถูกจำไว้ใน symlink พร้อมรุ่นของ tree (link_gen) ที่ใช้ resolve
+// operation ที่เปลี่ยนโครงสร้าง (rm, mv, rmdir, mkdir, mount, ...) เพิ่มรุ่น จึงไม่มีผลเก่าถูกใช้หลังจากนั้น
+
+#ifndef EMBEDDED_BUILD
+    #include <atomic>
+#endif
+
+// ผล resolve ของ symlink - ถูกแทนทั้งก้อน (reader lock-free อ่านได้ตลอด)
+struct MyLinkCache {
+    MyFolder *root;   // root ที่ใช้ resolve (target แบบ absolute ขึ้นกับ root)
+    MyFolder *folder; // folder ปลายทาง
+    uint64_t gen;     // link_gen ตอนเริ่ม resolve
+};
+
+#ifndef EMBEDDED_BUILD
+static inline MyLinkCache* cacheExchange(MyLinkCache **field, MyLinkCache *value) {
+    return sharedField(field)->exchange(value, std::memory_order_acq_rel);
+}
+#else
+static inline MyLinkCache* cacheExchange(MyLinkCache **field, MyLinkCache *value) {
+    MyLinkCache *old = *field;
+    *field = value;
+    return old;
+}
+#endif
+
+// ค้นหาไฟล์ตามชื่อใน folder (ผู้เรียกถือ lock ของ folder)
+static MyFile* findFile(MyFolder *folder, const char *filename) {
+    MyFile *cur = loadShared(&folder->files);
+    while (cur && strcmp((char*)cur->name, filename) != 0) cur = loadShared(&cur->next);
+    return cur;
+}
+
+MyFile* mountkit::linkFind(MyFolder *folder, const char *name) {
+    MyFile *file = findFile(folder, name);
+    return file && file->kind == MOUNTKIT_DT_LINK ? file : NULL;
+}
+
+uint64_t mountkit::linkGeneration() {
+    return loadShared(&link_gen);
+}
+
+void mountkit::linkInvalidate() {
+    #ifndef EMBEDDED_BUILD
+        sharedField(&link_gen)->fetch_add(1, std::memory_order_release);
+    #else
+        link_gen++;
+    #endif
+}
+
+MyFolder* mountkit::linkCached(MyFolder *root, MyFile *link) {
+    MyLinkCache *cache = loadShared(&link->cache);
+    if (!cache || cache->root != root || cache->gen != linkGeneration()) return NULL;
+    return cache->folder;
+}
+
+// ผู้เรียกอยู่ใน read-side section (lock-free read) หรือเป็น thread เดียว - symlink ยังไม่ถูกคืน
+void mountkit::linkRemember(MyFolder *root, MyFile *link, MyFolder *folder, uint64_t gen) {
+    if (linkGeneration() != gen) return; // tree เปลี่ยนระหว่าง resolve
+    if (!concurrent && link->cache) {
+        link->cache->root = root;
+        link->cache->folder = folder;
+        link->cache->gen = gen;
+        return;
+    }
+    MyLinkCache *cache = (MyLinkCache*)malloc(sizeof(MyLinkCache));
+    if (!cache) return; // ไม่จำก็ได้ - resolve ใหม่ครั้งหน้า
+    cache->root = root;
+    cache->folder = folder;
+    cache->gen = gen;
+    MyLinkCache *old = cacheExchange(&link->cache, cache);
+    if (!old) return;
+    // reader อื่นอาจยังอ่านก้อนเดิมอยู่
+    if (concurrent) retire(old, MOUNTKIT_RETIRE_DATA); else free(old);
+}
+
+void mountkit::unlinkName(MyFile *entry, bool locked) {
+    MyFile *inode = fileTarget(entry);
+    bool last = linkDrop(inode);
+    MyFile *release[2];
+    bool held[2];
+    int count = 0;
+    if (entry != inode) {
+        namesAdd(&link_names, true);
+        release[count] = entry;
+        held[count++] = locked;
+    }
+    if (last) {
+        notifyGone(NULL, inode);
+        release[count] = inode;
+        held[count++] = locked && entry == inode;
+    } else if (locked && entry == inode) {
+        writeUnlock(&inode->lock); // ชื่ออื่นยังใช้ไฟล์ต่อ
+    }
+    for (int i = 0; i < count; ++i) {
+        // lock-free read mode / safe handle: handle ที่ยังถืออยู่ใช้ไฟล์ต่อได้จนหมด grace period - ต้องไม่ค้าง lock ไว้
+        if (lockfree_reads || safe_handles) {
+            if (held[i]) writeUnlock(&release[i]->lock);
+            retire(release[i], MOUNTKIT_RETIRE_FILE);
+        } else {
+            if (!held[i]) writeLock(&release[i]->lock); // รอ thread ที่กำลังอ่าน/เขียนไฟล์นี้อยู่
+            releaseFile(release[i]);
+        }
+    }
+}
+
+// subtree ถูกถอดออกแล้ว: ไฟล์จริงที่ยังมีชื่ออื่นเลิกนับยอดเข้า folder ใน subtree
+// (folder = NULL บอก freeFiles ด้วยว่าชื่ออื่นอาจถูกลบไปก่อน subtree ถูกคืน)
+void mountkit::linkEvacuate(MyFolder *folder) {
+    if (!folder || loadRelaxed(&link_names) == 0) return;
+    MyIter it;
+    iter_begin(&it, folder, MOUNTKIT_ITER_PRE | MOUNTKIT_ITER_POST | MOUNTKIT_ITER_FILES);
+    while (iter_next(&it)) {
+        if (it.file) {
+            MyFile *f = it.file;
+            if (f->link || loadRelaxed(&f->links) < 2) continue;
+            writeLock(&f->lock);
+            usageUnlink(f);
+            writeUnlock(&f->lock);
+        } else if (it.post) {
+            writeUnlock(&it.folder->lock);
+        } else {
+            writeLock(&it.folder->lock); // กัน ln ที่กำลังเพิ่มชื่อให้ไฟล์ใน folder นี้
+        }
+    }
+    iter_end(&it);
+}
+
+#ifndef EMBEDDED_BUILD
+
+int mountkit::ln(MyFolder *src_folder, const char *filename, MyFolder *dst_folder, const char *linkname) {
+    if (!src_folder || !filename || !dst_folder || !linkname) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+
+    // ตรวจสอบว่าปลายทางมีชื่อนี้อยู่แล้วหรือไม่
+    readLock(&dst_folder->lock);
+    MyFile *dst = findFile(dst_folder, linkname);
+    readUnlock(&dst_folder->lock);
+    if (dst) {
+        setError(MOUNTKIT_EEXIST);
+        return 0;
+    }
+
+    if (!quotaCheck(dst_folder, 0, 1)) return 0; // ชื่อใหม่นับเป็นไฟล์หนึ่งไฟล์ใน dst (ไม่มี capacity ของตัวเอง)
+    MyFile *node = newFile(linkname, false);
+    if (!node) {
+        setError(MOUNTKIT_ENOMEM);
+        return 0;
+    }
+    // นับชื่อใหม่ภายใต้ lock ของ folder ต้นทาง - rm ชื่อเดิมพร้อมกันไม่ทำให้ไฟล์ถูกคืนก่อน
+    int error = MOUNTKIT_OK;
+    readLock(&src_folder->lock);
+    MyFile *src = findFile(src_folder, filename);
+    if (!src) {
+        error = MOUNTKIT_ENOENT;
+    } else {
+        MyFile *inode = fileTarget(src);
+        if (inode->kind == MOUNTKIT_DT_LINK) {
+            error = MOUNTKIT_EINVAL; // hard link ไปยัง symlink ไม่รองรับ
+        } else {
+            linkHold(inode);
+            node->link = inode;
+        }
+    }
+    readUnlock(&src_folder->lock);
+    if (error) {
+        releaseFile(node);
+        setError(error);
+        return 0;
+    }
+    namesAdd(&link_names, false);
+
+    if (linkFile(dst_folder, node, concurrent)) {
+        // thread อื่นสร้างชื่อเดียวกันในปลายทางไปก่อน
+        unlinkName(node, false);
+        setError(MOUNTKIT_EEXIST);
+        return 0;
+    }
+    metaTouch(nodeMeta(node->link), false); // จำนวนชื่อเพิ่ม
+    notify(dst_folder, MOUNTKIT_WATCH_CREATE, linkname);
+    return 1;
+}
+
+int mountkit::symlink(MyFolder *folder, const char *name, const char *target) {
+    if (!folder || !name || !target) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    size_t len = strlen(target);
+    if (len == 0 || len >= 256) {
+        setError(MOUNTKIT_EINVAL); // ต้องต่อกับ path ที่เหลือใน buffer ของ cd ได้
+        return 0;
+    }
+
+    readLock(&folder->lock);
+    MyFile *existing = findFile(folder, name);
+    readUnlock(&folder->lock);
+    if (existing) {
+        setError(MOUNTKIT_EEXIST);
+        return 0;
+    }
+
+    if (!quotaCheck(folder, len + 1, 1)) return 0;
+    MyFile *link = newFile(name, false);
+    uint8_t *data = link ? (uint8_t*)malloc(len + 1) : NULL;
+    if (!data) {
+        if (link) releaseFile(link);
+        setError(MOUNTKIT_ENOMEM);
+        return 0;
+    }
+    memcpy(data, target, len + 1);
+    link->data = data;
+    link->capacity = len + 1;
+    link->size = len;
+    link->reserved = len;
+    link->kind = MOUNTKIT_DT_LINK;
+    metaInit(nodeMeta(link), MOUNTKIT_MODE_LINK);
+
+    if (linkFile(folder, link, concurrent)) {
+        releaseFile(link);
+        setError(MOUNTKIT_EEXIST);
+        return 0;
+    }
+    linkInvalidate(); // symlink ใหม่อาจอยู่บน path ที่ resolve ไว้แล้ว (เดิมเป็น dangling)
+    notify(folder, MOUNTKIT_WATCH_CREATE, name);
+    return 1;
+}
+
+int mountkit::readlink(MyFolder *folder, const char *name, char *buffer, size_t size) {
+    if (!folder || !name || !buffer || size == 0) {
+        setError(MOUNTKIT_EINVAL);
+        return -1;
+    }
+    int len = -1;
+    int error = MOUNTKIT_ENOENT;
+    rcuEnter();
+    lookupLock(&folder->lock);
+    MyFile *file = findFile(folder, name);
+    if (file && file->kind == MOUNTKIT_DT_LINK) {
+        // data ไม่เปลี่ยนหลังสร้าง และอาจไม่มี '\0' ปิดท้ายหลัง compact - ใช้ size
+        size_t n = file->size < size - 1 ? file->size : size - 1;
+        memcpy(buffer, file->data, n);
+        buffer[n] = '\0';
+        len = (int)file->size;
+    } else if (file) {
+        error = MOUNTKIT_EINVAL;
+    }
+    lookupUnlock(&folder->lock);
+    rcuLeave();
+    if (len < 0) setError(error);
+    return len;
+}
+
+#endif
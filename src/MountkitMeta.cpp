@@ -0,0 +1,156 @@
+#include "MountkitInternal.h"
+
+// metadata ต่อ node (MyMeta): ino, mtime/ctime และ mode อยู่ใน struct ของ node เอง
+// การแก้หนึ่งครั้งคืออ่าน clock หนึ่งครั้งและ store สอง word - ไม่จอง ไม่ถือ lock เพิ่ม
+// stat อ่านทีละ field แบบ atomic จึงไม่ต้องรอ writer (ค่าของแต่ละ field ถูกต้อง แต่ไม่ใช่ snapshot ของทั้งชุด)
+
+#include <string.h>
+
+#ifndef EMBEDDED_BUILD
+
+#include <atomic>
+#include <chrono>
+#include <time.h>
+
+// ms จาก monotonic clock แบบ coarse (อ่านจาก vDSO ไม่เข้า kernel) - ความละเอียดหลาย ms ก็พอสำหรับ mtime
+static uint64_t defaultTicks() {
+    #ifdef CLOCK_MONOTONIC_COARSE
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+        return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+    #else
+        return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    #endif
+}
+
+void mountkit::metaInit(MyMeta *meta, uint16_t mode) {
+    meta->ino = sharedField(&next_ino)->fetch_add(1, std::memory_order_relaxed);
+    uint64_t now = clock_fn ? clock_fn() : defaultTicks();
+    meta->mtime = now;
+    meta->ctime = now;
+    meta->mode = mode;
+}
+
+void mountkit::metaTouch(MyMeta *meta, bool modified) {
+    uint64_t now = clock_fn ? clock_fn() : defaultTicks();
+    if (modified) storeRelaxed(&meta->mtime, now);
+    storeRelaxed(&meta->ctime, now);
+}
+
+void mountkit::set_clock(mountkit_clock_fn fn) {
+    clock_fn = fn;
+}
+
+int mountkit::stat(MyFile *file, MyStat *st) {
+    if (!file || !st) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    if (file->link) file = file->link; // hard link: metadata อยู่ที่ไฟล์จริง
+    st->ino = file->meta.ino;
+    st->type = file->kind;
+    st->mode = loadRelaxed(&file->meta.mode);
+    st->links = loadRelaxed(&file->links);
+    st->mtime = loadRelaxed(&file->meta.mtime);
+    st->ctime = loadRelaxed(&file->meta.ctime);
+    // size กับ capacity ต้องมาจาก buffer เดียวกัน
+    readLock(&file->lock);
+    st->size = file->size;
+    st->capacity = file->capacity;
+    readUnlock(&file->lock);
+    return 1;
+}
+
+int mountkit::stat(MyFolder *folder, MyStat *st) {
+    if (!folder || !st) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    folder = followMount(folder);
+    st->ino = folder->meta.ino;
+    st->type = MOUNTKIT_DT_DIR;
+    st->mode = loadRelaxed(&folder->meta.mode);
+    st->links = 1;
+    st->size = 0;
+    st->capacity = 0;
+    st->mtime = loadRelaxed(&folder->meta.mtime);
+    st->ctime = loadRelaxed(&folder->meta.ctime);
+    return 1;
+}
+
+int mountkit::chmod(MyFile *file, uint32_t mode) {
+    if (!file) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    if (file->link) file = file->link;
+    storeRelaxed(&file->meta.mode, (uint16_t)(mode & 07777));
+    metaTouch(&file->meta, false);
+    return 1;
+}
+
+int mountkit::chmod(MyFolder *folder, uint32_t mode) {
+    if (!folder) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    folder = followMount(folder);
+    storeRelaxed(&folder->meta.mode, (uint16_t)(mode & 07777));
+    metaTouch(&folder->meta, false);
+    return 1;
+}
+
+#else // EMBEDDED_BUILD
+
+// embedded: node ไม่มี MyMeta - stat คืนเฉพาะสิ่งที่ node มีอยู่แล้ว
+void mountkit::metaInit(MyMeta *meta, uint16_t mode) { (void)meta; (void)mode; }
+void mountkit::metaTouch(MyMeta *meta, bool modified) { (void)meta; (void)modified; }
+void mountkit::set_clock(mountkit_clock_fn fn) { (void)fn; }
+
+int mountkit::stat(MyFile *file, MyStat *st) {
+    if (!file || !st) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    if (file->link) file = file->link;
+    memset(st, 0, sizeof(*st));
+    st->type = file->kind;
+    st->mode = file->kind == MOUNTKIT_DT_LINK ? MOUNTKIT_MODE_LINK : MOUNTKIT_MODE_FILE;
+    st->links = file->links;
+    st->size = file->size;
+    st->capacity = file->capacity;
+    return 1;
+}
+
+int mountkit::stat(MyFolder *folder, MyStat *st) {
+    if (!folder || !st) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    memset(st, 0, sizeof(*st));
+    st->type = MOUNTKIT_DT_DIR;
+    st->mode = MOUNTKIT_MODE_DIR;
+    st->links = 1;
+    return 1;
+}
+
+int mountkit::chmod(MyFile *file, uint32_t mode) {
+    (void)mode;
+    if (!file) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    return 1;
+}
+
+int mountkit::chmod(MyFolder *folder, uint32_t mode) {
+    (void)mode;
+    if (!folder) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    return 1;
+}
+
+#endif // EMBEDDED_BUILD
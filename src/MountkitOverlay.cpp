@@ -0,0 +1,266 @@
+#include "MountkitInternal.h"
+
+// overlay (union) mount: upper tree ส่วนตัวที่เขียนได้ ซ้อนบน lower tree ที่แชร์กัน (read-only)
+#ifndef EMBEDDED_BUILD
+
+#include <cstring>
+#include <cstdlib>
+
+// ใช้รูปแบบเดียวกับ aufs/overlayfs: whiteout = ไฟล์ว่างชื่อ ".wh.<name>" ใน upper
+#define OVERLAY_WHITEOUT_PREFIX ".wh."
+#define OVERLAY_OPAQUE_MARKER   ".wh..wh..opq"
+#define OVERLAY_MAX_DEPTH       64
+
+// path ที่แยกเป็น component แล้ว
+typedef struct OverlayPath {
+    char buf[256];
+    char *parts[OVERLAY_MAX_DEPTH];
+    int count;
+} OverlayPath;
+
+// ตำแหน่งของ directory เดียวกันในทั้งสอง layer (NULL ถ้าไม่มีหรือถูกซ่อน)
+typedef struct OverlayPos {
+    MyFolder *upper;
+    MyFolder *lower;
+} OverlayPos;
+
+static int overlaySplit(OverlayPath *p, const char *path, const MyOverlay *ov) {
+    strncpy(p->buf, path, sizeof(p->buf));
+    p->buf[sizeof(p->buf) - 1] = '\0';
+    p->count = 0;
+    char *cursor = p->buf;
+    char *token = nextToken(&cursor);
+    // ถ้า token แรกตรงกับชื่อ root ให้ข้ามไป (เหมือน cd)
+    if (token && ((ov->upper && strcmp(ov->upper->data, token) == 0) ||
+                  (ov->lower && strcmp(ov->lower->data, token) == 0))) {
+        token = nextToken(&cursor);
+    }
+    while (token) {
+        if (strcmp(token, ".") != 0) {
+            if (strcmp(token, "..") == 0 || p->count >= OVERLAY_MAX_DEPTH) return 0;
+            p->parts[p->count++] = token;
+        }
+        token = nextToken(&cursor);
+    }
+    return 1;
+}
+
+static MyFolder* overlayFindDir(MyFolder *parent, const char *name) {
+    if (!parent) return NULL;
+    MyFolder *iter = parent->subdir;
+    while (iter && strcmp(iter->data, name) != 0) iter = iter->dir;
+    return followMount(iter); // ข้าม mount point เหมือน cd
+}
+
+static MyFile* overlayFindFile(MyFolder *parent, const char *name) {
+    if (!parent) return NULL;
+    MyFile *iter = parent->files;
+    while (iter && strcmp((char*)iter->name, name) != 0) iter = iter->next;
+    return iter;
+}
+
+static void overlayWhiteoutName(char *out, size_t out_size, const char *name) {
+    snprintf(out, out_size, "%s%s", OVERLAY_WHITEOUT_PREFIX, name);
+}
+
+static bool overlayHasWhiteout(MyFolder *upper, const char *name) {
+    if (!upper) return false;
+    char wh[300];
+    overlayWhiteoutName(wh, sizeof(wh), name);
+    return overlayFindFile(upper, wh) != NULL;
+}
+
+// เดินลงไปหนึ่งระดับใน directory ที่รวมสอง layer
+static OverlayPos overlayStep(OverlayPos pos, const char *name) {
+    OverlayPos next;
+    next.upper = overlayFindDir(pos.upper, name);
+    next.lower = NULL;
+    if (!overlayHasWhiteout(pos.upper, name)) {
+        next.lower = overlayFindDir(pos.lower, name);
+    }
+    // directory ที่ถูกสร้างใหม่ทับ whiteout จะเป็น opaque - ไม่เห็น lower อีก
+    if (next.upper && overlayFindFile(next.upper, OVERLAY_OPAQUE_MARKER)) {
+        next.lower = NULL;
+    }
+    return next;
+}
+
+// เดิน directory ทั้งหมดยกเว้น component สุดท้าย, return 0 ถ้าไม่พบ
+static int overlayWalk(MyOverlay *ov, OverlayPath *p, int depth, OverlayPos *pos) {
+    pos->upper = ov->upper;
+    pos->lower = ov->lower;
+    for (int i = 0; i < depth; ++i) {
+        *pos = overlayStep(*pos, p->parts[i]);
+        if (!pos->upper && !pos->lower) return 0;
+    }
+    return 1;
+}
+
+// สร้าง directory chain ใน upper ถึงระดับ depth (copy-up แค่ node ของ directory)
+static MyFolder* overlayCopyUpDirs(mountkit &mount, MyOverlay *ov, OverlayPath *p, int depth) {
+    MyFolder *upper = ov->upper;
+    for (int i = 0; i < depth && upper; ++i) {
+        MyFolder *child = overlayFindDir(upper, p->parts[i]);
+        if (!child) {
+            char wh[300];
+            overlayWhiteoutName(wh, sizeof(wh), p->parts[i]);
+            bool was_whiteout = mount.rm(upper, wh) == 1;
+            child = mount.mkdir_at(upper, p->parts[i]);
+            if (child && was_whiteout) {
+                mount.mk(child, OVERLAY_OPAQUE_MARKER);
+            }
+        }
+        upper = child;
+    }
+    return upper;
+}
+
+int mountkit::overlay_init(MyOverlay *ov, MyFolder *lower) {
+    if (!ov || !lower) return 0;
+    ov->lower = lower;
+    ov->upper = NULL;
+    createFolder(&ov->upper, lower->data);
+    return ov->upper != NULL;
+}
+
+void mountkit::overlay_release(MyOverlay *ov) {
+    if (!ov) return;
+    // ลบเฉพาะ upper - lower เป็นของที่แชร์กัน
+    removeFolder(ov->upper);
+    ov->upper = NULL;
+}
+
+MyFolder* mountkit::overlay_cd(MyOverlay *ov, const char *path) {
+    if (!ov || !path) return NULL;
+    OverlayPath p;
+    OverlayPos pos;
+    if (!overlaySplit(&p, path, ov)) return NULL;
+    if (!overlayWalk(ov, &p, p.count, &pos)) return NULL;
+    return pos.upper ? pos.upper : pos.lower;
+}
+
+MyFolder* mountkit::overlay_mkdir(MyOverlay *ov, const char *path) {
+    if (!ov || !ov->upper || !path) return NULL;
+    OverlayPath p;
+    if (!overlaySplit(&p, path, ov)) return NULL;
+    return overlayCopyUpDirs(*this, ov, &p, p.count);
+}
+
+MyFile* mountkit::overlay_lookup(MyOverlay *ov, const char *path) {
+    if (!ov || !path) return NULL;
+    OverlayPath p;
+    OverlayPos pos;
+    if (!overlaySplit(&p, path, ov) || p.count == 0) return NULL;
+    if (!overlayWalk(ov, &p, p.count - 1, &pos)) return NULL;
+
+    const char *name = p.parts[p.count - 1];
+    MyFile *file = overlayFindFile(pos.upper, name);
+    if (file) return file;
+    if (overlayHasWhiteout(pos.upper, name)) return NULL;
+    return overlayFindFile(pos.lower, name);
+}
+
+int mountkit::overlay_read(MyOverlay *ov, const char *path, uint8_t *buffer, size_t size, size_t offset) {
+    return read(overlay_lookup(ov, path), buffer, size, offset);
+}
+
+MyFile* mountkit::overlay_mk(MyOverlay *ov, const char *path) {
+    if (!ov || !ov->upper || !path) return NULL;
+    OverlayPath p;
+    OverlayPos pos;
+    if (!overlaySplit(&p, path, ov) || p.count == 0) return NULL;
+
+    const char *name = p.parts[p.count - 1];
+    MyFile *lower_file = NULL;
+    if (overlayWalk(ov, &p, p.count - 1, &pos)) {
+        if (overlayFindFile(pos.upper, name)) return overlayFindFile(pos.upper, name);
+        if (!overlayHasWhiteout(pos.upper, name)) lower_file = overlayFindFile(pos.lower, name);
+    }
+
+    MyFolder *upper = overlayCopyUpDirs(*this, ov, &p, p.count - 1);
+    if (!upper) return NULL;
+
+    char wh[300];
+    overlayWhiteoutName(wh, sizeof(wh), name);
+    rm(upper, wh);
+
+    if (lower_file) lower_file = fileTarget(lower_file); // hard link: data ของไฟล์จริง
+    if (lower_file && lower_file->kind == MOUNTKIT_DT_LINK) {
+        // symlink ถูก copy-up เป็น symlink ที่ชี้ target เดียวกัน
+        char target[256];
+        size_t len = lower_file->size < sizeof(target) ? lower_file->size : sizeof(target) - 1;
+        memcpy(target, lower_file->data, len);
+        target[len] = '\0';
+        if (!symlink(upper, name, target)) return NULL;
+        return overlayFindFile(upper, name);
+    }
+
+    MyFile *file = mk(upper, name);
+    if (!file) return NULL;
+
+    // copy-up เฉพาะไฟล์ที่ถูกแตะ
+    if (lower_file && lower_file->size > 0) {
+        if (!write(file, lower_file->data, lower_file->size)) {
+            rm(upper, name);
+            return NULL;
+        }
+    }
+    if (lower_file) chmod(file, metaMode(nodeMeta(lower_file), MOUNTKIT_MODE_FILE)); // copy-up คง mode ของ lower ไว้
+    return file;
+}
+
+int mountkit::overlay_rm(MyOverlay *ov, const char *path) {
+    if (!ov || !ov->upper || !path) return 0;
+    OverlayPath p;
+    OverlayPos pos;
+    if (!overlaySplit(&p, path, ov) || p.count == 0) return 0;
+    if (!overlayWalk(ov, &p, p.count - 1, &pos)) return 0;
+
+    const char *name = p.parts[p.count - 1];
+    int removed = rm(pos.upper, name);
+    if (overlayHasWhiteout(pos.upper, name) || !overlayFindFile(pos.lower, name)) {
+        return removed;
+    }
+
+    // ไฟล์ยังมองเห็นจาก lower - บันทึก whiteout ใน upper
+    MyFolder *upper = overlayCopyUpDirs(*this, ov, &p, p.count - 1);
+    char wh[300];
+    overlayWhiteoutName(wh, sizeof(wh), name);
+    return upper && mk(upper, wh) ? 1 : 0;
+}
+
+int mountkit::overlay_rmdir(MyOverlay *ov, const char *path) {
+    if (!ov || !ov->upper || !path) return 0;
+    OverlayPath p;
+    OverlayPos pos;
+    if (!overlaySplit(&p, path, ov) || p.count == 0) return 0;
+    if (!overlayWalk(ov, &p, p.count - 1, &pos)) return 0;
+
+    const char *name = p.parts[p.count - 1];
+    int removed = 0;
+    if (pos.upper) {
+        MyFolder **link = &pos.upper->subdir;
+        while (*link && strcmp((*link)->data, name) != 0) link = &(*link)->dir;
+        if (*link) {
+            MyFolder *victim = *link;
+            *link = victim->dir;
+            indexRemove(pos.upper, victim, NULL);
+            usageDetach(victim);
+            victim->dir = NULL;
+            linkInvalidate();
+            linkEvacuate(victim);
+            removeFolder(victim);
+            removed = 1;
+        }
+    }
+    if (overlayHasWhiteout(pos.upper, name) || !overlayFindDir(pos.lower, name)) {
+        return removed;
+    }
+
+    MyFolder *upper = overlayCopyUpDirs(*this, ov, &p, p.count - 1);
+    char wh[300];
+    overlayWhiteoutName(wh, sizeof(wh), name);
+    return upper && mk(upper, wh) ? 1 : 0;
+}
+
+#endif // EMBEDDED_BUILD
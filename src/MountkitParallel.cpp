@@ -0,0 +1,418 @@
+#include "MountkitInternal.h"
+
+// traversal แบบขนาน: removeFolder, PrintAllPath และการรวม capacity จากไฟล์จริง (benchmark) บน work-stealing pool
+// แต่ละ task เดิน sibling chain ของตัวเองแบบ DFS บน stack และแบ่ง entry ล่างสุดของ stack
+// (subdirectory ที่อยู่ท้ายสุดตามลำดับ ซึ่งมักเป็นงานก้อนใหญ่) ให้ worker อื่นเมื่อเดินครบ threshold
+// folder และมี worker ว่างรออยู่ - tree เล็กจึงไม่ถูกแบ่งเลย
+
+#ifndef EMBEDDED_BUILD
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <chrono>
+
+#define WALK_PATH_MAX 256  // ความยาว path ของ PrintAllPath (ตัดเหมือน buffer เดิมของ PrintAllPath)
+#define WALK_FANOUT   8    // subdirectory ต่อ folder ใน tree ของ parallel_benchmark
+
+// output ของ PrintAllPath - chunk ต่อ task เรียงต่อกันตามลำดับ pre-order
+typedef struct WalkChunk {
+    char *buf;
+    size_t len;
+    size_t cap;
+    struct WalkChunk *next;
+} WalkChunk;
+
+// traversal หนึ่งครั้ง (call หนึ่งของ removeFolder/calculateFolderCapacity/PrintAllPath)
+typedef struct WalkJob {
+    int kind;                   // MOUNTKIT_WALK_*
+    std::atomic<long> pending;  // task ที่ยังไม่จบ (รวม task แรกของผู้เรียก)
+    std::atomic<size_t> total;  // capacity รวม
+} WalkJob;
+
+typedef struct MyWalkTask {
+    WalkJob *job;
+    MyFolder *folder;           // sibling chain ที่เริ่มจาก folder นี้
+    WalkChunk *out;             // chunk ของ task นี้ (PrintAllPath)
+    char prefix[WALK_PATH_MAX]; // path ของ parent (PrintAllPath)
+} MyWalkTask;
+
+typedef struct WalkEntry {
+    MyFolder *folder;
+    size_t depth;               // ระดับเทียบกับ folder แรกของ task
+} WalkEntry;
+
+typedef struct PoolQueue {
+    std::mutex lock;
+    std::deque<MyWalkTask*> tasks;  // เจ้าของหยิบจากท้าย thread อื่นขโมยจากหัว
+} PoolQueue;
+
+typedef struct MyPool {
+    int workers;
+    size_t threshold;
+    PoolQueue *queues;          // [0..workers-1] ของ worker, [workers] ของ thread ที่เรียก traversal
+    std::thread *threads;
+    std::atomic<int> idle;      // worker ที่ไม่มีงาน - ต้องมากกว่า 0 จึงแบ่งงานออก
+    std::atomic<long> queued;   // จำนวน task ใน queue ทั้งหมด
+    std::atomic<bool> stop;
+    std::mutex sleep_lock;
+    std::condition_variable wake;
+} MyPool;
+
+static thread_local MyPool *worker_pool = NULL;  // pool ที่ thread นี้เป็น worker อยู่
+static thread_local int worker_index = 0;
+
+// index ของ queue ที่ thread ปัจจุบันใช้
+static int poolSelf(MyPool *pool) {
+    return worker_pool == pool ? worker_index : pool->workers;
+}
+
+static void chunkWrite(WalkChunk *chunk, const char *text, size_t len) {
+    if (chunk->len + len > chunk->cap) {
+        size_t cap = chunk->cap ? chunk->cap : 4096;
+        while (cap < chunk->len + len) cap *= 2;
+        char *grown = (char*)realloc(chunk->buf, cap);
+        if (!grown) return;  // memory ไม่พอ - บรรทัดนี้หายไปแต่ traversal ยังเดินต่อ
+        chunk->buf = grown;
+        chunk->cap = cap;
+    }
+    memcpy(chunk->buf + chunk->len, text, len);
+    chunk->len += len;
+}
+
+void mountkit::poolPush(int index, MyWalkTask *task) {
+    PoolQueue *queue = &pool->queues[index];
+    {
+        std::lock_guard<std::mutex> guard(queue->lock);
+        queue->tasks.push_back(task);
+    }
+    pool->queued.fetch_add(1);
+    std::lock_guard<std::mutex> guard(pool->sleep_lock);
+    pool->wake.notify_one();
+}
+
+MyWalkTask* mountkit::poolTake(int index) {
+    if (pool->queued.load(std::memory_order_relaxed) == 0) return NULL;
+    int count = pool->workers + 1;
+    for (int k = 0; k < count; ++k) {
+        PoolQueue *queue = &pool->queues[(index + k) % count];
+        std::lock_guard<std::mutex> guard(queue->lock);
+        if (queue->tasks.empty()) continue;
+        MyWalkTask *task;
+        if (k == 0) {
+            // queue ของตัวเอง: งานล่าสุดที่ cache ยังร้อน
+            task = queue->tasks.back();
+            queue->tasks.pop_back();
+        } else {
+            // ขโมย: งานเก่าสุด (ก้อนใหญ่สุด)
+            task = queue->tasks.front();
+            queue->tasks.pop_front();
+        }
+        pool->queued.fetch_sub(1);
+        return task;
+    }
+    return NULL;
+}
+
+void mountkit::poolWorker(int index) {
+    MyPool *p = pool;
+    worker_pool = p;
+    worker_index = index;
+    while (!p->stop.load()) {
+        MyWalkTask *task = poolTake(index);
+        if (task) {
+            walkRun(task);
+            free(task);
+            continue;
+        }
+        p->idle.fetch_add(1);
+        {
+            std::unique_lock<std::mutex> guard(p->sleep_lock);
+            while (p->queued.load() == 0 && !p->stop.load()) p->wake.wait(guard);
+        }
+        p->idle.fetch_sub(1);
+    }
+}
+
+void mountkit::walkRun(MyWalkTask *task) {
+    WalkJob *job = task->job;
+    std::vector<WalkEntry> stack;
+    std::vector<size_t> path_len;  // path_len[d] = ความยาว path ของ parent ของ entry ระดับ d
+    char path[WALK_PATH_MAX];
+    size_t total = 0;
+    size_t walked = 0;             // folder ที่เดินไปตั้งแต่แบ่งงานครั้งล่าสุด
+
+    if (job->kind == MOUNTKIT_WALK_PRINT) {
+        size_t base = strlen(task->prefix);
+        memcpy(path, task->prefix, base + 1);
+        path_len.push_back(base);
+    }
+    if (task->folder) {
+        WalkEntry first = { task->folder, 0 };
+        stack.push_back(first);
+    }
+
+    while (!stack.empty()) {
+        if (pool && walked >= pool->threshold && stack.size() > 1 && pool->idle.load(std::memory_order_relaxed) > 0) {
+            // ส่ง entry ล่างสุด (ทำทีหลังสุดตามลำดับ) ให้ worker ที่ว่าง
+            MyWalkTask *split = (MyWalkTask*)malloc(sizeof(MyWalkTask));
+            if (split) {
+                split->job = job;
+                split->folder = stack.front().folder;
+                split->out = NULL;
+                split->prefix[0] = '\0';
+                if (job->kind == MOUNTKIT_WALK_PRINT) {
+                    size_t len = path_len[stack.front().depth];
+                    memcpy(split->prefix, path, len);
+                    split->prefix[len] = '\0';
+                    // output ของ entry นี้อยู่หลังทุกอย่างที่ task นี้ยังจะพิมพ์
+                    // และก่อน entry ที่เคยแบ่งออกไปก่อนหน้า (ซึ่งอยู่ท้ายกว่า)
+                    WalkChunk *chunk = (WalkChunk*)calloc(1, sizeof(WalkChunk));
+                    if (!chunk) {
+                        free(split);
+                        split = NULL;
+                    } else {
+                        chunk->next = task->out->next;
+                        task->out->next = chunk;
+                        split->out = chunk;
+                    }
+                }
+            }
+            if (split) {
+                stack.erase(stack.begin());
+                job->pending.fetch_add(1);
+                poolPush(poolSelf(pool), split);
+            }
+            walked = 0;
+        }
+
+        WalkEntry entry = stack.back();
+        stack.pop_back();
+        MyFolder *folder = entry.folder;
+        MyFolder *next = folder->dir;
+        MyFolder *sub = NULL;
+        walked++;
+
+        switch (job->kind) {
+            case MOUNTKIT_WALK_REMOVE:
+                // ลำดับเดียวกับ removeFolder: รอ thread ที่เดินเข้ามาก่อนแล้วคืนไฟล์และ node
+                writeLock(&folder->lock);
+                next = folder->dir;
+                sub = folder->subdir;
+                freeFiles(folder->files);
+                releaseFolderNode(folder);
+                break;
+            case MOUNTKIT_WALK_CAPACITY: {
+                MyFolder *inner = followMount(folder);
+                total += scanCapacity(inner);
+                sub = inner->subdir;
+                break;
+            }
+            default: {
+                // path = path ของ parent + "/" + ชื่อ (ตัดที่ WALK_PATH_MAX - 1 ตัวอักษร)
+                size_t len = path_len[entry.depth];
+                if (len > 0 && len < WALK_PATH_MAX - 1) path[len++] = '/';
+                for (const char *c = folder->data; *c && len < WALK_PATH_MAX - 1; ++c) path[len++] = *c;
+                path[len] = '\0';
+                if (path_len.size() < entry.depth + 2) path_len.resize(entry.depth + 2);
+                path_len[entry.depth + 1] = len;
+                chunkWrite(task->out, path, len);
+                chunkWrite(task->out, "\n", 1);
+                sub = followMount(folder)->subdir;
+                break;
+            }
+        }
+
+        // sibling ถัดไปทำหลัง subtree ของ folder นี้ - push ก่อน
+        if (next) {
+            WalkEntry sibling = { next, entry.depth };
+            stack.push_back(sibling);
+        }
+        if (sub) {
+            WalkEntry child = { sub, entry.depth + 1 };
+            stack.push_back(child);
+        }
+    }
+
+    if (total) job->total.fetch_add(total);
+    job->pending.fetch_sub(1, std::memory_order_release);
+}
+
+size_t mountkit::parallelWalk(int kind, MyFolder *folder, const char *prefix) {
+    WalkJob job;
+    job.kind = kind;
+    job.pending.store(1);
+    job.total.store(0);
+
+    WalkChunk head = { NULL, 0, 0, NULL };
+    MyWalkTask first;
+    first.job = &job;
+    first.folder = folder;
+    first.out = &head;
+    first.prefix[0] = '\0';
+    if (kind == MOUNTKIT_WALK_PRINT && prefix) {
+        strncpy(first.prefix, prefix, sizeof(first.prefix) - 1);
+        first.prefix[sizeof(first.prefix) - 1] = '\0';
+    }
+    if (kind == MOUNTKIT_WALK_CAPACITY) {
+        // folder แรกนับเฉพาะตัวเอง (ไม่รวม sibling) แล้วเดินต่อที่ลูก
+        MyFolder *inner = followMount(folder);
+        job.total.store(scanCapacity(inner));
+        first.folder = inner->subdir;
+    }
+
+    walkRun(&first);
+
+    // ช่วยทำ task ที่ถูกแบ่งออกไปจนครบ
+    int self = poolSelf(pool);
+    while (job.pending.load(std::memory_order_acquire) > 0) {
+        MyWalkTask *task = poolTake(self);
+        if (task) {
+            walkRun(task);
+            free(task);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    if (kind == MOUNTKIT_WALK_PRINT) {
+        for (WalkChunk *chunk = &head; chunk;) {
+            WalkChunk *next = chunk->next;
+            if (chunk->len) fwrite(chunk->buf, 1, chunk->len, stdout);
+            free(chunk->buf);
+            if (chunk != &head) free(chunk);
+            chunk = next;
+        }
+    }
+    return job.total.load();
+}
+
+void mountkit::set_parallel(int threads, size_t threshold) {
+    if (pool) {
+        {
+            std::lock_guard<std::mutex> guard(pool->sleep_lock);
+            pool->stop.store(true);
+        }
+        pool->wake.notify_all();
+        for (int i = 0; i < pool->workers; ++i) pool->threads[i].join();
+        delete[] pool->threads;
+        delete[] pool->queues;
+        delete pool;
+        pool = NULL;
+    }
+    if (threads <= 1) return;
+
+    MyPool *p = new MyPool();
+    p->workers = threads - 1;  // thread ที่เรียก traversal ทำงานด้วยอีกหนึ่ง
+    p->threshold = threshold ? threshold : 1;
+    p->queues = new PoolQueue[threads];
+    p->threads = new std::thread[p->workers];
+    p->idle.store(0);
+    p->queued.store(0);
+    p->stop.store(false);
+    pool = p;
+    for (int i = 0; i < p->workers; ++i) {
+        p->threads[i] = std::thread([this, i]() { poolWorker(i); });
+    }
+}
+
+mountkit::~mountkit() {
+    set_parallel(0);
+    while (watches) unwatch(watches);
+}
+
+// =================================================================
+// parallel_benchmark
+// =================================================================
+
+static double walkSeconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int mountkit::parallel_benchmark(int max_threads, int folders) {
+    if (max_threads < 1 || folders < 1) return 0;
+
+    MyPool *was_pool = pool;
+    size_t was_threshold = pool ? pool->threshold : 4096;
+    int was_threads = pool ? pool->workers + 1 : 1;
+    if (was_pool) set_parallel(0);
+
+    printf("\n=== PARALLEL TRAVERSAL BENCHMARK (%d folders, %d files each) ===\n", folders, 2);
+    printf("%8s  %14s  %8s  %14s  %8s\n", "threads", "capacity", "speedup", "removeFolder", "speedup");
+
+    uint8_t block[64];
+    memset(block, 'p', sizeof(block));
+    double base_capacity = 0, base_remove = 0;
+    size_t expected = 0;
+    int ok = 1;
+    for (int threads = 1; ok; threads *= 2) {
+        if (threads > max_threads) threads = max_threads;
+
+        // tree ทดสอบ: folder ละ WALK_FANOUT subdirectory (สร้างแบบ BFS) และ 2 ไฟล์
+        // สร้างใหม่ทุกรอบเพราะ removeFolder ทำลาย tree
+        MyFolder *root = NULL;
+        createFolder(&root, "root");
+        std::vector<MyFolder*> all;
+        if (root) all.push_back(root);
+        char name[16];
+        for (size_t parent = 0; ok && parent < all.size() && (int)all.size() < folders; ++parent) {
+            for (int k = 0; k < WALK_FANOUT && (int)all.size() < folders; ++k) {
+                MyFolder *child = NULL;
+                snprintf(name, sizeof(name), "d%d", k);
+                createFolder(&child, name);
+                if (!child) {
+                    ok = 0;
+                    break;
+                }
+                child->dir = all[parent]->subdir;
+                all[parent]->subdir = child;
+                all.push_back(child);
+            }
+        }
+        for (size_t i = 0; ok && i < all.size(); ++i) {
+            MyFile *a = mk(all[i], "a.txt");
+            MyFile *b = mk(all[i], "b.txt");
+            // buffer เล็กพอให้ tree หลายล้าน node อยู่ใน memory ได้
+            if (!a || !b || !resizeData(a, sizeof(block)) || !resizeData(b, sizeof(block))) ok = 0;
+            else write(a, block, sizeof(block));
+        }
+        if (!root || !ok) {
+            removeFolder(root);
+            ok = 0;
+            break;
+        }
+        usageRebuild(root); // folder ถูกต่อ link เอง
+
+        // เดินทุก folder จริง - calculateFolderCapacity อ่านยอดรวมที่เก็บไว้และใช้ตรวจผลแทน
+        set_parallel(threads);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        size_t capacity = parallelWalk(MOUNTKIT_WALK_CAPACITY, root, NULL);
+        double capacity_s = walkSeconds(start);
+        if (capacity != calculateFolderCapacity(root, true)) ok = 0;
+        start = std::chrono::steady_clock::now();
+        removeFolder(root);
+        double remove_s = walkSeconds(start);
+        set_parallel(0);
+
+        if (threads == 1) {
+            base_capacity = capacity_s;
+            base_remove = remove_s;
+            expected = capacity;
+        } else if (capacity != expected) {
+            ok = 0;
+            break;
+        }
+        printf("%8d  %11.1f ms  %7.2fx  %11.1f ms  %7.2fx\n", threads,
+               capacity_s * 1000.0, capacity_s > 0 ? base_capacity / capacity_s : 0.0,
+               remove_s * 1000.0, remove_s > 0 ? base_remove / remove_s : 0.0);
+        if (threads == max_threads) break;
+    }
+
+    if (was_pool) set_parallel(was_threads, was_threshold);
+    return ok;
+}
+
+#endif // EMBEDDED_BUILD
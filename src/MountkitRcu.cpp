@@ -0,0 +1,262 @@
+#include "MountkitInternal.h"
+
+// lock-free read mode (RCU): reader ประกาศ epoch ที่เห็นไว้ใน slot ของ thread ตัวเอง
+// writer ถอด node ออกจาก tree ก่อน แล้วจึงคืนหน่วยความจำเมื่อไม่มี reader ที่เข้ามาก่อนหน้าเหลืออยู่
+
+#ifndef EMBEDDED_BUILD
+
+#include <atomic>
+#include <thread>
+
+#define RCU_MAX_THREADS   256  // จำนวน thread ที่อยู่ใน read-side section พร้อมกันได้
+#define RCU_RECLAIM_BATCH 64   // retire ครบเท่านี้แล้วลองคืนหน่วยความจำ
+
+// slot ต่อ thread - pad ให้ครบ cache line เพื่อไม่ให้ reader ต่าง thread เขียนทับ line เดียวกัน
+typedef struct RcuSlot {
+    std::atomic<uint64_t> epoch;  // 0 = ไม่ได้อยู่ใน section, อื่นๆ = epoch ตอนเข้า
+    std::atomic<bool> owned;      // มี thread จองอยู่
+    char pad[64 - sizeof(std::atomic<uint64_t>) - sizeof(std::atomic<bool>)];
+} RcuSlot;
+
+typedef struct MyRetired {
+    void *ptr;
+    int kind;
+    uint64_t epoch;               // epoch ตอนถูกถอดออก - คืนได้เมื่อ reader ทุกตัวเข้ามาหลังจากนี้
+    struct MyRetired *next;
+} MyRetired;
+
+static RcuSlot rcu_slots[RCU_MAX_THREADS];
+static std::atomic<int> rcu_slot_count(0);   // จำนวน slot ที่เคยถูกใช้ (scan แค่ช่วงนี้)
+static std::atomic<uint64_t> rcu_epoch(1);
+
+// สถานะต่อ thread - คืน slot เมื่อ thread จบ
+struct RcuThread {
+    RcuSlot *slot;
+    int depth;
+    RcuThread() : slot(NULL), depth(0) {}
+    ~RcuThread() { if (slot) slot->owned.store(false, std::memory_order_release); }
+};
+static thread_local RcuThread rcu_thread;
+
+static RcuSlot* rcuClaimSlot() {
+    for (;;) {
+        for (int i = 0; i < RCU_MAX_THREADS; ++i) {
+            bool expected = false;
+            if (!rcu_slots[i].owned.load(std::memory_order_relaxed) &&
+                rcu_slots[i].owned.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                int count = rcu_slot_count.load(std::memory_order_relaxed);
+                while (count < i + 1 && !rcu_slot_count.compare_exchange_weak(count, i + 1)) {}
+                return &rcu_slots[i];
+            }
+        }
+        // slot เต็ม - รอ thread อื่นจบ
+        std::this_thread::yield();
+    }
+}
+
+// epoch ต่ำสุดของ reader ที่อยู่ใน section (UINT64_MAX ถ้าไม่มี)
+static uint64_t rcuOldestReader() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    uint64_t oldest = UINT64_MAX;
+    int count = rcu_slot_count.load(std::memory_order_acquire);
+    for (int i = 0; i < count; ++i) {
+        uint64_t e = rcu_slots[i].epoch.load(std::memory_order_acquire);
+        if (e != 0 && e < oldest) oldest = e;
+    }
+    return oldest;
+}
+
+static void rcuSectionEnter() {
+    RcuThread &t = rcu_thread;
+    if (t.depth++ > 0) return;
+    if (!t.slot) t.slot = rcuClaimSlot();
+    // store ธรรมดาลง cache line ของตัวเอง + fence (ไม่มี read-modify-write บน line ที่แชร์)
+    t.slot->epoch.store(rcu_epoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+static void rcuSectionLeave() {
+    RcuThread &t = rcu_thread;
+    if (--t.depth == 0) t.slot->epoch.store(0, std::memory_order_release);
+}
+
+void mountkit::rcuEnter() {
+    if (lockfree_reads) rcuSectionEnter();
+}
+
+void mountkit::rcuLeave() {
+    if (lockfree_reads) rcuSectionLeave();
+}
+
+// guard ของ handle ใช้ read-side section เดียวกัน (ซ้อนกับ section ภายใน operation ได้)
+void mountkit::guard_enter() {
+    rcuSectionEnter();
+}
+
+void mountkit::guard_leave() {
+    rcuSectionLeave();
+}
+
+void mountkit::lookupLock(uint32_t *word) {
+    if (!lockfree_reads) readLock(word);
+}
+
+void mountkit::lookupUnlock(uint32_t *word) {
+    if (!lockfree_reads) readUnlock(word);
+}
+
+void mountkit::swapData(MyFile *file, uint8_t *data, size_t capacity, size_t size) {
+    uint8_t *old = file->data;
+    bool old_in_arena = (file->alloc_flags & MOUNTKIT_ALLOC_DATA) != 0;
+    usageResize(file, file->size, size, file->capacity, capacity);
+
+    // seqlock: reader ที่เห็น seq เปลี่ยนระหว่างอ่าน (data, size) จะอ่านใหม่
+    std::atomic<uint32_t> *seq = sharedField(&file->seq);
+    uint32_t s = seq->load(std::memory_order_relaxed);
+    seq->store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    storeRelaxed(&file->data, data);
+    storeRelaxed(&file->size, size);
+    seq->store(s + 2, std::memory_order_release);
+
+    // append_shared อ่าน capacity โดยไม่ถือ lock - publish หลัง data เพื่อให้เห็น buffer ใหม่คู่กัน
+    storeShared(&file->capacity, capacity);
+    file->alloc_flags &= (uint8_t)~MOUNTKIT_ALLOC_DATA;
+    if (lockfree_reads) {
+        retire(old, old_in_arena ? MOUNTKIT_RETIRE_DATA_ARENA : MOUNTKIT_RETIRE_DATA);
+    } else {
+        releaseData(old, old_in_arena);
+    }
+}
+
+void mountkit::retire(void *ptr, int kind) {
+    if (!ptr) return;
+    MyRetired *r = (MyRetired*)malloc(sizeof(MyRetired));
+    // เลื่อน epoch หลังถอด node แล้ว - reader ที่เข้ามาหลังจากนี้มองไม่เห็น ptr
+    uint64_t epoch = rcu_epoch.fetch_add(1);
+    if (!r) {
+        // ไม่มี memory สำหรับรายการ: รอ reader รุ่นเก่าออกให้หมดแล้วคืนทันที
+        while (rcuOldestReader() <= epoch) std::this_thread::yield();
+        releaseRetired(ptr, kind);
+        return;
+    }
+    r->ptr = ptr;
+    r->kind = kind;
+    r->epoch = epoch;
+
+    writeLock(&retire_lock);
+    r->next = retired;
+    retired = r;
+    bool full = ++retired_count >= RCU_RECLAIM_BATCH;
+    writeUnlock(&retire_lock);
+
+    if (full) reclaim(false);
+}
+
+void mountkit::reclaim(bool wait) {
+    for (;;) {
+        writeLock(&retire_lock);
+        MyRetired *list = retired;
+        retired = NULL;
+        retired_count = 0;
+        writeUnlock(&retire_lock);
+        if (!list) return;
+
+        uint64_t oldest = rcuOldestReader();
+        MyRetired *keep = NULL, *keep_tail = NULL;
+        size_t kept = 0;
+        while (list) {
+            MyRetired *next = list->next;
+            if (list->epoch < oldest) {
+                releaseRetired(list->ptr, list->kind);
+                free(list);
+            } else {
+                list->next = keep;
+                keep = list;
+                if (!keep_tail) keep_tail = list;
+                kept++;
+            }
+            list = next;
+        }
+        if (!keep) return;
+
+        // ยังมี reader รุ่นเก่าอยู่ - ใส่กลับไปรอรอบหน้า
+        writeLock(&retire_lock);
+        keep_tail->next = retired;
+        retired = keep;
+        retired_count += kept;
+        writeUnlock(&retire_lock);
+        if (!wait) return;
+        std::this_thread::yield();
+    }
+}
+
+void mountkit::set_lockfree_reads(bool enable) {
+    if (enable) {
+        concurrent = true;
+        lockfree_reads = true;
+    } else if (lockfree_reads) {
+        synchronize();
+        lockfree_reads = false;
+    }
+}
+
+void mountkit::set_safe_handles(bool enable) {
+    if (enable) {
+        concurrent = true;
+        safe_handles = true;
+    } else if (safe_handles) {
+        synchronize();
+        safe_handles = false;
+    }
+}
+
+void mountkit::synchronize() {
+    reclaim(true);
+}
+
+#endif // EMBEDDED_BUILD
+
+// คืนหน่วยความจำหนึ่งรายการ (ผ่าน grace period แล้ว ไม่มีใครเข้าถึงได้อีก)
+void mountkit::releaseRetired(void *ptr, int kind) {
+    switch (kind) {
+        case MOUNTKIT_RETIRE_FILE:
+            releaseFile((MyFile*)ptr);
+            break;
+        case MOUNTKIT_RETIRE_FOLDER: {
+            // dir ถูกปล่อยไว้ตอนถอดเพื่อให้ reader ที่ยังอยู่บน node นี้เดินต่อได้
+            MyFolder *folder = (MyFolder*)ptr;
+            folder->dir = NULL;
+            removeFolder(folder);
+            break;
+        }
+        default:
+            releaseData((uint8_t*)ptr, kind == MOUNTKIT_RETIRE_DATA_ARENA);
+            break;
+    }
+}
+
+#ifdef EMBEDDED_BUILD
+
+// embedded build ไม่มี thread - ไม่มี reader แบบ lock-free จึงคืนหน่วยความจำได้ทันที
+void mountkit::rcuEnter() {}
+void mountkit::rcuLeave() {}
+void mountkit::lookupLock(uint32_t *word) { readLock(word); }
+void mountkit::lookupUnlock(uint32_t *word) { readUnlock(word); }
+
+void mountkit::swapData(MyFile *file, uint8_t *data, size_t capacity, size_t size) {
+    usageResize(file, file->size, size, file->capacity, capacity);
+    releaseData(file->data, (file->alloc_flags & MOUNTKIT_ALLOC_DATA) != 0);
+    file->data = data;
+    file->size = size;
+    file->capacity = capacity;
+    file->alloc_flags &= (uint8_t)~MOUNTKIT_ALLOC_DATA;
+}
+
+void mountkit::retire(void *ptr, int kind) {
+    if (ptr) releaseRetired(ptr, kind);
+}
+
+void mountkit::reclaim(bool wait) { (void)wait; }
+
+#endif // EMBEDDED_BUILD
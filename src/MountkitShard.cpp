@@ -0,0 +1,278 @@
+#include "MountkitInternal.h"
+
+// sharded namespace: แบ่ง path ไปยัง mountkit instance อิสระหลายตัวตาม hash ของ depth component แรก
+// แต่ละ shard มี root chain, lock, retired list และ pool ของตัวเอง - thread ที่ทำงานใน top-level dir
+// คนละ shard จึงไม่แย่ง lock (รวมถึง root_lock) กันเลย
+// folder ที่ตื้นกว่า depth เป็นส่วนร่วมของ namespace: มีได้ในหลาย shard และถูกรวมกันตอน enumerate
+
+#ifndef EMBEDDED_BUILD
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <new>
+
+#define SHARD_PATH_MAX  256  // เท่ากับ buffer ของ mkdir/cd
+#define SHARD_DEPTH_MAX 128
+
+typedef struct MyShards {
+    int count;
+    int depth;            // จำนวน component ที่ใช้เป็น key
+    mountkit *shards;
+    MyFolder **roots;     // root chain ของแต่ละ shard (folder "root" ตัวเดียว)
+} MyShards;
+
+// path ที่แยกเป็น component แล้ว
+typedef struct ShardPath {
+    char buf[SHARD_PATH_MAX];
+    const char *parts[SHARD_DEPTH_MAX];
+    int count;
+} ShardPath;
+
+static bool shardSplit(const char *path, ShardPath *out) {
+    if (!path) return false;
+    strncpy(out->buf, path, sizeof(out->buf)); out->buf[sizeof(out->buf)-1] = '\0';
+    out->count = 0;
+    for (char *p = out->buf; *p;) {
+        if (*p == '/') {
+            *p++ = '\0';
+            continue;
+        }
+        if (out->count == SHARD_DEPTH_MAX) return false;
+        out->parts[out->count++] = p;
+        while (*p && *p != '/') p++;
+    }
+    return true;
+}
+
+// path ของ component 0..count-1 ในรูปที่ mkdir/cd ของ shard ใช้ ("root/a/b")
+static void shardJoin(const ShardPath *path, int count, char *out, size_t size) {
+    size_t len = (size_t)snprintf(out, size, "root");
+    for (int i = 0; i < count && len < size; ++i) {
+        len += (size_t)snprintf(out + len, size - len, "/%s", path->parts[i]);
+    }
+}
+
+// FNV-1a ของ key "a/b" (depth component แรก)
+static uint32_t shardHashPart(uint32_t h, const char *s) {
+    for (; *s; ++s) {
+        h ^= (uint8_t)*s;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static int shardOf(const MyShards *s, const ShardPath *path) {
+    int n = path->count < s->depth ? path->count : s->depth;
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < n; ++i) {
+        if (i) h = shardHashPart(h, "/");
+        h = shardHashPart(h, path->parts[i]);
+    }
+    return (int)(h % (uint32_t)s->count);
+}
+
+// shard ของ path แบบ "root/<key>" ที่มีพอดี depth component
+static int shardOfKey(const MyShards *s, const std::string &path) {
+    return (int)(shardHashPart(2166136261u, path.c_str() + 5) % (uint32_t)s->count);
+}
+
+MyShards* mountkit::shards_open(int count, int depth) {
+    if (count < 1) count = 1;
+    if (depth < 1) depth = 1;
+    MyShards *s = new (std::nothrow) MyShards;
+    if (!s) return NULL;
+    s->count = count;
+    s->depth = depth;
+    s->shards = new (std::nothrow) mountkit[count];
+    s->roots = new (std::nothrow) MyFolder*[count]();
+    if (!s->shards || !s->roots) {
+        delete[] s->shards;
+        delete[] s->roots;
+        delete s;
+        return NULL;
+    }
+    for (int i = 0; i < count; ++i) {
+        if (lockfree_reads) s->shards[i].set_lockfree_reads(true);
+        else s->shards[i].set_concurrent(concurrent);
+        if (!s->shards[i].mkdir(&s->roots[i], "root")) {
+            shards_close(s);
+            return NULL;
+        }
+    }
+    return s;
+}
+
+void mountkit::shards_close(MyShards *s) {
+    if (!s) return;
+    for (int i = 0; i < s->count; ++i) {
+        s->shards[i].synchronize();
+        s->shards[i].removeFolder(s->roots[i]);
+    }
+    delete[] s->shards;
+    delete[] s->roots;
+    delete s;
+}
+
+mountkit* mountkit::shards_instance(MyShards *s, const char *path) {
+    ShardPath p;
+    if (!s || !shardSplit(path, &p)) return NULL;
+    return &s->shards[shardOf(s, &p)];
+}
+
+MyFolder* mountkit::shards_mkdir(MyShards *s, const char *path) {
+    ShardPath p;
+    char full[SHARD_PATH_MAX];
+    if (!s || !shardSplit(path, &p)) return NULL;
+    int o = shardOf(s, &p);
+    shardJoin(&p, p.count, full, sizeof(full));
+    return s->shards[o].mkdir(&s->roots[o], full);
+}
+
+MyFolder* mountkit::shards_cd(MyShards *s, const char *path) {
+    ShardPath p;
+    char full[SHARD_PATH_MAX];
+    if (!s || !shardSplit(path, &p)) return NULL;
+    int o = shardOf(s, &p);
+    shardJoin(&p, p.count, full, sizeof(full));
+    MyFolder *folder = s->shards[o].cd(s->roots[o], full);
+    // folder ที่ตื้นกว่า depth อาจถูกสร้างเป็น parent ใน shard อื่นเท่านั้น
+    for (int i = 0; !folder && p.count < s->depth && i < s->count; ++i) {
+        folder = s->shards[i].cd(s->roots[i], full);
+    }
+    return folder;
+}
+
+MyFile* mountkit::shards_mk(MyShards *s, const char *path) {
+    ShardPath p;
+    char parent[SHARD_PATH_MAX];
+    if (!s || !shardSplit(path, &p) || p.count == 0) return NULL;
+    int o = shardOf(s, &p);
+    shardJoin(&p, p.count - 1, parent, sizeof(parent));
+    MyFolder *folder = s->shards[o].cd(s->roots[o], parent);
+    if (!folder && p.count - 1 < s->depth) {
+        folder = s->shards[o].mkdir(&s->roots[o], parent);
+    }
+    if (!folder) return NULL;
+    return s->shards[o].mk(folder, p.parts[p.count - 1]);
+}
+
+int mountkit::shards_rm(MyShards *s, const char *path) {
+    ShardPath p;
+    char parent[SHARD_PATH_MAX];
+    if (!s || !shardSplit(path, &p) || p.count == 0) return 0;
+    int o = shardOf(s, &p);
+    shardJoin(&p, p.count - 1, parent, sizeof(parent));
+    MyFolder *folder = s->shards[o].cd(s->roots[o], parent);
+    return folder ? s->shards[o].rm(folder, p.parts[p.count - 1]) : 0;
+}
+
+void mountkit::shards_rmdir(MyShards *s, const char *path) {
+    ShardPath p;
+    char full[SHARD_PATH_MAX];
+    if (!s || !shardSplit(path, &p) || p.count == 0) return; // root ของ namespace ลบไม่ได้
+    shardJoin(&p, p.count, full, sizeof(full));
+    if (p.count >= s->depth) {
+        int o = shardOf(s, &p);
+        s->shards[o].rmdir(&s->roots[o], full);
+        return;
+    }
+    for (int i = 0; i < s->count; ++i) {
+        s->shards[i].rmdir(&s->roots[i], full);
+    }
+}
+
+// =================================================================
+// enumeration ข้าม shard
+// =================================================================
+
+// folder ที่ตื้นกว่า depth ที่รอ enumerate (path แบบ "root/...", จำนวน component ใต้ root)
+typedef struct ShardLevel {
+    std::string path;
+    int level;
+} ShardLevel;
+
+void mountkit::shards_print(MyShards *s) {
+    if (!s) return;
+    // DFS ตามชื่อ: folder ที่ตื้นกว่า depth รวมชื่อลูกจากทุก shard, ที่เหลือให้ shard เจ้าของพิมพ์ทั้ง subtree
+    std::vector<ShardLevel> pending(1, ShardLevel{"root", 0});
+    char path[SHARD_PATH_MAX];
+    while (!pending.empty()) {
+        ShardLevel current = pending.back();
+        pending.pop_back();
+        snprintf(path, sizeof(path), "%s", current.path.c_str());
+        printf("%s\n", path);
+        if (current.level >= s->depth) {
+            int o = shardOfKey(s, current.path);
+            MyFolder *folder = s->shards[o].cd(s->roots[o], path);
+            if (!folder) continue;
+            s->shards[o].readLock(&folder->lock);
+            s->shards[o].PrintAllPath(folder->subdir, path);
+            s->shards[o].readUnlock(&folder->lock);
+            continue;
+        }
+
+        std::vector<std::string> names;
+        for (int i = 0; i < s->count; ++i) {
+            MyFolder *folder = s->shards[i].cd(s->roots[i], path);
+            if (!folder) continue;
+            s->shards[i].readLock(&folder->lock);
+            for (MyFolder *sub = folder->subdir; sub; sub = sub->dir) names.push_back(sub->data);
+            s->shards[i].readUnlock(&folder->lock);
+        }
+        std::sort(names.begin(), names.end());
+        names.erase(std::unique(names.begin(), names.end()), names.end());
+        for (size_t k = names.size(); k-- > 0;) {
+            pending.push_back(ShardLevel{current.path + "/" + names[k], current.level + 1});
+        }
+    }
+}
+
+size_t mountkit::shards_capacity(MyShards *s, const char *path, bool include_subdirs) {
+    ShardPath p;
+    char full[SHARD_PATH_MAX];
+    if (!s || !shardSplit(path, &p)) return 0;
+    shardJoin(&p, p.count, full, sizeof(full));
+    if (p.count >= s->depth) {
+        int o = shardOf(s, &p);
+        MyFolder *folder = s->shards[o].cd(s->roots[o], full);
+        return folder ? s->shards[o].calculateFolderCapacity(folder, include_subdirs) : 0;
+    }
+
+    size_t total = 0;
+    std::vector<ShardLevel> pending(1, ShardLevel{full, p.count});
+    while (!pending.empty()) {
+        ShardLevel current = pending.back();
+        pending.pop_back();
+        if (current.level >= s->depth) {
+            int o = shardOfKey(s, current.path);
+            MyFolder *folder = s->shards[o].cd(s->roots[o], current.path.c_str());
+            if (folder) total += s->shards[o].calculateFolderCapacity(folder, true);
+            continue;
+        }
+
+        // ไฟล์อยู่ใน shard เดียวเสมอ แต่ node ของ folder นี้อาจซ้ำกันหลาย shard - นับครั้งเดียว
+        std::vector<std::string> names;
+        bool counted = false;
+        for (int i = 0; i < s->count; ++i) {
+            MyFolder *folder = s->shards[i].cd(s->roots[i], current.path.c_str());
+            if (!folder) continue;
+            size_t own = s->shards[i].calculateFolderCapacity(folder, false);
+            if (counted) own -= strlen(folder->data) + sizeof(MyFolder);
+            counted = true;
+            total += own;
+            if (!include_subdirs) continue;
+            s->shards[i].readLock(&folder->lock);
+            for (MyFolder *sub = folder->subdir; sub; sub = sub->dir) names.push_back(sub->data);
+            s->shards[i].readUnlock(&folder->lock);
+        }
+        std::sort(names.begin(), names.end());
+        names.erase(std::unique(names.begin(), names.end()), names.end());
+        for (size_t k = 0; k < names.size(); ++k) {
+            pending.push_back(ShardLevel{current.path + "/" + names[k], current.level + 1});
+        }
+    }
+    return total;
+}
+
+#endif // EMBEDDED_BUILD
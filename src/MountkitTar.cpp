@@ -0,0 +1,508 @@
+#include "MountkitInternal.h"
+
+// tar export/import แบบ streaming (ustar + pax) - ใช้หน่วยความจำคงที่ต่อ entry
+#ifndef EMBEDDED_BUILD
+
+#include <cstring>
+#include <cstdlib>
+
+#ifdef _WIN32
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+
+#define TAR_BLOCK_SIZE 512
+#define TAR_PATH_MAX   1024
+
+// ustar header layout (POSIX.1-1988)
+typedef struct TarHeader {
+    char name[100];
+    char mode[8];
+    char uid[8];
+    char gid[8];
+    char size[12];
+    char mtime[12];
+    char chksum[8];
+    char typeflag;
+    char linkname[100];
+    char magic[6];
+    char version[2];
+    char uname[32];
+    char gname[32];
+    char devmajor[8];
+    char devminor[8];
+    char prefix[155];
+    char pad[12];
+} TarHeader;
+
+// state ของ writer ระหว่างเดิน tree
+typedef struct TarWriter {
+    mountkit_sink_fn sink;
+    void *ctx;
+    char path[TAR_PATH_MAX];
+    uint8_t block[TAR_BLOCK_SIZE];
+} TarWriter;
+
+static void tarOctal(char *field, size_t width, unsigned long long value) {
+    // เขียนเลขฐาน 8 แบบ zero-padded และปิดท้ายด้วย '\0'
+    field[width - 1] = '\0';
+    for (size_t i = width - 1; i > 0; --i) {
+        field[i - 1] = (char)('0' + (value & 7));
+        value >>= 3;
+    }
+}
+
+static unsigned long long tarParseOctal(const char *field, size_t width) {
+    unsigned long long value = 0;
+    size_t i = 0;
+    while (i < width && (field[i] == ' ' || field[i] == '\0')) i++;
+    for (; i < width && field[i] >= '0' && field[i] <= '7'; ++i) {
+        value = (value << 3) | (unsigned long long)(field[i] - '0');
+    }
+    return value;
+}
+
+static unsigned int tarChecksum(const uint8_t *block) {
+    unsigned int sum = 0;
+    for (int i = 0; i < TAR_BLOCK_SIZE; ++i) {
+        // ช่อง chksum (offset 148-155) นับเป็น space ตามสเปค
+        sum += (i >= 148 && i < 156) ? ' ' : block[i];
+    }
+    return sum;
+}
+
+// แยก path ลง name/prefix ของ ustar, return 0 ถ้าต้องใช้ pax header แทน
+static int tarSplitPath(TarHeader *hdr, const char *path) {
+    size_t len = strlen(path);
+    if (len <= sizeof(hdr->name)) {
+        memcpy(hdr->name, path, len);
+        return 1;
+    }
+    // หา '/' ที่ทำให้ prefix <= 155 และ name <= 100
+    for (size_t i = len - 1; i > 0; --i) {
+        if (path[i] != '/') continue;
+        if (i > sizeof(hdr->prefix)) continue;
+        if (len - i - 1 > sizeof(hdr->name) || len - i - 1 == 0) return 0;
+        memcpy(hdr->prefix, path, i);
+        memcpy(hdr->name, path + i + 1, len - i - 1);
+        return 1;
+    }
+    return 0;
+}
+
+static int tarEmit(TarWriter *w, const uint8_t *data, size_t size) {
+    return size == 0 || w->sink(w->ctx, data, size);
+}
+
+static int tarPad(TarWriter *w, unsigned long long size) {
+    size_t rem = (size_t)(size % TAR_BLOCK_SIZE);
+    if (rem == 0) return 1;
+    memset(w->block, 0, TAR_BLOCK_SIZE - rem);
+    return tarEmit(w, w->block, TAR_BLOCK_SIZE - rem);
+}
+
+// เขียน pax extended header ('x') สำหรับ path ยาว, target ของ symlink ที่ยาวเกิน 100 bytes หรือไฟล์ใหญ่เกิน 8GB
+// linkpath ไม่จำเป็นต้องมี '\0' ปิดท้าย (data ของ symlink หลัง compact) - ใช้ linkpath_len
+static int tarWritePax(TarWriter *w, const char *path, const uint8_t *linkpath, size_t linkpath_len,
+                       unsigned long long size, bool need_size) {
+    char records[2 * TAR_PATH_MAX + 96];
+    size_t used = 0;
+    const char *keys[3] = { "path", "linkpath", "size" };
+    char size_str[24];
+    snprintf(size_str, sizeof(size_str), "%llu", size);
+    const char *values[3] = { path, (const char*)linkpath, size_str };
+    size_t lengths[3] = { path ? strlen(path) : 0, linkpath_len, strlen(size_str) };
+
+    for (int k = 0; k < 3; ++k) {
+        if (!values[k]) continue;
+        if (k == 2 && !need_size) continue;
+        // record = "<len> <key>=<value>\n" โดย len นับรวมตัวเอง
+        size_t body = 1 + strlen(keys[k]) + 1 + lengths[k] + 1;
+        size_t total = body + 1;
+        while (total != body + (size_t)snprintf(NULL, 0, "%zu", total)) {
+            total = body + (size_t)snprintf(NULL, 0, "%zu", total);
+        }
+        if (used + total >= sizeof(records)) return 0;
+        used += (size_t)snprintf(records + used, sizeof(records) - used,
+                                 "%zu %s=%.*s\n", total, keys[k], (int)lengths[k], values[k]);
+    }
+
+    TarHeader *hdr = (TarHeader*)w->block;
+    memset(w->block, 0, TAR_BLOCK_SIZE);
+    snprintf(hdr->name, sizeof(hdr->name), "PaxHeader");
+    tarOctal(hdr->mode, sizeof(hdr->mode), 0644);
+    tarOctal(hdr->uid, sizeof(hdr->uid), 0);
+    tarOctal(hdr->gid, sizeof(hdr->gid), 0);
+    tarOctal(hdr->size, sizeof(hdr->size), used);
+    tarOctal(hdr->mtime, sizeof(hdr->mtime), 0);
+    hdr->typeflag = 'x';
+    memcpy(hdr->magic, "ustar", 6);
+    memcpy(hdr->version, "00", 2);
+    snprintf(hdr->chksum, sizeof(hdr->chksum), "%06o", tarChecksum(w->block));
+    hdr->chksum[7] = ' ';
+
+    if (!tarEmit(w, w->block, TAR_BLOCK_SIZE)) return 0;
+    if (!tarEmit(w, (const uint8_t*)records, used)) return 0;
+    return tarPad(w, used);
+}
+
+// mode: MyMeta::mode ของ node, linkname: target ของ symlink (type '2') - ยาวเกิน 100 bytes ไปอยู่ใน pax linkpath
+static int tarWriteHeader(TarWriter *w, const char *path, char type, unsigned long long size, unsigned mode,
+                          const uint8_t *linkname = NULL, size_t linkname_len = 0) {
+    TarHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+
+    bool big = size > 077777777777ULL;
+    bool fits = tarSplitPath(&hdr, path) != 0;
+    bool long_link = linkname && linkname_len > sizeof(hdr.linkname);
+    if (!fits || big || long_link) {
+        if (!tarWritePax(w, fits ? NULL : path, long_link ? linkname : NULL, linkname_len, size, big)) return 0;
+        if (!fits) {
+            // ใส่ชื่อแบบตัดสั้นไว้สำหรับ reader ที่ไม่รู้จัก pax
+            memset(hdr.name, 0, sizeof(hdr.name));
+            memset(hdr.prefix, 0, sizeof(hdr.prefix));
+            strncpy(hdr.name, path, sizeof(hdr.name) - 1);
+        }
+        if (long_link) linkname_len = sizeof(hdr.linkname) - 1; // ตัดสั้นเช่นเดียวกับชื่อ
+    }
+
+    tarOctal(hdr.mode, sizeof(hdr.mode), mode);
+    tarOctal(hdr.uid, sizeof(hdr.uid), 0);
+    tarOctal(hdr.gid, sizeof(hdr.gid), 0);
+    tarOctal(hdr.size, sizeof(hdr.size), big ? 0 : size);
+    tarOctal(hdr.mtime, sizeof(hdr.mtime), 0);
+    hdr.typeflag = type;
+    if (linkname) memcpy(hdr.linkname, linkname, linkname_len);
+    memcpy(hdr.magic, "ustar", 6);
+    memcpy(hdr.version, "00", 2);
+
+    memcpy(w->block, &hdr, TAR_BLOCK_SIZE);
+    snprintf(((TarHeader*)w->block)->chksum, 8, "%06o", tarChecksum(w->block));
+    ((TarHeader*)w->block)->chksum[7] = ' ';
+    return tarEmit(w, w->block, TAR_BLOCK_SIZE);
+}
+
+// เดิน subtree ตามลำดับ pre-order: header ของ folder, ไฟล์ของมัน แล้วจึง subfolder (ข้าม mount point เข้าไปด้วย)
+static int tarWriteFolder(mountkit &mount, TarWriter *w, MyFolder *folder) {
+    int ok = 1;
+    MyIter it;
+    mount.iter_begin(&it, folder, MOUNTKIT_ITER_PRE | MOUNTKIT_ITER_FILES | MOUNTKIT_ITER_MOUNTS);
+    while (ok && mount.iter_next(&it)) {
+        if (it.depth == 0) continue; // folder ที่ export เองไม่มี entry
+        size_t n = mount.iter_path(&it, w->path, TAR_PATH_MAX, 1);
+        if (!it.file) {
+            if (n + 1 >= TAR_PATH_MAX) {
+                ok = 0;
+                continue;
+            }
+            w->path[n] = '/';
+            w->path[n + 1] = '\0';
+            ok = tarWriteHeader(w, w->path, '5', 0, metaMode(nodeMeta(it.folder), MOUNTKIT_MODE_DIR));
+            continue;
+        }
+        // hard link ถูก export เป็นไฟล์ธรรมดา (data ของไฟล์จริง)
+        MyFile *f = fileTarget(it.file);
+        if (f->kind == MOUNTKIT_DT_LINK) {
+            // symlink: target อยู่ใน linkname ของ header (ustar) หรือ pax linkpath ถ้ายาวเกิน
+            ok = n < TAR_PATH_MAX && tarWriteHeader(w, w->path, '2', 0, metaMode(nodeMeta(f), MOUNTKIT_MODE_LINK), f->data, f->size);
+            continue;
+        }
+        // ส่ง data ตรงจาก MyFile::data โดยไม่ copy
+        ok = n < TAR_PATH_MAX && tarWriteHeader(w, w->path, '0', f->size, metaMode(nodeMeta(f), MOUNTKIT_MODE_FILE)) && tarEmit(w, f->data, f->size) &&
+             tarPad(w, f->size);
+    }
+    if (it.failed) ok = 0;
+    mount.iter_end(&it);
+    return ok;
+}
+
+int mountkit::tar_export(MyFolder *folder, mountkit_sink_fn sink, void *ctx) {
+    if (!folder || !sink) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    folder = followMount(folder);
+
+    TarWriter w;
+    w.sink = sink;
+    w.ctx = ctx;
+    w.path[0] = '\0';
+
+    if (!tarWriteFolder(*this, &w, folder)) {
+        #ifdef LIB_DEBUG
+            printf("Error: tar export failed at '%s'\n", w.path);
+        #endif
+        setError(MOUNTKIT_EIO);
+        return 0;
+    }
+
+    // end-of-archive = 2 block ว่าง
+    memset(w.block, 0, TAR_BLOCK_SIZE);
+    if (!tarEmit(&w, w.block, TAR_BLOCK_SIZE) || !tarEmit(&w, w.block, TAR_BLOCK_SIZE)) {
+        setError(MOUNTKIT_EIO);
+        return 0;
+    }
+    return 1;
+}
+
+// อ่านให้ครบ size bytes จาก source, return 0 ถ้า EOF/error ก่อนครบ
+static int tarReadFull(mountkit_source_fn source, void *ctx, uint8_t *buffer, size_t size) {
+    size_t got = 0;
+    while (got < size) {
+        int n = source(ctx, buffer + got, size - got);
+        if (n <= 0) return 0;
+        got += (size_t)n;
+    }
+    return 1;
+}
+
+static int tarSkip(mountkit_source_fn source, void *ctx, unsigned long long size) {
+    uint8_t scratch[TAR_BLOCK_SIZE];
+    while (size > 0) {
+        size_t chunk = size > TAR_BLOCK_SIZE ? TAR_BLOCK_SIZE : (size_t)size;
+        if (!tarReadFull(source, ctx, scratch, chunk)) return 0;
+        size -= chunk;
+    }
+    return 1;
+}
+
+static unsigned long long tarPadding(unsigned long long size) {
+    return (TAR_BLOCK_SIZE - size % TAR_BLOCK_SIZE) % TAR_BLOCK_SIZE;
+}
+
+// อ่าน pax records ที่สนใจ (path, linkpath, size) - ข้อมูลที่ยาวกว่า buffer จะถูกข้าม
+static int tarReadPax(mountkit_source_fn source, void *ctx, unsigned long long size,
+                      char *path, size_t path_size, char *linkpath, size_t linkpath_size,
+                      unsigned long long *pax_size, bool *has_size) {
+    char records[2 * TAR_PATH_MAX + 96];
+    if (size >= sizeof(records)) {
+        return tarSkip(source, ctx, size + tarPadding(size));
+    }
+    if (!tarReadFull(source, ctx, (uint8_t*)records, (size_t)size)) return 0;
+    if (!tarSkip(source, ctx, tarPadding(size))) return 0;
+    records[size] = '\0';
+
+    char *p = records;
+    char *end = records + size;
+    while (p < end) {
+        char *space = strchr(p, ' ');
+        if (!space) break;
+        size_t len = (size_t)strtoul(p, NULL, 10);
+        if (len == 0 || p + len > end) break;
+        char *key = space + 1;
+        char *eq = strchr(key, '=');
+        char *rec_end = p + len - 1; // ตำแหน่ง '\n'
+        if (eq && eq < rec_end) {
+            *rec_end = '\0';
+            *eq = '\0';
+            if (strcmp(key, "path") == 0) {
+                snprintf(path, path_size, "%s", eq + 1);
+            } else if (strcmp(key, "linkpath") == 0) {
+                snprintf(linkpath, linkpath_size, "%s", eq + 1);
+            } else if (strcmp(key, "size") == 0) {
+                *pax_size = strtoull(eq + 1, NULL, 10);
+                *has_size = true;
+            }
+        }
+        p += len;
+    }
+    return 1;
+}
+
+// สร้าง directory ทีละ component (รองรับ path ยาวกว่า buffer 256 ของ mkdir)
+// return NULL ถ้ามี component ".." หรือสร้างไม่สำเร็จ
+static MyFolder* tarMakeDirs(mountkit &mount, MyFolder *folder, char *path) {
+    MyFolder *current = folder;
+    char *comp = path;
+    while (*comp) {
+        char *slash = strchr(comp, '/');
+        if (slash) *slash = '\0';
+        if (strcmp(comp, "..") == 0) return NULL;
+        if (comp[0] != '\0' && strcmp(comp, ".") != 0) {
+            current = mount.mkdir_at(current, comp);
+            if (!current) return NULL;
+        }
+        if (!slash) break;
+        comp = slash + 1;
+    }
+    return current;
+}
+
+int mountkit::tar_import(MyFolder *folder, mountkit_source_fn source, void *ctx) {
+    if (!folder || !source) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+
+    uint8_t block[TAR_BLOCK_SIZE];
+    char pax_path[TAR_PATH_MAX];
+    char pax_linkpath[TAR_PATH_MAX];
+    char path[TAR_PATH_MAX];
+    unsigned long long pax_size = 0;
+    bool has_pax_size = false;
+    pax_path[0] = '\0';
+    pax_linkpath[0] = '\0';
+
+    while (true) {
+        if (!tarReadFull(source, ctx, block, TAR_BLOCK_SIZE)) {
+            setError(MOUNTKIT_EIO);
+            return 0;
+        }
+
+        bool zero = true;
+        for (int i = 0; i < TAR_BLOCK_SIZE && zero; ++i) zero = block[i] == 0;
+        if (zero) return 1; // end-of-archive
+
+        TarHeader *hdr = (TarHeader*)block;
+        if (tarParseOctal(hdr->chksum, sizeof(hdr->chksum)) != tarChecksum(block)) {
+            #ifdef LIB_DEBUG
+                printf("Error: tar header checksum mismatch\n");
+            #endif
+            setError(MOUNTKIT_EIO);
+            return 0;
+        }
+
+        unsigned long long size = tarParseOctal(hdr->size, sizeof(hdr->size));
+        char type = hdr->typeflag;
+
+        if (type == 'x') {
+            if (!tarReadPax(source, ctx, size, pax_path, sizeof(pax_path), pax_linkpath, sizeof(pax_linkpath),
+                            &pax_size, &has_pax_size)) {
+                setError(MOUNTKIT_EIO);
+                return 0;
+            }
+            continue;
+        }
+        if (type == 'g') {
+            if (!tarSkip(source, ctx, size + tarPadding(size))) {
+                setError(MOUNTKIT_EIO);
+                return 0;
+            }
+            continue;
+        }
+
+        if (has_pax_size) size = pax_size;
+        if (pax_path[0] != '\0') {
+            snprintf(path, sizeof(path), "%s", pax_path);
+        } else if (hdr->prefix[0] != '\0' && memcmp(hdr->magic, "ustar", 5) == 0) {
+            snprintf(path, sizeof(path), "%.155s/%.100s", hdr->prefix, hdr->name);
+        } else {
+            snprintf(path, sizeof(path), "%.100s", hdr->name);
+        }
+        pax_path[0] = '\0';
+        has_pax_size = false;
+        // target ของ symlink: pax linkpath มาก่อน linkname ของ ustar
+        char target[TAR_PATH_MAX];
+        if (pax_linkpath[0] != '\0') {
+            snprintf(target, sizeof(target), "%s", pax_linkpath);
+        } else {
+            snprintf(target, sizeof(target), "%.100s", hdr->linkname);
+        }
+        pax_linkpath[0] = '\0';
+
+        if (type == '5') {
+            // entry ที่มี ".." จะถูกข้าม
+            MyFolder *dir = tarMakeDirs(*this, folder, path);
+            if (dir) chmod(dir, (uint32_t)tarParseOctal(hdr->mode, sizeof(hdr->mode)));
+            continue;
+        }
+
+        // แยก parent directory กับชื่อไฟล์
+        MyFolder *parent = folder;
+        char *leaf = strrchr(path, '/');
+        if (leaf) {
+            *leaf++ = '\0';
+            parent = tarMakeDirs(*this, folder, path);
+        } else {
+            leaf = path;
+        }
+        if (type == '2' && parent && leaf[0] != '\0' && target[0] != '\0') {
+            // ชื่อที่มีอยู่แล้วคงไว้เหมือน mk
+            if (!symlink(parent, leaf, target) && lastError() != MOUNTKIT_EEXIST) return 0;
+            if (!tarSkip(source, ctx, size + tarPadding(size))) {
+                setError(MOUNTKIT_EIO);
+                return 0;
+            }
+            continue;
+        }
+        if ((type != '0' && type != '\0') || !parent || leaf[0] == '\0' ||
+            strcmp(leaf, ".") == 0 || strcmp(leaf, "..") == 0) {
+            // hard link, device, fifo ฯลฯ ไม่รองรับ - ข้าม data
+            if (!tarSkip(source, ctx, size + tarPadding(size))) {
+                setError(MOUNTKIT_EIO);
+                return 0;
+            }
+            continue;
+        }
+
+        MyFile *file = mk(parent, leaf); // mk บันทึก error เอง
+        if (!file) return 0;
+        file = fileTarget(file); // ชื่อเดิมเป็น hard link: เขียนลงไฟล์จริง
+        if (file->kind == MOUNTKIT_DT_LINK) {
+            // ชื่อเดิมเป็น symlink - คงไว้และข้าม data
+            if (!tarSkip(source, ctx, size + tarPadding(size))) {
+                setError(MOUNTKIT_EIO);
+                return 0;
+            }
+            continue;
+        }
+
+        // จอง capacity ครั้งเดียวแล้วอ่านเข้า MyFile::data โดยตรง
+        if (size > file->capacity) {
+            if (!quotaCheck(file->folder, (size_t)size - file->capacity, 0)) return 0;
+            if (!resizeData(file, (size_t)size)) {
+                setError(MOUNTKIT_ENOMEM);
+                return 0;
+            }
+        }
+        if (size > 0 && !tarReadFull(source, ctx, file->data, (size_t)size)) {
+            setError(MOUNTKIT_EIO);
+            return 0;
+        }
+        usageResize(file, file->size, (size_t)size, file->capacity, file->capacity);
+        file->size = (size_t)size;
+        file->reserved = file->size;
+        chmod(file, (uint32_t)tarParseOctal(hdr->mode, sizeof(hdr->mode)));
+        metaTouch(nodeMeta(file), true);
+        if (file->crc_state != MOUNTKIT_CRC_OFF) file->crc_state = MOUNTKIT_CRC_STALE;
+        if (!tarSkip(source, ctx, tarPadding(size))) {
+            setError(MOUNTKIT_EIO);
+            return 0;
+        }
+    }
+}
+
+static int tarFdSink(void *ctx, const uint8_t *data, size_t size) {
+    int fd = *(int*)ctx;
+    while (size > 0) {
+        long n = (long)::write(fd, data, (unsigned int)(size > 0x40000000 ? 0x40000000 : size));
+        if (n <= 0) return 0;
+        data += n;
+        size -= (size_t)n;
+    }
+    return 1;
+}
+
+static int tarFdSource(void *ctx, uint8_t *buffer, size_t size) {
+    int fd = *(int*)ctx;
+    return (int)::read(fd, buffer, (unsigned int)size);
+}
+
+int mountkit::tar_export_fd(MyFolder *folder, int fd) {
+    if (fd < 0) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    return tar_export(folder, tarFdSink, &fd);
+}
+
+int mountkit::tar_import_fd(MyFolder *folder, int fd) {
+    if (fd < 0) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    return tar_import(folder, tarFdSource, &fd);
+}
+
+#endif // EMBEDDED_BUILD
@@ -0,0 +1,333 @@
+#include "MountkitInternal.h"
+
+// ยอดรวมการใช้พื้นที่ต่อ subtree: ทุก operation ที่เปลี่ยนขนาดหรือโครงสร้างส่งส่วนต่างขึ้นไปตาม parent
+// จน root ของ tree ยอดของ folder ใดก็ตามจึงอ่านได้ทันทีโดยไม่ต้องเดิน tree
+// concurrent mode: ยอดถูกบวกแบบ atomic (ลบ = บวกค่า two's complement) และอ่านทีละ field
+// ราคาของการแก้หนึ่งครั้งเท่ากับความลึกของ folder - ข้ามไปเลยถ้าส่วนต่างเป็น 0
+// quota ตรวจกับยอดชุดเดียวกันนี้ตาม parent chain ก่อนที่ operation จะจองหน่วยความจำ
+
+#ifndef EMBEDDED_BUILD
+    #include <atomic>
+    #define QUOTA_THREAD_LOCAL thread_local
+#else
+    #define QUOTA_THREAD_LOCAL
+#endif
+
+// รายงานของ operation ล่าสุดที่เกิน quota ต่อ thread (เขียนเฉพาะตอน fail แบบเดียวกับ error code)
+static QUOTA_THREAD_LOCAL MyQuotaReport quota_report;
+static QUOTA_THREAD_LOCAL bool quota_reported = false;
+
+// ยอดถูกบวกแบบ atomic เฉพาะ concurrent mode - ที่เหลือ (ยอด, quota, flag, parent) ใช้ wrapper ใน MountkitInternal.h
+#ifndef EMBEDDED_BUILD
+static inline void counterAdd(size_t *counter, size_t value, bool shared) {
+    if (shared) sharedField(counter)->fetch_add(value, std::memory_order_relaxed);
+    else *counter += value;
+}
+#else
+static inline void counterAdd(size_t *counter, size_t value, bool shared) { (void)shared; *counter += value; }
+#endif
+
+static void usageLoad(const MyFolder *folder, MyUsage *out) {
+    out->bytes = loadRelaxed(&folder->usage.bytes);
+    out->capacity = loadRelaxed(&folder->usage.capacity);
+    out->files = loadRelaxed(&folder->usage.files);
+    out->dirs = loadRelaxed(&folder->usage.dirs);
+    out->names = loadRelaxed(&folder->usage.names);
+    out->mounts = loadRelaxed(&folder->usage.mounts);
+}
+
+// out += u (หรือ -= u)
+static void usageSum(MyUsage *out, const MyUsage *u, bool subtract) {
+    out->bytes += subtract ? 0 - u->bytes : u->bytes;
+    out->capacity += subtract ? 0 - u->capacity : u->capacity;
+    out->files += subtract ? 0 - u->files : u->files;
+    out->dirs += subtract ? 0 - u->dirs : u->dirs;
+    out->names += subtract ? 0 - u->names : u->names;
+    out->mounts += subtract ? 0 - u->mounts : u->mounts;
+}
+
+// ส่วนของไฟล์หนึ่งตัวในยอดรวม
+static void fileUsage(const MyFile *file, MyUsage *out) {
+    memset(out, 0, sizeof(*out));
+    out->bytes = file->size;
+    out->capacity = file->capacity;
+    out->files = 1;
+    out->names = strlen((const char*)file->name) + 1;
+}
+
+void mountkit::usageAdd(MyFolder *folder, const MyUsage *delta, bool subtract) {
+    MyUsage d = *delta;
+    if (subtract) {
+        memset(&d, 0, sizeof(d));
+        usageSum(&d, delta, true);
+    }
+    for (MyFolder *f = folder; f; f = loadShared(&f->parent)) {
+        counterAdd(&f->usage.bytes, d.bytes, concurrent);
+        counterAdd(&f->usage.capacity, d.capacity, concurrent);
+        counterAdd(&f->usage.files, d.files, concurrent);
+        counterAdd(&f->usage.dirs, d.dirs, concurrent);
+        counterAdd(&f->usage.names, d.names, concurrent);
+        counterAdd(&f->usage.mounts, d.mounts, concurrent);
+    }
+}
+
+void mountkit::usageResize(MyFile *file, size_t old_size, size_t new_size, size_t old_capacity, size_t new_capacity) {
+    if (!file->folder || (old_size == new_size && old_capacity == new_capacity)) return;
+    MyUsage d;
+    memset(&d, 0, sizeof(d));
+    d.bytes = new_size - old_size;
+    d.capacity = new_capacity - old_capacity;
+    usageAdd(file->folder, &d, false);
+}
+
+void mountkit::usageLink(MyFolder *folder, MyFile *file) {
+    MyUsage d;
+    fileUsage(file, &d);
+    file->folder = folder;
+    usageAdd(folder, &d, false);
+}
+
+void mountkit::usageUnlink(MyFile *file) {
+    MyFolder *folder = file->folder;
+    if (!folder) return;
+    MyUsage d;
+    fileUsage(file, &d);
+    file->folder = NULL;
+    usageAdd(folder, &d, true);
+}
+
+void mountkit::usageAttach(MyFolder *parent, MyFolder *child) {
+    storeShared(&child->parent, parent);
+    if (!parent) return;
+    MyUsage d;
+    usageLoad(child, &d);
+    usageAdd(parent, &d, false);
+}
+
+void mountkit::usageDetach(MyFolder *child) {
+    MyFolder *parent = loadShared(&child->parent);
+    storeShared(&child->parent, (MyFolder*)NULL); // writer ที่เดินขึ้นมาหลังจากนี้หยุดที่ child
+    if (!parent) return;
+    MyUsage d;
+    usageLoad(child, &d);
+    usageAdd(parent, &d, true);
+}
+
+// pre-visit: ยอดของ folder เอง และ parent = folder ของระดับก่อนหน้า, post-visit: บวกยอดทั้ง subtree เข้า parent
+void mountkit::usageRebuild(MyFolder *folder) {
+    MyIter it;
+    iter_begin(&it, folder, MOUNTKIT_ITER_PRE | MOUNTKIT_ITER_POST);
+    while (iter_next(&it)) {
+        MyFolder *current = it.folder;
+        MyFolder *up = (MyFolder*)*iter_data(&it, 1);
+        if (it.post) {
+            if (up) usageSum(&up->usage, &current->usage, false);
+            continue;
+        }
+        *iter_data(&it, 0) = current;
+        if (up) current->parent = up;
+        memset(&current->usage, 0, sizeof(current->usage));
+        current->usage.dirs = 1;
+        current->usage.names = strlen(current->data);
+        current->usage.mounts = current->mounted ? 1 : 0;
+        for (MyFile *f = current->files; f; f = f->next) {
+            MyUsage d;
+            fileUsage(f, &d);
+            f->folder = current;
+            usageSum(&current->usage, &d, false);
+        }
+    }
+    iter_end(&it);
+}
+
+size_t mountkit::scanCapacity(MyFolder *folder) {
+    size_t total = sizeof(MyFolder) + strlen(folder->data);
+    readLock(&folder->lock);
+    for (MyFile *f = folder->files; f; f = f->next) {
+        readLock(&f->lock);
+        total += f->capacity;
+        readUnlock(&f->lock);
+        total += sizeof(MyFile) + strlen((char*)f->name) + 1;
+    }
+    readUnlock(&folder->lock);
+    return total;
+}
+
+// ยอดของ folder เองไม่รวม subdirectory: ยอดรวม - ยอดของลูกทุกตัว (ผู้เรียกถือ read lock ของ folder)
+static void usageOwn(MyFolder *folder, MyUsage *out) {
+    usageLoad(folder, out);
+    for (MyFolder *sub = folder->subdir; sub; sub = sub->dir) {
+        MyUsage child;
+        usageLoad(sub, &child);
+        usageSum(out, &child, true);
+    }
+}
+
+int mountkit::usage(MyFolder *folder, MyUsage *out, bool include_subdirs) {
+    if (!folder || !out) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    MyFolder *inner = followMount(folder);
+    if (!include_subdirs) {
+        readLock(&inner->lock);
+        usageOwn(inner, out);
+        readUnlock(&inner->lock);
+        out->mounts = 0;
+        for (MyFolder *layer = folder; layer->mounted; layer = layer->mounted) out->mounts++;
+        return 1;
+    }
+    usageLoad(inner, out);
+    if (out->mounts == 0 && inner == folder) return 1;
+
+    // มี mount point ข้างใน: ใช้ยอดของ subtree ที่ไม่มี mount ได้ทันที เดินต่อเฉพาะ folder ที่มี mount อยู่ข้างใต้
+    // folder ถูก read lock ตั้งแต่ pre-visit จนถึง post-visit (ช่วงที่ iterator อ่านลูกของมัน)
+    memset(out, 0, sizeof(*out));
+    MyIter it;
+    iter_begin(&it, folder, MOUNTKIT_ITER_PRE | MOUNTKIT_ITER_POST | MOUNTKIT_ITER_MOUNTS);
+    while (iter_next(&it)) {
+        MyFolder *current = it.folder;
+        if (it.post) {
+            readUnlock(&current->lock);
+            continue;
+        }
+        for (MyFolder *layer = it.entry; layer->mounted; layer = layer->mounted) out->mounts++;
+        readLock(&current->lock);
+        MyUsage part;
+        usageLoad(current, &part);
+        if (part.mounts == 0) {
+            iter_prune(&it);
+        } else {
+            usageOwn(current, &part);
+            part.mounts = 0; // นับจาก entry ที่เดินผ่านแทน
+        }
+        usageSum(out, &part, false);
+    }
+    iter_end(&it);
+    return 1;
+}
+
+// =================================================================
+// quota
+// =================================================================
+
+static void quotaFill(MyFolder *folder, MyQuotaReport *out) {
+    snprintf(out->name, sizeof(out->name), "%s", folder->data);
+    out->limit.bytes = loadRelaxed(&folder->quota.bytes);
+    out->limit.nodes = loadRelaxed(&folder->quota.nodes);
+    usageLoad(folder, &out->used);
+    out->bytes = 0;
+    out->nodes = 0;
+}
+
+// used + add > limit โดยไม่ overflow (limit 0 = ไม่จำกัด, add 0 = operation ไม่ได้ขอส่วนนี้เพิ่ม)
+static inline bool quotaOver(size_t used, size_t add, size_t limit) {
+    return limit && add && (used >= limit || add > limit - used);
+}
+
+static inline bool quotaHas(const MyFolder *folder) {
+    return loadRelaxed(&folder->quota.bytes) || loadRelaxed(&folder->quota.nodes);
+}
+
+// ยอดของ folder ที่มี quota + ส่วนที่ขอเพิ่มเกินขีดจำกัดหรือไม่ - ถ้าเกินบันทึกรายงานของ thread นี้
+static bool quotaExceeded(MyFolder *folder, size_t bytes, size_t nodes) {
+    size_t max_bytes = loadRelaxed(&folder->quota.bytes);
+    size_t max_nodes = loadRelaxed(&folder->quota.nodes);
+    size_t used_nodes = loadRelaxed(&folder->usage.files) + loadRelaxed(&folder->usage.dirs);
+    if (!quotaOver(loadRelaxed(&folder->usage.capacity), bytes, max_bytes) && !quotaOver(used_nodes, nodes, max_nodes)) {
+        return false;
+    }
+    quotaFill(folder, &quota_report);
+    quota_report.bytes = bytes;
+    quota_report.nodes = nodes;
+    quota_reported = true;
+    #ifdef LIB_DEBUG
+        printf("Error: quota of '%s' exceeded (%zu/%zu bytes, %zu/%zu nodes, +%zu bytes, +%zu nodes)\n",
+               folder->data, quota_report.used.capacity, max_bytes, used_nodes, max_nodes, bytes, nodes);
+    #endif
+    return true;
+}
+
+int mountkit::quotaCheck(MyFolder *folder, size_t bytes, size_t nodes) {
+    if (!loadRelaxed(&quotas)) return 1;
+    for (MyFolder *f = folder; f; f = loadShared(&f->parent)) {
+        if (quotaHas(f) && quotaExceeded(f, bytes, nodes)) {
+            setError(MOUNTKIT_EDQUOT);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int mountkit::quotaCheckAll(MyFolder *const *folders, const MyQuota *adds, size_t count) {
+    if (!loadRelaxed(&quotas)) return 1;
+    // ยอดที่ขอเพิ่มรวมต่อ folder ที่มี quota (มักมีไม่กี่ตัว - ค้นแบบเส้นตรง)
+    MyFolder **keys = NULL;
+    MyQuota *sums = NULL;
+    size_t used = 0, capacity = 0;
+    int ok = 1;
+    for (size_t i = 0; i < count && ok; ++i) {
+        for (MyFolder *f = folders[i]; f && ok; f = loadShared(&f->parent)) {
+            if (!quotaHas(f)) continue;
+            size_t k = 0;
+            while (k < used && keys[k] != f) k++;
+            if (k == used) {
+                if (used == capacity) {
+                    capacity = capacity ? capacity * 2 : 8;
+                    MyFolder **more_keys = (MyFolder**)realloc(keys, capacity * sizeof(MyFolder*));
+                    if (more_keys) keys = more_keys;
+                    MyQuota *more_sums = (MyQuota*)realloc(sums, capacity * sizeof(MyQuota));
+                    if (more_sums) sums = more_sums;
+                    if (!more_keys || !more_sums) {
+                        setError(MOUNTKIT_ENOMEM);
+                        ok = 0;
+                        break;
+                    }
+                }
+                keys[used] = f;
+                sums[used].bytes = 0;
+                sums[used].nodes = 0;
+                used++;
+            }
+            sums[k].bytes += adds[i].bytes;
+            sums[k].nodes += adds[i].nodes;
+        }
+    }
+    for (size_t k = 0; k < used && ok; ++k) {
+        if (quotaExceeded(keys[k], sums[k].bytes, sums[k].nodes)) {
+            setError(MOUNTKIT_EDQUOT);
+            ok = 0;
+        }
+    }
+    free(keys);
+    free(sums);
+    return ok;
+}
+
+int mountkit::quota_set(MyFolder *folder, size_t max_bytes, size_t max_nodes) {
+    if (!folder) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    folder = followMount(folder);
+    storeRelaxed(&folder->quota.bytes, max_bytes);
+    storeRelaxed(&folder->quota.nodes, max_nodes);
+    if (max_bytes || max_nodes) storeRelaxed(&quotas, true); // ไม่ย้อนกลับ - folder ที่มี quota อาจยังอยู่ที่ใดใน tree
+    return 1;
+}
+
+int mountkit::quota_get(MyFolder *folder, MyQuotaReport *report) {
+    if (!folder || !report) {
+        setError(MOUNTKIT_EINVAL);
+        return 0;
+    }
+    folder = followMount(folder);
+    quotaFill(folder, report);
+    return report->limit.bytes || report->limit.nodes;
+}
+
+int mountkit::quota_last(MyQuotaReport *report) {
+    if (!report || !quota_reported) return 0;
+    *report = quota_report;
+    return 1;
+}
@@ -0,0 +1,225 @@
+#include "MountkitInternal.h"
+
+// iterator ของ tree บน explicit stack/queue - ทุก traversal ภายในใช้ตัวนี้แทน recursion
+// depth-first: frame หนึ่งตัวต่อระดับ พร้อม cursor ของไฟล์และลูกถัดไป (stack โตตามความลึก ไม่ใช่ตามจำนวนลูก)
+// breadth-first: queue ของ folder ที่รอ visit (โตตามความกว้างของระดับ)
+
+// สถานะของ frame
+#define ITER_FRESH    0 // ยังไม่ได้ pre-visit
+#define ITER_EXPAND   1 // pre-visit แล้ว ยังไม่ได้อ่าน link ของลูก
+#define ITER_FILES    2 // กำลัง visit ไฟล์
+#define ITER_CHILDREN 3 // กำลังเข้า subfolder (depth-first) / รอใส่ลูกลง queue (breadth-first)
+#define ITER_DONE     4 // post-visit แล้ว
+
+static MyFolder* iterInner(const MyIter *it, MyFolder *node) {
+    return (it->flags & MOUNTKIT_ITER_MOUNTS) ? followMount(node) : node;
+}
+
+// เพิ่ม frame ท้าย array - ใช้ inline_frames จนเต็มแล้วจึงย้ายไป heap
+static MyIterFrame* iterPush(MyIter *it, MyFolder *node, int depth) {
+    if (it->count == it->capacity) {
+        size_t capacity = it->capacity * 2;
+        MyIterFrame *grown;
+        if (it->frames == it->inline_frames) {
+            grown = (MyIterFrame*)malloc(capacity * sizeof(MyIterFrame));
+            if (grown) memcpy(grown, it->frames, it->count * sizeof(MyIterFrame));
+        } else {
+            grown = (MyIterFrame*)realloc(it->frames, capacity * sizeof(MyIterFrame));
+        }
+        if (!grown) {
+            it->failed = true;
+            return NULL;
+        }
+        it->frames = grown;
+        it->capacity = capacity;
+    }
+    MyIterFrame *f = &it->frames[it->count++];
+    f->node = node;
+    f->next_child = NULL;
+    f->next_file = NULL;
+    f->data = NULL;
+    f->depth = depth;
+    f->state = ITER_FRESH;
+    return f;
+}
+
+static int iterVisit(MyIter *it, const MyIterFrame *f, MyFile *file, bool post) {
+    it->entry = f->node;
+    it->folder = iterInner(it, f->node);
+    it->file = file;
+    it->depth = file ? f->depth + 1 : f->depth;
+    it->post = post;
+    return 1;
+}
+
+void mountkit::iter_begin(MyIter *it, MyFolder *folder, int flags) {
+    it->folder = it->entry = NULL;
+    it->file = NULL;
+    it->depth = 0;
+    it->post = false;
+    it->failed = false;
+    it->flags = flags;
+    it->frames = it->inline_frames;
+    it->count = 0;
+    it->head = 0;
+    it->capacity = MOUNTKIT_ITER_INLINE;
+    if (!folder) return;
+    if (flags & MOUNTKIT_ITER_BFS) {
+        for (MyFolder *start = folder; start; start = (flags & MOUNTKIT_ITER_SIBLINGS) ? start->dir : NULL) {
+            if (!iterPush(it, start, 0)) return;
+        }
+        return;
+    }
+    // frame ระดับบนสุด: ลูกของมันคือ node เริ่มต้น (และ sibling ถ้าขอ)
+    MyIterFrame *top = iterPush(it, NULL, -1);
+    top->next_child = folder;
+    top->state = ITER_CHILDREN;
+}
+
+// depth-first: ทำงานกับ frame บนสุดจนได้ node ที่ต้อง visit
+static int iterNextDepth(MyIter *it) {
+    while (it->count > 0) {
+        MyIterFrame *f = &it->frames[it->count - 1];
+        switch (f->state) {
+        case ITER_FRESH:
+            f->state = ITER_EXPAND;
+            if (it->flags & MOUNTKIT_ITER_PRE) return iterVisit(it, f, NULL, false);
+            break;
+        case ITER_EXPAND: {
+            // อ่าน link หลัง pre-visit - ผู้เรียกล็อก folder ไว้แล้วถ้าต้องการ
+            MyFolder *inner = iterInner(it, f->node);
+            f->next_file = (it->flags & MOUNTKIT_ITER_FILES) ? inner->files : NULL;
+            f->next_child = inner->subdir;
+            f->state = ITER_FILES;
+            break;
+        }
+        case ITER_FILES:
+            if (f->next_file) {
+                MyFile *file = f->next_file;
+                f->next_file = file->next; // อ่านก่อน visit - ผู้เรียกลบไฟล์นี้ได้
+                return iterVisit(it, f, file, false);
+            }
+            f->state = ITER_CHILDREN;
+            break;
+        case ITER_CHILDREN:
+            if (f->next_child) {
+                MyFolder *child = f->next_child;
+                bool siblings = f->node || (it->flags & MOUNTKIT_ITER_SIBLINGS);
+                f->next_child = siblings ? child->dir : NULL;
+                if (!iterPush(it, child, f->depth + 1)) return 0;
+                break;
+            }
+            f->state = ITER_DONE;
+            if (f->node && (it->flags & MOUNTKIT_ITER_POST)) return iterVisit(it, f, NULL, true);
+            break;
+        default:
+            it->count--;
+            break;
+        }
+    }
+    return 0;
+}
+
+// breadth-first: frame ที่หัว queue คือ folder ที่กำลัง visit
+static int iterNextBreadth(MyIter *it) {
+    while (it->head < it->count) {
+        size_t index = it->head;
+        MyIterFrame *f = &it->frames[index];
+        switch (f->state) {
+        case ITER_FRESH:
+            f->state = ITER_EXPAND;
+            if (it->flags & MOUNTKIT_ITER_PRE) return iterVisit(it, f, NULL, false);
+            break;
+        case ITER_EXPAND: {
+            MyFolder *inner = iterInner(it, f->node);
+            f->next_file = (it->flags & MOUNTKIT_ITER_FILES) ? inner->files : NULL;
+            f->next_child = inner->subdir;
+            f->state = ITER_FILES;
+            break;
+        }
+        case ITER_FILES:
+            if (f->next_file) {
+                MyFile *file = f->next_file;
+                f->next_file = file->next;
+                return iterVisit(it, f, file, false);
+            }
+            f->state = ITER_CHILDREN;
+            break;
+        case ITER_CHILDREN:
+            // ใส่ลูกทั้งหมดลง queue (array อาจย้าย - อ้าง frame ด้วย index)
+            while (it->frames[index].next_child) {
+                MyFolder *child = it->frames[index].next_child;
+                it->frames[index].next_child = child->dir;
+                if (!iterPush(it, child, it->frames[index].depth + 1)) return 0;
+            }
+            it->frames[index].state = ITER_DONE;
+            break;
+        default:
+            it->head++;
+            // queue ว่าง หรือส่วนที่ใช้ไปแล้วเกินครึ่ง - เลื่อนกลับไปต้น array
+            if (it->head == it->count) {
+                it->head = it->count = 0;
+            } else if (it->head > it->capacity / 2) {
+                memmove(it->frames, it->frames + it->head, (it->count - it->head) * sizeof(MyIterFrame));
+                it->count -= it->head;
+                it->head = 0;
+            }
+            break;
+        }
+    }
+    return 0;
+}
+
+int mountkit::iter_next(MyIter *it) {
+    if (!it || it->failed) return 0;
+    return (it->flags & MOUNTKIT_ITER_BFS) ? iterNextBreadth(it) : iterNextDepth(it);
+}
+
+void mountkit::iter_prune(MyIter *it) {
+    if (!it) return;
+    size_t index = (it->flags & MOUNTKIT_ITER_BFS) ? it->head : it->count - 1;
+    if (index >= it->count) return;
+    MyIterFrame *f = &it->frames[index];
+    if (f->state == ITER_EXPAND) {
+        f->state = ITER_FILES; // ไม่อ่าน link ของลูกเลย
+    }
+    f->next_file = NULL;
+    f->next_child = NULL;
+}
+
+void** mountkit::iter_data(MyIter *it, int up) {
+    if (!it || up < 0) return NULL;
+    if (it->flags & MOUNTKIT_ITER_BFS) {
+        return (up == 0 && it->head < it->count) ? &it->frames[it->head].data : NULL;
+    }
+    if ((size_t)up >= it->count) return NULL;
+    return &it->frames[it->count - 1 - up].data;
+}
+
+size_t mountkit::iter_path(MyIter *it, char *buf, size_t size, int from_depth) {
+    size_t len = 0;
+    if (buf && size) buf[0] = '\0';
+    if (!it || (it->flags & MOUNTKIT_ITER_BFS)) return 0;
+    // frame 0 คือระดับเหนือ node เริ่มต้น, frame ที่เหลือคือ ancestor จนถึง folder ปัจจุบัน
+    for (size_t i = 1; i <= it->count; ++i) {
+        const char *name;
+        if (i < it->count) {
+            if (it->frames[i].depth < from_depth) continue;
+            name = it->frames[i].node->data;
+        } else {
+            if (!it->file || it->depth < from_depth) break;
+            name = (const char*)it->file->name;
+        }
+        bool room = buf && len < size;
+        int n = snprintf(room ? buf + len : NULL, room ? size - len : 0, "%s%s", len ? "/" : "", name);
+        if (n > 0) len += (size_t)n;
+    }
+    return len;
+}
+
+void mountkit::iter_end(MyIter *it) {
+    if (!it) return;
+    if (it->frames != it->inline_frames) free(it->frames);
+    it->frames = it->inline_frames;
+    it->count = it->head = 0;
+}
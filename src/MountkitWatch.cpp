@@ -0,0 +1,302 @@
+#include "MountkitInternal.h"
+
+// watch: operation ที่แก้ tree ส่ง event ขนาดคงที่ลง ring buffer ของแต่ละ subscriber
+// ผู้ส่ง (thread ที่แก้ tree) จอง slot ด้วย CAS บน tail แล้ว publish ด้วย seq ของ slot - ไม่มีผู้ส่งคนใดรอกัน
+// ผู้อ่านไม่ถือ lock ใดเลย: หยิบ event ด้วย atomic exchange แล้วคืน slot ผ่าน seq
+// watch list ยังอ่านภายใต้ read lock ของ watch_lock - unwatch คืน queue ทันทีโดยไม่รอ grace period
+// watch_lock ทำงานแม้ไม่ได้เปิด concurrent mode: unwatch/watch_poll มักอยู่คนละ thread กับผู้แก้ tree
+
+#ifndef EMBEDDED_BUILD
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <vector>
+#include <new>
+
+#define WATCH_NAME_SIZE  sizeof(((MyWatchEvent*)0)->name)
+#define WATCH_NAME_WORDS (WATCH_NAME_SIZE / sizeof(uint64_t))
+
+// slot หนึ่งช่องของ queue (bounded MPSC แบบ sequence ต่อ slot)
+// ผู้ส่งที่รวม event อ่าน mask/name พร้อมกับผู้ส่งที่อาจเขียน slot รอบถัดไป - จึงเป็น atomic ทุก word
+// และตรวจซ้ำด้วย CAS บน state ที่มีรอบของ slot อยู่ด้วย (slot ถูกใช้ใหม่ = CAS fail)
+typedef struct WatchSlot {
+    std::atomic<size_t> seq;      // == pos: ว่างสำหรับตำแหน่ง pos, == pos + 1: publish แล้ว
+    std::atomic<uint64_t> state;  // (uint32_t)pos << 32 | count - count 0 = ผู้อ่านหยิบไปแล้ว
+    std::atomic<uint32_t> mask;
+    std::atomic<uint64_t> name[WATCH_NAME_WORDS];
+} WatchSlot;
+
+static_assert(WATCH_NAME_SIZE % sizeof(uint64_t) == 0, "event name must pack into 64-bit words");
+
+typedef struct MyWatch {
+    const void *target;           // folder หรือไฟล์ (NULL = ถูกลบไปแล้ว)
+    uint32_t mask;
+    struct MyWatch *next;         // watch list ของ mountkit
+    WatchSlot *slots;
+    size_t capacity;              // กำลังของ 2
+    std::atomic<size_t> tail;     // ผู้ส่งจองด้วย CAS
+    char pad[64];                 // head/tail คนละ cache line
+    std::atomic<size_t> head;     // ผู้อ่านเขียน
+    std::atomic<bool> overflow;   // มี event ถูกทิ้งและยังไม่ได้ส่ง marker
+    std::atomic<bool> sleeping;   // ผู้อ่านกำลัง block ใน watch_wait
+    std::mutex wait_lock;
+    std::condition_variable wake;
+} MyWatch;
+
+// ชื่อที่ตัดแล้วในรูป word (byte ที่เหลือเป็น 0) - ใช้ทั้งตอนเขียนและตอนเทียบกับ slot
+static void watchPackName(uint64_t *words, const char *name) {
+    char buf[WATCH_NAME_SIZE];
+    size_t len = name ? strlen(name) : 0;
+    if (len >= WATCH_NAME_SIZE) len = WATCH_NAME_SIZE - 1;
+    memset(buf, 0, sizeof(buf));
+    memcpy(buf, name ? name : "", len);
+    memcpy(words, buf, sizeof(buf));
+}
+
+static inline uint64_t watchState(size_t pos, uint32_t count) {
+    return (uint64_t)(uint32_t)pos << 32 | count;
+}
+
+// จอง slot ถัดไปด้วย CAS บน tail แล้ว publish - คืน false ถ้าเต็ม
+static bool watchPush(MyWatch *w, uint32_t mask, const uint64_t *name) {
+    size_t pos = w->tail.load(std::memory_order_relaxed);
+    WatchSlot *slot;
+    for (;;) {
+        slot = &w->slots[pos & (w->capacity - 1)];
+        size_t seq = slot->seq.load(std::memory_order_acquire);
+        if (seq == pos) {
+            if (w->tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if ((ptrdiff_t)(seq - pos) < 0) {
+            return false; // ผู้อ่านยังไม่คืน slot ของรอบก่อน
+        } else {
+            pos = w->tail.load(std::memory_order_relaxed); // ผู้ส่งอื่นจองไปแล้ว
+        }
+    }
+    slot->mask.store(mask, std::memory_order_relaxed);
+    for (size_t i = 0; i < WATCH_NAME_WORDS; ++i) slot->name[i].store(name[i], std::memory_order_relaxed);
+    slot->state.store(watchState(pos, 1), std::memory_order_relaxed);
+    slot->seq.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+// รวมกับ event ล่าสุดถ้า publish แล้ว ยังไม่ถูกอ่าน และเหมือนกันทุก field
+static bool watchMerge(MyWatch *w, uint32_t mask, const uint64_t *name) {
+    size_t pos = w->tail.load(std::memory_order_acquire) - 1;
+    WatchSlot *last = &w->slots[pos & (w->capacity - 1)];
+    if (last->seq.load(std::memory_order_acquire) != pos + 1) return false;
+    uint64_t state = last->state.load(std::memory_order_acquire);
+    if ((uint32_t)state == 0 || state >> 32 != (uint32_t)pos) return false;
+    if (last->mask.load(std::memory_order_relaxed) != mask) return false;
+    for (size_t i = 0; i < WATCH_NAME_WORDS; ++i) {
+        if (last->name[i].load(std::memory_order_relaxed) != name[i]) return false;
+    }
+    // ผู้อ่านหยิบไปแล้วหรือ slot ถูกใช้รอบใหม่ระหว่างเทียบ = state เปลี่ยน
+    return last->state.compare_exchange_strong(state, state + 1, std::memory_order_acq_rel);
+}
+
+// ส่ง event ให้ watch หนึ่งตัว: รวมกับ event ล่าสุดถ้ายังไม่ถูกอ่าน, ไม่งั้นต่อท้าย
+// คืน true ถ้ามี slot ใหม่ที่ผู้อ่านอาจกำลังรออยู่
+static bool watchSend(MyWatch *w, uint32_t mask, const char *name) {
+    uint64_t packed[WATCH_NAME_WORDS];
+    watchPackName(packed, name);
+    if (watchMerge(w, mask, packed)) return false;
+    // marker ต้องมาก่อน event ที่ตามหลัง event ที่หายไป (ผู้ส่งที่ทำงานพร้อมกันอาจแทรกระหว่างนั้นได้)
+    if (w->overflow.load(std::memory_order_relaxed) && w->overflow.exchange(false)) {
+        uint64_t empty[WATCH_NAME_WORDS];
+        watchPackName(empty, NULL);
+        if (!watchPush(w, MOUNTKIT_WATCH_OVERFLOW, empty)) {
+            w->overflow.store(true);
+            return false;
+        }
+    }
+    if (!watchPush(w, mask, packed)) w->overflow.store(true);
+    return true;
+}
+
+// ปลุกผู้อ่านที่ block อยู่ - fence คู่กับการตั้ง sleeping ใน watch_wait (ไม่มีใครพลาด wakeup)
+static void watchWake(MyWatch *w) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (w->sleeping.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> guard(w->wait_lock);
+        w->wake.notify_one();
+    }
+}
+
+void mountkit::notify(const void *node, uint32_t mask, const char *name) {
+    if (!loadShared(&watches)) return;
+    rwReadLock(&watch_lock);
+    for (MyWatch *w = watches; w; w = w->next) {
+        if (w->target != node || !(w->mask & mask)) continue;
+        if (watchSend(w, mask, name)) watchWake(w);
+    }
+    rwReadUnlock(&watch_lock);
+}
+
+void mountkit::notifyGone(MyFolder *folder, MyFile *file) {
+    if (!loadShared(&watches)) return;
+    std::vector<const void*> gone;
+    if (file) gone.push_back(file);
+    // subtree ถูกถอดออกแล้ว แต่ handle ที่ถืออยู่ (safe handle) ยังแก้ได้ - อ่าน list ภายใต้ lock ของ folder
+    std::vector<MyFolder*> pending;
+    if (folder) pending.push_back(folder);
+    while (!pending.empty()) {
+        MyFolder *current = pending.back();
+        pending.pop_back();
+        gone.push_back(current);
+        readLock(&current->lock);
+        for (MyFile *f = current->files; f; f = f->next) {
+            // hard link: ไฟล์จริงยังอยู่ถ้ามีชื่ออื่นเหลือ (นับไม่ตรงเมื่อหลายชื่ออยู่ใน subtree เดียวกัน)
+            MyFile *inode = fileTarget(f);
+            if (loadRelaxed(&inode->links) == 1) gone.push_back(inode);
+        }
+        for (MyFolder *sub = current->subdir; sub; sub = sub->dir) pending.push_back(sub);
+        readUnlock(&current->lock);
+    }
+
+    rwWriteLock(&watch_lock);
+    for (MyWatch *w = watches; w; w = w->next) {
+        if (!w->target) continue;
+        for (size_t i = 0; i < gone.size(); ++i) {
+            if (w->target != gone[i]) continue;
+            if (watchSend(w, MOUNTKIT_WATCH_DELETE_SELF, NULL)) watchWake(w);
+            w->target = NULL; // address อาจถูกใช้ใหม่หลังคืนหน่วยความจำ
+            break;
+        }
+    }
+    rwWriteUnlock(&watch_lock);
+}
+
+void mountkit::watchRetarget(const void *from, const void *to) {
+    if (!loadShared(&watches)) return;
+    rwWriteLock(&watch_lock);
+    for (MyWatch *w = watches; w; w = w->next) {
+        if (w->target == from) w->target = to;
+    }
+    rwWriteUnlock(&watch_lock);
+}
+
+static MyWatch* watchCreate(const void *target, uint32_t mask, size_t capacity) {
+    size_t slots = 2;
+    while (slots < capacity) slots *= 2;
+    MyWatch *w = new (std::nothrow) MyWatch;
+    if (!w) return NULL;
+    w->slots = new (std::nothrow) WatchSlot[slots];
+    if (!w->slots) {
+        delete w;
+        return NULL;
+    }
+    for (size_t i = 0; i < slots; ++i) {
+        w->slots[i].seq.store(i, std::memory_order_relaxed);
+        w->slots[i].state.store(0, std::memory_order_relaxed);
+    }
+    w->target = target;
+    w->mask = mask;
+    w->next = NULL;
+    w->capacity = slots;
+    w->tail.store(0, std::memory_order_relaxed);
+    w->head.store(0, std::memory_order_relaxed);
+    w->overflow.store(false, std::memory_order_relaxed);
+    w->sleeping.store(false, std::memory_order_relaxed);
+    return w;
+}
+
+MyWatch* mountkit::watchNode(const void *node, uint32_t mask, size_t capacity) {
+    if (!node || !(mask & MOUNTKIT_WATCH_ALL)) {
+        setError(MOUNTKIT_EINVAL);
+        return NULL;
+    }
+    MyWatch *w = watchCreate(node, mask, capacity);
+    if (!w) {
+        setError(MOUNTKIT_ENOMEM);
+        return NULL;
+    }
+    rwWriteLock(&watch_lock);
+    w->next = watches;
+    storeShared(&watches, w);
+    rwWriteUnlock(&watch_lock);
+    return w;
+}
+
+MyWatch* mountkit::watch(MyFolder *folder, uint32_t mask, size_t capacity) {
+    return watchNode(folder, mask, capacity);
+}
+
+MyWatch* mountkit::watch(MyFile *file, uint32_t mask, size_t capacity) {
+    return watchNode(file ? fileTarget(file) : NULL, mask, capacity); // hard link: ดูไฟล์จริง
+}
+
+void mountkit::unwatch(MyWatch *w) {
+    if (!w) return;
+    // ได้ write lock แล้ว = ไม่มีผู้ส่งคนใดถือ watch นี้อยู่
+    rwWriteLock(&watch_lock);
+    MyWatch **cur = &watches;
+    while (*cur && *cur != w) cur = &(*cur)->next;
+    if (*cur) storeShared(cur, w->next);
+    rwWriteUnlock(&watch_lock);
+    delete[] w->slots;
+    delete w;
+}
+
+int mountkit::watch_poll(MyWatch *w, MyWatchEvent *events, int max_events) {
+    if (!w || !events || max_events <= 0) return 0;
+    int n = 0;
+    size_t head = w->head.load(std::memory_order_relaxed);
+    bool empty = false;
+    while (n < max_events) {
+        WatchSlot *slot = &w->slots[head & (w->capacity - 1)];
+        // slot ที่ผู้ส่งจองแล้วแต่ยัง publish ไม่เสร็จนับเป็นจุดสิ้นสุดของ queue ในรอบนี้
+        if (slot->seq.load(std::memory_order_acquire) != head + 1) {
+            empty = true;
+            break;
+        }
+        // หยิบก่อนอ่าน - หลังจากนี้ผู้ส่งรวม event เข้า slot นี้ไม่ได้แล้ว
+        events[n].count = (uint32_t)slot->state.exchange(watchState(head, 0), std::memory_order_acq_rel);
+        events[n].mask = slot->mask.load(std::memory_order_relaxed);
+        uint64_t packed[WATCH_NAME_WORDS];
+        for (size_t i = 0; i < WATCH_NAME_WORDS; ++i) packed[i] = slot->name[i].load(std::memory_order_relaxed);
+        memcpy(events[n].name, packed, sizeof(events[n].name));
+        slot->seq.store(head + w->capacity, std::memory_order_release); // คืน slot ให้ผู้ส่งรอบถัดไป
+        n++;
+        head++;
+        w->head.store(head, std::memory_order_relaxed);
+    }
+    // queue ว่างแล้วแต่ยังมี event ที่ถูกทิ้ง - ส่ง marker เอง (ผู้ส่งอาจยังไม่มี event ใหม่มาอีก)
+    if (empty && w->overflow.load(std::memory_order_relaxed) && w->overflow.exchange(false)) {
+        events[n].mask = MOUNTKIT_WATCH_OVERFLOW;
+        events[n].count = 1;
+        events[n].name[0] = '\0';
+        n++;
+    }
+    return n;
+}
+
+int mountkit::watch_wait(MyWatch *w, MyWatchEvent *events, int max_events, int timeout_ms) {
+    int n = watch_poll(w, events, max_events);
+    if (n || !w || timeout_ms == 0) return n;
+    std::chrono::steady_clock::time_point deadline =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms < 0 ? 0 : timeout_ms);
+    std::unique_lock<std::mutex> guard(w->wait_lock);
+    w->sleeping.store(true);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    while ((n = watch_poll(w, events, max_events)) == 0) {
+        if (timeout_ms < 0) {
+            w->wake.wait(guard);
+        } else if (w->wake.wait_until(guard, deadline) == std::cv_status::timeout) {
+            n = watch_poll(w, events, max_events);
+            break;
+        }
+    }
+    w->sleeping.store(false, std::memory_order_relaxed);
+    return n;
+}
+
+#else // EMBEDDED_BUILD
+
+// embedded: ไม่มี thread ให้รอ event - operation ไม่ต้องแจ้งใคร
+void mountkit::notify(const void *node, uint32_t mask, const char *name) { (void)node; (void)mask; (void)name; }
+void mountkit::notifyGone(MyFolder *folder, MyFile *file) { (void)folder; (void)file; }
+void mountkit::watchRetarget(const void *from, const void *to) { (void)from; (void)to; }
+
+#endif // EMBEDDED_BUILD